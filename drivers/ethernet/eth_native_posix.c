@@ -175,12 +175,38 @@ static void update_gptp(struct net_if *iface, struct net_pkt *pkt,
 #define update_gptp(iface, pkt, send)
 #endif /* CONFIG_NET_GPTP */
 
+#if defined(CONFIG_ETH_NATIVE_POSIX_TSO)
+static int eth_send_segment(struct net_pkt *pkt, u8_t *frame, size_t len,
+			    void *user_data)
+{
+	struct eth_context *ctx = user_data;
+	int ret;
+
+	ret = eth_write_data(ctx->dev_fd, frame, len);
+	if (ret < 0) {
+		LOG_DBG("Cannot send pkt %p segment (%d)", pkt, ret);
+	}
+
+	return ret < 0 ? ret : 0;
+}
+#endif
+
 static int eth_send(struct device *dev, struct net_pkt *pkt)
 {
 	struct eth_context *ctx = dev->driver_data;
 	int count = net_pkt_get_len(pkt);
 	int ret;
 
+#if defined(CONFIG_ETH_NATIVE_POSIX_TSO)
+	if (net_pkt_tso_mss(pkt)) {
+		LOG_DBG("Send pkt %p len %d in segments of %u", pkt, count,
+			net_pkt_tso_mss(pkt));
+
+		return net_eth_tso_segment(pkt, ctx->send, sizeof(ctx->send),
+					   eth_send_segment, ctx);
+	}
+#endif
+
 	ret = net_pkt_read(pkt, ctx->send, count);
 	if (ret) {
 		return ret;
@@ -465,6 +491,9 @@ enum ethernet_hw_caps eth_posix_native_get_capabilities(struct device *dev)
 #if defined(CONFIG_ETH_NATIVE_POSIX_VLAN_TAG_STRIP)
 		| ETHERNET_HW_VLAN_TAG_STRIP
 #endif
+#if defined(CONFIG_ETH_NATIVE_POSIX_TSO)
+		| ETHERNET_HW_TSO
+#endif
 #if defined(CONFIG_ETH_NATIVE_POSIX_PTP_CLOCK)
 		| ETHERNET_PTP
 #endif
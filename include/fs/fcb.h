@@ -76,6 +76,20 @@ struct fcb_entry_ctx {
 	/**< Flash area where the entry is placed */
 };
 
+#if defined(CONFIG_FCB_DIRECTORY)
+/**
+ * @brief Location of a valid element, kept in the FCB directory.
+ */
+struct fcb_dir_entry {
+	u32_t fde_elem_off;
+	/**< Offset from the start of the sector to beginning of element. */
+
+	u16_t fde_data_len; /**< Size of data area of the element */
+
+	u8_t fde_sector; /**< Index of the sector in the sector array */
+};
+#endif /* CONFIG_FCB_DIRECTORY */
+
 /**
  * @brief FCB instance structure
  *
@@ -121,6 +135,21 @@ struct fcb {
 	/**< Flash area used by the fcb instance, , internal state.
 	 * This can be transfer to FCB user
 	 */
+
+#if defined(CONFIG_FCB_DIRECTORY)
+	struct fcb_dir_entry f_dir[CONFIG_FCB_DIRECTORY_SIZE];
+	/**< Ring of the valid elements from the oldest to the newest,
+	 * internal state
+	 */
+
+	u16_t f_dir_head; /**< Index of the oldest element, internal state */
+	u16_t f_dir_cnt; /**< Number of elements, internal state */
+
+	bool f_dir_valid;
+	/**< Directory holds all valid elements, otherwise the elements are
+	 * found by reading the flash, internal state
+	 */
+#endif /* CONFIG_FCB_DIRECTORY */
 };
 
 /*
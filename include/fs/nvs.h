@@ -30,6 +30,21 @@ extern "C" {
  * @{
  */
 
+/**
+ * @brief Non-volatile Storage garbage collection entry
+ *
+ * @param id Data id
+ * @param offset Data offset within sector
+ * @param len Data length, 0 when the data does not need to be copied
+ * @param ate_offset Allocation table entry offset within sector
+ */
+struct nvs_gc_entry {
+	u16_t id;
+	u16_t offset;
+	u16_t len;
+	u16_t ate_offset;
+};
+
 /**
  * @brief Non-volatile Storage File system structure
  *
@@ -43,6 +58,16 @@ extern "C" {
  * @param write_block_size Alignment size
  * @param nvs_lock Mutex
  * @param flash_device Flash Device
+ * @param lookup_addr Lookup cache: address of the most recent allocation
+ * table entry of lookup_id, 0xFFFFFFFF for an unused cache entry
+ * @param lookup_id Lookup cache: data id
+ * @param lookup_full Lookup cache does not hold all data ids
+ * @param gc_entry Garbage collection: allocation table entries of the batch
+ * being collected
+ * @param gc_count Garbage collection: number of sectors collected
+ * @param gc_copied Garbage collection: number of bytes copied
+ * @param gc_time Garbage collection: total duration in ms
+ * @param gc_time_max Garbage collection: longest duration in ms
  */
 struct nvs_fs {
 	off_t offset;		/* filesystem offset in flash */
@@ -57,6 +82,20 @@ struct nvs_fs {
 
 	struct k_mutex nvs_lock;
 	struct device *flash_device;
+#if defined(CONFIG_NVS_LOOKUP_CACHE)
+	u32_t lookup_addr[CONFIG_NVS_LOOKUP_CACHE_SIZE];
+	u16_t lookup_id[CONFIG_NVS_LOOKUP_CACHE_SIZE];
+	bool lookup_full;
+#endif
+#if defined(CONFIG_NVS_GC_BATCH)
+	struct nvs_gc_entry gc_entry[CONFIG_NVS_GC_BATCH_SIZE];
+#endif
+#if defined(CONFIG_NVS_GC_STATS)
+	u32_t gc_count;
+	u32_t gc_copied;
+	u32_t gc_time;
+	u32_t gc_time_max;
+#endif
 };
 
 /**
@@ -156,6 +195,53 @@ ssize_t nvs_read(struct nvs_fs *fs, u16_t id, void *data, size_t len);
 ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 		  u16_t cnt);
 
+/**
+ * @brief Callback called by nvs_walk for each entry
+ *
+ * @param id Id of the entry
+ * @param addr Address of the entry, to read it with nvs_read_addr()
+ * @param len Data length of the entry, 0 for a deleted entry
+ * @param arg Argument given to nvs_walk()
+ *
+ * @return 0 to continue the walk, any other value stops it
+ */
+typedef int (*nvs_walk_cb_t)(u16_t id, u32_t addr, size_t len, void *arg);
+
+/**
+ * @brief nvs_walk
+ *
+ * Walk through all the entries of the file system in a single pass, from the
+ * most recent to the oldest one. An id that was written more than once is
+ * found more than once, the first time with its latest entry.
+ *
+ * @param fs Pointer to file system
+ * @param cb Function called for each entry
+ * @param arg Argument passed to cb
+ *
+ * @return 0 when all entries were walked through, the value returned by cb
+ * when it stopped the walk. On error returns -ERRNO code.
+ */
+int nvs_walk(struct nvs_fs *fs, nvs_walk_cb_t cb, void *arg);
+
+/**
+ * @brief nvs_read_addr
+ *
+ * Read an entry found by nvs_walk() without looking it up. The address of an
+ * entry is only valid until the file system is written to.
+ *
+ * @param fs Pointer to file system
+ * @param id Id of the entry to be read
+ * @param addr Address of the entry as given by nvs_walk()
+ * @param data Pointer to data buffer
+ * @param len Number of bytes to be read
+ *
+ * @return Number of bytes read, as for nvs_read(). Returns -ENOENT when the
+ * entry at addr is deleted or is not an entry of id. On error returns -ERRNO
+ * code.
+ */
+ssize_t nvs_read_addr(struct nvs_fs *fs, u16_t id, u32_t addr, void *data,
+		      size_t len);
+
 /**
  * @brief nvs_calc_free_space
  *
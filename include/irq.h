@@ -223,6 +223,26 @@ unsigned int z_smp_global_lock(void);
 #define irq_lock() z_arch_irq_lock()
 #endif
 
+#if defined(CONFIG_SMP) && defined(CONFIG_SPINLOCK_STATS)
+/* An irq_lock() call site, and how many times another CPU had to spin
+ * on the SMP global lock while it was held from there
+ */
+struct z_smp_global_lock_site {
+	void *site;
+	u32_t waits;
+};
+
+struct z_smp_global_lock_stats {
+	u32_t acquired;
+	u32_t contended;
+	struct z_smp_global_lock_site
+		holders[CONFIG_SPINLOCK_STATS_GLOBAL_LOCK_SITES];
+};
+
+/* Copies out a consistent snapshot of the SMP global lock statistics */
+void z_smp_global_lock_stats_get(struct z_smp_global_lock_stats *stats);
+#endif
+
 /**
  * @brief Unlock interrupts.
  *
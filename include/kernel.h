@@ -451,7 +451,10 @@ struct _thread_base {
 	/* True for the per-CPU idle threads */
 	u8_t is_idle;
 
-	/* CPU index on which thread was last run */
+	/* CPU index on which thread was last run.  With
+	 * CONFIG_SCHED_CPU_RUNQ this is also the CPU whose ready
+	 * queue holds the thread while it is queued.
+	 */
 	u8_t cpu;
 
 	/* Recursive count of irq_lock() calls */
@@ -2683,6 +2686,25 @@ struct k_work;
  */
 typedef void (*k_work_handler_t)(struct k_work *work);
 
+/**
+ * @brief Workqueue statistics
+ *
+ * Times are in k_cycle_get_32() units.  Only work items processed by
+ * supervisor mode workqueue threads are counted.
+ */
+struct k_work_q_stats {
+	/** Number of work items processed */
+	u32_t processed;
+	/** Longest time a work item waited in the queue */
+	u32_t wait_max;
+	/** Total time work items waited in the queue */
+	u64_t wait_total;
+	/** Longest time a work item handler ran */
+	u32_t run_max;
+	/** Total time work item handlers ran */
+	u64_t run_total;
+};
+
 /**
  * @cond INTERNAL_HIDDEN
  */
@@ -2690,6 +2712,10 @@ typedef void (*k_work_handler_t)(struct k_work *work);
 struct k_work_q {
 	struct k_queue queue;
 	struct k_thread thread;
+#ifdef CONFIG_WORKQUEUE_STATS
+	struct k_spinlock stats_lock;
+	struct k_work_q_stats stats;
+#endif
 };
 
 enum {
@@ -2700,6 +2726,9 @@ struct k_work {
 	void *_reserved;		/* Used by k_queue implementation. */
 	k_work_handler_t handler;
 	atomic_t flags[1];
+#ifdef CONFIG_WORKQUEUE_STATS
+	u32_t submit_cycles;
+#endif
 };
 
 struct k_delayed_work {
@@ -2780,6 +2809,9 @@ static inline void k_work_submit_to_queue(struct k_work_q *work_q,
 					  struct k_work *work)
 {
 	if (!atomic_test_and_set_bit(work->flags, K_WORK_STATE_PENDING)) {
+#ifdef CONFIG_WORKQUEUE_STATS
+		work->submit_cycles = k_cycle_get_32();
+#endif
 		k_queue_append(&work_q->queue, work);
 	}
 }
@@ -2811,6 +2843,9 @@ static inline int k_work_submit_to_user_queue(struct k_work_q *work_q,
 	int ret = -EBUSY;
 
 	if (!atomic_test_and_set_bit(work->flags, K_WORK_STATE_PENDING)) {
+#ifdef CONFIG_WORKQUEUE_STATS
+		work->submit_cycles = k_cycle_get_32();
+#endif
 		ret = k_queue_alloc_append(&work_q->queue, work);
 
 		/* Couldn't insert into the queue. Clear the pending bit
@@ -2887,6 +2922,58 @@ extern void k_work_q_user_start(struct k_work_q *work_q,
 				k_thread_stack_t *stack,
 				size_t stack_size, int prio);
 
+/**
+ * @brief Start a workqueue served by several threads.
+ *
+ * This works like k_work_q_start(), except that @a num_threads worker
+ * threads take work items from the same queue, so a slow handler only
+ * holds up its own thread and on SMP systems handlers run in parallel.
+ * The workqueue's own thread field is not used.
+ *
+ * Work items may be processed concurrently and in any order.  A work
+ * item resubmitted while its handler is running may start again on
+ * another thread before the first run finishes.  Delayed work items
+ * work as with any other workqueue.
+ *
+ * For example:
+ *
+ * @code
+ * K_THREAD_STACK_ARRAY_DEFINE(stacks, 4, 1024);
+ * struct k_thread threads[4];
+ *
+ * k_work_q_pool_start(&work_q, threads, stacks[0], 1024, 4, prio, true);
+ * @endcode
+ *
+ * @param work_q Address of workqueue.
+ * @param threads Array of @a num_threads thread objects for the workers.
+ * @param stacks The first element of an array of @a num_threads stacks,
+ *		as defined by K_THREAD_STACK_ARRAY_DEFINE().
+ * @param stack_size The size passed to K_THREAD_STACK_ARRAY_DEFINE().
+ * @param num_threads Number of worker threads.
+ * @param prio Priority of the worker threads.
+ * @param pin Pin worker thread i to CPU (i % CONFIG_MP_NUM_CPUS).
+ *		Requires CONFIG_SCHED_CPU_MASK.
+ *
+ * @return N/A
+ */
+extern void k_work_q_pool_start(struct k_work_q *work_q,
+				struct k_thread *threads,
+				k_thread_stack_t *stacks, size_t stack_size,
+				int num_threads, int prio, bool pin);
+
+#ifdef CONFIG_WORKQUEUE_STATS
+/**
+ * @brief Get the statistics of a workqueue.
+ *
+ * @param work_q Address of workqueue.
+ * @param stats Filled with the statistics since the workqueue started.
+ *
+ * @return N/A
+ */
+extern void k_work_q_stats_get(struct k_work_q *work_q,
+			       struct k_work_q_stats *stats);
+#endif
+
 /**
  * @brief Initialize a delayed work item.
  *
@@ -3316,6 +3403,7 @@ struct k_msgq {
 	char *read_ptr;
 	char *write_ptr;
 	u32_t used_msgs;
+	u32_t reserved_msgs;
 
 	_OBJECT_TRACING_NEXT_PTR(k_msgq)
 	u8_t flags;
@@ -3335,6 +3423,7 @@ struct k_msgq {
 	.read_ptr = q_buffer, \
 	.write_ptr = q_buffer, \
 	.used_msgs = 0, \
+	.reserved_msgs = 0, \
 	_OBJECT_TRACING_INIT \
 	}
 #define K_MSGQ_INITIALIZER DEPRECATED_MACRO _K_MSGQ_INITIALIZER
@@ -3450,6 +3539,34 @@ void k_msgq_cleanup(struct k_msgq *q);
  */
 __syscall int k_msgq_put(struct k_msgq *q, void *data, s32_t timeout);
 
+/**
+ * @brief Send several messages to a message queue.
+ *
+ * This routine sends up to @a num consecutive messages from @a data to
+ * message queue @a q under a single lock, handing messages directly to
+ * waiting receivers first and waking them with a single reschedule.
+ *
+ * If the queue has room for fewer than @a num messages, only that many
+ * are sent.  Only if no message can be sent at all does the caller wait
+ * (for room for the first message).
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param q Address of the message queue.
+ * @param data Pointer to the messages.
+ * @param num Number of messages at @a data.
+ * @param timeout Waiting period to add the first message (in
+ *                milliseconds), or one of the special values K_NO_WAIT
+ *                and K_FOREVER.
+ *
+ * @return Number of messages sent, or
+ * @retval -ENOMSG Returned without waiting or queue purged.
+ * @retval -EAGAIN Waiting period timed out.
+ * @retval -EBUSY Slots of the queue are reserved, see k_msgq_reserve().
+ */
+__syscall int k_msgq_put_n(struct k_msgq *q, const void *data, u32_t num,
+			   s32_t timeout);
+
 /**
  * @brief Receive a message from a message queue.
  *
@@ -3470,6 +3587,76 @@ __syscall int k_msgq_put(struct k_msgq *q, void *data, s32_t timeout);
  */
 __syscall int k_msgq_get(struct k_msgq *q, void *data, s32_t timeout);
 
+/**
+ * @brief Receive several messages from a message queue.
+ *
+ * This routine receives up to @a num messages from message queue @a q in
+ * a "first in, first out" manner under a single lock, then refills the
+ * freed space from any senders waiting on a full queue.
+ *
+ * If fewer than @a num messages are queued, only those are received.
+ * Only if the queue is empty does the caller wait (for one message).
+ *
+ * @note Can be called by ISRs, but @a timeout must be set to K_NO_WAIT.
+ *
+ * @param q Address of the message queue.
+ * @param data Address of area to hold up to @a num messages.
+ * @param num Maximum number of messages to receive.
+ * @param timeout Waiting period to receive the first message (in
+ *                milliseconds), or one of the special values K_NO_WAIT
+ *                and K_FOREVER.
+ *
+ * @return Number of messages received, or
+ * @retval -ENOMSG Returned without waiting.
+ * @retval -EAGAIN Waiting period timed out.
+ */
+__syscall int k_msgq_get_n(struct k_msgq *q, void *data, u32_t num,
+			   s32_t timeout);
+
+/**
+ * @brief Reserve message slots in a message queue's ring buffer.
+ *
+ * This routine reserves up to @a num contiguous free message slots at
+ * the tail of message queue @a q so a producer can build messages in
+ * place, without copying them.  The reserved slots are invisible to
+ * receivers until k_msgq_commit() is called.
+ *
+ * Only one reservation can be outstanding at a time, and while it is
+ * k_msgq_put() and k_msgq_put_n() fail with -EBUSY: this is meant for
+ * queues with a single producer.  Fewer than @a num slots are reserved
+ * if the queue is nearly full or the free space wraps around the end of
+ * the ring buffer.
+ *
+ * @note Can be called by ISRs.  Not available to user mode threads.
+ *
+ * @param q Address of the message queue.
+ * @param slots Set to the address of the first reserved slot.
+ * @param num Maximum number of slots to reserve, at least 1.
+ *
+ * @return Number of slots reserved, or
+ * @retval -ENOMSG The queue is full.
+ * @retval -EBUSY A reservation is already outstanding.
+ */
+int k_msgq_reserve(struct k_msgq *q, void **slots, u32_t num);
+
+/**
+ * @brief Commit reserved message slots.
+ *
+ * This routine makes the first @a num slots of the outstanding
+ * reservation on message queue @a q available to receivers and releases
+ * the rest of the reservation.  Receivers waiting on the queue are
+ * handed the new messages and woken with a single reschedule.
+ *
+ * @note Can be called by ISRs.  Not available to user mode threads.
+ *
+ * @param q Address of the message queue.
+ * @param num Number of reserved slots holding messages, possibly 0.
+ *
+ * @retval 0 Messages committed.
+ * @retval -EINVAL @a num exceeds the number of reserved slots.
+ */
+int k_msgq_commit(struct k_msgq *q, u32_t num);
+
 /**
  * @brief Peek/read a message from a message queue.
  *
@@ -3530,7 +3717,7 @@ __syscall void  k_msgq_get_attrs(struct k_msgq *q, struct k_msgq_attrs *attrs);
 
 static inline u32_t z_impl_k_msgq_num_free_get(struct k_msgq *q)
 {
-	return q->max_msgs - q->used_msgs;
+	return q->max_msgs - q->used_msgs - q->reserved_msgs;
 }
 
 /**
@@ -3965,14 +4152,37 @@ extern void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
  * @cond INTERNAL_HIDDEN
  */
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+struct k_mem_slab_magazine {
+	/* Held by the owning CPU while it uses the magazine, and by
+	 * the slab lock holder when it needs to steal from it
+	 */
+	atomic_t busy;
+	u32_t count;
+	char *blocks[CONFIG_MEM_SLAB_MAGAZINE_SIZE];
+
+	u32_t hits;
+	u32_t misses;
+	u32_t refills;
+	u32_t flushes;
+};
+#endif
+
 struct k_mem_slab {
 	_wait_q_t wait_q;
+	struct k_spinlock lock;
 	u32_t num_blocks;
 	size_t block_size;
 	char *buffer;
 	char *free_list;
 	u32_t num_used;
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	/* Blocks cached in magazines count as used in num_used */
+	atomic_t waiters;
+	struct k_mem_slab_magazine magazines[CONFIG_MP_NUM_CPUS];
+#endif
+
 	_OBJECT_TRACING_NEXT_PTR(k_mem_slab)
 };
 
@@ -4098,7 +4308,17 @@ extern void k_mem_slab_free(struct k_mem_slab *slab, void **mem);
  */
 static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
 {
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	u32_t cached = 0U;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		cached += slab->magazines[i].count;
+	}
+
+	return slab->num_used - MIN(cached, slab->num_used);
+#else
 	return slab->num_used;
+#endif
 }
 
 /**
@@ -4114,9 +4334,41 @@ static inline u32_t k_mem_slab_num_used_get(struct k_mem_slab *slab)
  */
 static inline u32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 {
-	return slab->num_blocks - slab->num_used;
+	return slab->num_blocks - k_mem_slab_num_used_get(slab);
 }
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+/**
+ * @brief Memory slab per-CPU cache statistics.
+ *
+ * Totals across all CPUs.  An allocation or free is a hit when it was
+ * served by the local CPU's magazine without taking the slab lock.
+ */
+struct k_mem_slab_magazine_stats {
+	/** Allocations and frees served from the local magazine */
+	u32_t hits;
+	/** Allocations and frees that had to take the slab lock */
+	u32_t misses;
+	/** Batches of blocks moved from the slab into a magazine */
+	u32_t refills;
+	/** Batches of blocks moved from a magazine back to the slab */
+	u32_t flushes;
+	/** Blocks currently cached in magazines */
+	u32_t cached;
+};
+
+/**
+ * @brief Get the per-CPU cache statistics of a memory slab.
+ *
+ * @param slab Address of the memory slab.
+ * @param stats Filled with the statistics summed over all CPUs.
+ *
+ * @return N/A
+ */
+extern void k_mem_slab_magazine_stats_get(struct k_mem_slab *slab,
+				struct k_mem_slab_magazine_stats *stats);
+#endif
+
 /** @} */
 
 /**
@@ -4285,6 +4537,21 @@ extern void k_free(void *ptr);
  */
 extern void *k_calloc(size_t nmemb, size_t size);
 
+#ifdef CONFIG_HEAP_MEM_POOL_TLSF
+struct sys_tlsf_stats;
+
+/**
+ * @brief Get the heap usage statistics.
+ *
+ * Only available when the heap uses the TLSF allocator.
+ *
+ * @param stats Filled with the heap statistics.
+ *
+ * @return N/A
+ */
+extern void k_malloc_stats_get(struct sys_tlsf_stats *stats);
+#endif
+
 /** @} */
 
 /* polling API - PRIVATE */
@@ -4413,6 +4680,11 @@ struct k_poll_event {
 	/* PRIVATE - DO NOT TOUCH */
 	struct _poller *poller;
 
+#ifdef CONFIG_POLL_SET
+	/* PRIVATE - DO NOT TOUCH */
+	sys_dnode_t _ready_node;
+#endif
+
 	/* optional user-specified tag, opaque, untouched by the API */
 	u32_t tag:8;
 
@@ -4594,6 +4866,95 @@ __syscall void k_poll_signal_check(struct k_poll_signal *signal,
 
 __syscall int k_poll_signal_raise(struct k_poll_signal *signal, int result);
 
+#ifdef CONFIG_POLL_SET
+/**
+ * @brief Persistent poll set
+ *
+ * A poll set keeps its events registered with their objects between
+ * waits.  When an object becomes available the event is queued on the
+ * set's ready list, so k_poll_set_wait() only has to look at the
+ * events that became ready instead of registering and unregistering
+ * every event on every call like k_poll() does.
+ */
+struct k_poll_set {
+	/* PRIVATE - DO NOT TOUCH */
+	struct _poller poller;
+	sys_dlist_t ready;
+	_wait_q_t wait_q;
+};
+
+/**
+ * @brief Initialize a poll set
+ *
+ * @param set The poll set to initialize.
+ *
+ * @return N/A
+ */
+extern void k_poll_set_init(struct k_poll_set *set);
+
+/**
+ * @brief Add an event to a poll set
+ *
+ * The event, initialized with k_poll_event_init(), stays registered
+ * with its object until it is removed with k_poll_set_remove().  It
+ * must not be passed to k_poll() or added to another set meanwhile,
+ * and its memory must remain valid.  An event whose object is already
+ * available becomes ready immediately.
+ *
+ * @param set The poll set.
+ * @param event The event to add.
+ *
+ * @retval 0 The event was added.
+ * @retval -EBUSY The event is already registered.
+ * @retval -EINVAL The event has type K_POLL_TYPE_IGNORE.
+ */
+extern int k_poll_set_add(struct k_poll_set *set, struct k_poll_event *event);
+
+/**
+ * @brief Remove an event from a poll set
+ *
+ * @param set The poll set.
+ * @param event The event to remove.
+ *
+ * @retval 0 The event was removed.
+ * @retval -EINVAL The event is not in @a set.
+ */
+extern int k_poll_set_remove(struct k_poll_set *set,
+			     struct k_poll_event *event);
+
+/**
+ * @brief Wait for events in a poll set to become ready
+ *
+ * This routine stores pointers to up to @a num_events ready events of
+ * @a set in @a events, with each event's state field set as k_poll()
+ * would.  Readiness is level triggered: an event is returned by every
+ * call for as long as its object stays available (a semaphore has a
+ * non-zero count, a queue is not empty or a poll signal is signaled).
+ * The cost of a call is proportional to the number of ready events,
+ * not to the number of events in the set; ready events are returned
+ * in round-robin order.
+ *
+ * If several threads wait on the same set, each readiness change
+ * wakes one of them.  Cancelling a queue of the set with
+ * k_queue_cancel_wait() makes one waiting thread return -EINTR.  If
+ * no thread is waiting, the queue's event is returned once instead,
+ * by the next call, with state K_POLL_STATE_CANCELLED.
+ *
+ * @param set The poll set.
+ * @param events Array that receives pointers to the ready events.
+ * @param num_events The size of @a events.
+ * @param timeout Waiting period for an event to be ready (in
+ *                milliseconds), or one of the special values K_NO_WAIT
+ *                and K_FOREVER.
+ *
+ * @return Number of ready events stored in @a events
+ * @retval -EAGAIN Waiting period timed out.
+ * @retval -EINTR A queue of the set was cancelled while waiting.
+ */
+extern int k_poll_set_wait(struct k_poll_set *set, struct k_poll_event **events,
+			   int num_events, s32_t timeout);
+#endif /* CONFIG_POLL_SET */
+
 /**
  * @internal
  */
@@ -78,6 +78,9 @@ struct net_eth_addr {
 
 #define NET_ETH_VLAN_HDR_SIZE	4
 
+/* Longest TCP options the receive coalescing compares */
+#define NET_ETH_GRO_TCP_OPTS_LEN	40
+
 /** @endcond */
 
 /** Ethernet hardware capabilities */
@@ -126,6 +129,12 @@ enum ethernet_hw_caps {
 
 	/** VLAN Tag stripping */
 	ETHERNET_HW_VLAN_TAG_STRIP	= BIT(14),
+
+	/** TCP segmentation offload: TCP packets larger than the MTU are
+	 * split by the device into segments of net_pkt_tso_mss() bytes,
+	 * with their IP and TCP checksums computed.
+	 */
+	ETHERNET_HW_TSO			= BIT(15),
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -318,6 +327,38 @@ struct ethernet_lldp {
 };
 #endif /* CONFIG_NET_LLDP */
 
+#if defined(CONFIG_NET_ETHERNET_GRO)
+/** Software receive coalescing (GRO) state of one Rx queue */
+struct ethernet_gro {
+	/** Delivers the held packet once the Rx queue has processed the
+	 * packets that were already waiting in it.
+	 */
+	struct k_work flush;
+
+	/** Held packet that the following segments of its flow are
+	 * merged into, or NULL.
+	 */
+	struct net_pkt *pkt;
+
+	/** IP and TCP headers of the held packet. The length, ACK,
+	 * window and flags are only written back to the packet when
+	 * it is delivered.
+	 */
+	union {
+		struct net_ipv4_hdr ipv4;
+		struct net_ipv6_hdr ipv6;
+	} ip;
+	struct net_tcp_hdr tcp;
+	u8_t tcp_opts[NET_ETH_GRO_TCP_OPTS_LEN];
+
+	/** Sequence number the next segment must start with */
+	u32_t seq;
+
+	/** Number of segments merged into the held packet */
+	u16_t count;
+};
+#endif /* CONFIG_NET_ETHERNET_GRO */
+
 /** Ethernet L2 context that is needed for VLAN */
 struct ethernet_context {
 #if defined(CONFIG_NET_VLAN)
@@ -370,6 +411,13 @@ struct ethernet_context {
 	s8_t vlan_enabled;
 #endif
 
+#if defined(CONFIG_NET_ETHERNET_GRO)
+	/** Receive coalescing state, one per Rx queue so that each is
+	 * only ever touched by the thread of that queue.
+	 */
+	struct ethernet_gro gro[NET_RX_QUEUE_COUNT];
+#endif
+
 	/** Is this context already initialized */
 	bool is_init;
 };
@@ -664,6 +712,50 @@ void net_eth_carrier_off(struct net_if *iface);
  */
 int net_eth_promisc_mode(struct net_if *iface, bool enable);
 
+/**
+ * @typedef net_eth_tso_cb_t
+ * @brief Callback receiving the frames of a segmented TSO packet.
+ *
+ * @param pkt The packet being segmented
+ * @param frame Complete Ethernet frame of one segment
+ * @param len Length of the frame
+ * @param user_data User data given to net_eth_tso_segment()
+ *
+ * @return 0 to go on with the next segment, <0 to stop.
+ */
+typedef int (*net_eth_tso_cb_t)(struct net_pkt *pkt, u8_t *frame,
+				size_t len, void *user_data);
+
+/**
+ * @brief Split a TCP segmentation offload packet into Ethernet frames.
+ *
+ * For drivers that advertise ETHERNET_HW_TSO without hardware support
+ * for it. The Ethernet, IP and TCP headers of @a pkt are replicated in
+ * front of each net_pkt_tso_mss() sized part of the payload, with the
+ * lengths, IPv4 identification, TCP sequence number and checksums
+ * adjusted. FIN and PSH are only kept on the last segment.
+ *
+ * @param pkt Packet with net_pkt_tso_mss() set, as passed to the
+ * driver's send function
+ * @param frame Buffer each frame is built in
+ * @param size Size of @a frame, the largest frame the device can send
+ * @param cb Called for each frame, in order
+ * @param user_data Passed to @a cb
+ *
+ * @return 0 if all segments were passed to @a cb, <0 otherwise.
+ */
+#if defined(CONFIG_NET_TCP_TSO)
+int net_eth_tso_segment(struct net_pkt *pkt, u8_t *frame, size_t size,
+			net_eth_tso_cb_t cb, void *user_data);
+#else
+static inline int net_eth_tso_segment(struct net_pkt *pkt, u8_t *frame,
+				      size_t size, net_eth_tso_cb_t cb,
+				      void *user_data)
+{
+	return -ENOTSUP;
+}
+#endif
+
 /**
  * @brief Return PTP clock that is tied to this ethernet network interface.
  *
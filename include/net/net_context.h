@@ -263,6 +263,11 @@ struct net_context {
 		struct k_fifo accept_q;
 	};
 
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	/** epoll instances this socket is registered with */
+	sys_slist_t epoll_items;
+#endif /* CONFIG_NET_SOCKETS_EPOLL */
+
 #if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
 	/** TLS context information */
 	struct tls_context *tls;
@@ -295,9 +300,24 @@ struct net_context {
 			struct sockaddr addr;
 			socklen_t addrlen;
 		} proxy;
+#endif
+#if defined(CONFIG_NET_CONTEXT_ZEROCOPY)
+		bool zerocopy;
 #endif
 	} options;
 
+#if defined(CONFIG_NET_CONTEXT_ZEROCOPY)
+	/** Completion state of MSG_ZEROCOPY sends */
+	struct {
+		/** Number given to the next send */
+		u32_t next;
+		/** All sends numbered below this have completed */
+		u32_t done;
+		/** Bit n is set if send done + n has completed */
+		u32_t completed;
+	} zc;
+#endif
+
 	/** Protocol (UDP, TCP or IEEE 802.3 protocol value) */
 	u16_t proto;
 
@@ -888,7 +908,10 @@ int net_context_sendto(struct net_context *context,
  *
  * @param context The network context to use.
  * @param msghdr The data to send
- * @param flags Flags for the sending.
+ * @param flags Flags for the sending. With MSG_ZEROCOPY, and the
+ * NET_OPT_ZEROCOPY option set, UDP and TCP data is referenced from the
+ * iovecs instead of being copied; see NET_OPT_ZEROCOPY_DONE for when it
+ * may be reused.
  * @param cb Caller-supplied callback function.
  * @param timeout Currently this value is not used.
  * @param user_data Caller-supplied user data.
@@ -971,6 +994,8 @@ enum net_context_option {
 	NET_OPT_TIMESTAMP	= 2,
 	NET_OPT_TXTIME		= 3,
 	NET_OPT_SOCKS5		= 4,
+	NET_OPT_ZEROCOPY	= 5,
+	NET_OPT_ZEROCOPY_DONE	= 6,
 };
 
 /**
@@ -223,6 +223,15 @@ void net_analyze_stack(const char *name, const char *stack, size_t size);
 #define NET_TC_COUNT 1
 #endif /* CONFIG_NET_TC_TX_COUNT && CONFIG_NET_TC_RX_COUNT */
 
+/* Each Rx traffic class is served by this many queues */
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+#define NET_RX_FLOW_QUEUES CONFIG_NET_RX_FLOW_QUEUES
+#else
+#define NET_RX_FLOW_QUEUES 1
+#endif
+
+#define NET_RX_QUEUE_COUNT (NET_TC_RX_COUNT * NET_RX_FLOW_QUEUES)
+
 /* @endcond */
 
 /**
@@ -1863,6 +1863,26 @@ bool net_if_need_calc_rx_checksum(struct net_if *iface);
  */
 bool net_if_need_calc_tx_checksum(struct net_if *iface);
 
+/**
+ * @brief Check if the network interface segments large TCP packets
+ * itself (TCP segmentation offload).
+ *
+ * @param iface Network interface
+ *
+ * @return True if TCP packets up to CONFIG_NET_TCP_TSO_MAX_SIZE bytes
+ * can be sent, false otherwise.
+ */
+#if defined(CONFIG_NET_TCP_TSO)
+bool net_if_supports_tso(struct net_if *iface);
+#else
+static inline bool net_if_supports_tso(struct net_if *iface)
+{
+	ARG_UNUSED(iface);
+
+	return false;
+}
+#endif
+
 /**
  * @brief Get interface according to index
  *
@@ -207,6 +207,29 @@ struct net_pkt {
 	u8_t ipv6_next_hdr;	/* What is the very first next header */
 #endif /* CONFIG_NET_IPV6 */
 
+#if defined(CONFIG_NET_CHKSUM_COPY)
+	/* Internet checksum of the last chksum_len bytes of the packet,
+	 * computed by net_pkt_write_chksum().
+	 */
+	u16_t chksum;
+	u16_t chksum_len;
+#endif /* CONFIG_NET_CHKSUM_COPY */
+
+#if defined(CONFIG_NET_TCP_TSO)
+	/* Segment size the Ethernet device splits this TCP packet into,
+	 * 0 if it is not to be segmented.
+	 */
+	u16_t tso_mss;
+#endif /* CONFIG_NET_TCP_TSO */
+
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+	/* Hash of the flow a received packet belongs to, selecting its Rx
+	 * queue. Either set by the driver or computed when the packet is
+	 * queued, 0 if not known.
+	 */
+	u32_t flow_hash;
+#endif /* CONFIG_NET_RX_FLOW_STEERING */
+
 #if defined(CONFIG_IEEE802154)
 	u8_t ieee802154_rssi; /* Received Signal Strength Indication */
 	u8_t ieee802154_lqi;  /* Link Quality Indicator */
@@ -586,6 +609,56 @@ static inline void net_pkt_set_ipv6_fragment_id(struct net_pkt *pkt,
 }
 #endif /* CONFIG_NET_IPV6_FRAGMENT */
 
+#if defined(CONFIG_NET_TCP_TSO)
+static inline u16_t net_pkt_tso_mss(struct net_pkt *pkt)
+{
+	return pkt->tso_mss;
+}
+
+static inline void net_pkt_set_tso_mss(struct net_pkt *pkt, u16_t mss)
+{
+	pkt->tso_mss = mss;
+}
+#else /* CONFIG_NET_TCP_TSO */
+static inline u16_t net_pkt_tso_mss(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_tso_mss(struct net_pkt *pkt, u16_t mss)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(mss);
+}
+#endif /* CONFIG_NET_TCP_TSO */
+
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+static inline u32_t net_pkt_flow_hash(struct net_pkt *pkt)
+{
+	return pkt->flow_hash;
+}
+
+static inline void net_pkt_set_flow_hash(struct net_pkt *pkt, u32_t hash)
+{
+	pkt->flow_hash = hash;
+}
+#else /* CONFIG_NET_RX_FLOW_STEERING */
+static inline u32_t net_pkt_flow_hash(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_flow_hash(struct net_pkt *pkt, u32_t hash)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(hash);
+}
+#endif /* CONFIG_NET_RX_FLOW_STEERING */
+
 #if NET_TC_COUNT > 1
 static inline u8_t net_pkt_priority(struct net_pkt *pkt)
 {
@@ -1431,6 +1504,22 @@ size_t net_pkt_available_buffer(struct net_pkt *pkt);
 size_t net_pkt_available_payload_buffer(struct net_pkt *pkt,
 					enum net_ip_protocol proto);
 
+/**
+ * @brief Get how much of a payload fits in a pkt
+ *
+ * @details This is the payload length net_pkt_alloc_buffer() would make
+ *          room for, given the pkt interface MTU and family, for callers
+ *          attaching payload buffers of their own.
+ *
+ * @param pkt   The net_pkt the payload is meant for
+ * @param size  The payload length wanted
+ * @param proto The IP protocol type (can be 0 for none).
+ *
+ * @return the payload length, at most size
+ */
+size_t net_pkt_max_payload_length(struct net_pkt *pkt, size_t size,
+				  enum net_ip_protocol proto);
+
 /**
  * @brief Trim net_pkt buffer
  *
@@ -1578,6 +1667,25 @@ struct net_pkt *net_pkt_shallow_clone(struct net_pkt *pkt, s32_t timeout);
  */
 int net_pkt_read(struct net_pkt *pkt, void *data, size_t length);
 
+#if defined(CONFIG_NET_CHKSUM_COPY)
+/**
+ * @brief Read some data from a net_pkt, computing its checksum
+ *
+ * @details Like net_pkt_read(), but the Internet checksum of the data
+ *          is computed while it is copied and added to the one kept in
+ *          the packet, as net_pkt_write_chksum() does.  Reading the
+ *          packet's payload this way after clearing that checksum lets
+ *          a later checksum verification skip the payload.
+ *
+ * @param pkt    The network packet from where to read some data
+ * @param data   The destination buffer, or NULL to only sum the data
+ * @param length The amount of data to read
+ *
+ * @return 0 on success, negative errno code otherwise.
+ */
+int net_pkt_read_chksum(struct net_pkt *pkt, void *data, size_t length);
+#endif /* CONFIG_NET_CHKSUM_COPY */
+
 /* Read u8_t data data a net_pkt */
 static inline int net_pkt_read_u8(struct net_pkt *pkt, u8_t *data)
 {
@@ -1641,6 +1749,33 @@ int net_pkt_read_be32(struct net_pkt *pkt, u32_t *data);
  */
 int net_pkt_write(struct net_pkt *pkt, const void *data, size_t length);
 
+/**
+ * @brief Write payload data into a net_pkt, computing its checksum
+ *
+ * @details Like net_pkt_write(), but the Internet checksum of the data
+ *          is computed while it is copied and kept in the packet.
+ *          Successive calls add to it.  The UDP, TCP and ICMP checksum
+ *          computation then only reads the headers, as long as the data
+ *          written this way remains, unmodified, at the end of the
+ *          packet.  Headers may still be added in front of it.
+ *
+ * @param pkt    The network packet where to write
+ * @param data   Data to be written
+ * @param length Length of the data to be written
+ *
+ * @return 0 on success, negative errno code otherwise.
+ */
+#if defined(CONFIG_NET_CHKSUM_COPY)
+int net_pkt_write_chksum(struct net_pkt *pkt, const void *data,
+			 size_t length);
+#else
+static inline int net_pkt_write_chksum(struct net_pkt *pkt, const void *data,
+				       size_t length)
+{
+	return net_pkt_write(pkt, data, length);
+}
+#endif
+
 /* Write u8_t data into a net_pkt. */
 static inline int net_pkt_write_u8(struct net_pkt *pkt, u8_t data)
 {
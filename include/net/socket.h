@@ -26,6 +26,7 @@
 #include <net/net_ip.h>
 #include <net/dns_resolve.h>
 #include <net/socket_select.h>
+#include <net/socket_epoll.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -54,8 +55,12 @@ struct zsock_pollfd {
 
 /** zsock_recv: Read data without removing it from socket input queue */
 #define ZSOCK_MSG_PEEK 0x02
+/** zsock_recvmmsg: Datagram was longer than the buffers (output value only) */
+#define ZSOCK_MSG_TRUNC 0x20
 /** zsock_recv/zsock_send: Override operation to non-blocking */
 #define ZSOCK_MSG_DONTWAIT 0x40
+/** zsock_sendmsg: Send the data without copying it, see SO_ZEROCOPY */
+#define ZSOCK_MSG_ZEROCOPY 0x4000000
 
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
@@ -285,6 +290,23 @@ static inline ssize_t zsock_send(int sock, const void *buf, size_t len,
 __syscall ssize_t zsock_sendmsg(int sock, const struct msghdr *msg,
 				int flags);
 
+/**
+ * @brief Send several messages with one call
+ *
+ * @details
+ * @rst
+ * Like a sequence of ``zsock_sendmsg()`` calls, one per element of
+ * msgvec, but the socket is looked up and locked only once. The length
+ * sent of each message is stored in its msg_len field. Returns the
+ * number of messages sent, which is less than vlen if a send fails
+ * after the first one. See Linux ``man 2 sendmmsg``.
+ * This function is also exposed as ``sendmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ */
+__syscall int zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
 /**
  * @brief Receive data from an arbitrary network address
  *
@@ -319,6 +341,27 @@ static inline ssize_t zsock_recv(int sock, void *buf, size_t max_len,
 	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
 }
 
+/**
+ * @brief Receive several datagrams with one call
+ *
+ * @details
+ * @rst
+ * Each datagram is scattered into the msg_iov buffers of one element of
+ * msgvec, its source address stored in msg_name, and its length in
+ * msg_len. ``ZSOCK_MSG_TRUNC`` is set in msg_flags when the datagram
+ * did not fit in the buffers and was cut short. Only the first
+ * datagram is waited for (as with Linux ``MSG_WAITFORONE``), the call
+ * then returns what else is already queued, up to vlen datagrams.
+ * Returns the number of datagrams received. There is no timeout
+ * argument; use ``ZSOCK_MSG_DONTWAIT`` or ``zsock_poll()``. Only
+ * datagram sockets are supported. See Linux ``man 2 recvmmsg``.
+ * This function is also exposed as ``recvmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ */
+__syscall int zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
 /**
  * @brief Control blocking/non-blocking mode of a socket
  *
@@ -618,12 +661,24 @@ static inline ssize_t sendmsg(int sock, const struct msghdr *message,
 	return zsock_sendmsg(sock, message, flags);
 }
 
+static inline int sendmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 			       struct sockaddr *src_addr, socklen_t *addrlen)
 {
 	return zsock_recvfrom(sock, buf, max_len, flags, src_addr, addrlen);
 }
 
+static inline int recvmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_recvmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline int poll(struct zsock_pollfd *fds, int nfds, int timeout)
 {
 	return zsock_poll(fds, nfds, timeout);
@@ -722,7 +777,9 @@ static inline int inet_pton(sa_family_t family, const char *src, void *dst)
 #define POLLNVAL ZSOCK_POLLNVAL
 
 #define MSG_PEEK ZSOCK_MSG_PEEK
+#define MSG_TRUNC ZSOCK_MSG_TRUNC
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
+#define MSG_ZEROCOPY ZSOCK_MSG_ZEROCOPY
 
 #define SHUT_RD ZSOCK_SHUT_RD
 #define SHUT_WR ZSOCK_SHUT_WR
@@ -775,6 +832,17 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 /** sockopt: Enable SOCKS5 for Socket */
 #define SO_SOCKS5 60
 
+/* Socket options for zero-copy send */
+/** sockopt: Allow MSG_ZEROCOPY sends (Linux uses 60, taken by SO_SOCKS5) */
+#define SO_ZEROCOPY 63
+/**
+ * sockopt: Number of MSG_ZEROCOPY sends completed so far (read only).
+ * Sends are numbered from 0 in the order they were made; a value of N
+ * means that the data of sends 0 to N - 1 is no longer referenced by
+ * the stack and the application may reuse it.
+ */
+#define SO_ZEROCOPY_DONE 64
+
 /** @cond INTERNAL_HIDDEN */
 /**
  * @brief Registration information for a given BSD socket family.
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_
+#define ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_
+
+/**
+ * @brief BSD Sockets compatible API
+ * @defgroup bsd_sockets BSD Sockets compatible API
+ * @ingroup networking
+ * @{
+ */
+
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef union zsock_epoll_data {
+	void *ptr;
+	int fd;
+	u32_t u32;
+	u64_t u64;
+} zsock_epoll_data_t;
+
+struct zsock_epoll_event {
+	u32_t events;
+	zsock_epoll_data_t data;
+};
+
+/* ZSOCK_EPOLL* values are compatible with Linux and with ZSOCK_POLL* */
+/** zsock_epoll: Wait for readability */
+#define ZSOCK_EPOLLIN 1
+/** zsock_epoll: Wait for writability */
+#define ZSOCK_EPOLLOUT 4
+/** zsock_epoll: Error condition (output value only) */
+#define ZSOCK_EPOLLERR 8
+/** zsock_epoll: Closed connection (output value only) */
+#define ZSOCK_EPOLLHUP 0x10
+/** zsock_epoll: Report the socket once, until it is modified again */
+#define ZSOCK_EPOLLONESHOT (1U << 30)
+/** zsock_epoll: Report the socket only when it becomes ready */
+#define ZSOCK_EPOLLET (1U << 31)
+
+/** zsock_epoll_ctl: Register a socket */
+#define ZSOCK_EPOLL_CTL_ADD 1
+/** zsock_epoll_ctl: Unregister a socket */
+#define ZSOCK_EPOLL_CTL_DEL 2
+/** zsock_epoll_ctl: Change the events of a registered socket */
+#define ZSOCK_EPOLL_CTL_MOD 3
+
+/**
+ * @brief Create an epoll instance
+ *
+ * @details
+ * @rst
+ * See `Linux man page
+ * <http://man7.org/linux/man-pages/man2/epoll_create.2.html>`__
+ * for normative description. The size argument must be positive but is
+ * otherwise ignored; the number of sockets which can be registered is
+ * set by :option:`CONFIG_NET_SOCKETS_EPOLL_ITEMS`. The instance is
+ * released with :c:func:`zsock_close()`.
+ * This function is also exposed as ``epoll_create()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ */
+int zsock_epoll_create(int size);
+
+/**
+ * @brief Register, modify or unregister a socket of an epoll instance
+ *
+ * @details
+ * @rst
+ * See `Linux man page
+ * <http://man7.org/linux/man-pages/man2/epoll_ctl.2.html>`__
+ * for normative description. Only native sockets can be registered,
+ * other descriptors fail with EPERM. A socket is unregistered from all
+ * epoll instances when it is closed.
+ * This function is also exposed as ``epoll_ctl()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ */
+int zsock_epoll_ctl(int epfd, int op, int fd, struct zsock_epoll_event *event);
+
+/**
+ * @brief Wait for events on the sockets of an epoll instance
+ *
+ * @details
+ * @rst
+ * See `Linux man page
+ * <http://man7.org/linux/man-pages/man2/epoll_wait.2.html>`__
+ * for normative description. Unlike :c:func:`zsock_poll()`, the cost of
+ * a call depends on the number of ready sockets, not on the number of
+ * registered ones: sockets put themselves on a ready list of the
+ * instance when they receive data or a connection.
+ * This function is also exposed as ``epoll_wait()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ */
+int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+		     int maxevents, int timeout);
+
+#ifdef CONFIG_NET_SOCKETS_POSIX_NAMES
+
+#define epoll_data_t zsock_epoll_data_t
+#define epoll_event zsock_epoll_event
+
+#define EPOLLIN ZSOCK_EPOLLIN
+#define EPOLLOUT ZSOCK_EPOLLOUT
+#define EPOLLERR ZSOCK_EPOLLERR
+#define EPOLLHUP ZSOCK_EPOLLHUP
+#define EPOLLONESHOT ZSOCK_EPOLLONESHOT
+#define EPOLLET ZSOCK_EPOLLET
+
+#define EPOLL_CTL_ADD ZSOCK_EPOLL_CTL_ADD
+#define EPOLL_CTL_DEL ZSOCK_EPOLL_CTL_DEL
+#define EPOLL_CTL_MOD ZSOCK_EPOLL_CTL_MOD
+
+static inline int epoll_create(int size)
+{
+	return zsock_epoll_create(size);
+}
+
+static inline int epoll_ctl(int epfd, int op, int fd,
+			    struct zsock_epoll_event *event)
+{
+	return zsock_epoll_ctl(epfd, op, fd, event);
+}
+
+static inline int epoll_wait(int epfd, struct zsock_epoll_event *events,
+			     int maxevents, int timeout)
+{
+	return zsock_epoll_wait(epfd, events, maxevents, timeout);
+}
+
+#endif /* CONFIG_NET_SOCKETS_POSIX_NAMES */
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_SOCKET_EPOLL_H_ */
@@ -246,6 +246,27 @@ int settings_save_one(const char *name, const void *value, size_t val_len);
  */
 int settings_delete(const char *name);
 
+/**
+ * Write the settings kept in the write-back cache to persisted storage.
+ *
+ * With CONFIG_SETTINGS_CACHE enabled, settings_save_one() and
+ * settings_delete() only update a RAM cache, which is written to storage
+ * later. Settings are written in the order in which they were first changed
+ * since the previous flush, so once a setting is persisted, the settings
+ * changed before it are persisted too, with their latest value. Call this
+ * before a reset or power down to persist all changes.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+#if defined(CONFIG_SETTINGS_CACHE)
+int settings_flush(void);
+#else
+static inline int settings_flush(void)
+{
+	return 0;
+}
+#endif /* CONFIG_SETTINGS_CACHE */
+
 /**
  * Call commit for all settings handler. This should apply all
  * settings which has been set, but not applied yet.
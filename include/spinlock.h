@@ -52,8 +52,20 @@ typedef struct k_spinlock_key k_spinlock_key_t;
 
 struct k_spinlock {
 #ifdef CONFIG_SMP
+#if defined(CONFIG_SPINLOCK_TICKET)
+	/* Next ticket to hand out, and the ticket being served */
+	atomic_t tail;
+	atomic_t owner;
+#elif defined(CONFIG_SPINLOCK_MCS)
+	/* Queue node index of the last CPU to ask for the lock (zero
+	 * when free), and of the current holder
+	 */
+	atomic_t tail;
+	atomic_val_t owner;
+#else
 	atomic_t locked;
 #endif
+#endif
 
 #ifdef SPIN_VALIDATE
 	/* Stores the thread that holds the lock with the locking CPU
@@ -61,8 +73,68 @@ struct k_spinlock {
 	 */
 	uintptr_t thread_cpu;
 #endif
+
+#ifdef CONFIG_SPINLOCK_STATS
+	/* Number of acquisitions, and how many of them had to spin */
+	u32_t acquired;
+	u32_t contended;
+#endif
 };
 
+#ifdef CONFIG_SMP
+#ifdef CONFIG_SPINLOCK_MCS
+bool z_spin_mcs_lock(struct k_spinlock *l);
+void z_spin_mcs_unlock(struct k_spinlock *l);
+#endif
+
+/* Internal functions: take and drop the lock word itself, with
+ * interrupts already masked.  Acquisition returns true if the lock
+ * was held by another CPU and the caller had to wait.
+ */
+static ALWAYS_INLINE bool z_spin_acquire(struct k_spinlock *l)
+{
+#if defined(CONFIG_SPINLOCK_TICKET)
+	atomic_val_t ticket = atomic_inc(&l->tail);
+
+	if (atomic_get(&l->owner) == ticket) {
+		return false;
+	}
+
+	while (atomic_get(&l->owner) != ticket) {
+	}
+	return true;
+#elif defined(CONFIG_SPINLOCK_MCS)
+	return z_spin_mcs_lock(l);
+#else
+	if (atomic_cas(&l->locked, 0, 1)) {
+		return false;
+	}
+
+	while (!atomic_cas(&l->locked, 0, 1)) {
+	}
+	return true;
+#endif
+}
+
+static ALWAYS_INLINE void z_spin_release_lock(struct k_spinlock *l)
+{
+#if defined(CONFIG_SPINLOCK_TICKET)
+	atomic_inc(&l->owner);
+#elif defined(CONFIG_SPINLOCK_MCS)
+	z_spin_mcs_unlock(l);
+#else
+	/* Strictly we don't need atomic_clear() here (which is an
+	 * exchange operation that returns the old value).  We are always
+	 * setting a zero and (because we hold the lock) know the existing
+	 * state won't change due to a race.  But some architectures need
+	 * a memory barrier when used like this, and we don't have a
+	 * Zephyr framework for that.
+	 */
+	atomic_clear(&l->locked);
+#endif
+}
+#endif /* CONFIG_SMP */
+
 static ALWAYS_INLINE k_spinlock_key_t k_spin_lock(struct k_spinlock *l)
 {
 	ARG_UNUSED(l);
@@ -78,14 +150,20 @@ static ALWAYS_INLINE k_spinlock_key_t k_spin_lock(struct k_spinlock *l)
 	__ASSERT(z_spin_lock_valid(l), "Recursive spinlock");
 #endif
 
-#ifdef CONFIG_SMP
-	while (!atomic_cas(&l->locked, 0, 1)) {
-	}
+#if defined(CONFIG_SPINLOCK_STATS)
+	bool contended = z_spin_acquire(l);
+#elif defined(CONFIG_SMP)
+	(void)z_spin_acquire(l);
 #endif
 
 #ifdef SPIN_VALIDATE
 	z_spin_lock_set_owner(l);
 #endif
+
+#ifdef CONFIG_SPINLOCK_STATS
+	l->acquired++;
+	l->contended += contended ? 1 : 0;
+#endif
 	return k;
 }
 
@@ -98,14 +176,7 @@ static ALWAYS_INLINE void k_spin_unlock(struct k_spinlock *l,
 #endif
 
 #ifdef CONFIG_SMP
-	/* Strictly we don't need atomic_clear() here (which is an
-	 * exchange operation that returns the old value).  We are always
-	 * setting a zero and (because we hold the lock) know the existing
-	 * state won't change due to a race.  But some architectures need
-	 * a memory barrier when used like this, and we don't have a
-	 * Zephyr framework for that.
-	 */
-	atomic_clear(&l->locked);
+	z_spin_release_lock(l);
 #endif
 	z_arch_irq_unlock(key.key);
 }
@@ -120,7 +191,7 @@ static ALWAYS_INLINE void k_spin_release(struct k_spinlock *l)
 	__ASSERT(z_spin_unlock_valid(l), "Not my spinlock!");
 #endif
 #ifdef CONFIG_SMP
-	atomic_clear(&l->locked);
+	z_spin_release_lock(l);
 #endif
 }
 
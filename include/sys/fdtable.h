@@ -141,6 +141,8 @@ enum {
 	ZFD_IOCTL_POLL_PREPARE,
 	ZFD_IOCTL_POLL_UPDATE,
 	ZFD_IOCTL_GETSOCKNAME,
+	ZFD_IOCTL_POLL_READY,
+	ZFD_IOCTL_EPOLL_ITEMS,
 };
 
 #ifdef __cplusplus
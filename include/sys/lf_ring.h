@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Lock-free ring buffers
+ */
+
+#ifndef ZEPHYR_INCLUDE_SYS_LF_RING_H_
+#define ZEPHYR_INCLUDE_SYS_LF_RING_H_
+
+#include <zephyr/types.h>
+#include <sys/atomic.h>
+#include <sys/util.h>
+#include <toolchain.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup lf_ring_apis Lock-free Ring Buffer APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/*
+ * Unlike struct ring_buf, these ring buffers need no external locking
+ * for the access patterns they support, so they can connect an ISR to
+ * a thread, or threads on different CPUs, without irq_lock() or a
+ * spinlock.
+ *
+ * struct spsc_ring is a byte stream with exactly one producer and one
+ * consumer context at a time, with zero-copy claim/finish calls like
+ * ring_buf_put_claim() and ring_buf_get_claim().
+ *
+ * struct mpsc_ring holds fixed size items and accepts any number of
+ * concurrent producers (including ISRs preempting a producer on the
+ * same CPU) but only one consumer.  Each slot carries a sequence
+ * number, so a producer that has reserved a slot but not yet filled
+ * it never blocks the others; the consumer simply sees the ring as
+ * empty at that slot until the item is published.
+ *
+ * Both use free running 32-bit indices into a power of two sized
+ * buffer.  The producer and consumer indices live in separate cache
+ * lines (see CONFIG_LF_RING_CACHE_LINE_SIZE) and each side keeps a
+ * cached copy of the other side's index, so the hot paths only touch
+ * shared cache lines when the ring looks full or empty.
+ */
+
+#define Z_LF_RING_ALIGN __aligned(CONFIG_LF_RING_CACHE_LINE_SIZE)
+
+/**
+ * @brief A lock-free single-producer, single-consumer byte ring buffer
+ */
+struct spsc_ring {
+	u8_t *buf;
+	u32_t mask;
+
+	struct {
+		atomic_t head;
+		u32_t claimed;
+		u32_t tail_cache;
+	} prod Z_LF_RING_ALIGN;
+
+	struct {
+		atomic_t tail;
+		u32_t claimed;
+		u32_t head_cache;
+	} cons Z_LF_RING_ALIGN;
+};
+
+/**
+ * @brief A lock-free multi-producer, single-consumer item ring buffer
+ */
+struct mpsc_ring {
+	u8_t *buf;
+	atomic_t *seq;
+	u32_t mask;
+	u32_t item_size;
+
+	struct {
+		atomic_t head;
+	} prod Z_LF_RING_ALIGN;
+
+	struct {
+		u32_t tail;
+	} cons Z_LF_RING_ALIGN;
+};
+
+/**
+ * @brief Statically define and initialize a single-producer,
+ * single-consumer ring buffer
+ *
+ * @param name Name of the ring buffer
+ * @param pow Size exponent: the ring holds 2^pow bytes
+ */
+#define SPSC_RING_DECLARE(name, pow) \
+	static u8_t _spsc_ring_data_##name[BIT(pow)]; \
+	struct spsc_ring name = { \
+		.buf = _spsc_ring_data_##name, \
+		.mask = BIT(pow) - 1, \
+	}
+
+/**
+ * @brief Statically define and initialize a multi-producer,
+ * single-consumer ring buffer
+ *
+ * @param name Name of the ring buffer
+ * @param isize Size of each item in bytes, a multiple of 4
+ * @param pow Size exponent: the ring holds 2^pow items
+ */
+#define MPSC_RING_DECLARE(name, isize, pow) \
+	static u32_t _mpsc_ring_data_##name[BIT(pow) * ((isize) / 4)]; \
+	static atomic_t _mpsc_ring_seq_##name[BIT(pow)]; \
+	struct mpsc_ring name = { \
+		.buf = (u8_t *)_mpsc_ring_data_##name, \
+		.seq = _mpsc_ring_seq_##name, \
+		.mask = BIT(pow) - 1, \
+		.item_size = (isize), \
+	}
+
+/**
+ * @brief Initialize a single-producer, single-consumer ring buffer
+ *
+ * Only needed for rings not defined with SPSC_RING_DECLARE.
+ *
+ * @param ring Address of ring buffer
+ * @param size Size of @a data in bytes, a power of two
+ * @param data Ring buffer data area
+ */
+void spsc_ring_init(struct spsc_ring *ring, u32_t size, u8_t *data);
+
+/**
+ * @brief Get the capacity of a single-producer, single-consumer ring
+ *
+ * @param ring Address of ring buffer
+ *
+ * @return Ring buffer capacity in bytes
+ */
+static inline u32_t spsc_ring_capacity_get(struct spsc_ring *ring)
+{
+	return ring->mask + 1;
+}
+
+/**
+ * @brief Get the number of bytes in a single-producer, single-consumer
+ * ring
+ *
+ * The result may already be stale when called from a context other
+ * than the producer or consumer.  Bytes claimed but not yet finished
+ * by the producer are not counted; bytes claimed but not yet finished
+ * by the consumer are.
+ *
+ * @param ring Address of ring buffer
+ *
+ * @return Number of bytes that have been put and not yet consumed
+ */
+static inline u32_t spsc_ring_used_get(struct spsc_ring *ring)
+{
+	u32_t tail = (u32_t)atomic_get(&ring->cons.tail);
+
+	return (u32_t)atomic_get(&ring->prod.head) - tail;
+}
+
+/**
+ * @brief Allocate contiguous space in a single-producer,
+ * single-consumer ring buffer
+ *
+ * Only the producer may call this.  Successive claims are cumulative
+ * until spsc_ring_put_finish() is called.
+ *
+ * @param[in]  ring Address of ring buffer
+ * @param[out] data Set to a location within the ring buffer
+ * @param[in]  size Requested size in bytes
+ *
+ * @return Number of bytes claimed at @a data, which may be less than
+ *	   @a size if the ring is nearly full or wraps
+ */
+u32_t spsc_ring_put_claim(struct spsc_ring *ring, u8_t **data, u32_t size);
+
+/**
+ * @brief Publish bytes written to claimed space
+ *
+ * Only the producer may call this.  Any claimed space beyond @a size
+ * is released.
+ *
+ * @param ring Address of ring buffer
+ * @param size Number of bytes written
+ *
+ * @retval 0 Success
+ * @retval -EINVAL @a size exceeds the claimed space
+ */
+int spsc_ring_put_finish(struct spsc_ring *ring, u32_t size);
+
+/**
+ * @brief Copy data into a single-producer, single-consumer ring buffer
+ *
+ * Only the producer may call this, with no claim outstanding.
+ *
+ * @param ring Address of ring buffer
+ * @param data Data to copy
+ * @param size Size of @a data in bytes
+ *
+ * @return Number of bytes written
+ */
+u32_t spsc_ring_put(struct spsc_ring *ring, const u8_t *data, u32_t size);
+
+/**
+ * @brief Get the address of contiguous data in a single-producer,
+ * single-consumer ring buffer
+ *
+ * Only the consumer may call this.  Successive claims are cumulative
+ * until spsc_ring_get_finish() is called.
+ *
+ * @param[in]  ring Address of ring buffer
+ * @param[out] data Set to a location within the ring buffer
+ * @param[in]  size Requested size in bytes
+ *
+ * @return Number of bytes available at @a data, which may be less than
+ *	   @a size if the ring is nearly empty or wraps
+ */
+u32_t spsc_ring_get_claim(struct spsc_ring *ring, u8_t **data, u32_t size);
+
+/**
+ * @brief Release bytes consumed from claimed data
+ *
+ * Only the consumer may call this.  Claimed data beyond @a size stays
+ * in the ring.
+ *
+ * @param ring Address of ring buffer
+ * @param size Number of bytes consumed
+ *
+ * @retval 0 Success
+ * @retval -EINVAL @a size exceeds the claimed data
+ */
+int spsc_ring_get_finish(struct spsc_ring *ring, u32_t size);
+
+/**
+ * @brief Copy data out of a single-producer, single-consumer ring buffer
+ *
+ * Only the consumer may call this, with no claim outstanding.
+ *
+ * @param ring Address of ring buffer
+ * @param data Destination buffer
+ * @param size Size of @a data in bytes
+ *
+ * @return Number of bytes read
+ */
+u32_t spsc_ring_get(struct spsc_ring *ring, u8_t *data, u32_t size);
+
+/**
+ * @brief Initialize a multi-producer, single-consumer ring buffer
+ *
+ * Only needed for rings not defined with MPSC_RING_DECLARE.
+ *
+ * @param ring Address of ring buffer
+ * @param item_size Size of each item in bytes
+ * @param count Number of items, a power of two
+ * @param data Data area of @a count * @a item_size bytes
+ * @param seq Array of @a count sequence numbers, zeroed by this call
+ */
+void mpsc_ring_init(struct mpsc_ring *ring, u32_t item_size, u32_t count,
+		    void *data, atomic_t *seq);
+
+/**
+ * @brief Copy an item into a multi-producer, single-consumer ring buffer
+ *
+ * May be called concurrently from any number of threads, ISRs and
+ * CPUs.
+ *
+ * @param ring Address of ring buffer
+ * @param item Item to copy, of the ring's item size
+ *
+ * @retval 0 Success
+ * @retval -ENOMEM The ring is full
+ */
+int mpsc_ring_put(struct mpsc_ring *ring, const void *item);
+
+/**
+ * @brief Copy the oldest item out of a multi-producer, single-consumer
+ * ring buffer
+ *
+ * Only the consumer may call this.  If the producer that reserved the
+ * oldest slot has not finished writing it yet, the ring is reported
+ * as empty even though newer items may already be present.
+ *
+ * @param ring Address of ring buffer
+ * @param item Destination, of the ring's item size
+ *
+ * @retval 0 Success
+ * @retval -EAGAIN No item is available
+ */
+int mpsc_ring_get(struct mpsc_ring *ring, void *item);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_SYS_LF_RING_H_ */
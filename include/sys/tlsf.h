@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_SYS_TLSF_H_
+#define ZEPHYR_INCLUDE_SYS_TLSF_H_
+
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup tlsf_apis TLSF Heap APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/*
+ * A "two-level segregated fit" heap allocator.  Free blocks are kept
+ * on segregated lists indexed by the most significant bit of their
+ * size (the first level) and the next few bits below it (the second
+ * level), with a bitmap of the non-empty lists at each level, so both
+ * allocation and free run in constant time: two find-first-set
+ * operations pick a list whose blocks are all large enough, and freed
+ * blocks are merged with their physical neighbors through boundary
+ * tags.  Allocations are rounded up to at most 1/16th of their size
+ * (plus word alignment) and carry one word of header overhead.
+ *
+ * The heap state lives at the start of the memory handed to
+ * sys_tlsf_init().  There is no internal locking: callers must
+ * serialize access to a heap themselves.
+ */
+
+struct z_tlsf;
+
+/**
+ * @brief A TLSF heap
+ */
+struct sys_tlsf {
+	struct z_tlsf *tlsf;
+};
+
+/**
+ * @brief TLSF heap statistics
+ *
+ * All sizes are in bytes.  A simple measure of fragmentation is
+ * 100 * (1 - largest_free_bytes / free_bytes) percent.
+ */
+struct sys_tlsf_stats {
+	/** Bytes available for allocation in an empty heap */
+	size_t total_bytes;
+	/** Bytes currently allocated, including block headers */
+	size_t used_bytes;
+	/** High water mark of used_bytes */
+	size_t peak_used_bytes;
+	/** Bytes in free blocks */
+	size_t free_bytes;
+	/** Size of the largest free block */
+	size_t largest_free_bytes;
+	/** Number of free blocks */
+	u32_t free_blocks;
+};
+
+/**
+ * @brief Initialize a TLSF heap
+ *
+ * @param heap Heap to initialize
+ * @param mem Memory to manage, at least word aligned
+ * @param bytes Size of @a mem.  Part of it holds the heap's own
+ *              state: a few words plus sixteen list heads for each
+ *              power of two up to @a bytes.
+ */
+void sys_tlsf_init(struct sys_tlsf *heap, void *mem, size_t bytes);
+
+/**
+ * @brief Allocate memory from a TLSF heap
+ *
+ * @param heap Heap to allocate from
+ * @param bytes Number of bytes requested
+ *
+ * @return Word aligned pointer to the memory, or NULL if no free block
+ *         is large enough
+ */
+void *sys_tlsf_alloc(struct sys_tlsf *heap, size_t bytes);
+
+/**
+ * @brief Free memory back to a TLSF heap
+ *
+ * @param heap Heap the memory was allocated from
+ * @param mem Pointer returned by sys_tlsf_alloc(), or NULL
+ */
+void sys_tlsf_free(struct sys_tlsf *heap, void *mem);
+
+/**
+ * @brief Get the usage statistics of a TLSF heap
+ *
+ * This walks the free lists, so it is not constant time.
+ *
+ * @param heap Heap to inspect
+ * @param stats Filled with the heap statistics
+ */
+void sys_tlsf_stats_get(struct sys_tlsf *heap, struct sys_tlsf_stats *stats);
+
+/**
+ * @brief Check the internal consistency of a TLSF heap
+ *
+ * Walks every block in the heap and every free list, checking the
+ * boundary tags, the free list linkage and the bitmaps.  Meant for
+ * tests and debugging.
+ *
+ * @param heap Heap to check
+ *
+ * @return true if the heap is consistent
+ */
+bool sys_tlsf_validate(struct sys_tlsf *heap);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_SYS_TLSF_H_ */
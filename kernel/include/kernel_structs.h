@@ -110,6 +110,15 @@ struct _cpu {
 	/* True when _current is allowed to context switch */
 	u8_t swap_ok;
 #endif
+
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	/* Threads queued to run on this CPU, and the lock protecting
+	 * them.  Kept after the small fields for the same reason as
+	 * _kernel.ready_q.
+	 */
+	struct _ready_q ready_q;
+	struct k_spinlock ready_q_lock;
+#endif
 };
 
 typedef struct _cpu _cpu_t;
@@ -39,6 +39,8 @@ void z_sched_init(void);
 void z_add_thread_to_ready_q(struct k_thread *thread);
 void z_move_thread_to_end_of_prio_q(struct k_thread *thread);
 void z_remove_thread_from_ready_q(struct k_thread *thread);
+void z_sched_thread_states_update(struct k_thread *thread, u32_t set,
+				  u32_t clear);
 int z_is_thread_time_slicing(struct k_thread *thread);
 void z_unpend_thread_no_timeout(struct k_thread *thread);
 int z_pend_curr(struct k_spinlock *lock, k_spinlock_key_t key,
@@ -212,7 +212,7 @@ static void mbox_message_dispose(struct k_mbox_msg *rx_msg)
 
 	/* synchronous send: wake up sending thread */
 	z_set_thread_return_value(sending_thread, 0);
-	z_mark_thread_as_not_pending(sending_thread);
+	z_sched_thread_states_update(sending_thread, 0, _THREAD_PENDING);
 	z_ready_thread(sending_thread);
 	z_reschedule_unlocked();
 }
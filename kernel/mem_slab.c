@@ -13,8 +13,7 @@
 #include <sys/dlist.h>
 #include <ksched.h>
 #include <init.h>
-
-static struct k_spinlock lock;
+#include <string.h>
 
 #ifdef CONFIG_OBJECT_TRACING
 struct k_mem_slab *_trace_list_k_mem_slab;
@@ -77,6 +76,11 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 	slab->block_size = block_size;
 	slab->buffer = buffer;
 	slab->num_used = 0U;
+	slab->lock = (struct k_spinlock) {};
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	slab->waiters = 0;
+	(void)memset(slab->magazines, 0, sizeof(slab->magazines));
+#endif
 	create_free_list(slab);
 	z_waitq_init(&slab->wait_q);
 	SYS_TRACING_OBJ_INIT(k_mem_slab, slab);
@@ -84,48 +88,287 @@ void k_mem_slab_init(struct k_mem_slab *slab, void *buffer,
 	z_object_init(slab);
 }
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+#define MAGAZINE_BATCH (CONFIG_MEM_SLAB_MAGAZINE_SIZE / 2)
+
+/* Magazines are only touched by their own CPU, with interrupts
+ * masked, or by a slab lock holder stealing blocks for a thread that
+ * would otherwise have to wait.  The busy flag arbitrates between the
+ * two: the owner only ever tries it (failing over to the locked slow
+ * path) and never waits for anything while holding it, so the lock
+ * holder can safely spin on it.
+ */
+static struct k_mem_slab_magazine *magazine_tryget(struct k_mem_slab *slab)
+{
+	struct k_mem_slab_magazine *mag = &slab->magazines[_current_cpu->id];
+
+	return atomic_cas(&mag->busy, 0, 1) ? mag : NULL;
+}
+
+static struct k_mem_slab_magazine *magazine_get(struct k_mem_slab *slab,
+						int cpu)
+{
+	struct k_mem_slab_magazine *mag = &slab->magazines[cpu];
+
+	while (!atomic_cas(&mag->busy, 0, 1)) {
+	}
+
+	return mag;
+}
+
+static void magazine_put(struct k_mem_slab_magazine *mag)
+{
+	(void)atomic_clear(&mag->busy);
+}
+
+static bool magazine_alloc(struct k_mem_slab *slab, void **mem)
+{
+	unsigned int key = z_arch_irq_lock();
+	struct k_mem_slab_magazine *mag = magazine_tryget(slab);
+	bool hit = false;
+
+	if (mag != NULL) {
+		if (mag->count > 0U) {
+			*mem = mag->blocks[--mag->count];
+			mag->hits++;
+			hit = true;
+		} else {
+			mag->misses++;
+		}
+		magazine_put(mag);
+	}
+
+	z_arch_irq_unlock(key);
+
+	return hit;
+}
+
+/* Slab lock held: top up the local magazine from the free list */
+static void magazine_refill(struct k_mem_slab *slab)
+{
+	struct k_mem_slab_magazine *mag =
+		magazine_get(slab, _current_cpu->id);
+	u32_t moved = 0U;
+
+	while (mag->count < MAGAZINE_BATCH && slab->free_list != NULL) {
+		mag->blocks[mag->count++] = slab->free_list;
+		slab->free_list = *(char **)(slab->free_list);
+		moved++;
+	}
+
+	if (moved != 0U) {
+		slab->num_used += moved;
+		mag->refills++;
+	}
+
+	magazine_put(mag);
+}
+
+/* Slab lock held: return half of a full local magazine */
+static void magazine_flush(struct k_mem_slab *slab)
+{
+	struct k_mem_slab_magazine *mag =
+		magazine_get(slab, _current_cpu->id);
+
+	if (mag->count == CONFIG_MEM_SLAB_MAGAZINE_SIZE) {
+		for (int i = 0; i < MAGAZINE_BATCH; i++) {
+			char *block = mag->blocks[--mag->count];
+
+			*(char **)block = slab->free_list;
+			slab->free_list = block;
+		}
+
+		slab->num_used -= MAGAZINE_BATCH;
+		mag->flushes++;
+	}
+
+	magazine_put(mag);
+}
+
+/* Slab lock held: take a cached block from any CPU's magazine */
+static char *magazine_steal(struct k_mem_slab *slab)
+{
+	char *block = NULL;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS && block == NULL; i++) {
+		struct k_mem_slab_magazine *mag = magazine_get(slab, i);
+
+		if (mag->count > 0U) {
+			block = mag->blocks[--mag->count];
+		}
+		magazine_put(mag);
+	}
+
+	return block;
+}
+
+/* A thread may have pended on the slab while we were caching a block
+ * it could have stolen: hand it one from the magazines.
+ */
+static void magazine_wake_waiter(struct k_mem_slab *slab)
+{
+	k_spinlock_key_t key = k_spin_lock(&slab->lock);
+	char *block = magazine_steal(slab);
+	struct k_thread *pending_thread;
+
+	if (block == NULL) {
+		/* Someone else got there first */
+		k_spin_unlock(&slab->lock, key);
+		return;
+	}
+
+	pending_thread = z_unpend_first_thread(&slab->wait_q);
+	if (pending_thread != NULL) {
+		z_set_thread_return_value_with_data(pending_thread, 0, block);
+		z_ready_thread(pending_thread);
+		z_reschedule(&slab->lock, key);
+	} else {
+		*(char **)block = slab->free_list;
+		slab->free_list = block;
+		slab->num_used--;
+		k_spin_unlock(&slab->lock, key);
+	}
+}
+
+static bool magazine_free(struct k_mem_slab *slab, char *block)
+{
+	unsigned int key;
+	struct k_mem_slab_magazine *mag;
+	bool hit = false;
+
+	if (atomic_get(&slab->waiters) != 0) {
+		return false;
+	}
+
+	key = z_arch_irq_lock();
+	mag = magazine_tryget(slab);
+	if (mag != NULL) {
+		if (mag->count < CONFIG_MEM_SLAB_MAGAZINE_SIZE) {
+			mag->blocks[mag->count++] = block;
+			mag->hits++;
+			hit = true;
+		} else {
+			mag->misses++;
+		}
+		magazine_put(mag);
+	}
+	z_arch_irq_unlock(key);
+
+	/* An allocator registers in waiters before it tries to steal,
+	 * so either it saw our block or we see it here
+	 */
+	if (hit && atomic_get(&slab->waiters) != 0) {
+		magazine_wake_waiter(slab);
+	}
+
+	return hit;
+}
+
+void k_mem_slab_magazine_stats_get(struct k_mem_slab *slab,
+				   struct k_mem_slab_magazine_stats *stats)
+{
+	(void)memset(stats, 0, sizeof(*stats));
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct k_mem_slab_magazine *mag = &slab->magazines[i];
+
+		stats->hits += mag->hits;
+		stats->misses += mag->misses;
+		stats->refills += mag->refills;
+		stats->flushes += mag->flushes;
+		stats->cached += mag->count;
+	}
+}
+#endif /* CONFIG_MEM_SLAB_MAGAZINE */
+
 int k_mem_slab_alloc(struct k_mem_slab *slab, void **mem, s32_t timeout)
 {
-	k_spinlock_key_t key = k_spin_lock(&lock);
+	k_spinlock_key_t key;
 	int result;
 
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	if (magazine_alloc(slab, mem)) {
+		return 0;
+	}
+#endif
+
+	key = k_spin_lock(&slab->lock);
+
 	if (slab->free_list != NULL) {
 		/* take a free block */
 		*mem = slab->free_list;
 		slab->free_list = *(char **)(slab->free_list);
 		slab->num_used++;
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+		magazine_refill(slab);
+#endif
 		result = 0;
-	} else if (timeout == K_NO_WAIT) {
-		/* don't wait for a free block to become available */
-		*mem = NULL;
-		result = -ENOMEM;
 	} else {
-		/* wait for a free block or timeout */
-		result = z_pend_curr(&lock, key, &slab->wait_q, timeout);
-		if (result == 0) {
-			*mem = _current->base.swap_data;
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+		/* The free list is empty, but other CPUs may be caching
+		 * blocks.  Register as a waiter first so concurrent
+		 * frees either leave their block where we can steal it
+		 * or come and wake us up.
+		 */
+		(void)atomic_inc(&slab->waiters);
+		*mem = magazine_steal(slab);
+		if (*mem != NULL) {
+			(void)atomic_dec(&slab->waiters);
+			k_spin_unlock(&slab->lock, key);
+			return 0;
+		}
+#endif
+		if (timeout == K_NO_WAIT) {
+			/* don't wait for a free block to become available */
+			*mem = NULL;
+			result = -ENOMEM;
+		} else {
+			/* wait for a free block or timeout */
+			result = z_pend_curr(&slab->lock, key, &slab->wait_q,
+					     timeout);
+			if (result == 0) {
+				*mem = _current->base.swap_data;
+			}
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+			(void)atomic_dec(&slab->waiters);
+#endif
+			return result;
 		}
-		return result;
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+		(void)atomic_dec(&slab->waiters);
+#endif
 	}
 
-	k_spin_unlock(&lock, key);
+	k_spin_unlock(&slab->lock, key);
 
 	return result;
 }
 
 void k_mem_slab_free(struct k_mem_slab *slab, void **mem)
 {
-	k_spinlock_key_t key = k_spin_lock(&lock);
-	struct k_thread *pending_thread = z_unpend_first_thread(&slab->wait_q);
+	k_spinlock_key_t key;
+	struct k_thread *pending_thread;
+
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	if (magazine_free(slab, *mem)) {
+		return;
+	}
+#endif
+
+	key = k_spin_lock(&slab->lock);
+	pending_thread = z_unpend_first_thread(&slab->wait_q);
 
 	if (pending_thread != NULL) {
 		z_set_thread_return_value_with_data(pending_thread, 0, *mem);
 		z_ready_thread(pending_thread);
-		z_reschedule(&lock, key);
+		z_reschedule(&slab->lock, key);
 	} else {
 		**(char ***)mem = slab->free_list;
 		slab->free_list = *(char **)mem;
 		slab->num_used--;
-		k_spin_unlock(&lock, key);
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+		magazine_flush(slab);
+#endif
+		k_spin_unlock(&slab->lock, key);
 	}
 }
@@ -11,10 +11,15 @@
 #include <string.h>
 #include <sys/__assert.h>
 #include <sys/math_extras.h>
+#include <sys/tlsf.h>
 #include <stdbool.h>
 
 static struct k_spinlock lock;
 
+#ifdef CONFIG_HEAP_MEM_POOL_TLSF
+static bool heap_free(void *ptr);
+#endif
+
 static struct k_mem_pool *get_pool(int id)
 {
 	extern struct k_mem_pool _k_mem_pool_list_start[];
@@ -159,6 +164,11 @@ void *k_mem_pool_malloc(struct k_mem_pool *pool, size_t size)
 void k_free(void *ptr)
 {
 	if (ptr != NULL) {
+#ifdef CONFIG_HEAP_MEM_POOL_TLSF
+		if (heap_free(ptr)) {
+			return;
+		}
+#endif
 		/* point to hidden block descriptor at start of block */
 		ptr = (char *)ptr - WB_UP(sizeof(struct k_mem_block_id));
 
@@ -169,6 +179,70 @@ void k_free(void *ptr)
 
 #if (CONFIG_HEAP_MEM_POOL_SIZE > 0)
 
+#ifdef CONFIG_HEAP_MEM_POOL_TLSF
+
+/*
+ * Heap is a TLSF heap of HEAP_MEM_POOL_SIZE bytes.
+ *
+ * Threads assigned the system heap get _HEAP_MEM_POOL as their resource
+ * pool.  It is only a placeholder that z_thread_malloc() recognizes,
+ * never a usable k_mem_pool.
+ */
+
+static char __aligned(sizeof(void *)) heap_mem[CONFIG_HEAP_MEM_POOL_SIZE];
+static struct sys_tlsf heap;
+static struct k_spinlock heap_lock;
+static struct k_mem_pool heap_resource_pool;
+#define _HEAP_MEM_POOL (&heap_resource_pool)
+
+static int init_heap(struct device *unused)
+{
+	ARG_UNUSED(unused);
+
+	sys_tlsf_init(&heap, heap_mem, sizeof(heap_mem));
+
+	return 0;
+}
+
+SYS_INIT(init_heap, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
+
+void *k_malloc(size_t size)
+{
+	k_spinlock_key_t key = k_spin_lock(&heap_lock);
+	void *ret = sys_tlsf_alloc(&heap, size);
+
+	k_spin_unlock(&heap_lock, key);
+
+	return ret;
+}
+
+/* k_free() takes both heap and k_mem_pool_malloc() memory */
+static bool heap_free(void *ptr)
+{
+	k_spinlock_key_t key;
+
+	if ((char *)ptr < heap_mem ||
+	    (char *)ptr >= heap_mem + sizeof(heap_mem)) {
+		return false;
+	}
+
+	key = k_spin_lock(&heap_lock);
+	sys_tlsf_free(&heap, ptr);
+	k_spin_unlock(&heap_lock, key);
+
+	return true;
+}
+
+void k_malloc_stats_get(struct sys_tlsf_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&heap_lock);
+
+	sys_tlsf_stats_get(&heap, stats);
+	k_spin_unlock(&heap_lock, key);
+}
+
+#else
+
 /*
  * Heap is defined using HEAP_MEM_POOL_SIZE configuration option.
  *
@@ -185,6 +259,8 @@ void *k_malloc(size_t size)
 	return k_mem_pool_malloc(_HEAP_MEM_POOL, size);
 }
 
+#endif /* CONFIG_HEAP_MEM_POOL_TLSF */
+
 void *k_calloc(size_t nmemb, size_t size)
 {
 	void *ret;
@@ -212,6 +288,11 @@ void *z_thread_malloc(size_t size)
 	void *ret;
 
 	if (_current->resource_pool != NULL) {
+#ifdef CONFIG_HEAP_MEM_POOL_TLSF
+		if (_current->resource_pool == _HEAP_MEM_POOL) {
+			return k_malloc(size);
+		}
+#endif
 		ret = k_mem_pool_malloc(_current->resource_pool, size);
 	} else {
 		ret = NULL;
@@ -54,6 +54,7 @@ void k_msgq_init(struct k_msgq *msgq, char *buffer, size_t msg_size,
 	msgq->read_ptr = buffer;
 	msgq->write_ptr = buffer;
 	msgq->used_msgs = 0;
+	msgq->reserved_msgs = 0;
 	msgq->flags = 0;
 	z_waitq_init(&msgq->wait_q);
 	msgq->lock = (struct k_spinlock) {};
@@ -116,7 +117,10 @@ int z_impl_k_msgq_put(struct k_msgq *msgq, void *data, s32_t timeout)
 
 	key = k_spin_lock(&msgq->lock);
 
-	if (msgq->used_msgs < msgq->max_msgs) {
+	if (msgq->reserved_msgs != 0U) {
+		/* the tail of the ring belongs to a zero-copy producer */
+		result = -EBUSY;
+	} else if (msgq->used_msgs < msgq->max_msgs) {
 		/* message queue isn't full */
 		pending_thread = z_unpend_first_thread(&msgq->wait_q);
 		if (pending_thread != NULL) {
@@ -164,6 +168,195 @@ Z_SYSCALL_HANDLER(k_msgq_put, msgq_p, data, timeout)
 }
 #endif
 
+/* Copy num messages to the tail of the ring, which must have room */
+static void ring_put(struct k_msgq *msgq, const char *data, u32_t num)
+{
+	size_t len = num * msgq->msg_size;
+	size_t chunk = MIN(len, (size_t)(msgq->buffer_end - msgq->write_ptr));
+
+	(void)memcpy(msgq->write_ptr, data, chunk);
+	(void)memcpy(msgq->buffer_start, data + chunk, len - chunk);
+
+	msgq->write_ptr += chunk;
+	if (msgq->write_ptr == msgq->buffer_end) {
+		msgq->write_ptr = msgq->buffer_start + (len - chunk);
+	}
+	msgq->used_msgs += num;
+}
+
+/* Copy num messages from the head of the ring, which must hold them */
+static void ring_get(struct k_msgq *msgq, char *data, u32_t num)
+{
+	size_t len = num * msgq->msg_size;
+	size_t chunk = MIN(len, (size_t)(msgq->buffer_end - msgq->read_ptr));
+
+	(void)memcpy(data, msgq->read_ptr, chunk);
+	(void)memcpy(data + chunk, msgq->buffer_start, len - chunk);
+
+	msgq->read_ptr += chunk;
+	if (msgq->read_ptr == msgq->buffer_end) {
+		msgq->read_ptr = msgq->buffer_start + (len - chunk);
+	}
+	msgq->used_msgs -= num;
+}
+
+/* Hand queued messages to threads waiting on an empty queue */
+static bool wake_readers(struct k_msgq *msgq)
+{
+	struct k_thread *pending_thread;
+	bool woken = false;
+
+	while (msgq->used_msgs > 0U) {
+		pending_thread = z_unpend_first_thread(&msgq->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+
+		ring_get(msgq, pending_thread->base.swap_data, 1);
+		z_set_thread_return_value(pending_thread, 0);
+		z_ready_thread(pending_thread);
+		woken = true;
+	}
+
+	return woken;
+}
+
+int z_impl_k_msgq_put_n(struct k_msgq *msgq, const void *data, u32_t num,
+			s32_t timeout)
+{
+	__ASSERT(!z_is_in_isr() || timeout == K_NO_WAIT, "");
+
+	struct k_thread *pending_thread;
+	const char *src = data;
+	k_spinlock_key_t key;
+	bool woken = false;
+	u32_t sent = 0U;
+	u32_t n;
+	int result;
+
+	key = k_spin_lock(&msgq->lock);
+
+	if (msgq->reserved_msgs != 0U) {
+		k_spin_unlock(&msgq->lock, key);
+		return -EBUSY;
+	}
+
+	/* threads only wait on a non-full queue to receive: give them
+	 * the first messages directly
+	 */
+	while (sent < num && msgq->used_msgs < msgq->max_msgs) {
+		pending_thread = z_unpend_first_thread(&msgq->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+
+		(void)memcpy(pending_thread->base.swap_data, src,
+			     msgq->msg_size);
+		z_set_thread_return_value(pending_thread, 0);
+		z_ready_thread(pending_thread);
+		src += msgq->msg_size;
+		sent++;
+		woken = true;
+	}
+
+	/* queue as many of the rest as fit */
+	n = MIN(num - sent, msgq->max_msgs - msgq->used_msgs);
+	ring_put(msgq, src, n);
+	sent += n;
+
+	if (sent == 0U && num != 0U) {
+		if (timeout == K_NO_WAIT) {
+			k_spin_unlock(&msgq->lock, key);
+			return -ENOMSG;
+		}
+
+		/* wait for room for the first message */
+		_current->base.swap_data = (void *)data;
+		result = z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
+		return (result == 0) ? 1 : result;
+	}
+
+	if (woken) {
+		z_reschedule(&msgq->lock, key);
+	} else {
+		k_spin_unlock(&msgq->lock, key);
+	}
+
+	return sent;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(k_msgq_put_n, msgq_p, data, num, timeout)
+{
+	struct k_msgq *q = (struct k_msgq *)msgq_p;
+	size_t size;
+
+	Z_OOPS(Z_SYSCALL_OBJ(q, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_VERIFY_MSG(!size_mul_overflow(q->msg_size, num,
+						       &size),
+				    "message count overflow"));
+	Z_OOPS(Z_SYSCALL_MEMORY_READ(data, size));
+
+	return z_impl_k_msgq_put_n(q, (const void *)data, num, timeout);
+}
+#endif
+
+int k_msgq_reserve(struct k_msgq *msgq, void **slots, u32_t num)
+{
+	k_spinlock_key_t key;
+	u32_t contiguous;
+	int result;
+
+	__ASSERT(num > 0U, "");
+
+	key = k_spin_lock(&msgq->lock);
+
+	contiguous = (msgq->buffer_end - msgq->write_ptr) / msgq->msg_size;
+	num = MIN(num, MIN(msgq->max_msgs - msgq->used_msgs, contiguous));
+
+	if (msgq->reserved_msgs != 0U) {
+		result = -EBUSY;
+	} else if (num == 0U) {
+		result = -ENOMSG;
+	} else {
+		msgq->reserved_msgs = num;
+		*slots = msgq->write_ptr;
+		result = num;
+	}
+
+	k_spin_unlock(&msgq->lock, key);
+
+	return result;
+}
+
+int k_msgq_commit(struct k_msgq *msgq, u32_t num)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&msgq->lock);
+
+	if (num > msgq->reserved_msgs) {
+		k_spin_unlock(&msgq->lock, key);
+		return -EINVAL;
+	}
+
+	/* the messages are already in place */
+	msgq->reserved_msgs = 0U;
+	msgq->write_ptr += num * msgq->msg_size;
+	if (msgq->write_ptr == msgq->buffer_end) {
+		msgq->write_ptr = msgq->buffer_start;
+	}
+	msgq->used_msgs += num;
+
+	if (wake_readers(msgq)) {
+		z_reschedule(&msgq->lock, key);
+	} else {
+		k_spin_unlock(&msgq->lock, key);
+	}
+
+	return 0;
+}
+
 void z_impl_k_msgq_get_attrs(struct k_msgq *msgq, struct k_msgq_attrs *attrs)
 {
 	attrs->msg_size = msgq->msg_size;
@@ -247,6 +440,74 @@ Z_SYSCALL_HANDLER(k_msgq_get, msgq_p, data, timeout)
 }
 #endif
 
+int z_impl_k_msgq_get_n(struct k_msgq *msgq, void *data, u32_t num,
+			s32_t timeout)
+{
+	__ASSERT(!z_is_in_isr() || timeout == K_NO_WAIT, "");
+
+	struct k_thread *pending_thread;
+	k_spinlock_key_t key;
+	bool woken = false;
+	u32_t n;
+	int result;
+
+	key = k_spin_lock(&msgq->lock);
+
+	n = MIN(num, msgq->used_msgs);
+	if (n == 0U && num != 0U) {
+		if (timeout == K_NO_WAIT) {
+			k_spin_unlock(&msgq->lock, key);
+			return -ENOMSG;
+		}
+
+		/* wait for one message */
+		_current->base.swap_data = data;
+		result = z_pend_curr(&msgq->lock, key, &msgq->wait_q, timeout);
+		return (result == 0) ? 1 : result;
+	}
+
+	ring_get(msgq, data, n);
+
+	/* threads only wait on a non-empty queue to send: move their
+	 * messages into the space we just freed
+	 */
+	while (msgq->used_msgs + msgq->reserved_msgs < msgq->max_msgs) {
+		pending_thread = z_unpend_first_thread(&msgq->wait_q);
+		if (pending_thread == NULL) {
+			break;
+		}
+
+		ring_put(msgq, pending_thread->base.swap_data, 1);
+		z_set_thread_return_value(pending_thread, 0);
+		z_ready_thread(pending_thread);
+		woken = true;
+	}
+
+	if (woken) {
+		z_reschedule(&msgq->lock, key);
+	} else {
+		k_spin_unlock(&msgq->lock, key);
+	}
+
+	return n;
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(k_msgq_get_n, msgq_p, data, num, timeout)
+{
+	struct k_msgq *q = (struct k_msgq *)msgq_p;
+	size_t size;
+
+	Z_OOPS(Z_SYSCALL_OBJ(q, K_OBJ_MSGQ));
+	Z_OOPS(Z_SYSCALL_VERIFY_MSG(!size_mul_overflow(q->msg_size, num,
+						       &size),
+				    "message count overflow"));
+	Z_OOPS(Z_SYSCALL_MEMORY_WRITE(data, size));
+
+	return z_impl_k_msgq_get_n(q, (void *)data, num, timeout);
+}
+#endif
+
 int z_impl_k_msgq_peek(struct k_msgq *msgq, void *data)
 {
 	k_spinlock_key_t key;
@@ -84,13 +84,25 @@ static inline bool is_condition_met(struct k_poll_event *event, u32_t *state)
 	return false;
 }
 
+/* Poll set registrations have no thread and are kept ahead of all
+ * k_poll() registrations in an object's list, see handle_obj_events().
+ */
+static inline bool is_set_event(struct k_poll_event *event)
+{
+#ifdef CONFIG_POLL_SET
+	return event->poller->thread == NULL;
+#else
+	return false;
+#endif
+}
+
 static inline void add_event(sys_dlist_t *events, struct k_poll_event *event,
 			     struct _poller *poller)
 {
 	struct k_poll_event *pending;
 
 	pending = (struct k_poll_event *)sys_dlist_peek_tail(events);
-	if ((pending == NULL) ||
+	if ((pending == NULL) || is_set_event(pending) ||
 		z_is_t1_higher_prio_than_t2(pending->poller->thread,
 					    poller->thread)) {
 		sys_dlist_append(events, &event->_node);
@@ -98,7 +110,8 @@ static inline void add_event(sys_dlist_t *events, struct k_poll_event *event,
 	}
 
 	SYS_DLIST_FOR_EACH_CONTAINER(events, pending, _node) {
-		if (z_is_t1_higher_prio_than_t2(poller->thread,
+		if (!is_set_event(pending) &&
+		    z_is_t1_higher_prio_than_t2(poller->thread,
 						pending->poller->thread)) {
 			sys_dlist_insert(&pending->_node, &event->_node);
 			return;
@@ -370,14 +383,69 @@ ready_event:
 	return 0;
 }
 
-void z_handle_obj_poll_events(sys_dlist_t *events, u32_t state)
+#ifdef CONFIG_POLL_SET
+/* must be called with interrupts locked */
+static void signal_set_event(struct k_poll_event *event, u32_t state)
+{
+	struct k_poll_set *set = CONTAINER_OF(event->poller,
+					      struct k_poll_set, poller);
+	struct k_thread *thread = z_unpend_first_thread(&set->wait_q);
+
+	/* Like k_poll(), a cancelled wait returns -EINTR.  Without a
+	 * waiter the cancellation is recorded in the event and reported
+	 * once by the next wait.  Otherwise the waiter picks up the state
+	 * from the ready list: it is level triggered, so there is nothing
+	 * to record in the event.
+	 */
+	if (state == K_POLL_STATE_CANCELLED) {
+		if (thread != NULL) {
+			z_set_thread_return_value(thread, -EINTR);
+			z_ready_thread(thread);
+			return;
+		}
+		event->state = state;
+	} else if (!sys_dnode_is_linked(&event->_ready_node)) {
+		event->state = K_POLL_STATE_NOT_READY;
+	}
+
+	if (!sys_dnode_is_linked(&event->_ready_node)) {
+		sys_dlist_append(&set->ready, &event->_ready_node);
+	}
+
+	if (thread != NULL) {
+		z_set_thread_return_value(thread, 0);
+		z_ready_thread(thread);
+	}
+}
+#endif
+
+/* must be called with interrupts locked */
+static int handle_obj_events(sys_dlist_t *events, u32_t state)
 {
 	struct k_poll_event *poll_event;
 
-	poll_event = (struct k_poll_event *)sys_dlist_get(events);
-	if (poll_event != NULL) {
-		(void) signal_poll_event(poll_event, state);
+	/* Notify every poll set watching the object, which stay
+	 * registered, then hand the event to the first k_poll() caller
+	 */
+	SYS_DLIST_FOR_EACH_CONTAINER(events, poll_event, _node) {
+		if (!is_set_event(poll_event)) {
+			sys_dlist_remove(&poll_event->_node);
+			return signal_poll_event(poll_event, state);
+		}
+#ifdef CONFIG_POLL_SET
+		signal_set_event(poll_event, state);
+#endif
 	}
+
+	return 0;
+}
+
+void z_handle_obj_poll_events(sys_dlist_t *events, u32_t state)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	(void)handle_obj_events(events, state);
+	k_spin_unlock(&lock, key);
 }
 
 void z_impl_k_poll_signal_init(struct k_poll_signal *signal)
@@ -420,18 +488,16 @@ Z_SYSCALL_HANDLER(k_poll_signal_check, signal, signaled, result)
 int z_impl_k_poll_signal_raise(struct k_poll_signal *signal, int result)
 {
 	k_spinlock_key_t key = k_spin_lock(&lock);
-	struct k_poll_event *poll_event;
 
 	signal->result = result;
 	signal->signaled = 1U;
 
-	poll_event = (struct k_poll_event *)sys_dlist_get(&signal->poll_events);
-	if (poll_event == NULL) {
+	if (sys_dlist_is_empty(&signal->poll_events)) {
 		k_spin_unlock(&lock, key);
 		return 0;
 	}
 
-	int rc = signal_poll_event(poll_event, K_POLL_STATE_SIGNALED);
+	int rc = handle_obj_events(&signal->poll_events, K_POLL_STATE_SIGNALED);
 
 	z_reschedule(&lock, key);
 	return rc;
@@ -447,3 +513,159 @@ Z_SYSCALL_HANDLER1_SIMPLE_VOID(k_poll_signal_reset, K_OBJ_POLL_SIGNAL,
 			       struct k_poll_signal *);
 #endif
 
+
+#ifdef CONFIG_POLL_SET
+void k_poll_set_init(struct k_poll_set *set)
+{
+	set->poller.thread = NULL;
+	set->poller.is_polling = false;
+	sys_dlist_init(&set->ready);
+	z_waitq_init(&set->wait_q);
+}
+
+static sys_dlist_t *obj_poll_events(struct k_poll_event *event)
+{
+	switch (event->type) {
+	case K_POLL_TYPE_SEM_AVAILABLE:
+		return &event->sem->poll_events;
+	case K_POLL_TYPE_DATA_AVAILABLE:
+		return &event->queue->poll_events;
+	case K_POLL_TYPE_SIGNAL:
+		return &event->signal->poll_events;
+	default:
+		return NULL;
+	}
+}
+
+int k_poll_set_add(struct k_poll_set *set, struct k_poll_event *event)
+{
+	sys_dlist_t *events = obj_poll_events(event);
+	k_spinlock_key_t key;
+	u32_t state;
+
+	if (events == NULL) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&lock);
+
+	if (event->poller != NULL) {
+		k_spin_unlock(&lock, key);
+		return -EBUSY;
+	}
+
+	event->poller = &set->poller;
+	event->state = K_POLL_STATE_NOT_READY;
+	sys_dnode_init(&event->_ready_node);
+	sys_dlist_prepend(events, &event->_node);
+
+	if (is_condition_met(event, &state)) {
+		signal_set_event(event, state);
+		z_reschedule(&lock, key);
+		return 0;
+	}
+
+	k_spin_unlock(&lock, key);
+	return 0;
+}
+
+int k_poll_set_remove(struct k_poll_set *set, struct k_poll_event *event)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (event->poller != &set->poller) {
+		k_spin_unlock(&lock, key);
+		return -EINVAL;
+	}
+
+	sys_dlist_remove(&event->_node);
+	if (sys_dnode_is_linked(&event->_ready_node)) {
+		sys_dlist_remove(&event->_ready_node);
+	}
+	event->poller = NULL;
+
+	k_spin_unlock(&lock, key);
+	return 0;
+}
+
+/* must be called with interrupts locked */
+static int collect_ready_events(struct k_poll_set *set,
+				struct k_poll_event **events, int num_events)
+{
+	sys_dlist_t still_ready;
+	sys_dnode_t *node;
+	int n = 0;
+
+	sys_dlist_init(&still_ready);
+
+	/* Events whose object is no longer available (e.g. someone else
+	 * took the semaphore) drop off the ready list until the object
+	 * signals again.  The others are reported and move to the back
+	 * of the list, to be checked again by the next call.  A recorded
+	 * cancellation is reported once and drops off.
+	 */
+	while (n < num_events) {
+		struct k_poll_event *event;
+		u32_t state;
+
+		node = sys_dlist_get(&set->ready);
+		if (node == NULL) {
+			break;
+		}
+
+		event = CONTAINER_OF(node, struct k_poll_event, _ready_node);
+		if (event->state == K_POLL_STATE_CANCELLED) {
+			events[n++] = event;
+		} else if (is_condition_met(event, &state)) {
+			event->state = state;
+			events[n++] = event;
+			sys_dlist_append(&still_ready, node);
+		} else {
+			event->state = K_POLL_STATE_NOT_READY;
+		}
+	}
+
+	while ((node = sys_dlist_get(&still_ready)) != NULL) {
+		sys_dlist_append(&set->ready, node);
+	}
+
+	return n;
+}
+
+int k_poll_set_wait(struct k_poll_set *set, struct k_poll_event **events,
+		    int num_events, s32_t timeout)
+{
+	__ASSERT(!z_is_in_isr(), "");
+	__ASSERT(events != NULL, "NULL events\n");
+	__ASSERT(num_events > 0, "zero events\n");
+
+	s32_t remaining = timeout;
+	u32_t start = 0U;
+
+	if (timeout != K_FOREVER) {
+		start = k_uptime_get_32();
+	}
+
+	while (true) {
+		k_spinlock_key_t key = k_spin_lock(&lock);
+		int n = collect_ready_events(set, events, num_events);
+
+		if ((n > 0) || (remaining == K_NO_WAIT)) {
+			k_spin_unlock(&lock, key);
+			return (n > 0) ? n : -EAGAIN;
+		}
+
+		int rc = z_pend_curr(&lock, key, &set->wait_q, remaining);
+
+		if (rc != 0) {
+			return rc;
+		}
+
+		/* Another waiter may have raced us to the event */
+		if (timeout != K_FOREVER) {
+			remaining = MAX(0, timeout -
+					   (s32_t)(k_uptime_get_32() - start));
+		}
+	}
+}
+#endif /* CONFIG_POLL_SET */
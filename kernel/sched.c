@@ -176,6 +176,166 @@ static ALWAYS_INLINE struct k_thread *_priq_dumb_mask_best(sys_dlist_t *pq)
 }
 #endif
 
+#ifdef CONFIG_SCHED_CPU_RUNQ
+static ALWAYS_INLINE void *thread_runq(struct k_thread *thread)
+{
+	return &_kernel.cpus[thread->base.cpu].ready_q.runq;
+}
+
+static ALWAYS_INLINE void *curr_cpu_runq(void)
+{
+	return &_current_cpu->ready_q.runq;
+}
+
+static ALWAYS_INLINE struct k_spinlock *curr_cpu_runq_lock(void)
+{
+	return &_current_cpu->ready_q_lock;
+}
+#else
+static ALWAYS_INLINE void *thread_runq(struct k_thread *thread)
+{
+	ARG_UNUSED(thread);
+
+	return &_kernel.ready_q.runq;
+}
+
+static ALWAYS_INLINE void *curr_cpu_runq(void)
+{
+	return &_kernel.ready_q.runq;
+}
+
+static ALWAYS_INLINE struct k_spinlock *curr_cpu_runq_lock(void)
+{
+	return &sched_spinlock;
+}
+#endif
+
+static ALWAYS_INLINE void runq_add(struct k_thread *thread)
+{
+	_priq_run_add(thread_runq(thread), thread);
+}
+
+static ALWAYS_INLINE void runq_remove(struct k_thread *thread)
+{
+	_priq_run_remove(thread_runq(thread), thread);
+}
+
+static ALWAYS_INLINE struct k_thread *runq_best(void)
+{
+	return _priq_run_best(curr_cpu_runq());
+}
+
+/* Locks the ready queue that thread is queued in (or will be added
+ * to, per its base.cpu field).  Without CONFIG_SCHED_CPU_RUNQ this is
+ * just sched_spinlock.
+ */
+static ALWAYS_INLINE struct k_spinlock *runq_lock(struct k_thread *thread,
+						  k_spinlock_key_t *key)
+{
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	/* A queued thread only changes queues (by being stolen) with
+	 * its old queue locked, so once we hold the lock of the queue
+	 * named by base.cpu it can't move out from under us.  Retry
+	 * if it moved while we were acquiring the lock.
+	 */
+	while (true) {
+		struct _cpu *cpu = &_kernel.cpus[thread->base.cpu];
+
+		*key = k_spin_lock(&cpu->ready_q_lock);
+		if (thread->base.cpu == cpu->id) {
+			return &cpu->ready_q_lock;
+		}
+		k_spin_unlock(&cpu->ready_q_lock, *key);
+	}
+#else
+	ARG_UNUSED(thread);
+
+	*key = k_spin_lock(&sched_spinlock);
+	return &sched_spinlock;
+#endif
+}
+
+#ifdef CONFIG_SCHED_CPU_RUNQ
+/* Chooses the CPU whose queue a newly runnable thread joins: the one
+ * it last ran on if its mask still allows that, otherwise the first
+ * one it may run on.  This only needs to be a good first guess, as
+ * CPUs with nothing to do steal work from the others.
+ */
+static int runq_target_cpu(struct k_thread *thread)
+{
+	int cpu = thread->base.cpu;
+
+#ifdef CONFIG_SCHED_CPU_MASK
+	u32_t mask = thread->base.cpu_mask & BIT_MASK(CONFIG_MP_NUM_CPUS);
+
+	if ((mask & BIT(cpu)) == 0U && mask != 0U) {
+		cpu = __builtin_ctz(mask);
+	}
+#endif
+
+	return cpu;
+}
+
+/* Called with the current CPU's queue locked when it has nothing to
+ * run.  Looks for the best thread this CPU may run in the other CPUs'
+ * queues and migrates it into the local one.  The local lock is
+ * dropped while doing so: no two ready queue locks are ever held at
+ * the same time, so there is no lock ordering to get wrong.
+ */
+static k_spinlock_key_t steal_thread(k_spinlock_key_t key)
+{
+	struct _cpu *self = _current_cpu;
+	struct k_thread *th = NULL;
+
+	k_spin_unlock(&self->ready_q_lock, key);
+
+	for (int i = 1; i < CONFIG_MP_NUM_CPUS && th == NULL; i++) {
+		struct _cpu *cpu =
+			&_kernel.cpus[(self->id + i) % CONFIG_MP_NUM_CPUS];
+
+		LOCKED(&cpu->ready_q_lock) {
+			/* With CONFIG_SCHED_CPU_MASK this only returns
+			 * threads allowed to run on _current_cpu
+			 */
+			th = _priq_run_best(&cpu->ready_q.runq);
+			if (th != NULL) {
+				_priq_run_remove(&cpu->ready_q.runq, th);
+				z_mark_thread_as_not_queued(th);
+			}
+		}
+	}
+
+	key = k_spin_lock(&self->ready_q_lock);
+
+	if (th != NULL) {
+		th->base.cpu = self->id;
+		runq_add(th);
+		z_mark_thread_as_queued(th);
+	}
+
+	return key;
+}
+#endif
+
+/* Locks the current CPU's ready queue for next_up().  With
+ * CONFIG_SCHED_CPU_RUNQ, a CPU about to go idle first tries to steal
+ * something to run from its peers.
+ */
+static ALWAYS_INLINE k_spinlock_key_t lock_curr_cpu_runq(void)
+{
+	k_spinlock_key_t key = k_spin_lock(curr_cpu_runq_lock());
+
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	if (runq_best() == NULL &&
+	    (is_idle(_current) ||
+	     z_is_thread_prevented_from_running(_current))) {
+		key = steal_thread(key);
+	}
+#endif
+
+	return key;
+}
+
 static ALWAYS_INLINE struct k_thread *next_up(void)
 {
 #ifndef CONFIG_SMP
@@ -185,7 +345,7 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 	 * responsible for putting it back in z_swap and ISR return!),
 	 * which makes this choice simple.
 	 */
-	struct k_thread *th = _priq_run_best(&_kernel.ready_q.runq);
+	struct k_thread *th = runq_best();
 
 	return th ? th : _current_cpu->idle_thread;
 #else
@@ -203,7 +363,7 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 	int active = !z_is_thread_prevented_from_running(_current);
 
 	/* Choose the best thread that is not current */
-	struct k_thread *th = _priq_run_best(&_kernel.ready_q.runq);
+	struct k_thread *th = runq_best();
 	if (th == NULL) {
 		th = _current_cpu->idle_thread;
 	}
@@ -221,13 +381,13 @@ static ALWAYS_INLINE struct k_thread *next_up(void)
 
 	/* Put _current back into the queue */
 	if (th != _current && active && !is_idle(_current) && !queued) {
-		_priq_run_add(&_kernel.ready_q.runq, _current);
+		runq_add(_current);
 		z_mark_thread_as_queued(_current);
 	}
 
 	/* Take the new _current out of the queue */
 	if (z_is_thread_queued(th)) {
-		_priq_run_remove(&_kernel.ready_q.runq, th);
+		runq_remove(th);
 	}
 	z_mark_thread_as_not_queued(th);
 
@@ -332,38 +492,70 @@ static void update_cache(int preempt_ok)
 
 void z_add_thread_to_ready_q(struct k_thread *thread)
 {
-	LOCKED(&sched_spinlock) {
-		_priq_run_add(&_kernel.ready_q.runq, thread);
-		z_mark_thread_as_queued(thread);
-		update_cache(0);
-	}
+	k_spinlock_key_t key;
+	struct k_spinlock *lock;
+
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	thread->base.cpu = runq_target_cpu(thread);
+#endif
+	lock = runq_lock(thread, &key);
+	runq_add(thread);
+	z_mark_thread_as_queued(thread);
+	update_cache(0);
+	k_spin_unlock(lock, key);
 }
 
 void z_move_thread_to_end_of_prio_q(struct k_thread *thread)
 {
-	LOCKED(&sched_spinlock) {
-		_priq_run_remove(&_kernel.ready_q.runq, thread);
-		_priq_run_add(&_kernel.ready_q.runq, thread);
-		z_mark_thread_as_queued(thread);
-		update_cache(thread == _current);
+	k_spinlock_key_t key;
+	struct k_spinlock *lock = runq_lock(thread, &key);
+
+	if (z_is_thread_queued(thread)) {
+		runq_remove(thread);
 	}
+	runq_add(thread);
+	z_mark_thread_as_queued(thread);
+	update_cache(thread == _current);
+	k_spin_unlock(lock, key);
 }
 
-void z_remove_thread_from_ready_q(struct k_thread *thread)
+/* Takes thread out of its ready queue and sets the states keeping it
+ * out, with the queue locked: under CONFIG_SCHED_CPU_RUNQ that lock,
+ * not sched_spinlock, protects the thread's thread_state.
+ */
+static void unready_thread(struct k_thread *thread, u32_t states)
 {
-	LOCKED(&sched_spinlock) {
-		if (z_is_thread_queued(thread)) {
-			_priq_run_remove(&_kernel.ready_q.runq, thread);
-			z_mark_thread_as_not_queued(thread);
-		}
-		update_cache(thread == _current);
+	k_spinlock_key_t key;
+	struct k_spinlock *lock = runq_lock(thread, &key);
+
+	if (z_is_thread_queued(thread)) {
+		runq_remove(thread);
+		z_mark_thread_as_not_queued(thread);
 	}
+	z_set_thread_states(thread, states);
+	update_cache(thread == _current);
+	k_spin_unlock(lock, key);
+}
+
+void z_remove_thread_from_ready_q(struct k_thread *thread)
+{
+	unready_thread(thread, 0);
+}
+
+void z_sched_thread_states_update(struct k_thread *thread, u32_t set,
+				  u32_t clear)
+{
+	k_spinlock_key_t key;
+	struct k_spinlock *lock = runq_lock(thread, &key);
+
+	z_reset_thread_states(thread, clear);
+	z_set_thread_states(thread, set);
+	k_spin_unlock(lock, key);
 }
 
 static void pend(struct k_thread *thread, _wait_q_t *wait_q, s32_t timeout)
 {
-	z_remove_thread_from_ready_q(thread);
-	z_mark_thread_as_pending(thread);
+	unready_thread(thread, _THREAD_PENDING);
 
 	if (wait_q != NULL) {
 		thread->base.pended_on = wait_q;
@@ -410,7 +602,13 @@ ALWAYS_INLINE void z_unpend_thread_no_timeout(struct k_thread *thread)
 {
 	LOCKED(&sched_spinlock) {
 		_priq_wait_remove(&pended_on(thread)->waitq, thread);
-		z_mark_thread_as_not_pending(thread);
+		if (!IS_ENABLED(CONFIG_SCHED_CPU_RUNQ)) {
+			z_mark_thread_as_not_pending(thread);
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_SCHED_CPU_RUNQ)) {
+		z_sched_thread_states_update(thread, 0, _THREAD_PENDING);
 	}
 
 	thread->base.pended_on = NULL;
@@ -425,8 +623,8 @@ void z_thread_timeout(struct _timeout *to)
 	if (th->base.pended_on != NULL) {
 		z_unpend_thread_no_timeout(th);
 	}
-	z_mark_thread_as_started(th);
-	z_mark_thread_as_not_suspended(th);
+	z_sched_thread_states_update(th, 0,
+				     _THREAD_PRESTART | _THREAD_SUSPENDED);
 	z_ready_thread(th);
 }
 #endif
@@ -480,24 +678,25 @@ void z_unpend_thread(struct k_thread *thread)
 void z_thread_priority_set(struct k_thread *thread, int prio)
 {
 	bool need_sched = 0;
+	k_spinlock_key_t key;
+	struct k_spinlock *lock = runq_lock(thread, &key);
 
-	LOCKED(&sched_spinlock) {
-		need_sched = z_is_thread_ready(thread);
-
-		if (need_sched) {
-			/* Don't requeue on SMP if it's the running thread */
-			if (!IS_ENABLED(CONFIG_SMP) || z_is_thread_queued(thread)) {
-				_priq_run_remove(&_kernel.ready_q.runq, thread);
-				thread->base.prio = prio;
-				_priq_run_add(&_kernel.ready_q.runq, thread);
-			} else {
-				thread->base.prio = prio;
-			}
-			update_cache(1);
+	need_sched = z_is_thread_ready(thread);
+
+	if (need_sched) {
+		/* Don't requeue on SMP if it's the running thread */
+		if (!IS_ENABLED(CONFIG_SMP) || z_is_thread_queued(thread)) {
+			runq_remove(thread);
+			thread->base.prio = prio;
+			runq_add(thread);
 		} else {
 			thread->base.prio = prio;
 		}
+		update_cache(1);
+	} else {
+		thread->base.prio = prio;
 	}
+	k_spin_unlock(lock, key);
 	sys_trace_thread_priority_set(thread);
 
 	if (IS_ENABLED(CONFIG_SMP) &&
@@ -568,11 +767,11 @@ void k_sched_unlock(void)
 #ifdef CONFIG_SMP
 struct k_thread *z_get_next_ready_thread(void)
 {
-	struct k_thread *ret = 0;
+	struct k_thread *ret;
+	k_spinlock_key_t key = lock_curr_cpu_runq();
 
-	LOCKED(&sched_spinlock) {
-		ret = next_up();
-	}
+	ret = next_up();
+	k_spin_unlock(curr_cpu_runq_lock(), key);
 
 	return ret;
 }
@@ -598,23 +797,23 @@ void *z_get_next_switch_handle(void *interrupted)
 	z_check_stack_sentinel();
 
 #ifdef CONFIG_SMP
-	LOCKED(&sched_spinlock) {
-		struct k_thread *th = next_up();
+	k_spinlock_key_t key = lock_curr_cpu_runq();
+	struct k_thread *th = next_up();
 
-		if (_current != th) {
-			reset_time_slice();
-			_current_cpu->swap_ok = 0;
-			set_current(th);
+	if (_current != th) {
+		reset_time_slice();
+		_current_cpu->swap_ok = 0;
+		set_current(th);
 #ifdef SPIN_VALIDATE
-			/* Changed _current!  Update the spinlock
-			 * bookeeping so the validation doesn't get
-			 * confused when the "wrong" thread tries to
-			 * release the lock.
-			 */
-			z_spin_lock_set_owner(&sched_spinlock);
+		/* Changed _current!  Update the spinlock
+		 * bookeeping so the validation doesn't get
+		 * confused when the "wrong" thread tries to
+		 * release the lock.
+		 */
+		z_spin_lock_set_owner(curr_cpu_runq_lock());
 #endif
-		}
 	}
+	k_spin_unlock(curr_cpu_runq_lock(), key);
 #else
 	set_current(z_get_next_ready_thread());
 #endif
@@ -800,14 +999,14 @@ int z_unpend_all(_wait_q_t *wait_q)
 	return need_sched;
 }
 
-void z_sched_init(void)
+static void init_ready_q(struct _ready_q *rq)
 {
 #ifdef CONFIG_SCHED_DUMB
-	sys_dlist_init(&_kernel.ready_q.runq);
+	sys_dlist_init(&rq->runq);
 #endif
 
 #ifdef CONFIG_SCHED_SCALABLE
-	_kernel.ready_q.runq = (struct _priq_rb) {
+	rq->runq = (struct _priq_rb) {
 		.tree = {
 			.lessthan_fn = z_priq_rb_lessthan,
 		}
@@ -815,10 +1014,21 @@ void z_sched_init(void)
 #endif
 
 #ifdef CONFIG_SCHED_MULTIQ
-	for (int i = 0; i < ARRAY_SIZE(_kernel.ready_q.runq.queues); i++) {
-		sys_dlist_init(&_kernel.ready_q.runq.queues[i]);
+	for (int i = 0; i < ARRAY_SIZE(rq->runq.queues); i++) {
+		sys_dlist_init(&rq->runq.queues[i]);
 	}
 #endif
+}
+
+void z_sched_init(void)
+{
+#ifdef CONFIG_SCHED_CPU_RUNQ
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		init_ready_q(&_kernel.cpus[i].ready_q);
+	}
+#else
+	init_ready_q(&_kernel.ready_q);
+#endif
 
 #ifdef CONFIG_TIMESLICING
 	k_sched_time_slice_set(CONFIG_TIMESLICE_SIZE,
@@ -871,14 +1081,15 @@ Z_SYSCALL_HANDLER(k_thread_priority_set, thread_p, prio)
 void z_impl_k_thread_deadline_set(k_tid_t tid, int deadline)
 {
 	struct k_thread *th = tid;
+	k_spinlock_key_t key;
+	struct k_spinlock *lock = runq_lock(th, &key);
 
-	LOCKED(&sched_spinlock) {
-		th->base.prio_deadline = k_cycle_get_32() + deadline;
-		if (z_is_thread_queued(th)) {
-			_priq_run_remove(&_kernel.ready_q.runq, th);
-			_priq_run_add(&_kernel.ready_q.runq, th);
-		}
+	th->base.prio_deadline = k_cycle_get_32() + deadline;
+	if (z_is_thread_queued(th)) {
+		runq_remove(th);
+		runq_add(th);
 	}
+	k_spin_unlock(lock, key);
 }
 
 #ifdef CONFIG_USERSPACE
@@ -902,16 +1113,16 @@ void z_impl_k_yield(void)
 	__ASSERT(!z_is_in_isr(), "");
 
 	if (!is_idle(_current)) {
-		LOCKED(&sched_spinlock) {
-			if (!IS_ENABLED(CONFIG_SMP) ||
-			    z_is_thread_queued(_current)) {
-				_priq_run_remove(&_kernel.ready_q.runq,
-						 _current);
-				_priq_run_add(&_kernel.ready_q.runq,
-					      _current);
-			}
-			update_cache(1);
+		k_spinlock_key_t key;
+		struct k_spinlock *lock = runq_lock(_current, &key);
+
+		if (!IS_ENABLED(CONFIG_SMP) ||
+		    z_is_thread_queued(_current)) {
+			runq_remove(_current);
+			runq_add(_current);
 		}
+		update_cache(1);
+		k_spin_unlock(lock, key);
 	}
 	z_swap_unlocked();
 }
@@ -948,9 +1159,8 @@ static s32_t z_tick_sleep(s32_t ticks)
 #if defined(CONFIG_TIMESLICING) && defined(CONFIG_SWAP_NONATOMIC)
 	pending_current = _current;
 #endif
-	z_remove_thread_from_ready_q(_current);
+	unready_thread(_current, _THREAD_SUSPENDED);
 	z_add_thread_timeout(_current, ticks);
-	z_mark_thread_as_suspended(_current);
 
 	(void)z_swap(&local_lock, key);
 
@@ -1007,7 +1217,7 @@ void z_impl_k_wakeup(k_tid_t thread)
 		return;
 	}
 
-	z_mark_thread_as_not_suspended(thread);
+	z_sched_thread_states_update(thread, 0, _THREAD_SUSPENDED);
 	z_ready_thread(thread);
 
 	if (!z_is_in_isr()) {
@@ -1029,12 +1239,14 @@ void z_impl_k_wakeup(k_tid_t thread)
  */
 void z_sched_ipi(void)
 {
-	LOCKED(&sched_spinlock) {
-		if (_current->base.thread_state & _THREAD_ABORTING) {
-			_current->base.thread_state |= _THREAD_DEAD;
-			_current_cpu->swap_ok = true;
-		}
+	k_spinlock_key_t key;
+	struct k_spinlock *lock = runq_lock(_current, &key);
+
+	if (_current->base.thread_state & _THREAD_ABORTING) {
+		_current->base.thread_state |= _THREAD_DEAD;
+		_current_cpu->swap_ok = true;
 	}
+	k_spin_unlock(lock, key);
 }
 
 void z_sched_abort(struct k_thread *thread)
@@ -1048,7 +1260,7 @@ void z_sched_abort(struct k_thread *thread)
 	 * it locally.  Not all architectures support that, alas.  If
 	 * we don't have it, we need to wait for some other interrupt.
 	 */
-	thread->base.thread_state |= _THREAD_ABORTING;
+	z_sched_thread_states_update(thread, _THREAD_ABORTING, 0);
 #ifdef CONFIG_SCHED_IPI_SUPPORTED
 	z_arch_sched_ipi();
 #endif
@@ -1057,13 +1269,15 @@ void z_sched_abort(struct k_thread *thread)
 	 * running on or because we caught it idle in the queue
 	 */
 	while ((thread->base.thread_state & _THREAD_DEAD) == 0U) {
-		LOCKED(&sched_spinlock) {
-			if (z_is_thread_queued(thread)) {
-				thread->base.thread_state |= _THREAD_DEAD;
-				_priq_run_remove(&_kernel.ready_q.runq, thread);
-				z_mark_thread_as_not_queued(thread);
-			}
+		k_spinlock_key_t key;
+		struct k_spinlock *lock = runq_lock(thread, &key);
+
+		if (z_is_thread_queued(thread)) {
+			thread->base.thread_state |= _THREAD_DEAD;
+			runq_remove(thread);
+			z_mark_thread_as_not_queued(thread);
 		}
+		k_spin_unlock(lock, key);
 	}
 }
 #endif
@@ -14,13 +14,71 @@
 static atomic_t global_lock;
 static atomic_t start_flag;
 
+#ifdef CONFIG_SPINLOCK_STATS
+/* Protected by global_lock itself */
+static struct z_smp_global_lock_stats global_lock_stats;
+
+/* irq_lock() call site of the current holder, NULL if it was
+ * reacquired on context switch
+ */
+static void *volatile global_lock_site;
+
+static void note_global_lock_wait(void *holder)
+{
+	struct z_smp_global_lock_site *s = global_lock_stats.holders;
+
+	global_lock_stats.contended++;
+
+	for (int i = 0; i < CONFIG_SPINLOCK_STATS_GLOBAL_LOCK_SITES; i++) {
+		if (s[i].site == holder || s[i].waits == 0U) {
+			s[i].site = holder;
+			s[i].waits++;
+			break;
+		}
+	}
+}
+#endif
+
+static void global_lock_acquire(void *site)
+{
+	ARG_UNUSED(site);
+
+#ifdef CONFIG_SPINLOCK_STATS
+	void *holder = NULL;
+	bool contended = !atomic_cas(&global_lock, 0, 1);
+
+	if (contended) {
+		/* Racy, but good enough to blame the usual suspects */
+		holder = global_lock_site;
+		while (!atomic_cas(&global_lock, 0, 1)) {
+		}
+		note_global_lock_wait(holder);
+	}
+
+	global_lock_stats.acquired++;
+	global_lock_site = site;
+#else
+	while (!atomic_cas(&global_lock, 0, 1)) {
+	}
+#endif
+}
+
+#ifdef CONFIG_SPINLOCK_STATS
+void z_smp_global_lock_stats_get(struct z_smp_global_lock_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	*stats = global_lock_stats;
+	irq_unlock(key);
+}
+#endif
+
 unsigned int z_smp_global_lock(void)
 {
 	unsigned int key = z_arch_irq_lock();
 
 	if (!_current->base.global_lock_count) {
-		while (!atomic_cas(&global_lock, 0, 1)) {
-		}
+		global_lock_acquire(__builtin_return_address(0));
 	}
 
 	_current->base.global_lock_count++;
@@ -46,8 +104,7 @@ void z_smp_reacquire_global_lock(struct k_thread *thread)
 	if (thread->base.global_lock_count) {
 		z_arch_irq_lock();
 
-		while (!atomic_cas(&global_lock, 0, 1)) {
-		}
+		global_lock_acquire(NULL);
 	}
 }
 
@@ -60,6 +117,87 @@ void z_smp_release_global_lock(struct k_thread *thread)
 	}
 }
 
+#ifdef CONFIG_SPINLOCK_MCS
+/* MCS queue nodes.  Each CPU owns CONFIG_SPINLOCK_MCS_NESTING of
+ * them, one per lock it holds or is waiting for, and only ever
+ * allocates from its own set with interrupts masked.  Locks refer to
+ * nodes by index plus one (our atomics can't hold a pointer on all
+ * architectures), so a zero tail means the lock is free.
+ */
+struct mcs_node {
+	atomic_t next;
+	atomic_t wait;
+	bool in_use;
+};
+
+static struct mcs_node mcs_nodes[CONFIG_MP_NUM_CPUS *
+				 CONFIG_SPINLOCK_MCS_NESTING];
+
+static inline struct mcs_node *mcs_node(atomic_val_t idx)
+{
+	return &mcs_nodes[idx - 1];
+}
+
+static atomic_val_t mcs_node_alloc(void)
+{
+	int base = z_arch_curr_cpu()->id * CONFIG_SPINLOCK_MCS_NESTING;
+
+	for (int i = 0; i < CONFIG_SPINLOCK_MCS_NESTING; i++) {
+		struct mcs_node *n = &mcs_nodes[base + i];
+
+		if (!n->in_use) {
+			n->in_use = true;
+			(void)atomic_clear(&n->next);
+			(void)atomic_set(&n->wait, 1);
+			return base + i + 1;
+		}
+	}
+
+	__ASSERT(false, "Spinlocks nested too deeply");
+	return 0;
+}
+
+bool z_spin_mcs_lock(struct k_spinlock *l)
+{
+	atomic_val_t me = mcs_node_alloc();
+	atomic_val_t prev = atomic_set(&l->tail, me);
+
+	if (prev != 0) {
+		/* Link behind the previous waiter, then spin on our
+		 * own node until it hands the lock over
+		 */
+		(void)atomic_set(&mcs_node(prev)->next, me);
+		while (atomic_get(&mcs_node(me)->wait)) {
+		}
+	}
+
+	l->owner = me;
+	return prev != 0;
+}
+
+void z_spin_mcs_unlock(struct k_spinlock *l)
+{
+	atomic_val_t me = l->owner;
+	struct mcs_node *n = mcs_node(me);
+
+	if (atomic_get(&n->next) == 0) {
+		if (atomic_cas(&l->tail, me, 0)) {
+			n->in_use = false;
+			return;
+		}
+
+		/* Someone swapped themselves into the tail but hasn't
+		 * linked to us yet
+		 */
+		while (atomic_get(&n->next) == 0) {
+		}
+	}
+
+	(void)atomic_clear(&mcs_node(atomic_get(&n->next))->wait);
+	n->in_use = false;
+}
+#endif /* CONFIG_SPINLOCK_MCS */
+
 extern k_thread_stack_t _interrupt_stack1[];
 extern k_thread_stack_t _interrupt_stack2[];
 extern k_thread_stack_t _interrupt_stack3[];
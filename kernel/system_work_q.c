@@ -14,10 +14,39 @@
 #include <kernel.h>
 #include <init.h>
 
-K_THREAD_STACK_DEFINE(sys_work_q_stack, CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE);
+#if defined(CONFIG_SYSTEM_WORKQUEUE_THREADS) && \
+	(CONFIG_SYSTEM_WORKQUEUE_THREADS > 1)
+#define SYS_WORK_Q_THREADS CONFIG_SYSTEM_WORKQUEUE_THREADS
+#else
+#define SYS_WORK_Q_THREADS 1
+#endif
 
 struct k_work_q k_sys_work_q;
 
+#if SYS_WORK_Q_THREADS > 1
+K_THREAD_STACK_ARRAY_DEFINE(sys_work_q_stacks, SYS_WORK_Q_THREADS,
+			    CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE);
+static struct k_thread sys_work_q_threads[SYS_WORK_Q_THREADS];
+
+static int k_sys_work_q_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_work_q_pool_start(&k_sys_work_q, sys_work_q_threads,
+			    sys_work_q_stacks[0],
+			    CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE,
+			    SYS_WORK_Q_THREADS,
+			    CONFIG_SYSTEM_WORKQUEUE_PRIORITY,
+			    IS_ENABLED(CONFIG_SYSTEM_WORKQUEUE_PIN_THREADS));
+	for (int i = 0; i < SYS_WORK_Q_THREADS; i++) {
+		k_thread_name_set(&sys_work_q_threads[i], "sysworkq");
+	}
+
+	return 0;
+}
+#else
+K_THREAD_STACK_DEFINE(sys_work_q_stack, CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE);
+
 static int k_sys_work_q_init(struct device *dev)
 {
 	ARG_UNUSED(dev);
@@ -30,5 +59,6 @@ static int k_sys_work_q_init(struct device *dev)
 
 	return 0;
 }
+#endif
 
 SYS_INIT(k_sys_work_q_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -591,7 +591,7 @@ void z_thread_single_suspend(struct k_thread *thread)
 		z_remove_thread_from_ready_q(thread);
 	}
 
-	z_mark_thread_as_suspended(thread);
+	z_sched_thread_states_update(thread, _THREAD_SUSPENDED, 0);
 }
 
 void z_impl_k_thread_suspend(struct k_thread *thread)
@@ -615,7 +615,7 @@ Z_SYSCALL_HANDLER1_SIMPLE_VOID(k_thread_suspend, K_OBJ_THREAD, k_tid_t);
 
 void z_thread_single_resume(struct k_thread *thread)
 {
-	z_mark_thread_as_not_suspended(thread);
+	z_sched_thread_states_update(thread, 0, _THREAD_SUSPENDED);
 	z_ready_thread(thread);
 }
 
@@ -654,7 +654,7 @@ void z_thread_single_abort(struct k_thread *thread)
 		}
 	}
 
-	thread->base.thread_state |= _THREAD_DEAD;
+	z_sched_thread_states_update(thread, _THREAD_DEAD, 0);
 
 	sys_trace_thread_abort(thread);
 
@@ -17,8 +17,6 @@
 
 static u64_t curr_tick;
 
-static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
-
 static struct k_spinlock timeout_lock;
 
 #define MAX_WAIT (IS_ENABLED(CONFIG_SYSTEM_CLOCK_SLOPPY_IDLE) \
@@ -38,6 +36,204 @@ Z_SYSCALL_HANDLER(z_clock_hw_cycles_per_sec_runtime_get)
 #endif /* CONFIG_USERSPACE */
 #endif /* CONFIG_TIMER_READS_ITS_FREQUENCY_AT_RUNTIME */
 
+static s32_t elapsed(void)
+{
+	return announce_remaining == 0 ? z_clock_elapsed() : 0;
+}
+
+#ifdef CONFIG_TIMEOUT_QUEUE_WHEEL
+
+/* Hierarchical timing wheel.  Level N has 32 slots each covering
+ * 32^N ticks.  A timeout lives at the lowest level whose slot
+ * boundaries it shares with curr_tick above that level's range
+ * (i.e. at level 0 it expires within the current 32 tick block, at
+ * level 1 within the current 1024 tick block, etc), in the slot
+ * holding its expiry.  As curr_tick advances into a slot above level
+ * 0 that slot is "cascaded": its timeouts are reinserted, which moves
+ * them to lower levels.  Timeouts beyond the range of the top level
+ * wait on an overflow list which is cascaded when curr_tick enters a
+ * new top level block.
+ *
+ * Slot bitmaps are cleared lazily: a set bit means the slot list was
+ * initialized and may be non-empty, so aborting a timeout is just an
+ * unlink.
+ */
+#define WHEEL_SLOT_BITS	5
+#define WHEEL_SLOTS	BIT(WHEEL_SLOT_BITS)
+#define WHEEL_LEVELS	CONFIG_TIMEOUT_WHEEL_LEVELS
+#define WHEEL_SHIFT(lvl) ((lvl) * WHEEL_SLOT_BITS)
+
+struct wheel_level {
+	u32_t bitmap;
+	sys_dlist_t slots[WHEEL_SLOTS];
+};
+
+static struct wheel_level wheel[WHEEL_LEVELS];
+
+static sys_dlist_t wheel_overflow = SYS_DLIST_STATIC_INIT(&wheel_overflow);
+
+static inline int wheel_slot(u64_t tick, int lvl)
+{
+	return (tick >> WHEEL_SHIFT(lvl)) & (WHEEL_SLOTS - 1);
+}
+
+static void wheel_insert(struct _timeout *to)
+{
+	u64_t diff = to->expiry ^ curr_tick;
+	int lvl = 0;
+
+	if (diff != 0U) {
+		lvl = (63 - __builtin_clzll(diff)) / WHEEL_SLOT_BITS;
+	}
+
+	if (lvl < WHEEL_LEVELS) {
+		struct wheel_level *wl = &wheel[lvl];
+		int slot = wheel_slot(to->expiry, lvl);
+
+		if ((wl->bitmap & BIT(slot)) == 0U) {
+			sys_dlist_init(&wl->slots[slot]);
+			wl->bitmap |= BIT(slot);
+		}
+		sys_dlist_append(&wl->slots[slot], &to->node);
+	} else {
+		sys_dlist_append(&wheel_overflow, &to->node);
+	}
+}
+
+/* Finds the next point in time at which the wheel needs servicing:
+ * either the exact expiry of the soonest timeouts (at level 0) or the
+ * start of the next slot that needs cascading.  Returns the slot list
+ * concerned and stores its level in *lvl (WHEEL_LEVELS for the
+ * overflow list), or NULL if there are no timeouts at all.
+ */
+static sys_dlist_t *wheel_next(u64_t *when, int *lvl)
+{
+	for (int i = 0; i < WHEEL_LEVELS; i++) {
+		struct wheel_level *wl = &wheel[i];
+		u32_t pending = ~0U << wheel_slot(curr_tick, i);
+
+		/* Cascading can leave timeouts expiring right at
+		 * curr_tick in the current level 0 slot, but above
+		 * level 0 the current slot is always empty.
+		 */
+		if (i > 0) {
+			pending <<= 1;
+		}
+		pending &= wl->bitmap;
+
+		while (pending != 0U) {
+			int slot = __builtin_ctz(pending);
+
+			if (!sys_dlist_is_empty(&wl->slots[slot])) {
+				*when = (curr_tick >> WHEEL_SHIFT(i + 1))
+					<< WHEEL_SHIFT(i + 1);
+				*when |= (u64_t)slot << WHEEL_SHIFT(i);
+				*lvl = i;
+				return &wl->slots[slot];
+			}
+			wl->bitmap &= ~BIT(slot);
+			pending &= ~BIT(slot);
+		}
+	}
+
+	if (!sys_dlist_is_empty(&wheel_overflow)) {
+		*when = ((curr_tick >> WHEEL_SHIFT(WHEEL_LEVELS)) + 1)
+			<< WHEEL_SHIFT(WHEEL_LEVELS);
+		*lvl = WHEEL_LEVELS;
+		return &wheel_overflow;
+	}
+
+	return NULL;
+}
+
+static void wheel_cascade(sys_dlist_t *list, int lvl)
+{
+	sys_dlist_t pending;
+	sys_dnode_t *node;
+
+	/* Detach first: overflow entries may go right back */
+	sys_dlist_init(&pending);
+	while ((node = sys_dlist_get(list)) != NULL) {
+		sys_dlist_append(&pending, node);
+	}
+
+	if (lvl < WHEEL_LEVELS) {
+		wheel[lvl].bitmap &= ~BIT(wheel_slot(curr_tick, lvl));
+	}
+
+	while ((node = sys_dlist_get(&pending)) != NULL) {
+		wheel_insert(CONTAINER_OF(node, struct _timeout, node));
+	}
+}
+
+/* Returns the number of ticks from curr_tick to the next time the
+ * timeout queue needs servicing, or K_FOREVER if it is empty
+ */
+static s32_t first_dticks(void)
+{
+	u64_t when;
+	int lvl;
+
+	if (wheel_next(&when, &lvl) == NULL) {
+		return K_FOREVER;
+	}
+
+	return MIN(when - curr_tick, INT_MAX);
+}
+
+/* Inserts to, returning true if it is now the first timeout to expire */
+static bool add_timeout(struct _timeout *to, s32_t ticks)
+{
+	s32_t dt = first_dticks();
+
+	to->expiry = curr_tick + ticks;
+	wheel_insert(to);
+
+	return dt == K_FOREVER || ticks < dt;
+}
+
+static void remove_timeout(struct _timeout *t)
+{
+	sys_dlist_remove(&t->node);
+}
+
+static s32_t timeout_dticks(struct _timeout *t)
+{
+	return t->expiry - curr_tick;
+}
+
+/* Pops the next timeout expiring within the announce_remaining ticks
+ * past curr_tick, advancing curr_tick to its expiry
+ */
+static struct _timeout *pop_expired(void)
+{
+	u64_t end = curr_tick + announce_remaining;
+	sys_dlist_t *list;
+	u64_t when;
+	int lvl;
+
+	while ((list = wheel_next(&when, &lvl)) != NULL && when <= end) {
+		curr_tick = when;
+		announce_remaining = end - when;
+
+		if (lvl == 0) {
+			struct _timeout *t = CONTAINER_OF(sys_dlist_get(list),
+							  struct _timeout,
+							  node);
+			t->dticks = 0;
+			return t;
+		}
+
+		wheel_cascade(list, lvl);
+	}
+
+	return NULL;
+}
+
+#else /* !CONFIG_TIMEOUT_QUEUE_WHEEL */
+
+static sys_dlist_t timeout_list = SYS_DLIST_STATIC_INIT(&timeout_list);
+
 static struct _timeout *first(void)
 {
 	sys_dnode_t *t = sys_dlist_peek_head(&timeout_list);
@@ -52,6 +248,36 @@ static struct _timeout *next(struct _timeout *t)
 	return n == NULL ? NULL : CONTAINER_OF(n, struct _timeout, node);
 }
 
+static s32_t first_dticks(void)
+{
+	struct _timeout *to = first();
+
+	return to == NULL ? K_FOREVER : to->dticks;
+}
+
+static bool add_timeout(struct _timeout *to, s32_t ticks)
+{
+	struct _timeout *t;
+
+	to->dticks = ticks;
+	for (t = first(); t != NULL; t = next(t)) {
+		__ASSERT(t->dticks >= 0, "");
+
+		if (t->dticks > to->dticks) {
+			t->dticks -= to->dticks;
+			sys_dlist_insert(&t->node, &to->node);
+			break;
+		}
+		to->dticks -= t->dticks;
+	}
+
+	if (t == NULL) {
+		sys_dlist_append(&timeout_list, &to->node);
+	}
+
+	return to == first();
+}
+
 static void remove_timeout(struct _timeout *t)
 {
 	if (next(t) != NULL) {
@@ -61,16 +287,44 @@ static void remove_timeout(struct _timeout *t)
 	sys_dlist_remove(&t->node);
 }
 
-static s32_t elapsed(void)
+static s32_t timeout_dticks(struct _timeout *timeout)
 {
-	return announce_remaining == 0 ? z_clock_elapsed() : 0;
+	s32_t ticks = 0;
+
+	for (struct _timeout *t = first(); t != NULL; t = next(t)) {
+		ticks += t->dticks;
+		if (timeout == t) {
+			break;
+		}
+	}
+
+	return ticks;
+}
+
+static struct _timeout *pop_expired(void)
+{
+	struct _timeout *t = first();
+
+	if (t == NULL || t->dticks > announce_remaining) {
+		return NULL;
+	}
+
+	curr_tick += t->dticks;
+	announce_remaining -= t->dticks;
+	t->dticks = 0;
+	remove_timeout(t);
+
+	return t;
 }
 
+#endif /* CONFIG_TIMEOUT_QUEUE_WHEEL */
+
 static s32_t next_timeout(void)
 {
-	struct _timeout *to = first();
+	s32_t dticks = first_dticks();
 	s32_t ticks_elapsed = elapsed();
-	s32_t ret = to == NULL ? MAX_WAIT : MAX(0, to->dticks - ticks_elapsed);
+	s32_t ret = dticks == K_FOREVER ?
+		MAX_WAIT : MAX(0, dticks - ticks_elapsed);
 
 #ifdef CONFIG_TIMESLICING
 	if (_current_cpu->slice_ticks && _current_cpu->slice_ticks < ret) {
@@ -87,25 +341,7 @@ void z_add_timeout(struct _timeout *to, _timeout_func_t fn, s32_t ticks)
 	ticks = MAX(1, ticks);
 
 	LOCKED(&timeout_lock) {
-		struct _timeout *t;
-
-		to->dticks = ticks + elapsed();
-		for (t = first(); t != NULL; t = next(t)) {
-			__ASSERT(t->dticks >= 0, "");
-
-			if (t->dticks > to->dticks) {
-				t->dticks -= to->dticks;
-				sys_dlist_insert(&t->node, &to->node);
-				break;
-			}
-			to->dticks -= t->dticks;
-		}
-
-		if (t == NULL) {
-			sys_dlist_append(&timeout_list, &to->node);
-		}
-
-		if (to == first()) {
+		if (add_timeout(to, ticks + elapsed())) {
 			z_clock_set_timeout(next_timeout(), false);
 		}
 	}
@@ -134,12 +370,7 @@ s32_t z_timeout_remaining(struct _timeout *timeout)
 	}
 
 	LOCKED(&timeout_lock) {
-		for (struct _timeout *t = first(); t != NULL; t = next(t)) {
-			ticks += t->dticks;
-			if (timeout == t) {
-				break;
-			}
-		}
+		ticks = timeout_dticks(timeout);
 	}
 
 	return ticks - elapsed();
@@ -182,25 +413,21 @@ void z_clock_announce(s32_t ticks)
 
 	k_spinlock_key_t key = k_spin_lock(&timeout_lock);
 
-	announce_remaining = ticks;
+	struct _timeout *t;
 
-	while (first() != NULL && first()->dticks <= announce_remaining) {
-		struct _timeout *t = first();
-		int dt = t->dticks;
-
-		curr_tick += dt;
-		announce_remaining -= dt;
-		t->dticks = 0;
-		remove_timeout(t);
+	announce_remaining = ticks;
 
+	while ((t = pop_expired()) != NULL) {
 		k_spin_unlock(&timeout_lock, key);
 		t->fn(t);
 		key = k_spin_lock(&timeout_lock);
 	}
 
+#ifndef CONFIG_TIMEOUT_QUEUE_WHEEL
 	if (first() != NULL) {
 		first()->dticks -= announce_remaining;
 	}
+#endif
 
 	curr_tick += announce_remaining;
 	announce_remaining = 0;
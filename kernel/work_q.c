@@ -16,6 +16,7 @@
 #include <spinlock.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <string.h>
 
 #define WORKQUEUE_THREAD_NAME	"workqueue"
 
@@ -25,16 +26,65 @@ static struct k_spinlock lock;
 
 extern void z_work_q_main(void *work_q_ptr, void *p2, void *p3);
 
+static void work_q_init(struct k_work_q *work_q)
+{
+	k_queue_init(&work_q->queue);
+#ifdef CONFIG_WORKQUEUE_STATS
+	(void)memset(&work_q->stats, 0, sizeof(work_q->stats));
+#endif
+}
+
 void k_work_q_start(struct k_work_q *work_q, k_thread_stack_t *stack,
 		    size_t stack_size, int prio)
 {
-	k_queue_init(&work_q->queue);
+	work_q_init(work_q);
 	(void)k_thread_create(&work_q->thread, stack, stack_size, z_work_q_main,
 			work_q, NULL, NULL, prio, 0, 0);
 
 	k_thread_name_set(&work_q->thread, WORKQUEUE_THREAD_NAME);
 }
 
+void k_work_q_pool_start(struct k_work_q *work_q, struct k_thread *threads,
+			 k_thread_stack_t *stacks, size_t stack_size,
+			 int num_threads, int prio, bool pin)
+{
+	__ASSERT(num_threads > 0, "");
+	__ASSERT(!pin || IS_ENABLED(CONFIG_SCHED_CPU_MASK),
+		 "pinning needs CONFIG_SCHED_CPU_MASK");
+
+	work_q_init(work_q);
+
+	for (int i = 0; i < num_threads; i++) {
+		k_thread_stack_t *stack = (k_thread_stack_t *)
+			((char *)stacks + i * K_THREAD_STACK_LEN(stack_size));
+
+		(void)k_thread_create(&threads[i], stack, stack_size,
+				      z_work_q_main, work_q, NULL, NULL,
+				      prio, 0, K_FOREVER);
+		k_thread_name_set(&threads[i], WORKQUEUE_THREAD_NAME);
+
+#ifdef CONFIG_SCHED_CPU_MASK
+		/* The mask can only be changed before the thread runs */
+		if (pin) {
+			(void)k_thread_cpu_mask_clear(&threads[i]);
+			(void)k_thread_cpu_mask_enable(&threads[i],
+						       i % CONFIG_MP_NUM_CPUS);
+		}
+#endif
+		k_thread_start(&threads[i]);
+	}
+}
+
+#ifdef CONFIG_WORKQUEUE_STATS
+void k_work_q_stats_get(struct k_work_q *work_q, struct k_work_q_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&work_q->stats_lock);
+
+	*stats = work_q->stats;
+	k_spin_unlock(&work_q->stats_lock, key);
+}
+#endif
+
 #ifdef CONFIG_SYS_CLOCK_EXISTS
 static void work_timeout(struct _timeout *t)
 {
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/lf_ring.h>
+#include <sys/__assert.h>
+#include <string.h>
+#include <errno.h>
+
+/* Both rings use free running indices: head - tail is the fill level
+ * and index & mask the position in the buffer.  The atomic_get() and
+ * atomic_set() on the shared indices order the data accesses against
+ * publishing them, so the side reading an index always sees the data
+ * (or free space) that index covers.
+ */
+
+void spsc_ring_init(struct spsc_ring *ring, u32_t size, u8_t *data)
+{
+	__ASSERT(is_power_of_two(size), "size must be a power of two");
+
+	(void)memset(ring, 0, sizeof(*ring));
+	ring->buf = data;
+	ring->mask = size - 1;
+}
+
+u32_t spsc_ring_put_claim(struct spsc_ring *ring, u8_t **data, u32_t size)
+{
+	u32_t head = (u32_t)atomic_get(&ring->prod.head) + ring->prod.claimed;
+	u32_t space = ring->mask + 1 - (head - ring->prod.tail_cache);
+	u32_t offset = head & ring->mask;
+
+	if (space < size) {
+		/* Only look at the consumer's cache line when the ring
+		 * looks full.
+		 */
+		ring->prod.tail_cache = (u32_t)atomic_get(&ring->cons.tail);
+		space = ring->mask + 1 - (head - ring->prod.tail_cache);
+	}
+
+	size = MIN(size, space);
+	size = MIN(size, ring->mask + 1 - offset);
+
+	*data = &ring->buf[offset];
+	ring->prod.claimed += size;
+
+	return size;
+}
+
+int spsc_ring_put_finish(struct spsc_ring *ring, u32_t size)
+{
+	if (size > ring->prod.claimed) {
+		return -EINVAL;
+	}
+
+	atomic_add(&ring->prod.head, size);
+	ring->prod.claimed = 0U;
+
+	return 0;
+}
+
+u32_t spsc_ring_put(struct spsc_ring *ring, const u8_t *data, u32_t size)
+{
+	u8_t *dst;
+	u32_t partial_size;
+	u32_t total_size = 0U;
+	int err;
+
+	do {
+		partial_size = spsc_ring_put_claim(ring, &dst, size);
+		memcpy(dst, data, partial_size);
+		total_size += partial_size;
+		size -= partial_size;
+		data += partial_size;
+	} while (size && partial_size);
+
+	err = spsc_ring_put_finish(ring, total_size);
+	__ASSERT_NO_MSG(err == 0);
+
+	return total_size;
+}
+
+u32_t spsc_ring_get_claim(struct spsc_ring *ring, u8_t **data, u32_t size)
+{
+	u32_t tail = (u32_t)atomic_get(&ring->cons.tail) + ring->cons.claimed;
+	u32_t avail = ring->cons.head_cache - tail;
+	u32_t offset = tail & ring->mask;
+
+	if (avail < size) {
+		ring->cons.head_cache = (u32_t)atomic_get(&ring->prod.head);
+		avail = ring->cons.head_cache - tail;
+	}
+
+	size = MIN(size, avail);
+	size = MIN(size, ring->mask + 1 - offset);
+
+	*data = &ring->buf[offset];
+	ring->cons.claimed += size;
+
+	return size;
+}
+
+int spsc_ring_get_finish(struct spsc_ring *ring, u32_t size)
+{
+	if (size > ring->cons.claimed) {
+		return -EINVAL;
+	}
+
+	atomic_add(&ring->cons.tail, size);
+	ring->cons.claimed = 0U;
+
+	return 0;
+}
+
+u32_t spsc_ring_get(struct spsc_ring *ring, u8_t *data, u32_t size)
+{
+	u8_t *src;
+	u32_t partial_size;
+	u32_t total_size = 0U;
+	int err;
+
+	do {
+		partial_size = spsc_ring_get_claim(ring, &src, size);
+		memcpy(data, src, partial_size);
+		total_size += partial_size;
+		size -= partial_size;
+		data += partial_size;
+	} while (size && partial_size);
+
+	err = spsc_ring_get_finish(ring, total_size);
+	__ASSERT_NO_MSG(err == 0);
+
+	return total_size;
+}
+
+/* The multi-producer ring is Vyukov's bounded queue.  Slot i's
+ * sequence number says which lap of the ring it is on: it equals the
+ * producer index that may fill it next, becomes that index plus one
+ * once the item is published, and the next lap's producer index once
+ * the consumer has taken it.  A producer claims a slot by moving the
+ * shared head index forward with a compare-and-swap, so a producer
+ * preempted between the claim and the publish only holds up the
+ * consumer, never the other producers.
+ *
+ * The sequence numbers are stored relative to their slot index so an
+ * all-zero array (as in MPSC_RING_DECLARE) is a valid empty ring.
+ */
+static inline u32_t slot_seq(struct mpsc_ring *ring, u32_t idx)
+{
+	return (u32_t)atomic_get(&ring->seq[idx]) + idx;
+}
+
+static inline void slot_seq_set(struct mpsc_ring *ring, u32_t idx, u32_t seq)
+{
+	(void)atomic_set(&ring->seq[idx], (atomic_val_t)(seq - idx));
+}
+
+void mpsc_ring_init(struct mpsc_ring *ring, u32_t item_size, u32_t count,
+		    void *data, atomic_t *seq)
+{
+	__ASSERT(is_power_of_two(count), "count must be a power of two");
+
+	(void)memset(ring, 0, sizeof(*ring));
+	(void)memset(seq, 0, count * sizeof(*seq));
+	ring->buf = data;
+	ring->seq = seq;
+	ring->mask = count - 1;
+	ring->item_size = item_size;
+}
+
+int mpsc_ring_put(struct mpsc_ring *ring, const void *item)
+{
+	u32_t pos = (u32_t)atomic_get(&ring->prod.head);
+	u32_t idx;
+
+	for (;;) {
+		s32_t diff;
+
+		idx = pos & ring->mask;
+		diff = (s32_t)(slot_seq(ring, idx) - pos);
+
+		if (diff == 0) {
+			if (atomic_cas(&ring->prod.head, (atomic_val_t)pos,
+				       (atomic_val_t)(pos + 1))) {
+				break;
+			}
+		} else if (diff < 0) {
+			/* The slot still holds last lap's item */
+			return -ENOMEM;
+		}
+
+		/* Another producer got there first */
+		pos = (u32_t)atomic_get(&ring->prod.head);
+	}
+
+	memcpy(&ring->buf[idx * ring->item_size], item, ring->item_size);
+	slot_seq_set(ring, idx, pos + 1);
+
+	return 0;
+}
+
+int mpsc_ring_get(struct mpsc_ring *ring, void *item)
+{
+	u32_t pos = ring->cons.tail;
+	u32_t idx = pos & ring->mask;
+
+	if (slot_seq(ring, idx) != pos + 1) {
+		return -EAGAIN;
+	}
+
+	memcpy(item, &ring->buf[idx * ring->item_size], ring->item_size);
+	slot_seq_set(ring, idx, pos + ring->mask + 1);
+	ring->cons.tail = pos + 1;
+
+	return 0;
+}
@@ -0,0 +1,454 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/tlsf.h>
+#include <sys/__assert.h>
+#include <sys/util.h>
+#include <string.h>
+
+/* Block layout.  A block's header is its size word, preceded by a
+ * pointer to the physically previous block which is only valid while
+ * that previous block is free (otherwise it overlaps the previous
+ * block's last payload word).  Free blocks keep their free list links
+ * at the start of the payload.
+ *
+ *         +-----------+
+ *         | prev_phys |  (end of the previous block's payload)
+ * block > +-----------+
+ *         | size      |  payload bytes | FREE | PREV_FREE
+ *         +-----------+ < pointer returned to the user
+ *         | next_free |
+ *         | prev_free |
+ *         | ...       |
+ *         +-----------+
+ *         | prev_phys |  (of the next block)
+ *         +-----------+
+ *
+ * The heap ends with a zero sized, permanently used sentinel block so
+ * the last real block has a next neighbor like any other.
+ */
+struct tlsf_block {
+	struct tlsf_block *prev_phys;
+	size_t size;
+	struct tlsf_block *next_free;
+	struct tlsf_block *prev_free;
+};
+
+#define BLOCK_FREE BIT(0)
+#define BLOCK_PREV_FREE BIT(1)
+#define BLOCK_FLAGS (BLOCK_FREE | BLOCK_PREV_FREE)
+
+/* Payload offset from the block pointer, and per-block overhead */
+#define BLOCK_START offsetof(struct tlsf_block, next_free)
+#define BLOCK_OVERHEAD sizeof(size_t)
+
+/* The free list links plus the next block's prev_phys pointer */
+#define BLOCK_SIZE_MIN (sizeof(struct tlsf_block) - \
+			sizeof(struct tlsf_block *))
+
+/* Payloads are word aligned, and so are all block sizes */
+#define ALIGN_SIZE sizeof(void *)
+
+/* Each first level list (one per power of two) is split into
+ * 2^SL_INDEX_LOG2 second level lists.  Sizes below SMALL_BLOCK_SIZE
+ * all go in the first first-level list, split linearly.
+ */
+#define SL_INDEX_LOG2 4
+#define SL_INDEX_COUNT BIT(SL_INDEX_LOG2)
+#define FL_INDEX_SHIFT (SL_INDEX_LOG2 + (ALIGN_SIZE == 8 ? 3 : 2))
+#define SMALL_BLOCK_SIZE BIT(FL_INDEX_SHIFT)
+#define FL_INDEX_MAX 31
+
+struct z_tlsf {
+	u32_t fl_count;
+	u32_t fl_bitmap;
+	u16_t sl_bitmap[FL_INDEX_MAX];
+
+	struct tlsf_block *first;
+	size_t total_bytes;
+	size_t used_bytes;
+	size_t peak_used_bytes;
+
+	/* fl_count * SL_INDEX_COUNT list heads */
+	struct tlsf_block *blocks[];
+};
+
+static inline int fls_size(size_t x)
+{
+	return (int)(8 * sizeof(unsigned long)) - 1 -
+		__builtin_clzl((unsigned long)x);
+}
+
+static inline size_t block_size(struct tlsf_block *b)
+{
+	return b->size & ~(size_t)BLOCK_FLAGS;
+}
+
+static inline void block_set_size(struct tlsf_block *b, size_t size)
+{
+	b->size = size | (b->size & BLOCK_FLAGS);
+}
+
+static inline bool block_is_free(struct tlsf_block *b)
+{
+	return (b->size & BLOCK_FREE) != 0U;
+}
+
+static inline bool block_prev_is_free(struct tlsf_block *b)
+{
+	return (b->size & BLOCK_PREV_FREE) != 0U;
+}
+
+static inline void *block_to_ptr(struct tlsf_block *b)
+{
+	return (char *)b + BLOCK_START;
+}
+
+static inline struct tlsf_block *ptr_to_block(void *ptr)
+{
+	return (struct tlsf_block *)((char *)ptr - BLOCK_START);
+}
+
+static inline struct tlsf_block *block_next(struct tlsf_block *b)
+{
+	return (struct tlsf_block *)((char *)block_to_ptr(b) +
+				     block_size(b) - BLOCK_OVERHEAD);
+}
+
+static inline struct tlsf_block **list_head(struct z_tlsf *t, int fl, int sl)
+{
+	return &t->blocks[fl * SL_INDEX_COUNT + sl];
+}
+
+static void mapping_insert(size_t size, int *fl, int *sl)
+{
+	if (size < SMALL_BLOCK_SIZE) {
+		*fl = 0;
+		*sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+	} else {
+		int top = fls_size(size);
+
+		*sl = (size >> (top - SL_INDEX_LOG2)) ^ SL_INDEX_COUNT;
+		*fl = top - (FL_INDEX_SHIFT - 1);
+	}
+}
+
+/* Like mapping_insert(), but rounds up to the next list so that every
+ * block found there is big enough
+ */
+static void mapping_search(size_t size, int *fl, int *sl)
+{
+	if (size >= SMALL_BLOCK_SIZE) {
+		size += BIT(fls_size(size) - SL_INDEX_LOG2) - 1;
+	}
+
+	mapping_insert(size, fl, sl);
+}
+
+static struct tlsf_block *find_suitable(struct z_tlsf *t, int *fl, int *sl)
+{
+	u32_t sl_map, fl_map;
+
+	if (*fl >= t->fl_count) {
+		return NULL;
+	}
+
+	sl_map = t->sl_bitmap[*fl] & (~0U << *sl);
+	if (sl_map == 0U) {
+		fl_map = t->fl_bitmap & (~0U << (*fl + 1));
+		if (fl_map == 0U) {
+			return NULL;
+		}
+
+		*fl = __builtin_ctz(fl_map);
+		sl_map = t->sl_bitmap[*fl];
+	}
+
+	*sl = __builtin_ctz(sl_map);
+
+	return *list_head(t, *fl, *sl);
+}
+
+static void free_list_remove(struct z_tlsf *t, struct tlsf_block *b,
+			     int fl, int sl)
+{
+	struct tlsf_block **head = list_head(t, fl, sl);
+
+	if (b->prev_free != NULL) {
+		b->prev_free->next_free = b->next_free;
+	} else {
+		*head = b->next_free;
+	}
+
+	if (b->next_free != NULL) {
+		b->next_free->prev_free = b->prev_free;
+	}
+
+	if (*head == NULL) {
+		t->sl_bitmap[fl] &= ~BIT(sl);
+		if (t->sl_bitmap[fl] == 0U) {
+			t->fl_bitmap &= ~BIT(fl);
+		}
+	}
+}
+
+static void free_list_insert(struct z_tlsf *t, struct tlsf_block *b)
+{
+	struct tlsf_block **head;
+	int fl, sl;
+
+	mapping_insert(block_size(b), &fl, &sl);
+	head = list_head(t, fl, sl);
+
+	b->prev_free = NULL;
+	b->next_free = *head;
+	if (*head != NULL) {
+		(*head)->prev_free = b;
+	}
+	*head = b;
+
+	t->sl_bitmap[fl] |= BIT(sl);
+	t->fl_bitmap |= BIT(fl);
+}
+
+static void block_remove(struct z_tlsf *t, struct tlsf_block *b)
+{
+	int fl, sl;
+
+	mapping_insert(block_size(b), &fl, &sl);
+	free_list_remove(t, b, fl, sl);
+}
+
+static void block_mark_free(struct tlsf_block *b)
+{
+	struct tlsf_block *next = block_next(b);
+
+	next->prev_phys = b;
+	next->size |= BLOCK_PREV_FREE;
+	b->size |= BLOCK_FREE;
+}
+
+static void block_mark_used(struct tlsf_block *b)
+{
+	struct tlsf_block *next = block_next(b);
+
+	next->size &= ~(size_t)BLOCK_PREV_FREE;
+	b->size &= ~(size_t)BLOCK_FREE;
+}
+
+/* Trims a (removed from its list) free block down to size, returning
+ * any usable remainder to the free lists
+ */
+static void block_trim(struct z_tlsf *t, struct tlsf_block *b, size_t size)
+{
+	struct tlsf_block *rest;
+
+	if (block_size(b) < size + BLOCK_OVERHEAD + BLOCK_SIZE_MIN) {
+		return;
+	}
+
+	rest = (struct tlsf_block *)((char *)block_to_ptr(b) +
+				     size - BLOCK_OVERHEAD);
+	rest->size = block_size(b) - size - BLOCK_OVERHEAD;
+	block_set_size(b, size);
+
+	block_mark_free(rest);
+	free_list_insert(t, rest);
+}
+
+void sys_tlsf_init(struct sys_tlsf *heap, void *mem, size_t bytes)
+{
+	uintptr_t start = ROUND_UP((uintptr_t)mem, ALIGN_SIZE);
+	uintptr_t end = ROUND_DOWN((uintptr_t)mem + bytes, ALIGN_SIZE);
+	struct z_tlsf *t = (struct z_tlsf *)start;
+	struct tlsf_block *b, *sentinel;
+	size_t lists, size;
+	int fl, sl;
+
+	mapping_insert(end - start, &fl, &sl);
+	__ASSERT(fl < FL_INDEX_MAX, "heap too large");
+
+	(void)memset(t, 0, sizeof(*t));
+	t->fl_count = fl + 1;
+
+	lists = t->fl_count * SL_INDEX_COUNT;
+	(void)memset(t->blocks, 0, lists * sizeof(t->blocks[0]));
+
+	/* One block spanning everything after the list heads, then the
+	 * sentinel's size word.  The first block has no physical
+	 * predecessor, so its prev_phys is never used and may overlap
+	 * the last list head.
+	 */
+	b = (struct tlsf_block *)ROUND_UP((uintptr_t)&t->blocks[lists] -
+					  sizeof(b->prev_phys), ALIGN_SIZE);
+	__ASSERT((uintptr_t)block_to_ptr(b) + BLOCK_SIZE_MIN +
+		 BLOCK_OVERHEAD <= end, "heap too small");
+
+	size = end - (uintptr_t)block_to_ptr(b) - BLOCK_OVERHEAD;
+	b->size = size;
+	t->first = b;
+	t->total_bytes = size;
+
+	sentinel = block_next(b);
+	sentinel->size = 0;
+
+	block_mark_free(b);
+	free_list_insert(t, b);
+
+	heap->tlsf = t;
+}
+
+void *sys_tlsf_alloc(struct sys_tlsf *heap, size_t bytes)
+{
+	struct z_tlsf *t = heap->tlsf;
+	struct tlsf_block *b;
+	size_t size;
+	int fl, sl;
+
+	if (bytes > t->total_bytes) {
+		return NULL;
+	}
+
+	size = MAX(ROUND_UP(bytes, ALIGN_SIZE), BLOCK_SIZE_MIN);
+	mapping_search(size, &fl, &sl);
+
+	b = find_suitable(t, &fl, &sl);
+	if (b == NULL) {
+		return NULL;
+	}
+
+	free_list_remove(t, b, fl, sl);
+	block_trim(t, b, size);
+	block_mark_used(b);
+
+	t->used_bytes += block_size(b) + BLOCK_OVERHEAD;
+	t->peak_used_bytes = MAX(t->peak_used_bytes, t->used_bytes);
+
+	return block_to_ptr(b);
+}
+
+void sys_tlsf_free(struct sys_tlsf *heap, void *mem)
+{
+	struct z_tlsf *t = heap->tlsf;
+	struct tlsf_block *b, *next;
+
+	if (mem == NULL) {
+		return;
+	}
+
+	b = ptr_to_block(mem);
+	__ASSERT(!block_is_free(b), "double free of %p", mem);
+
+	t->used_bytes -= block_size(b) + BLOCK_OVERHEAD;
+
+	if (block_prev_is_free(b)) {
+		struct tlsf_block *prev = b->prev_phys;
+
+		block_remove(t, prev);
+		block_set_size(prev, block_size(prev) + block_size(b) +
+			       BLOCK_OVERHEAD);
+		b = prev;
+	}
+
+	next = block_next(b);
+	if (block_is_free(next)) {
+		block_remove(t, next);
+		block_set_size(b, block_size(b) + block_size(next) +
+			       BLOCK_OVERHEAD);
+	}
+
+	block_mark_free(b);
+	free_list_insert(t, b);
+}
+
+void sys_tlsf_stats_get(struct sys_tlsf *heap, struct sys_tlsf_stats *stats)
+{
+	struct z_tlsf *t = heap->tlsf;
+
+	(void)memset(stats, 0, sizeof(*stats));
+	stats->total_bytes = t->total_bytes;
+	stats->used_bytes = t->used_bytes;
+	stats->peak_used_bytes = t->peak_used_bytes;
+
+	for (int i = 0; i < t->fl_count * SL_INDEX_COUNT; i++) {
+		for (struct tlsf_block *b = t->blocks[i]; b != NULL;
+		     b = b->next_free) {
+			stats->free_bytes += block_size(b);
+			stats->largest_free_bytes =
+				MAX(stats->largest_free_bytes, block_size(b));
+			stats->free_blocks++;
+		}
+	}
+}
+
+bool sys_tlsf_validate(struct sys_tlsf *heap)
+{
+	struct z_tlsf *t = heap->tlsf;
+	struct tlsf_block *b, *prev = NULL;
+	u32_t free_blocks = 0U;
+	size_t used = 0;
+
+	/* Physical order: tags agree, no two free neighbors */
+	for (b = t->first; block_size(b) != 0U; b = block_next(b)) {
+		if (block_prev_is_free(b) !=
+		    (prev != NULL && block_is_free(prev))) {
+			return false;
+		}
+		if (block_prev_is_free(b) && b->prev_phys != prev) {
+			return false;
+		}
+		if (block_is_free(b)) {
+			if (block_prev_is_free(b)) {
+				return false;
+			}
+			free_blocks++;
+		} else {
+			used += block_size(b) + BLOCK_OVERHEAD;
+		}
+		prev = b;
+	}
+
+	if (used != t->used_bytes ||
+	    block_prev_is_free(b) != (prev != NULL && block_is_free(prev))) {
+		return false;
+	}
+
+	/* Free lists: every block free and in the right list, bitmaps
+	 * matching list occupancy
+	 */
+	for (int fl = 0; fl < t->fl_count; fl++) {
+		for (int sl = 0; sl < SL_INDEX_COUNT; sl++) {
+			struct tlsf_block *head = *list_head(t, fl, sl);
+			bool bit = (t->sl_bitmap[fl] & BIT(sl)) != 0U;
+
+			if (bit != (head != NULL)) {
+				return false;
+			}
+
+			for (b = head; b != NULL; b = b->next_free) {
+				int bfl, bsl;
+
+				mapping_insert(block_size(b), &bfl, &bsl);
+				if (!block_is_free(b) || bfl != fl ||
+				    bsl != sl) {
+					return false;
+				}
+				if (b->next_free != NULL &&
+				    b->next_free->prev_free != b) {
+					return false;
+				}
+				free_blocks--;
+			}
+		}
+
+		if (((t->fl_bitmap & BIT(fl)) != 0U) !=
+		    (t->sl_bitmap[fl] != 0U)) {
+			return false;
+		}
+	}
+
+	return free_blocks == 0U;
+}
@@ -8,6 +8,28 @@
 #include <kernel.h>
 #define WORKQUEUE_THREAD_NAME	"workqueue"
 
+#ifdef CONFIG_WORKQUEUE_STATS
+static void update_stats(struct k_work_q *work_q, u32_t wait, u32_t run)
+{
+	k_spinlock_key_t key;
+
+#ifdef CONFIG_USERSPACE
+	/* User mode workqueue threads can't take the lock */
+	if (_is_user_context()) {
+		return;
+	}
+#endif
+
+	key = k_spin_lock(&work_q->stats_lock);
+	work_q->stats.processed++;
+	work_q->stats.wait_total += wait;
+	work_q->stats.wait_max = MAX(work_q->stats.wait_max, wait);
+	work_q->stats.run_total += run;
+	work_q->stats.run_max = MAX(work_q->stats.run_max, run);
+	k_spin_unlock(&work_q->stats_lock, key);
+}
+#endif
+
 void z_work_q_main(void *work_q_ptr, void *p2, void *p3)
 {
 	struct k_work_q *work_q = work_q_ptr;
@@ -26,10 +48,20 @@ void z_work_q_main(void *work_q_ptr, void *p2, void *p3)
 
 		handler = work->handler;
 
+#ifdef CONFIG_WORKQUEUE_STATS
+		/* Read before the item can be resubmitted */
+		u32_t submitted = work->submit_cycles;
+		u32_t start = k_cycle_get_32();
+#endif
+
 		/* Reset pending state so it can be resubmitted by handler */
 		if (atomic_test_and_clear_bit(work->flags,
 					      K_WORK_STATE_PENDING)) {
 			handler(work);
+#ifdef CONFIG_WORKQUEUE_STATS
+			update_stats(work_q, start - submitted,
+				     k_cycle_get_32() - start);
+#endif
 		}
 
 		/* Make sure we don't hog up the CPU if the FIFO never (or
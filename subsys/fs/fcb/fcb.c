@@ -163,6 +163,11 @@ fcb_init(int f_area_id, struct fcb *fcb)
 			break;
 		}
 	}
+#if defined(CONFIG_FCB_DIRECTORY)
+	if (rc == FCB_OK) {
+		fcb_dir_build(fcb);
+	}
+#endif /* CONFIG_FCB_DIRECTORY */
 	k_mutex_init(&fcb->f_mtx);
 	return rc;
 }
@@ -295,6 +300,19 @@ fcb_offset_last_n(struct fcb *fcb, u8_t entries,
 		entries = 1U;
 	}
 
+#if defined(CONFIG_FCB_DIRECTORY)
+	i = k_mutex_lock(&fcb->f_mtx, K_FOREVER);
+	if (i) {
+		return FCB_ERR_ARGS;
+	}
+	if (fcb->f_dir_valid) {
+		i = fcb_dir_last_n(fcb, entries, last_n_entry);
+		k_mutex_unlock(&fcb->f_mtx);
+		return i;
+	}
+	k_mutex_unlock(&fcb->f_mtx);
+#endif /* CONFIG_FCB_DIRECTORY */
+
 	i = 0;
 	(void)memset(&loc, 0, sizeof(loc));
 	while (!fcb_getnext(fcb, &loc)) {
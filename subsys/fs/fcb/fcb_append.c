@@ -131,5 +131,15 @@ fcb_append_finish(struct fcb *fcb, struct fcb_entry *loc)
 	if (rc) {
 		return FCB_ERR_FLASH;
 	}
+
+#if defined(CONFIG_FCB_DIRECTORY)
+	rc = k_mutex_lock(&fcb->f_mtx, K_FOREVER);
+	if (rc) {
+		return FCB_ERR_ARGS;
+	}
+	fcb_dir_append(fcb, loc);
+	k_mutex_unlock(&fcb->f_mtx);
+#endif /* CONFIG_FCB_DIRECTORY */
+
 	return 0;
 }
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2019 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stddef.h>
+#include <errno.h>
+
+#include <fs/fcb.h>
+#include "fcb_priv.h"
+
+static struct fcb_dir_entry *
+fcb_dir_entry(struct fcb *fcb, u16_t i)
+{
+	return &fcb->f_dir[(fcb->f_dir_head + i) % CONFIG_FCB_DIRECTORY_SIZE];
+}
+
+/*
+ * Position of the sector from the oldest one, elements are in the order of
+ * their sector position and offset.
+ */
+static int
+fcb_dir_sector_pos(struct fcb *fcb, int idx)
+{
+	int oldest = fcb->f_oldest - fcb->f_sectors;
+
+	return (idx - oldest + fcb->f_sector_cnt) % fcb->f_sector_cnt;
+}
+
+static void
+fcb_dir_entry_loc(struct fcb *fcb, struct fcb_dir_entry *fde,
+		  struct fcb_entry *loc)
+{
+	/* Length of the element length field */
+	int cnt = fde->fde_data_len < 0x80 ? 1 : 2;
+
+	loc->fe_sector = &fcb->f_sectors[fde->fde_sector];
+	loc->fe_elem_off = fde->fde_elem_off;
+	loc->fe_data_off = fde->fde_elem_off + fcb_len_in_flash(fcb, cnt);
+	loc->fe_data_len = fde->fde_data_len;
+}
+
+void
+fcb_dir_build(struct fcb *fcb)
+{
+	struct fcb_entry loc;
+	int rc;
+
+	fcb->f_dir_valid = false;
+	fcb->f_dir_head = 0U;
+	fcb->f_dir_cnt = 0U;
+
+	loc.fe_sector = NULL;
+	loc.fe_elem_off = 0U;
+	while ((rc = fcb_getnext_nolock(fcb, &loc)) == 0) {
+		if (fcb->f_dir_cnt == CONFIG_FCB_DIRECTORY_SIZE) {
+			return;
+		}
+		fcb->f_dir[fcb->f_dir_cnt].fde_sector =
+			loc.fe_sector - fcb->f_sectors;
+		fcb->f_dir[fcb->f_dir_cnt].fde_elem_off = loc.fe_elem_off;
+		fcb->f_dir[fcb->f_dir_cnt].fde_data_len = loc.fe_data_len;
+		fcb->f_dir_cnt++;
+	}
+
+	fcb->f_dir_valid = (rc == FCB_ERR_NOVAR);
+}
+
+void
+fcb_dir_append(struct fcb *fcb, struct fcb_entry *loc)
+{
+	struct fcb_dir_entry *fde;
+	int idx, pos, fde_pos;
+
+	if (!fcb->f_dir_valid) {
+		return;
+	}
+
+	idx = loc->fe_sector - fcb->f_sectors;
+
+	if (fcb->f_dir_cnt) {
+		/* Appends finished out of order are found in flash */
+		fde = fcb_dir_entry(fcb, fcb->f_dir_cnt - 1);
+		pos = fcb_dir_sector_pos(fcb, idx);
+		fde_pos = fcb_dir_sector_pos(fcb, fde->fde_sector);
+		if ((pos < fde_pos) ||
+		    ((pos == fde_pos) &&
+		     (loc->fe_elem_off <= fde->fde_elem_off))) {
+			fcb->f_dir_valid = false;
+			return;
+		}
+	}
+
+	if (fcb->f_dir_cnt == CONFIG_FCB_DIRECTORY_SIZE) {
+		fcb->f_dir_valid = false;
+		return;
+	}
+
+	fde = fcb_dir_entry(fcb, fcb->f_dir_cnt);
+	fde->fde_sector = idx;
+	fde->fde_elem_off = loc->fe_elem_off;
+	fde->fde_data_len = loc->fe_data_len;
+	fcb->f_dir_cnt++;
+}
+
+/*
+ * Drop the elements of a sector that was erased, it is the oldest one.
+ */
+void
+fcb_dir_erase(struct fcb *fcb, struct flash_sector *sector)
+{
+	int idx = sector - fcb->f_sectors;
+
+	while (fcb->f_dir_cnt &&
+	       (fcb_dir_entry(fcb, 0)->fde_sector == idx)) {
+		fcb->f_dir_head = (fcb->f_dir_head + 1) %
+				  CONFIG_FCB_DIRECTORY_SIZE;
+		fcb->f_dir_cnt--;
+	}
+}
+
+int
+fcb_dir_getnext(struct fcb *fcb, struct fcb_entry *loc)
+{
+	struct fcb_dir_entry *fde;
+	u16_t lo, hi, mid;
+	int pos, fde_pos;
+
+	lo = 0U;
+	hi = fcb->f_dir_cnt;
+
+	if (loc->fe_sector) {
+		/* First element after loc, or the first one of the sector */
+		pos = fcb_dir_sector_pos(fcb, loc->fe_sector - fcb->f_sectors);
+		while (lo < hi) {
+			mid = (lo + hi) / 2U;
+			fde = fcb_dir_entry(fcb, mid);
+			fde_pos = fcb_dir_sector_pos(fcb, fde->fde_sector);
+			if ((fde_pos < pos) ||
+			    ((fde_pos == pos) &&
+			     (fde->fde_elem_off <= loc->fe_elem_off))) {
+				lo = mid + 1U;
+			} else {
+				hi = mid;
+			}
+		}
+	}
+
+	if (lo == fcb->f_dir_cnt) {
+		return FCB_ERR_NOVAR;
+	}
+
+	fcb_dir_entry_loc(fcb, fcb_dir_entry(fcb, lo), loc);
+	return 0;
+}
+
+int
+fcb_dir_last_n(struct fcb *fcb, u8_t entries, struct fcb_entry *last_n_entry)
+{
+	if (!fcb->f_dir_cnt) {
+		return -ENOENT;
+	}
+
+	entries = MIN(entries, fcb->f_dir_cnt);
+	fcb_dir_entry_loc(fcb, fcb_dir_entry(fcb, fcb->f_dir_cnt - entries),
+			  last_n_entry);
+	return 0;
+}
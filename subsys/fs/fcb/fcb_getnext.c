@@ -45,6 +45,12 @@ fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc)
 {
 	int rc;
 
+#if defined(CONFIG_FCB_DIRECTORY)
+	if (fcb->f_dir_valid) {
+		return fcb_dir_getnext(fcb, loc);
+	}
+#endif /* CONFIG_FCB_DIRECTORY */
+
 	if (loc->fe_sector == NULL) {
 		/*
 		 * Find the first one we have in flash.
@@ -51,6 +51,15 @@ int fcb_sector_hdr_init(struct fcb *fcb, struct flash_sector *sector, u16_t id);
 int fcb_sector_hdr_read(struct fcb *fcb, struct flash_sector *sector,
 			struct fcb_disk_area *fdap);
 
+#if defined(CONFIG_FCB_DIRECTORY)
+void fcb_dir_build(struct fcb *fcb);
+void fcb_dir_append(struct fcb *fcb, struct fcb_entry *loc);
+void fcb_dir_erase(struct fcb *fcb, struct flash_sector *sector);
+int fcb_dir_getnext(struct fcb *fcb, struct fcb_entry *loc);
+int fcb_dir_last_n(struct fcb *fcb, u8_t entries,
+		   struct fcb_entry *last_n_entry);
+#endif /* CONFIG_FCB_DIRECTORY */
+
 #ifdef __cplusplus
 }
 #endif
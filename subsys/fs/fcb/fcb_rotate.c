@@ -24,6 +24,9 @@ fcb_rotate(struct fcb *fcb)
 		rc = FCB_ERR_FLASH;
 		goto out;
 	}
+#if defined(CONFIG_FCB_DIRECTORY)
+	fcb_dir_erase(fcb, fcb->f_oldest);
+#endif /* CONFIG_FCB_DIRECTORY */
 	if (fcb->f_oldest == fcb->f_active.fe_sector) {
 		/*
 		 * Need to create a new active area, as we're wiping
@@ -39,6 +42,12 @@ fcb_rotate(struct fcb *fcb)
 		fcb->f_active_id++;
 	}
 	fcb->f_oldest = fcb_getnext_sector(fcb, fcb->f_oldest);
+#if defined(CONFIG_FCB_DIRECTORY)
+	if (!fcb->f_dir_valid) {
+		/* The elements left may fit now */
+		fcb_dir_build(fcb);
+	}
+#endif /* CONFIG_FCB_DIRECTORY */
 out:
 	k_mutex_unlock(&fcb->f_mtx);
 	return rc;
@@ -28,6 +28,153 @@ static inline size_t nvs_al_size(struct nvs_fs *fs, size_t len)
 }
 /* end basic routines */
 
+#if defined(CONFIG_NVS_LOOKUP_CACHE)
+/* lookup cache routines */
+/* The cache is a hash table with linear probing that maps ids to the address
+ * of their most recent ate. When it ran out of entries or is not built yet
+ * (lookup_full) an id that is not in it has to be looked for in flash,
+ * otherwise it was never written or was removed by gc.
+ */
+static inline size_t nvs_lookup_cache_pos(u16_t id)
+{
+	/* spread consecutive ids over the cache */
+	return ((id * 0x9E3779B1U) >> 16) % CONFIG_NVS_LOOKUP_CACHE_SIZE;
+}
+
+/* nvs_lookup_cache_find returns the position of the id in the cache, or of
+ * the empty entry where it would go, -1 if neither was found.
+ */
+static int nvs_lookup_cache_find(struct nvs_fs *fs, u16_t id)
+{
+	size_t pos = nvs_lookup_cache_pos(id);
+
+	for (int i = 0; i < CONFIG_NVS_LOOKUP_CACHE_SIZE; i++) {
+		if ((fs->lookup_addr[pos] == NVS_LOOKUP_CACHE_NO_ADDR) ||
+		    (fs->lookup_id[pos] == id)) {
+			return pos;
+		}
+		pos = (pos + 1) % CONFIG_NVS_LOOKUP_CACHE_SIZE;
+	}
+	return -1;
+}
+
+/* nvs_lookup_cache_start returns the address to start looking for the most
+ * recent ate of an id, NVS_LOOKUP_CACHE_NO_ADDR if the id is not in flash.
+ */
+static u32_t nvs_lookup_cache_start(struct nvs_fs *fs, u16_t id)
+{
+	int pos = nvs_lookup_cache_find(fs, id);
+
+	if ((pos >= 0) && (fs->lookup_addr[pos] != NVS_LOOKUP_CACHE_NO_ADDR)) {
+		return fs->lookup_addr[pos];
+	}
+	if (fs->lookup_full) {
+		return fs->ate_wra;
+	}
+	return NVS_LOOKUP_CACHE_NO_ADDR;
+}
+
+/* store the address of an ate, when only_new is set keep the address that
+ * is already there
+ */
+static void nvs_lookup_cache_set(struct nvs_fs *fs, u16_t id, u32_t addr,
+				 bool only_new)
+{
+	int pos;
+
+	/* id 0xFFFF is used by the sector close ate */
+	if (id == 0xFFFF) {
+		return;
+	}
+
+	pos = nvs_lookup_cache_find(fs, id);
+	if (pos < 0) {
+		fs->lookup_full = true;
+		return;
+	}
+	if (only_new && (fs->lookup_addr[pos] != NVS_LOOKUP_CACHE_NO_ADDR)) {
+		return;
+	}
+	fs->lookup_id[pos] = id;
+	fs->lookup_addr[pos] = addr;
+}
+
+static inline void nvs_lookup_cache_update(struct nvs_fs *fs, u16_t id,
+					   u32_t addr)
+{
+	nvs_lookup_cache_set(fs, id, addr, false);
+}
+
+/* remove the entry at pos, moving back the entries of the same probe
+ * sequence that follow it
+ */
+static void nvs_lookup_cache_remove(struct nvs_fs *fs, size_t pos)
+{
+	size_t next = pos;
+	size_t home;
+
+	while (1) {
+		fs->lookup_addr[pos] = NVS_LOOKUP_CACHE_NO_ADDR;
+		do {
+			next = (next + 1) % CONFIG_NVS_LOOKUP_CACHE_SIZE;
+			if (fs->lookup_addr[next] == NVS_LOOKUP_CACHE_NO_ADDR) {
+				return;
+			}
+			home = nvs_lookup_cache_pos(fs->lookup_id[next]);
+		} while ((pos <= next) ? ((pos < home) && (home <= next)) :
+					 ((pos < home) || (home <= next)));
+		fs->lookup_id[pos] = fs->lookup_id[next];
+		fs->lookup_addr[pos] = fs->lookup_addr[next];
+		pos = next;
+	}
+}
+
+/* drop the ids whose most recent ate was in a sector that has been erased,
+ * these were deleted and gc did not copy them.
+ */
+static void nvs_lookup_cache_invalidate(struct nvs_fs *fs, u32_t addr)
+{
+	size_t pos = 0;
+
+	while (pos < CONFIG_NVS_LOOKUP_CACHE_SIZE) {
+		if ((fs->lookup_addr[pos] != NVS_LOOKUP_CACHE_NO_ADDR) &&
+		    ((fs->lookup_addr[pos] & ADDR_SECT_MASK) ==
+		     (addr & ADDR_SECT_MASK))) {
+			/* another entry may have moved here */
+			nvs_lookup_cache_remove(fs, pos);
+			continue;
+		}
+		pos++;
+	}
+}
+
+/* empty the lookup cache, until it is rebuilt it does not hold all ids */
+static inline void nvs_lookup_cache_clear(struct nvs_fs *fs)
+{
+	(void)memset(fs->lookup_addr, 0xff, sizeof(fs->lookup_addr));
+	fs->lookup_full = true;
+}
+/* end lookup cache routines */
+#else
+static inline u32_t nvs_lookup_cache_start(struct nvs_fs *fs, u16_t id)
+{
+	return fs->ate_wra;
+}
+
+static inline void nvs_lookup_cache_update(struct nvs_fs *fs, u16_t id,
+					   u32_t addr)
+{
+}
+
+static inline void nvs_lookup_cache_invalidate(struct nvs_fs *fs, u32_t addr)
+{
+}
+
+static inline void nvs_lookup_cache_clear(struct nvs_fs *fs)
+{
+}
+#endif /* CONFIG_NVS_LOOKUP_CACHE */
+
 /* flash routines */
 /* basic aligned flash write to nvs address */
 static int nvs_flash_al_wrt(struct nvs_fs *fs, u32_t addr, const void *data,
@@ -103,11 +250,42 @@ static int nvs_flash_ate_wrt(struct nvs_fs *fs, const struct nvs_ate *entry)
 
 	rc = nvs_flash_al_wrt(fs, fs->ate_wra, entry,
 			       sizeof(struct nvs_ate));
+	if (!rc) {
+		nvs_lookup_cache_update(fs, entry->id, fs->ate_wra);
+	}
 	fs->ate_wra -= nvs_al_size(fs, sizeof(struct nvs_ate));
 
 	return rc;
 }
 
+#if defined(CONFIG_NVS_GC_BATCH)
+/* write cnt allocation entries at once, buf holds them aligned and from the
+ * last written to the first written one.
+ */
+static int nvs_flash_ates_wrt(struct nvs_fs *fs, const u8_t *buf, size_t cnt)
+{
+	int rc;
+	const struct nvs_ate *entry;
+	size_t ate_size, i;
+	u32_t addr;
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+	addr = fs->ate_wra - (cnt - 1) * ate_size;
+
+	rc = nvs_flash_al_wrt(fs, addr, buf, cnt * ate_size);
+	if (!rc) {
+		for (i = 0; i < cnt; i++) {
+			entry = (const struct nvs_ate *)(buf + i * ate_size);
+			nvs_lookup_cache_update(fs, entry->id,
+						addr + i * ate_size);
+		}
+	}
+	fs->ate_wra -= cnt * ate_size;
+
+	return rc;
+}
+#endif
+
 /* data write */
 static int nvs_flash_data_wrt(struct nvs_fs *fs, const void *data, size_t len)
 {
@@ -243,6 +421,9 @@ static int nvs_flash_erase_sector(struct nvs_fs *fs, u32_t addr)
 		return rc;
 	}
 	(void) flash_write_protection_set(fs->flash_device, 1);
+
+	nvs_lookup_cache_invalidate(fs, addr);
+
 	return 0;
 }
 
@@ -397,6 +578,40 @@ static int nvs_prev_ate(struct nvs_fs *fs, u32_t *addr, struct nvs_ate *ate)
 	return 0;
 }
 
+#if defined(CONFIG_NVS_LOOKUP_CACHE)
+/* fill the lookup cache by walking through all ate's from newest to oldest */
+static int nvs_lookup_cache_rebuild(struct nvs_fs *fs)
+{
+	int rc;
+	struct nvs_ate ate;
+	u32_t addr, ate_addr;
+
+	nvs_lookup_cache_clear(fs);
+	fs->lookup_full = false;
+
+	addr = fs->ate_wra;
+
+	while (1) {
+		ate_addr = addr;
+		rc = nvs_prev_ate(fs, &addr, &ate);
+		if (rc) {
+			return rc;
+		}
+
+		/* the first ate found for an id is its most recent one */
+		if (!nvs_ate_crc8_check(&ate)) {
+			nvs_lookup_cache_set(fs, ate.id, ate_addr, true);
+		}
+
+		if (addr == fs->ate_wra) {
+			break;
+		}
+	}
+
+	return 0;
+}
+#endif
+
 static void nvs_sector_advance(struct nvs_fs *fs, u32_t *addr)
 {
 	*addr += (1 << ADDR_SECT_SHIFT);
@@ -435,52 +650,254 @@ static int nvs_sector_close(struct nvs_fs *fs)
 }
 
 
-/* garbage collection: the address ate_wra has been updated to the new sector
- * that has just been started. The data to gc is in the sector after this new
- * sector.
+#if defined(CONFIG_NVS_GC_BATCH)
+/* index of the batch entry with id, or where it is to be inserted */
+static size_t nvs_gc_batch_find(struct nvs_fs *fs, size_t cnt, u16_t id)
+{
+	size_t lo = 0, hi = cnt, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2U;
+		if (fs->gc_entry[mid].id < id) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+/* read a batch of entries starting at gc_addr into fs->gc_entry, sorted by
+ * id. Only the most recent valid entry of each id is kept, older ones are
+ * not in use. last is set when the batch ends with stop_addr.
  */
-static int nvs_gc(struct nvs_fs *fs)
+static int nvs_gc_batch_read(struct nvs_fs *fs, u32_t *gc_addr,
+			     u32_t stop_addr, size_t *cnt, bool *last)
 {
 	int rc;
-	struct nvs_ate close_ate, gc_ate, wlk_ate;
-	u32_t sec_addr, gc_addr, gc_prev_addr, wlk_addr, wlk_prev_addr,
-	      data_addr, stop_addr;
-	size_t ate_size;
+	struct nvs_ate gc_ate;
+	struct nvs_gc_entry *entry;
+	u32_t gc_prev_addr;
+	size_t i;
+
+	*cnt = 0;
+	*last = false;
+
+	while (*cnt < CONFIG_NVS_GC_BATCH_SIZE) {
+		gc_prev_addr = *gc_addr;
+		rc = nvs_prev_ate(fs, gc_addr, &gc_ate);
+		if (rc) {
+			return rc;
+		}
+
+		i = nvs_gc_batch_find(fs, *cnt, gc_ate.id);
+		if (!nvs_ate_crc8_check(&gc_ate) &&
+		    ((i == *cnt) || (fs->gc_entry[i].id != gc_ate.id))) {
+			entry = &fs->gc_entry[i];
+			memmove(entry + 1, entry, (*cnt - i) * sizeof(*entry));
+			entry->id = gc_ate.id;
+			entry->offset = gc_ate.offset;
+			entry->len = gc_ate.len;
+			entry->ate_offset =
+				(u16_t)(gc_prev_addr & ADDR_OFFS_MASK);
+			(*cnt)++;
+		}
+
+		if (gc_prev_addr == stop_addr) {
+			*last = true;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/* drop the batch entries that have a more recent entry. The lookup cache
+ * knows the most recent entry of the ids it holds, for the other ids this is
+ * found by a single walk from the newest entry back to batch_addr, the first
+ * entry of the batch.
+ */
+static int nvs_gc_batch_mark(struct nvs_fs *fs, size_t cnt, u32_t batch_addr)
+{
+	int rc;
+	struct nvs_ate wlk_ate;
+	struct nvs_gc_entry *entry;
+	u32_t wlk_addr;
+	size_t i, wlk_cnt = 0;
+
+	for (i = 0; i < cnt; i++) {
+		entry = &fs->gc_entry[i];
+		if (!entry->len) {
+			continue;
+		}
+
+		wlk_addr = nvs_lookup_cache_start(fs, entry->id);
+		if (wlk_addr == fs->ate_wra) {
+			wlk_cnt++;
+		} else if (wlk_addr != ((batch_addr & ADDR_SECT_MASK) +
+					entry->ate_offset)) {
+			entry->len = 0U;
+		}
+	}
+
+	/* stop the walk when no entry is left to drop */
+	wlk_addr = fs->ate_wra;
+	while (wlk_cnt && (wlk_addr != batch_addr)) {
+		rc = nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
+		if (rc) {
+			return rc;
+		}
+		if (!nvs_ate_crc8_check(&wlk_ate)) {
+			i = nvs_gc_batch_find(fs, cnt, wlk_ate.id);
+			entry = &fs->gc_entry[i];
+			if ((i < cnt) && (entry->id == wlk_ate.id) &&
+			    entry->len) {
+				entry->len = 0U;
+				wlk_cnt--;
+			}
+		}
+		if (wlk_addr == fs->ate_wra) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/* copy the data of the batch entries in use, followed by their allocation
+ * table entries. The allocation table entries are written as many at once
+ * as fit in a block.
+ */
+static int nvs_gc_batch_copy(struct nvs_fs *fs, size_t cnt, u32_t sec_addr)
+{
+	int rc;
+	struct nvs_ate gc_ate;
+	struct nvs_gc_entry *entry;
+	u8_t buf[NVS_BLOCK_SIZE];
+	u32_t data_addr;
+	size_t ate_size, ate_max, ate_cnt, i;
+
+	for (i = 0; i < cnt; i++) {
+		entry = &fs->gc_entry[i];
+		if (!entry->len) {
+			continue;
+		}
+
+		LOG_DBG("Moving %d, len %d", entry->id, entry->len);
+
+		data_addr = sec_addr + entry->offset;
+		entry->offset = (u16_t)(fs->data_wra & ADDR_OFFS_MASK);
+
+		rc = nvs_flash_block_move(fs, data_addr, entry->len);
+		if (rc) {
+			return rc;
+		}
+	}
 
 	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+	ate_max = sizeof(buf) / ate_size;
+	ate_cnt = 0;
+	(void)memset(buf, 0xff, sizeof(buf));
+
+	for (i = 0; i < cnt; i++) {
+		entry = &fs->gc_entry[i];
+		if (!entry->len) {
+			continue;
+		}
 
-	sec_addr = (fs->ate_wra & ADDR_SECT_MASK);
-	nvs_sector_advance(fs, &sec_addr);
-	gc_addr = sec_addr + fs->sector_size - ate_size;
+		gc_ate.id = entry->id;
+		gc_ate.offset = entry->offset;
+		gc_ate.len = entry->len;
+		gc_ate.part = 0xff;
+		nvs_ate_crc8_update(&gc_ate);
 
-	/* if the sector is not closed don't do gc */
-	rc = nvs_flash_ate_rd(fs, gc_addr, &close_ate);
-	if (rc < 0) {
-		/* flash error */
-		return rc;
+		/* entries are written from the end of the buffer backwards,
+		 * as the allocation table grows downwards.
+		 */
+		ate_cnt++;
+		memcpy(buf + (ate_max - ate_cnt) * ate_size, &gc_ate,
+		       sizeof(gc_ate));
+
+		if (ate_cnt == ate_max) {
+			rc = nvs_flash_ates_wrt(fs, buf, ate_cnt);
+			if (rc) {
+				return rc;
+			}
+			ate_cnt = 0;
+		}
 	}
 
-	rc = nvs_ate_cmp_const(&close_ate, 0xff);
-	if (!rc) {
-		rc = nvs_flash_erase_sector(fs, sec_addr);
+	if (ate_cnt) {
+		rc = nvs_flash_ates_wrt(fs,
+					buf + (ate_max - ate_cnt) * ate_size,
+					ate_cnt);
 		if (rc) {
 			return rc;
 		}
-		return 0;
 	}
 
-	stop_addr = gc_addr - ate_size;
+	return 0;
+}
 
-	gc_addr &= ADDR_SECT_MASK;
-	gc_addr += close_ate.offset;
+/* garbage collect the entries from gc_addr to stop_addr in batches */
+static int nvs_gc_batches(struct nvs_fs *fs, u32_t gc_addr, u32_t stop_addr)
+{
+	int rc;
+	u32_t batch_addr;
+	size_t cnt;
+	bool last;
 
-	while (1) {
+	do {
+		batch_addr = gc_addr;
+
+		rc = nvs_gc_batch_read(fs, &gc_addr, stop_addr, &cnt, &last);
+		if (rc) {
+			return rc;
+		}
+
+		rc = nvs_gc_batch_mark(fs, cnt, batch_addr);
+		if (rc) {
+			return rc;
+		}
+
+		rc = nvs_gc_batch_copy(fs, cnt, stop_addr & ADDR_SECT_MASK);
+		if (rc) {
+			return rc;
+		}
+	} while (!last);
+
+	return 0;
+}
+#else
+/* garbage collect the entries from gc_addr to stop_addr one at a time: walk
+ * for each entry from the newest entry back to find out if it is the most
+ * recent one for its id, if so copy it.
+ */
+static int nvs_gc_entries(struct nvs_fs *fs, u32_t gc_addr, u32_t stop_addr)
+{
+	int rc;
+	struct nvs_ate gc_ate, wlk_ate;
+	u32_t gc_prev_addr, wlk_addr, wlk_prev_addr, data_addr;
+
+	do {
 		gc_prev_addr = gc_addr;
 		rc = nvs_prev_ate(fs, &gc_addr, &gc_ate);
 		if (rc) {
 			return rc;
 		}
-		wlk_addr = fs->ate_wra;
+
+		/* an invalid entry is never copied, and there might be no
+		 * valid entry with the same id to end the walk.
+		 */
+		if (nvs_ate_crc8_check(&gc_ate)) {
+			continue;
+		}
+
+		wlk_addr = nvs_lookup_cache_start(fs, gc_ate.id);
+		if (wlk_addr == NVS_LOOKUP_CACHE_NO_ADDR) {
+			wlk_addr = fs->ate_wra;
+		}
 		while (1) {
 			wlk_prev_addr = wlk_addr;
 			rc = nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
@@ -522,15 +939,84 @@ static int nvs_gc(struct nvs_fs *fs)
 		}
 
 		/* stop gc at end of the sector */
-		if (gc_prev_addr == stop_addr) {
-			break;
+	} while (gc_prev_addr != stop_addr);
+
+	return 0;
+}
+#endif /* CONFIG_NVS_GC_BATCH */
+
+/* garbage collection: the address ate_wra has been updated to the new sector
+ * that has just been started. The data to gc is in the sector after this new
+ * sector.
+ */
+static int nvs_gc(struct nvs_fs *fs)
+{
+	int rc;
+	struct nvs_ate close_ate;
+	u32_t sec_addr, gc_addr, stop_addr;
+	size_t ate_size;
+#if defined(CONFIG_NVS_GC_STATS)
+	u32_t start_time, ate_wra, data_wra, duration, copied;
+
+	start_time = k_uptime_get_32();
+	ate_wra = fs->ate_wra;
+	data_wra = fs->data_wra;
+#endif
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+
+	sec_addr = (fs->ate_wra & ADDR_SECT_MASK);
+	nvs_sector_advance(fs, &sec_addr);
+	gc_addr = sec_addr + fs->sector_size - ate_size;
+
+	/* if the sector is not closed don't do gc */
+	rc = nvs_flash_ate_rd(fs, gc_addr, &close_ate);
+	if (rc < 0) {
+		/* flash error */
+		return rc;
+	}
+
+	rc = nvs_ate_cmp_const(&close_ate, 0xff);
+	if (!rc) {
+		rc = nvs_flash_erase_sector(fs, sec_addr);
+		if (rc) {
+			return rc;
 		}
+		return 0;
+	}
+
+	stop_addr = gc_addr - ate_size;
+
+	gc_addr &= ADDR_SECT_MASK;
+	gc_addr += close_ate.offset;
+
+#if defined(CONFIG_NVS_GC_BATCH)
+	rc = nvs_gc_batches(fs, gc_addr, stop_addr);
+#else
+	rc = nvs_gc_entries(fs, gc_addr, stop_addr);
+#endif
+	if (rc) {
+		return rc;
 	}
 
 	rc = nvs_flash_erase_sector(fs, sec_addr);
 	if (rc) {
 		return rc;
 	}
+
+#if defined(CONFIG_NVS_GC_STATS)
+	duration = k_uptime_get_32() - start_time;
+	copied = (fs->data_wra - data_wra) + (ate_wra - fs->ate_wra);
+
+	fs->gc_count++;
+	fs->gc_copied += copied;
+	fs->gc_time += duration;
+	fs->gc_time_max = MAX(fs->gc_time_max, duration);
+
+	LOG_DBG("Garbage collected sector %d: %d bytes copied in %d ms",
+		sec_addr >> ADDR_SECT_SHIFT, copied, duration);
+#endif
+
 	return 0;
 }
 
@@ -548,6 +1034,9 @@ static int nvs_startup(struct nvs_fs *fs)
 
 	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
 
+	/* an interrupted gc below has to walk all ate's */
+	nvs_lookup_cache_clear(fs);
+
 	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
 	/* step through the sectors to find a open sector following
 	 * a closed sector, this is where NVS can to write.
@@ -663,6 +1152,10 @@ static int nvs_startup(struct nvs_fs *fs)
 		}
 	}
 
+#if defined(CONFIG_NVS_LOOKUP_CACHE)
+	rc = nvs_lookup_cache_rebuild(fs);
+#endif
+
 end:
 	k_mutex_unlock(&fs->nvs_lock);
 	return rc;
@@ -696,6 +1189,13 @@ int nvs_init(struct nvs_fs *fs, const char *dev_name)
 
 	k_mutex_init(&fs->nvs_lock);
 
+#if defined(CONFIG_NVS_GC_STATS)
+	fs->gc_count = 0U;
+	fs->gc_copied = 0U;
+	fs->gc_time = 0U;
+	fs->gc_time_max = 0U;
+#endif
+
 	fs->flash_device = device_get_binding(dev_name);
 	if (!fs->flash_device) {
 		LOG_ERR("No valid flash device found");
@@ -753,6 +1253,7 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 	struct nvs_ate wlk_ate;
 	u32_t wlk_addr, rd_addr;
 	u16_t required_space = 0U; /* no space, appropriate for delete ate */
+	bool prev_found = false;
 
 	if (!fs->ready) {
 		LOG_ERR("NVS not initialized");
@@ -772,16 +1273,17 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 	}
 
 	/* find latest entry with same id */
-	wlk_addr = fs->ate_wra;
+	wlk_addr = nvs_lookup_cache_start(fs, id);
 	rd_addr = wlk_addr;
 
-	while (1) {
+	while (wlk_addr != NVS_LOOKUP_CACHE_NO_ADDR) {
 		rd_addr = wlk_addr;
 		rc = nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
 		if (rc) {
 			return rc;
 		}
 		if ((wlk_ate.id == id) && (!nvs_ate_crc8_check(&wlk_ate))) {
+			prev_found = true;
 			break;
 		}
 		if (wlk_addr == fs->ate_wra) {
@@ -789,7 +1291,7 @@ ssize_t nvs_write(struct nvs_fs *fs, u16_t id, const void *data, size_t len)
 		}
 	}
 
-	if (wlk_addr != fs->ate_wra) {
+	if (prev_found) {
 		/* previous entry found */
 		rd_addr &= ADDR_SECT_MASK;
 		rd_addr += wlk_ate.offset;
@@ -888,7 +1390,10 @@ ssize_t nvs_read_hist(struct nvs_fs *fs, u16_t id, void *data, size_t len,
 
 	cnt_his = 0U;
 
-	wlk_addr = fs->ate_wra;
+	wlk_addr = nvs_lookup_cache_start(fs, id);
+	if (wlk_addr == NVS_LOOKUP_CACHE_NO_ADDR) {
+		return -ENOENT;
+	}
 	rd_addr = wlk_addr;
 
 	while (cnt_his <= cnt) {
@@ -931,6 +1436,75 @@ ssize_t nvs_read(struct nvs_fs *fs, u16_t id, void *data, size_t len)
 	return rc;
 }
 
+int nvs_walk(struct nvs_fs *fs, nvs_walk_cb_t cb, void *arg)
+{
+	int rc;
+	u32_t wlk_addr, rd_addr;
+	struct nvs_ate wlk_ate;
+
+	if (!fs->ready) {
+		LOG_ERR("NVS not initialized");
+		return -EACCES;
+	}
+
+	wlk_addr = fs->ate_wra;
+
+	do {
+		rd_addr = wlk_addr;
+		rc = nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
+		if (rc) {
+			return rc;
+		}
+		if (!nvs_ate_crc8_check(&wlk_ate)) {
+			rc = cb(wlk_ate.id, rd_addr, wlk_ate.len, arg);
+			if (rc) {
+				return rc;
+			}
+		}
+	} while (wlk_addr != fs->ate_wra);
+
+	return 0;
+}
+
+ssize_t nvs_read_addr(struct nvs_fs *fs, u16_t id, u32_t addr, void *data,
+		      size_t len)
+{
+	int rc;
+	struct nvs_ate ate;
+	size_t ate_size;
+
+	if (!fs->ready) {
+		LOG_ERR("NVS not initialized");
+		return -EACCES;
+	}
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+
+	if ((len > (fs->sector_size - 2 * ate_size)) ||
+	    ((addr >> ADDR_SECT_SHIFT) >= fs->sector_count) ||
+	    ((addr & ADDR_OFFS_MASK) > (fs->sector_size - ate_size))) {
+		return -EINVAL;
+	}
+
+	rc = nvs_flash_ate_rd(fs, addr, &ate);
+	if (rc) {
+		return rc;
+	}
+
+	if (nvs_ate_crc8_check(&ate) || (ate.id != id) || (ate.len == 0U)) {
+		return -ENOENT;
+	}
+
+	addr &= ADDR_SECT_MASK;
+	addr += ate.offset;
+	rc = nvs_flash_rd(fs, addr, data, MIN(len, ate.len));
+	if (rc) {
+		return rc;
+	}
+
+	return ate.len;
+}
+
 ssize_t nvs_calc_free_space(struct nvs_fs *fs)
 {
 
@@ -51,10 +51,110 @@ LOG_MODULE_REGISTER(net_conn, CONFIG_NET_CONN_LOG_LEVEL);
 
 #define NET_CONN_RANK(_flags)		(_flags & 0x78)
 
+/** Flags of the connections kept in the conn_exact table */
+#define NET_CONN_EXACT_SPEC		(NET_CONN_REMOTE_ADDR_SPEC | \
+					 NET_CONN_REMOTE_PORT_SPEC | \
+					 NET_CONN_LOCAL_PORT_SPEC)
+
 static struct net_conn conns[CONFIG_NET_MAX_CONN];
 
 static sys_slist_t conn_unused;
-static sys_slist_t conn_used;
+
+/* Connections in use are kept in one of three places, so that
+ * net_conn_input() only needs to look at the handlers that can
+ * possibly match a packet:
+ *
+ * - conn_exact, hashed on protocol, remote address, remote port and
+ *   local port, holds the handlers that specify all of those (e.g.
+ *   connected TCP and UDP sockets). At most one of these can match a
+ *   packet and none of the other handlers outranks it.
+ * - conn_port, hashed on protocol and local port, holds the remaining
+ *   handlers bound to a local port (e.g. listening sockets).
+ * - conn_wildcard holds the handlers without a local port.
+ */
+static sys_slist_t conn_exact[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_port[CONFIG_NET_CONN_HASH_SIZE];
+static sys_slist_t conn_wildcard;
+
+#define CONN_HASH_INIT			2166136261U
+#define CONN_HASH_PRIME			16777619U
+
+/* FNV-1a, byte by byte as the IP headers need not be aligned */
+static u32_t conn_hash(u32_t hash, const void *data, size_t len)
+{
+	const u8_t *p = data;
+
+	while (len--) {
+		hash = (hash ^ *p++) * CONN_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+/* Ports are in network byte order */
+static sys_slist_t *conn_exact_bucket(u16_t proto, const void *remote_addr,
+				      size_t addr_len, u16_t remote_port,
+				      u16_t local_port)
+{
+	u32_t hash = CONN_HASH_INIT;
+
+	hash = conn_hash(hash, &proto, sizeof(proto));
+	hash = conn_hash(hash, &remote_port, sizeof(remote_port));
+	hash = conn_hash(hash, &local_port, sizeof(local_port));
+	hash = conn_hash(hash, remote_addr, addr_len);
+
+	return &conn_exact[hash % CONFIG_NET_CONN_HASH_SIZE];
+}
+
+static sys_slist_t *conn_port_bucket(u16_t proto, u16_t local_port)
+{
+	u32_t hash = CONN_HASH_INIT;
+
+	hash = conn_hash(hash, &proto, sizeof(proto));
+	hash = conn_hash(hash, &local_port, sizeof(local_port));
+
+	return &conn_port[hash % CONFIG_NET_CONN_HASH_SIZE];
+}
+
+/* Find the list a connection with the given rank flags belongs to */
+static sys_slist_t *conn_list_get(u16_t proto, u8_t flags,
+				  const struct sockaddr *remote_addr,
+				  u16_t remote_port, u16_t local_port)
+{
+	if ((flags & NET_CONN_EXACT_SPEC) == NET_CONN_EXACT_SPEC) {
+		if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		    remote_addr->sa_family == AF_INET6) {
+			return conn_exact_bucket(
+				proto, &net_sin6(remote_addr)->sin6_addr,
+				sizeof(struct in6_addr),
+				remote_port, local_port);
+		} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
+			   remote_addr->sa_family == AF_INET) {
+			return conn_exact_bucket(
+				proto, &net_sin(remote_addr)->sin_addr,
+				sizeof(struct in_addr),
+				remote_port, local_port);
+		}
+	}
+
+	if (flags & NET_CONN_LOCAL_PORT_SPEC) {
+		return conn_port_bucket(proto, local_port);
+	}
+
+	return &conn_wildcard;
+}
+
+static bool conn_addr_is_spec(const struct sockaddr *addr)
+{
+	if (IS_ENABLED(CONFIG_NET_IPV6) && addr->sa_family == AF_INET6) {
+		return !net_ipv6_is_addr_unspecified(
+			&net_sin6(addr)->sin6_addr);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) && addr->sa_family == AF_INET) {
+		return net_sin(addr)->sin_addr.s_addr != 0U;
+	}
+
+	return false;
+}
 
 #if (CONFIG_NET_CONN_LOG_LEVEL >= LOG_LEVEL_DBG)
 static inline
@@ -124,11 +224,18 @@ static struct net_conn *conn_get_unused(void)
 	return CONTAINER_OF(node, struct net_conn, node);
 }
 
+static sys_slist_t *conn_list(struct net_conn *conn)
+{
+	return conn_list_get(conn->proto, conn->flags, &conn->remote_addr,
+			     net_sin(&conn->remote_addr)->sin_port,
+			     net_sin(&conn->local_addr)->sin_port);
+}
+
 static void conn_set_used(struct net_conn *conn)
 {
 	conn->flags |= NET_CONN_IN_USE;
 
-	sys_slist_prepend(&conn_used, &conn->node);
+	sys_slist_prepend(conn_list(conn), &conn->node);
 }
 
 static void conn_set_unused(struct net_conn *conn)
@@ -146,8 +253,26 @@ static struct net_conn *conn_find_handler(u16_t proto, u8_t family,
 					  u16_t local_port)
 {
 	struct net_conn *conn;
+	sys_slist_t *list;
+	u8_t flags = 0U;
+
+	/* An identical handler would be in the same list */
+	if (remote_addr && conn_addr_is_spec(remote_addr)) {
+		flags |= NET_CONN_REMOTE_ADDR_SPEC;
+	}
+
+	if (remote_port) {
+		flags |= NET_CONN_REMOTE_PORT_SPEC;
+	}
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used, conn, node) {
+	if (local_port) {
+		flags |= NET_CONN_LOCAL_PORT_SPEC;
+	}
+
+	list = conn_list_get(proto, flags, remote_addr, htons(remote_port),
+			     htons(local_port));
+
+	SYS_SLIST_FOR_EACH_CONTAINER(list, conn, node) {
 		if (conn->proto != proto) {
 			continue;
 		}
@@ -369,7 +494,7 @@ int net_conn_unregister(struct net_conn_handle *handle)
 
 	NET_DBG("Connection handler %p removed", conn);
 
-	sys_slist_find_and_remove(&conn_used, &conn->node);
+	sys_slist_find_and_remove(conn_list(conn), &conn->node);
 
 	conn_set_unused(conn);
 
@@ -497,6 +622,137 @@ static bool conn_are_end_points_valid(struct net_pkt *pkt,
 	return !(my_src_addr && (src_port == dst_port));
 }
 
+static bool conn_match(struct net_conn *conn, struct net_pkt *pkt,
+		       union net_ip_header *ip_hdr, u8_t proto,
+		       u16_t src_port, u16_t dst_port)
+{
+	if (conn->proto != proto) {
+		return false;
+	}
+
+	if (conn->family != AF_UNSPEC &&
+	    conn->family != net_pkt_family(pkt)) {
+		return false;
+	}
+
+	if (net_sin(&conn->remote_addr)->sin_port) {
+		if (net_sin(&conn->remote_addr)->sin_port != src_port) {
+			return false;
+		}
+	}
+
+	if (net_sin(&conn->local_addr)->sin_port) {
+		if (net_sin(&conn->local_addr)->sin_port != dst_port) {
+			return false;
+		}
+	}
+
+	if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
+		if (!conn_addr_cmp(pkt, ip_hdr, &conn->remote_addr, true)) {
+			return false;
+		}
+	}
+
+	if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
+		if (!conn_addr_cmp(pkt, ip_hdr, &conn->local_addr, false)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Look up the handler of a fully specified connection */
+static struct net_conn *conn_find_exact(struct net_pkt *pkt,
+					union net_ip_header *ip_hdr,
+					u8_t proto,
+					u16_t src_port, u16_t dst_port)
+{
+	struct net_conn *best_match = NULL;
+	struct net_conn *conn;
+	sys_slist_t *bucket;
+
+	if (!src_port || !dst_port) {
+		return NULL;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && net_pkt_family(pkt) == AF_INET6) {
+		bucket = conn_exact_bucket(proto, &ip_hdr->ipv6->src,
+					   sizeof(struct in6_addr),
+					   src_port, dst_port);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		   net_pkt_family(pkt) == AF_INET) {
+		bucket = conn_exact_bucket(proto, &ip_hdr->ipv4->src,
+					   sizeof(struct in_addr),
+					   src_port, dst_port);
+	} else {
+		return NULL;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(bucket, conn, node) {
+		if (!conn_match(conn, pkt, ip_hdr, proto, src_port,
+				dst_port)) {
+			continue;
+		}
+
+		/* Only the local address may differ: prefer the handler
+		 * that specifies it.
+		 */
+		if (!best_match ||
+		    NET_CONN_RANK(best_match->flags) <
+		    NET_CONN_RANK(conn->flags)) {
+			best_match = conn;
+		}
+	}
+
+	return best_match;
+}
+
+static void conn_rank_list(sys_slist_t *list, struct net_pkt *pkt,
+			   union net_ip_header *ip_hdr, u8_t proto,
+			   u16_t src_port, u16_t dst_port,
+			   struct net_conn **best_match, s16_t *best_rank)
+{
+	struct net_conn *conn;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(list, conn, node) {
+		if (IS_ENABLED(CONFIG_NET_UDP) ||
+		    IS_ENABLED(CONFIG_NET_TCP)) {
+			if (!conn_match(conn, pkt, ip_hdr, proto, src_port,
+					dst_port)) {
+				continue;
+			}
+
+			/* If we have an existing best_match, and that one
+			 * specifies a remote port, then we've matched to a
+			 * LISTENING connection that should not override.
+			 */
+			if (*best_match != NULL &&
+			    (*best_match)->flags & NET_CONN_REMOTE_PORT_SPEC) {
+				continue;
+			}
+
+			if (*best_rank < NET_CONN_RANK(conn->flags)) {
+				*best_rank = NET_CONN_RANK(conn->flags);
+				*best_match = conn;
+			}
+		} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) ||
+			   IS_ENABLED(CONFIG_NET_SOCKETS_CAN)) {
+			if (conn->proto != proto) {
+				continue;
+			}
+
+			if (conn->family != AF_UNSPEC &&
+			    conn->family != net_pkt_family(pkt)) {
+				continue;
+			}
+
+			*best_rank = 0;
+			*best_match = conn;
+		}
+	}
+}
+
 enum net_verdict net_conn_input(struct net_pkt *pkt,
 				union net_ip_header *ip_hdr,
 				u8_t proto,
@@ -546,66 +802,24 @@ enum net_verdict net_conn_input(struct net_pkt *pkt,
 		" family %d", net_proto2str(net_pkt_family(pkt), proto), pkt,
 		ntohs(src_port), ntohs(dst_port), net_pkt_family(pkt));
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used, conn, node) {
-		if (conn->proto != proto) {
-			continue;
-		}
-
-		if (conn->family != AF_UNSPEC &&
-		    conn->family != net_pkt_family(pkt)) {
-			continue;
-		}
-
-		if (IS_ENABLED(CONFIG_NET_UDP) ||
-		    IS_ENABLED(CONFIG_NET_TCP)) {
-			if (net_sin(&conn->remote_addr)->sin_port) {
-				if (net_sin(&conn->remote_addr)->sin_port !=
-				    src_port) {
-					continue;
-				}
-			}
-
-			if (net_sin(&conn->local_addr)->sin_port) {
-				if (net_sin(&conn->local_addr)->sin_port !=
-				    dst_port) {
-					continue;
-				}
-			}
-
-			if (conn->flags & NET_CONN_REMOTE_ADDR_SET) {
-				if (!conn_addr_cmp(pkt, ip_hdr,
-						   &conn->remote_addr,
-						   true)) {
-					continue;
-				}
-			}
-
-			if (conn->flags & NET_CONN_LOCAL_ADDR_SET) {
-				if (!conn_addr_cmp(pkt, ip_hdr,
-						   &conn->local_addr,
-						   false)) {
-					continue;
-				}
-			}
+	conn = NULL;
 
-			/* If we have an existing best_match, and that one
-			 * specifies a remote port, then we've matched to a
-			 * LISTENING connection that should not override.
-			 */
-			if (best_match != NULL &&
-			    best_match->flags & NET_CONN_REMOTE_PORT_SPEC) {
-				continue;
-			}
+	if ((IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) ||
+	    (IS_ENABLED(CONFIG_NET_TCP) && proto == IPPROTO_TCP)) {
+		conn = conn_find_exact(pkt, ip_hdr, proto, src_port, dst_port);
+	}
 
-			if (best_rank < NET_CONN_RANK(conn->flags)) {
-				best_rank = NET_CONN_RANK(conn->flags);
-				best_match = conn;
-			}
-		} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) ||
-			   IS_ENABLED(CONFIG_NET_SOCKETS_CAN)) {
-			best_rank = 0;
-			best_match = conn;
+	if (conn) {
+		best_match = conn;
+	} else {
+		if (dst_port) {
+			conn_rank_list(conn_port_bucket(proto, dst_port),
+				       pkt, ip_hdr, proto, src_port, dst_port,
+				       &best_match, &best_rank);
 		}
+
+		conn_rank_list(&conn_wildcard, pkt, ip_hdr, proto,
+			       src_port, dst_port, &best_match, &best_rank);
 	}
 
 	conn = best_match;
@@ -655,10 +869,12 @@ drop:
 
 void net_conn_foreach(net_conn_foreach_cb_t cb, void *user_data)
 {
-	struct net_conn *conn;
+	int i;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&conn_used, conn, node) {
-		cb(conn, user_data);
+	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
+		if (conns[i].flags & NET_CONN_IN_USE) {
+			cb(&conns[i], user_data);
+		}
 	}
 }
 
@@ -667,7 +883,12 @@ void net_conn_init(void)
 	int i;
 
 	sys_slist_init(&conn_unused);
-	sys_slist_init(&conn_used);
+	sys_slist_init(&conn_wildcard);
+
+	for (i = 0; i < CONFIG_NET_CONN_HASH_SIZE; i++) {
+		sys_slist_init(&conn_exact[i]);
+		sys_slist_init(&conn_port[i]);
+	}
 
 	for (i = 0; i < CONFIG_NET_MAX_CONN; i++) {
 		sys_slist_prepend(&conn_unused, &conns[i].node);
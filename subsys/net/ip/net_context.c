@@ -279,6 +279,11 @@ int net_context_get(sa_family_t family,
 		k_sem_init(&contexts[i].recv_data_wait, 1, UINT_MAX);
 #endif /* CONFIG_NET_CONTEXT_SYNC_RECV */
 
+#if defined(CONFIG_NET_CONTEXT_ZEROCOPY)
+		contexts[i].options.zerocopy = false;
+		(void)memset(&contexts[i].zc, 0, sizeof(contexts[i].zc));
+#endif
+
 		k_mutex_init(&contexts[i].lock);
 
 		contexts[i].flags |= NET_CONTEXT_IN_USE;
@@ -311,6 +316,228 @@ int net_context_get(sa_family_t family,
 	return ret;
 }
 
+struct zc_send;
+
+#if defined(CONFIG_NET_CONTEXT_ZEROCOPY)
+/* The longest run of zero-copy sends of a context that can be waiting
+ * for completion, the width of the zc.completed bitmap.
+ */
+#define ZC_MAX_PENDING 32
+
+/* A MSG_ZEROCOPY send. It completes once the buffers referencing its
+ * data, and the sender itself, have let go of it.
+ */
+struct zc_send {
+	struct net_context *context;
+	u32_t id;
+	atomic_t refs;
+};
+
+K_MEM_SLAB_DEFINE(zc_sends, sizeof(struct zc_send),
+		  CONFIG_NET_CONTEXT_ZEROCOPY_BUF_COUNT, sizeof(void *));
+
+/* The send each zc_bufs buffer belongs to, by buffer id */
+static struct zc_send *zc_buf_send[CONFIG_NET_CONTEXT_ZEROCOPY_BUF_COUNT];
+static struct k_spinlock zc_lock;
+
+static void zc_buf_destroy(struct net_buf *buf);
+
+NET_BUF_POOL_FIXED_DEFINE(zc_bufs, CONFIG_NET_CONTEXT_ZEROCOPY_BUF_COUNT,
+			  0, zc_buf_destroy);
+
+/* Called with zc_lock held */
+static void zc_complete(struct net_context *context, u32_t id)
+{
+	context->zc.completed |= BIT(id - context->zc.done);
+
+	while (context->zc.completed & 1) {
+		context->zc.completed >>= 1;
+		context->zc.done++;
+	}
+}
+
+static void zc_send_unref(struct zc_send *send)
+{
+	k_spinlock_key_t key;
+
+	if (atomic_dec(&send->refs) != 1) {
+		return;
+	}
+
+	key = k_spin_lock(&zc_lock);
+
+	if (send->context) {
+		zc_complete(send->context, send->id);
+	}
+
+	k_spin_unlock(&zc_lock, key);
+
+	k_mem_slab_free(&zc_sends, (void **)&send);
+}
+
+static void zc_buf_destroy(struct net_buf *buf)
+{
+	struct zc_send *send;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&zc_lock);
+	send = zc_buf_send[net_buf_id(buf)];
+	zc_buf_send[net_buf_id(buf)] = NULL;
+	k_spin_unlock(&zc_lock, key);
+
+	net_buf_destroy(buf);
+
+	zc_send_unref(send);
+}
+
+/* Add the data of msghdr to pkt by reference. Returns the send the
+ * buffers belong to, or NULL if the data has to be copied after all.
+ */
+static struct zc_send *zc_attach_data(struct net_context *context,
+				      struct net_pkt *pkt, size_t len,
+				      const struct msghdr *msghdr)
+{
+	struct net_buf *head = NULL;
+	struct zc_send *send;
+	k_spinlock_key_t key;
+	int i;
+
+	if (k_mem_slab_alloc(&zc_sends, (void **)&send, K_NO_WAIT)) {
+		return NULL;
+	}
+
+	send->context = context;
+	/* Held by the sender until the send has its number */
+	atomic_set(&send->refs, 1);
+
+	for (i = 0; i < msghdr->msg_iovlen && len; i++) {
+		size_t size = MIN(msghdr->msg_iov[i].iov_len, len);
+		struct net_buf *buf;
+
+		if (!size) {
+			continue;
+		}
+
+		buf = net_buf_alloc_with_data(&zc_bufs,
+					      msghdr->msg_iov[i].iov_base,
+					      size, K_NO_WAIT);
+		if (!buf) {
+			/* Releasing the buffers must not complete anything */
+			send->context = NULL;
+
+			if (head) {
+				net_buf_unref(head);
+			}
+
+			zc_send_unref(send);
+
+			return NULL;
+		}
+
+		atomic_inc(&send->refs);
+
+		key = k_spin_lock(&zc_lock);
+		zc_buf_send[net_buf_id(buf)] = send;
+		k_spin_unlock(&zc_lock, key);
+
+		if (head) {
+			net_buf_frag_add(head, buf);
+		} else {
+			head = buf;
+		}
+
+		len -= size;
+	}
+
+	if (head) {
+		net_pkt_append_buffer(pkt, head);
+	}
+
+	return send;
+}
+
+/* Number the send once it is known to have been made, or let it go
+ * without a number if it failed.
+ */
+static void zc_sent(struct net_context *context, struct zc_send *send,
+		    bool sent)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&zc_lock);
+
+	if (!sent) {
+		if (send) {
+			send->context = NULL;
+		}
+	} else if (send) {
+		send->id = context->zc.next++;
+	} else {
+		/* The data was copied */
+		zc_complete(context, context->zc.next++);
+	}
+
+	k_spin_unlock(&zc_lock, key);
+
+	if (send) {
+		zc_send_unref(send);
+	}
+}
+
+static void zc_context_released(struct net_context *context)
+{
+	k_spinlock_key_t key;
+	int i;
+
+	key = k_spin_lock(&zc_lock);
+
+	for (i = 0; i < ARRAY_SIZE(zc_buf_send); i++) {
+		if (zc_buf_send[i] && zc_buf_send[i]->context == context) {
+			zc_buf_send[i]->context = NULL;
+		}
+	}
+
+	k_spin_unlock(&zc_lock, key);
+}
+
+static int context_check_zerocopy(struct net_context *context,
+				  const struct msghdr *msghdr, int flags,
+				  bool *zerocopy)
+{
+	*zerocopy = false;
+
+	if (!msghdr || !(flags & ZSOCK_MSG_ZEROCOPY) ||
+	    !context->options.zerocopy ||
+	    (net_context_get_ip_proto(context) != IPPROTO_UDP &&
+	     net_context_get_ip_proto(context) != IPPROTO_TCP) ||
+	    (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
+	     net_if_is_ip_offloaded(net_context_get_iface(context)))) {
+		return 0;
+	}
+
+	if (context->zc.next - context->zc.done >= ZC_MAX_PENDING) {
+		return -ENOBUFS;
+	}
+
+	*zerocopy = true;
+
+	return 0;
+}
+#else
+#define zc_attach_data(...) NULL
+#define zc_sent(...)
+#define zc_context_released(...)
+
+static int context_check_zerocopy(struct net_context *context,
+				  const struct msghdr *msghdr, int flags,
+				  bool *zerocopy)
+{
+	*zerocopy = false;
+
+	return 0;
+}
+#endif /* CONFIG_NET_CONTEXT_ZEROCOPY */
+
 int net_context_ref(struct net_context *context)
 {
 	int old_rc = atomic_inc(&context->refcount);
@@ -341,6 +568,9 @@ int net_context_unref(struct net_context *context)
 
 	net_context_set_state(context, NET_CONTEXT_UNCONNECTED);
 
+	/* Sends still in flight must not complete in a reused context */
+	zc_context_released(context);
+
 	context->flags &= ~NET_CONTEXT_IN_USE;
 
 	NET_DBG("Context %p released", context);
@@ -1172,36 +1402,99 @@ static int get_context_txtime(struct net_context *context,
 #endif
 }
 
+static int get_context_zerocopy(struct net_context *context,
+				void *value, size_t *len)
+{
+#if defined(CONFIG_NET_CONTEXT_ZEROCOPY)
+	*((bool *)value) = context->options.zerocopy;
+
+	if (len) {
+		*len = sizeof(bool);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+static int get_context_zerocopy_done(struct net_context *context,
+				     void *value, size_t *len)
+{
+#if defined(CONFIG_NET_CONTEXT_ZEROCOPY)
+	/* Sends complete from other threads, without the context lock */
+	*((u32_t *)value) = *(volatile u32_t *)&context->zc.done;
+
+	if (len) {
+		*len = sizeof(u32_t);
+	}
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 /* If buf is not NULL, then use it. Otherwise read the data to be written
  * to net_pkt from msghdr.
  */
 static int context_write_data(struct net_pkt *pkt, const void *buf,
-			      int buf_len, const struct msghdr *msghdr)
+			      int buf_len, const struct msghdr *msghdr,
+			      bool chksum)
 {
+	int (*write)(struct net_pkt *pkt, const void *data, size_t length);
 	int ret = 0;
 
+	/* Sum UDP and TCP payload on the way in, unless the interface
+	 * computes the checksum anyway.
+	 */
+	if (chksum && net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
+		write = net_pkt_write_chksum;
+	} else {
+		write = net_pkt_write;
+	}
+
 	if (msghdr) {
 		int i;
 
 		for (i = 0; i < msghdr->msg_iovlen; i++) {
-			ret = net_pkt_write(pkt, msghdr->msg_iov[i].iov_base,
-					    msghdr->msg_iov[i].iov_len);
+			ret = write(pkt, msghdr->msg_iov[i].iov_base,
+				    msghdr->msg_iov[i].iov_len);
 			if (ret < 0) {
 				break;
 			}
 		}
 	} else {
-		ret = net_pkt_write(pkt, buf, buf_len);
+		ret = write(pkt, buf, buf_len);
 	}
 
 	return ret;
 }
 
+/* Reference the data of a zero-copy send from pkt, or make room for it
+ * if it has to be copied after all.
+ */
+static int context_attach_data(struct net_context *context,
+			       struct net_pkt *pkt, size_t len,
+			       const struct msghdr *msghdr,
+			       struct zc_send **zc)
+{
+	*zc = zc_attach_data(context, pkt, len, msghdr);
+	if (*zc) {
+		return 0;
+	}
+
+	/* Only room for the headers was allocated */
+	if (net_pkt_alloc_buffer(pkt, len, net_context_get_ip_proto(context),
+				 PKT_WAIT_TIME)) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
 static int context_setup_udp_packet(struct net_context *context,
 				    struct net_pkt *pkt,
-				    const void *buf,
-				    size_t len,
-				    const struct msghdr *msg,
 				    const struct sockaddr *dst_addr,
 				    socklen_t addrlen)
 {
@@ -1235,20 +1528,10 @@ static int context_setup_udp_packet(struct net_context *context,
 		return ret;
 	}
 
-	ret = net_udp_create(pkt,
-			     net_sin((struct sockaddr *)
-				     &context->local)->sin_port,
-			     dst_port);
-	if (ret) {
-		return ret;
-	}
-
-	ret = context_write_data(pkt, buf, len, msg);
-	if (ret) {
-		return ret;
-	}
-
-	return 0;
+	return net_udp_create(pkt,
+			      net_sin((struct sockaddr *)
+				      &context->local)->sin_port,
+			      dst_port);
 }
 
 static void context_finalize_packet(struct net_context *context,
@@ -1331,10 +1614,13 @@ static int context_sendto(struct net_context *context,
 			  net_context_send_cb_t cb,
 			  s32_t timeout,
 			  void *user_data,
-			  bool sendto)
+			  bool sendto,
+			  int flags)
 {
 	const struct msghdr *msghdr = NULL;
+	struct zc_send *zc = NULL;
 	struct net_pkt *pkt;
+	bool zerocopy;
 	size_t tmp_len;
 	int ret;
 
@@ -1465,17 +1751,38 @@ static int context_sendto(struct net_context *context,
 		}
 	}
 
-	pkt = context_alloc_pkt(context, len, PKT_WAIT_TIME);
+	ret = context_check_zerocopy(context, msghdr, flags, &zerocopy);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* Zero-copy data is attached to the packet as is, only the
+	 * headers need room.
+	 */
+	pkt = context_alloc_pkt(context, zerocopy ? 0 : len, PKT_WAIT_TIME);
 	if (!pkt) {
 		return -ENOMEM;
 	}
 
-	tmp_len = net_pkt_available_payload_buffer(
+	if (zerocopy) {
+		tmp_len = net_pkt_max_payload_length(
+				pkt, len, net_context_get_ip_proto(context));
+	} else {
+		tmp_len = net_pkt_available_payload_buffer(
 				pkt, net_context_get_ip_proto(context));
+	}
+
 	if (tmp_len < len) {
 		len = tmp_len;
 	}
 
+	if (zerocopy) {
+		ret = context_attach_data(context, pkt, len, msghdr, &zc);
+		if (ret < 0) {
+			goto fail;
+		}
+	}
+
 	context->send_cb = cb;
 	context->user_data = user_data;
 
@@ -1532,7 +1839,7 @@ static int context_sendto(struct net_context *context,
 
 	if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
 	    net_if_is_ip_offloaded(net_context_get_iface(context))) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1549,20 +1856,31 @@ static int context_sendto(struct net_context *context,
 		}
 	} else if (IS_ENABLED(CONFIG_NET_UDP) &&
 	    net_context_get_ip_proto(context) == IPPROTO_UDP) {
-		ret = context_setup_udp_packet(context, pkt, buf, len, msghdr,
-					       dst_addr, addrlen);
+		ret = context_setup_udp_packet(context, pkt, dst_addr, addrlen);
 		if (ret < 0) {
 			goto fail;
 		}
 
+		if (!zc) {
+			ret = context_write_data(pkt, buf, len, msghdr, true);
+			if (ret < 0) {
+				goto fail;
+			}
+		}
+
 		context_finalize_packet(context, pkt);
 
 		ret = net_send_data(pkt);
 	} else if (IS_ENABLED(CONFIG_NET_TCP) &&
 		   net_context_get_ip_proto(context) == IPPROTO_TCP) {
-		ret = context_write_data(pkt, buf, len, msghdr);
-		if (ret < 0) {
-			goto fail;
+		if (zc) {
+			/* Drop the header room, TCP adds its own buffer */
+			net_pkt_trim_buffer(pkt);
+		} else {
+			ret = context_write_data(pkt, buf, len, msghdr, true);
+			if (ret < 0) {
+				goto fail;
+			}
 		}
 
 		net_pkt_cursor_init(pkt);
@@ -1574,7 +1892,7 @@ static int context_sendto(struct net_context *context,
 		ret = net_tcp_send_data(context, cb, user_data);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) &&
 		   net_context_get_family(context) == AF_PACKET) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1585,7 +1903,7 @@ static int context_sendto(struct net_context *context,
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) &&
 		   net_context_get_family(context) == AF_CAN &&
 		   net_context_get_ip_proto(context) == CAN_RAW) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1603,8 +1921,16 @@ static int context_sendto(struct net_context *context,
 		goto fail;
 	}
 
+	if (zerocopy) {
+		zc_sent(context, zc, true);
+	}
+
 	return len;
 fail:
+	if (zerocopy) {
+		zc_sent(context, zc, false);
+	}
+
 	net_pkt_unref(pkt);
 
 	return ret;
@@ -1646,7 +1972,7 @@ int net_context_send(struct net_context *context,
 	}
 
 	ret = context_sendto(context, buf, len, &context->remote,
-			     addrlen, cb, timeout, user_data, false);
+			     addrlen, cb, timeout, user_data, false, 0);
 unlock:
 	k_mutex_unlock(&context->lock);
 
@@ -1665,7 +1991,7 @@ int net_context_sendmsg(struct net_context *context,
 	k_mutex_lock(&context->lock, K_FOREVER);
 
 	ret = context_sendto(context, msghdr, 0, NULL, 0,
-			     cb, timeout, user_data, true);
+			     cb, timeout, user_data, true, flags);
 
 	k_mutex_unlock(&context->lock);
 
@@ -1686,7 +2012,7 @@ int net_context_sendto(struct net_context *context,
 	k_mutex_lock(&context->lock, K_FOREVER);
 
 	ret = context_sendto(context, buf, len, dst_addr, addrlen,
-			     cb, timeout, user_data, true);
+			     cb, timeout, user_data, true, 0);
 
 	k_mutex_unlock(&context->lock);
 
@@ -2039,6 +2365,22 @@ static int set_context_proxy(struct net_context *context,
 #endif
 }
 
+static int set_context_zerocopy(struct net_context *context,
+				const void *value, size_t len)
+{
+#if defined(CONFIG_NET_CONTEXT_ZEROCOPY)
+	if (len > sizeof(bool)) {
+		return -EINVAL;
+	}
+
+	context->options.zerocopy = *((bool *)value);
+
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 int net_context_set_option(struct net_context *context,
 			   enum net_context_option option,
 			   const void *value, size_t len)
@@ -2066,6 +2408,12 @@ int net_context_set_option(struct net_context *context,
 	case NET_OPT_SOCKS5:
 		ret = set_context_proxy(context, value, len);
 		break;
+	case NET_OPT_ZEROCOPY:
+		ret = set_context_zerocopy(context, value, len);
+		break;
+	case NET_OPT_ZEROCOPY_DONE:
+		ret = -EINVAL;
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -2100,6 +2448,12 @@ int net_context_get_option(struct net_context *context,
 	case NET_OPT_SOCKS5:
 		ret = get_context_proxy(context, value, len);
 		break;
+	case NET_OPT_ZEROCOPY:
+		ret = get_context_zerocopy(context, value, len);
+		break;
+	case NET_OPT_ZEROCOPY_DONE:
+		ret = get_context_zerocopy_done(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -68,6 +68,34 @@ void net_analyze_stack(const char *name, const char *stack, size_t size)
 }
 #endif /* CONFIG_INIT_STACKS */
 
+static enum net_verdict process_l3_data(struct net_pkt *pkt,
+					bool is_loopback)
+{
+	/* L2 has modified the buffer starting point, it is easier
+	 * to re-initialize the cursor rather than updating it.
+	 */
+	net_pkt_cursor_init(pkt);
+
+	/* IP version and header length. */
+	switch (NET_IPV6_HDR(pkt)->vtc & 0xf0) {
+#if defined(CONFIG_NET_IPV6)
+	case 0x60:
+		return net_ipv6_input(pkt, is_loopback);
+#endif
+#if defined(CONFIG_NET_IPV4)
+	case 0x40:
+		return net_ipv4_input(pkt);
+#endif
+	}
+
+	NET_DBG("Unknown IP family packet (0x%x)",
+		NET_IPV6_HDR(pkt)->vtc & 0xf0);
+	net_stats_update_ip_errors_protoerr(net_pkt_iface(pkt));
+	net_stats_update_ip_errors_vhlerr(net_pkt_iface(pkt));
+
+	return NET_DROP;
+}
+
 static inline enum net_verdict process_data(struct net_pkt *pkt,
 					    bool is_loopback)
 {
@@ -115,29 +143,7 @@ static inline enum net_verdict process_data(struct net_pkt *pkt,
 		return ret;
 	}
 
-	/* L2 has modified the buffer starting point, it is easier
-	 * to re-initialize the cursor rather than updating it.
-	 */
-	net_pkt_cursor_init(pkt);
-
-	/* IP version and header length. */
-	switch (NET_IPV6_HDR(pkt)->vtc & 0xf0) {
-#if defined(CONFIG_NET_IPV6)
-	case 0x60:
-		return net_ipv6_input(pkt, is_loopback);
-#endif
-#if defined(CONFIG_NET_IPV4)
-	case 0x40:
-		return net_ipv4_input(pkt);
-#endif
-	}
-
-	NET_DBG("Unknown IP family packet (0x%x)",
-		NET_IPV6_HDR(pkt)->vtc & 0xf0);
-	net_stats_update_ip_errors_protoerr(net_pkt_iface(pkt));
-	net_stats_update_ip_errors_vhlerr(net_pkt_iface(pkt));
-
-	return NET_DROP;
+	return process_l3_data(pkt, is_loopback);
 }
 
 static void processing_data(struct net_pkt *pkt, bool is_loopback)
@@ -154,6 +160,14 @@ static void processing_data(struct net_pkt *pkt, bool is_loopback)
 	}
 }
 
+void net_process_l3_data(struct net_pkt *pkt)
+{
+	if (process_l3_data(pkt, false) == NET_DROP) {
+		NET_DBG("Dropping pkt %p", pkt);
+		net_pkt_unref(pkt);
+	}
+}
+
 /* Things to setup after we are able to RX and TX */
 static void net_post_init(void)
 {
@@ -368,22 +382,34 @@ static void process_rx_packet(struct k_work *work)
 
 static void net_queue_rx(struct net_if *iface, struct net_pkt *pkt)
 {
-	u8_t prio = net_pkt_priority(pkt);
-	u8_t tc = net_rx_priority2tc(prio);
+	u8_t queue;
 
 	k_work_init(net_pkt_work(pkt), process_rx_packet);
 
-#if defined(CONFIG_NET_STATISTICS)
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+	if (!net_pkt_flow_hash(pkt)) {
+		net_pkt_set_flow_hash(pkt, net_rx_flow_hash(iface, pkt));
+	}
+#endif
+
+	queue = net_rx_pkt2queue(pkt);
+
+#if (NET_TC_COUNT > 1) && defined(CONFIG_NET_STATISTICS)
+	u8_t prio = net_pkt_priority(pkt);
+	u8_t tc = net_rx_priority2tc(prio);
+
 	net_stats_update_tc_recv_pkt(iface, tc);
 	net_stats_update_tc_recv_bytes(iface, tc, net_pkt_get_len(pkt));
 	net_stats_update_tc_recv_priority(iface, tc, prio);
 #endif
 
-#if NET_TC_RX_COUNT > 1
-	NET_DBG("TC %d with prio %d pkt %p", tc, prio, pkt);
+#if NET_RX_QUEUE_COUNT > 1
+	NET_DBG("TC %d queue %d with prio %d pkt %p",
+		net_rx_priority2tc(net_pkt_priority(pkt)), queue,
+		net_pkt_priority(pkt), pkt);
 #endif
 
-	net_tc_submit_to_rx_queue(tc, pkt);
+	net_tc_submit_to_rx_queue(queue, pkt);
 }
 
 /* Called by driver when an IP packet has been received */
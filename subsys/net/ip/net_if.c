@@ -3297,6 +3297,13 @@ bool net_if_need_calc_rx_checksum(struct net_if *iface)
 	return need_calc_checksum(iface, ETHERNET_HW_RX_CHKSUM_OFFLOAD);
 }
 
+#if defined(CONFIG_NET_TCP_TSO)
+bool net_if_supports_tso(struct net_if *iface)
+{
+	return !need_calc_checksum(iface, ETHERNET_HW_TSO);
+}
+#endif /* CONFIG_NET_TCP_TSO */
+
 struct net_if *net_if_get_by_index(int index)
 {
 	if (index <= 0) {
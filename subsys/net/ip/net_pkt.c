@@ -952,6 +952,16 @@ static size_t pkt_buffer_length(struct net_pkt *pkt,
 		max_len = 0;
 	}
 
+#if defined(CONFIG_NET_TCP_TSO)
+	/* TCP packets, and clones of them, may be larger than the MTU if
+	 * the device segments them.
+	 */
+	if ((proto == IPPROTO_TCP || family == AF_UNSPEC) &&
+	    net_pkt_iface(pkt) && net_if_supports_tso(net_pkt_iface(pkt))) {
+		max_len = MAX(max_len, CONFIG_NET_TCP_TSO_MAX_SIZE);
+	}
+#endif
+
 	/* Family vs iface MTU */
 	if (IS_ENABLED(CONFIG_NET_IPV6) && family == AF_INET6) {
 		if (IS_ENABLED(CONFIG_NET_IPV6_FRAGMENT) && (size > max_len)) {
@@ -1057,6 +1067,18 @@ size_t net_pkt_available_payload_buffer(struct net_pkt *pkt,
 	return len;
 }
 
+size_t net_pkt_max_payload_length(struct net_pkt *pkt, size_t size,
+				  enum net_ip_protocol proto)
+{
+	size_t hdr_len;
+	size_t len;
+
+	hdr_len = pkt_estimate_headers_length(pkt, net_pkt_family(pkt), proto);
+	len = pkt_buffer_length(pkt, size + hdr_len, proto, 0);
+
+	return len > hdr_len ? len - hdr_len : 0;
+}
+
 void net_pkt_trim_buffer(struct net_pkt *pkt)
 {
 	struct net_buf *buf, *prev;
@@ -1490,9 +1512,21 @@ static void pkt_cursor_update(struct net_pkt *pkt,
 }
 
 /* Internal function that does all operation (skip/read/write/memset) */
+#if defined(CONFIG_NET_CHKSUM_COPY)
+static void pkt_chksum_copy(struct net_pkt *pkt, void *dst,
+			    const void *src, size_t len)
+{
+	pkt->chksum = net_calc_chksum_copy(pkt->chksum, pkt->chksum_len,
+					   dst, src, len);
+	pkt->chksum_len += len;
+}
+#else
+#define pkt_chksum_copy(pkt, dst, src, len) memcpy(dst, src, len)
+#endif /* CONFIG_NET_CHKSUM_COPY */
+
 static int net_pkt_cursor_operate(struct net_pkt *pkt,
 				  void *data, size_t length,
-				  bool copy, bool write)
+				  bool copy, bool write, bool chksum)
 {
 	/* We use such variable to avoid lengthy lines */
 	struct net_pkt_cursor *c_op = &pkt->cursor;
@@ -1522,7 +1556,10 @@ static int net_pkt_cursor_operate(struct net_pkt *pkt,
 			len = d_len;
 		}
 
-		if (copy) {
+		if (copy && chksum) {
+			pkt_chksum_copy(pkt, write ? c_op->pos : data,
+					write ? data : c_op->pos, len);
+		} else if (copy) {
 			memcpy(write ? c_op->pos : data,
 			       write ? data : c_op->pos,
 			       len);
@@ -1555,22 +1592,31 @@ int net_pkt_skip(struct net_pkt *pkt, size_t skip)
 {
 	NET_DBG("pkt %p skip %zu", pkt, skip);
 
-	return net_pkt_cursor_operate(pkt, NULL, skip, false, true);
+	return net_pkt_cursor_operate(pkt, NULL, skip, false, true, false);
 }
 
 int net_pkt_memset(struct net_pkt *pkt, int byte, size_t amount)
 {
 	NET_DBG("pkt %p byte %d amount %zu", pkt, byte, amount);
 
-	return net_pkt_cursor_operate(pkt, &byte, amount, false, true);
+	return net_pkt_cursor_operate(pkt, &byte, amount, false, true, false);
 }
 
 int net_pkt_read(struct net_pkt *pkt, void *data, size_t length)
 {
 	NET_DBG("pkt %p data %p length %zu", pkt, data, length);
 
-	return net_pkt_cursor_operate(pkt, data, length, true, false);
+	return net_pkt_cursor_operate(pkt, data, length, true, false, false);
+}
+
+#if defined(CONFIG_NET_CHKSUM_COPY)
+int net_pkt_read_chksum(struct net_pkt *pkt, void *data, size_t length)
+{
+	NET_DBG("pkt %p data %p length %zu", pkt, data, length);
+
+	return net_pkt_cursor_operate(pkt, data, length, true, false, true);
 }
+#endif /* CONFIG_NET_CHKSUM_COPY */
 
 int net_pkt_read_be16(struct net_pkt *pkt, u16_t *data)
 {
@@ -1616,8 +1662,20 @@ int net_pkt_write(struct net_pkt *pkt, const void *data, size_t length)
 		return net_pkt_skip(pkt, length);
 	}
 
-	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true);
+	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true,
+				      false);
+}
+
+#if defined(CONFIG_NET_CHKSUM_COPY)
+int net_pkt_write_chksum(struct net_pkt *pkt, const void *data,
+			 size_t length)
+{
+	NET_DBG("pkt %p data %p length %zu", pkt, data, length);
+
+	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true,
+				      true);
 }
+#endif /* CONFIG_NET_CHKSUM_COPY */
 
 int net_pkt_copy(struct net_pkt *pkt_dst,
 		 struct net_pkt *pkt_src,
@@ -1681,6 +1739,8 @@ static void clone_pkt_attributes(struct net_pkt *pkt, struct net_pkt *clone_pkt)
 	net_pkt_set_timestamp(clone_pkt, net_pkt_timestamp(pkt));
 	net_pkt_set_priority(clone_pkt, net_pkt_priority(pkt));
 	net_pkt_set_orig_iface(clone_pkt, net_pkt_orig_iface(pkt));
+	net_pkt_set_tso_mss(clone_pkt, net_pkt_tso_mss(pkt));
+	net_pkt_set_flow_hash(clone_pkt, net_pkt_flow_hash(pkt));
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
 		net_pkt_set_ipv4_ttl(clone_pkt, net_pkt_ipv4_ttl(pkt));
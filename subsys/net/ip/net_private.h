@@ -48,7 +48,14 @@ enum net_verdict net_ipv6_input(struct net_pkt *pkt, bool is_loopback);
 extern void net_tc_tx_init(void);
 extern void net_tc_rx_init(void);
 extern void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt);
-extern void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt);
+extern void net_tc_submit_to_rx_queue(u8_t queue, struct net_pkt *pkt);
+extern void net_tc_submit_work_to_rx_queue(u8_t queue, struct k_work *work);
+extern int net_rx_pkt2queue(struct net_pkt *pkt);
+extern int net_rx_queue_current(void);
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+extern u32_t net_rx_flow_hash(struct net_if *iface, struct net_pkt *pkt);
+#endif
+extern void net_process_l3_data(struct net_pkt *pkt);
 extern enum net_verdict net_promisc_mode_input(struct net_pkt *pkt);
 
 char *net_sprint_addr(sa_family_t af, const void *addr);
@@ -92,6 +99,11 @@ extern char *net_byte_to_hex(char *ptr, u8_t byte, char base, bool pad);
 extern char *net_sprint_ll_addr_buf(const u8_t *ll, u8_t ll_len,
 				    char *buf, int buflen);
 extern u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto);
+extern u16_t net_calc_chksum_add(u16_t sum, size_t offset, u16_t part);
+extern u16_t net_calc_chksum_copy(u16_t sum, size_t offset, void *dst,
+				  const void *src, size_t len);
+extern u16_t net_calc_chksum_update(u16_t chksum, const void *old_data,
+				    const void *new_data, size_t len);
 
 enum net_verdict net_context_packet_received(struct net_conn *conn,
 					     struct net_pkt *pkt,
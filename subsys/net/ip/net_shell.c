@@ -34,6 +34,10 @@ LOG_MODULE_REGISTER(net_shell, LOG_LEVEL_DBG);
 #include "tcp_internal.h"
 #endif
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+#include "tcp_cc.h"
+#endif
+
 #include "ipv6.h"
 
 #if defined(CONFIG_NET_ARP)
@@ -1075,6 +1079,28 @@ static void tcp_cb(struct net_tcp *tcp, void *user_data)
 	(*count)++;
 }
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+static void tcp_cc_cb(struct net_tcp *tcp, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	int *count = data->user_data;
+
+	/* Not established yet */
+	if (!tcp->cc) {
+		return;
+	}
+
+	PR("%p %-8s %7u %10u %7u %5u %5u %6u %7u %5u %7u\n",
+	   tcp, tcp->cc->name, tcp->cwnd, tcp->ssthresh,
+	   net_tcp_cc_flight(tcp), tcp->send_wnd, tcp->srtt >> 3, tcp->rto,
+	   tcp->cc_stats.rexmits, tcp->cc_stats.recoveries,
+	   tcp->cc_stats.timeouts);
+
+	(*count)++;
+}
+#endif /* CONFIG_NET_TCP_CONGESTION_CONTROL */
+
 #if CONFIG_NET_TCP_LOG_LEVEL >= LOG_LEVEL_DBG
 static void tcp_sent_list_cb(struct net_tcp *tcp, void *user_data)
 {
@@ -3218,12 +3244,20 @@ static int cmd_net_route(const struct shell *shell, size_t argc, char *argv[])
 	return 0;
 }
 
+/* A system workqueue with several threads has an array of stacks */
+#if !defined(CONFIG_SYSTEM_WORKQUEUE_THREADS) || \
+	(CONFIG_SYSTEM_WORKQUEUE_THREADS == 1)
+#define SYS_WORK_Q_SINGLE_STACK 1
+#endif
+
 #if defined(CONFIG_INIT_STACKS)
 extern K_THREAD_STACK_DEFINE(_main_stack, CONFIG_MAIN_STACK_SIZE);
 extern K_THREAD_STACK_DEFINE(_interrupt_stack, CONFIG_ISR_STACK_SIZE);
+#if defined(SYS_WORK_Q_SINGLE_STACK)
 extern K_THREAD_STACK_DEFINE(sys_work_q_stack,
 			     CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE);
 #endif
+#endif
 
 static int cmd_net_stacks(const struct shell *shell, size_t argc,
 			  char *argv[])
@@ -3281,6 +3315,7 @@ static int cmd_net_stacks(const struct shell *shell, size_t argc,
 	   CONFIG_ISR_STACK_SIZE, unused,
 	   CONFIG_ISR_STACK_SIZE - unused, CONFIG_ISR_STACK_SIZE, pcnt);
 
+#if defined(SYS_WORK_Q_SINGLE_STACK)
 	net_analyze_stack_get_values(Z_THREAD_STACK_BUFFER(sys_work_q_stack),
 				     K_THREAD_STACK_SIZEOF(sys_work_q_stack),
 				     &pcnt, &unused);
@@ -3290,6 +3325,7 @@ static int cmd_net_stacks(const struct shell *shell, size_t argc,
 	   CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE, unused,
 	   CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE - unused,
 	   CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE, pcnt);
+#endif
 #else
 	PR_INFO("Enable CONFIG_INIT_STACKS to see usage information.\n");
 #endif
@@ -3703,9 +3739,28 @@ static int cmd_net_tcp_close(const struct shell *shell, size_t argc,
 
 static int cmd_net_tcp(const struct shell *shell, size_t argc, char *argv[])
 {
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	struct net_shell_user_data user_data;
+	int count = 0;
+#endif
+
 	ARG_UNUSED(argc);
 	ARG_UNUSED(argv);
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	PR("TCP        Algorithm   Cwnd   Ssthresh  Flight   Wnd  SRTT    "
+	   "RTO  Rexmit Recov Timeout\n");
+
+	user_data.shell = shell;
+	user_data.user_data = &count;
+
+	net_tcp_foreach(tcp_cc_cb, &user_data);
+
+	if (count == 0) {
+		PR("No TCP connections\n");
+	}
+#endif
+
 	return 0;
 }
 
@@ -13,6 +13,7 @@ LOG_MODULE_REGISTER(net_tc, CONFIG_NET_TC_LOG_LEVEL);
 #include <net/net_core.h>
 #include <net/net_pkt.h>
 #include <net/net_stats.h>
+#include <net/ethernet.h>
 
 #include "net_private.h"
 #include "net_stats.h"
@@ -28,19 +29,28 @@ NET_STACK_ARRAY_DEFINE(TX, tx_stack,
 NET_STACK_ARRAY_DEFINE(RX, rx_stack,
 		       CONFIG_NET_RX_STACK_SIZE,
 		       CONFIG_NET_RX_STACK_SIZE,
-		       NET_TC_RX_COUNT);
+		       NET_RX_QUEUE_COUNT);
 
 static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
-static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
+
+/* Rx queues NET_RX_FLOW_QUEUES * tc up to NET_RX_FLOW_QUEUES * (tc + 1)
+ * serve traffic class tc.
+ */
+static struct net_traffic_class rx_classes[NET_RX_QUEUE_COUNT];
 
 void net_tc_submit_to_tx_queue(u8_t tc, struct net_pkt *pkt)
 {
 	k_work_submit_to_queue(&tx_classes[tc].work_q, net_pkt_work(pkt));
 }
 
-void net_tc_submit_to_rx_queue(u8_t tc, struct net_pkt *pkt)
+void net_tc_submit_to_rx_queue(u8_t queue, struct net_pkt *pkt)
+{
+	k_work_submit_to_queue(&rx_classes[queue].work_q, net_pkt_work(pkt));
+}
+
+void net_tc_submit_work_to_rx_queue(u8_t queue, struct k_work *work)
 {
-	k_work_submit_to_queue(&rx_classes[tc].work_q, net_pkt_work(pkt));
+	k_work_submit_to_queue(&rx_classes[queue].work_q, work);
 }
 
 int net_tx_priority2tc(enum net_priority prio)
@@ -63,6 +73,165 @@ int net_rx_priority2tc(enum net_priority prio)
 	return rx_prio2tc_map[prio];
 }
 
+int net_rx_pkt2queue(struct net_pkt *pkt)
+{
+	int tc = net_rx_priority2tc(net_pkt_priority(pkt));
+
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+	u32_t hash = net_pkt_flow_hash(pkt);
+
+	/* The hash may come from the device, fold in its upper bits too */
+	hash ^= hash >> 16;
+
+	return tc * NET_RX_FLOW_QUEUES + hash % NET_RX_FLOW_QUEUES;
+#else
+	return tc;
+#endif
+}
+
+/* The Rx queue threads are embedded in rx_classes, so the index follows
+ * from the thread address without searching.
+ */
+int net_rx_queue_current(void)
+{
+	uintptr_t offset = (uintptr_t)k_current_get() -
+			   (uintptr_t)&rx_classes[0].work_q.thread;
+	size_t i = offset / sizeof(rx_classes[0]);
+
+	if (i >= NET_RX_QUEUE_COUNT ||
+	    k_current_get() != &rx_classes[i].work_q.thread) {
+		return -ENOENT;
+	}
+
+	return i;
+}
+
+#if defined(CONFIG_NET_RX_FLOW_STEERING)
+#define FLOW_HASH_INIT			2166136261U
+#define FLOW_HASH_PRIME			16777619U
+
+/* FNV-1a, byte by byte as the headers need not be aligned */
+static u32_t flow_hash(u32_t hash, const void *data, size_t len)
+{
+	const u8_t *p = data;
+
+	while (len--) {
+		hash = (hash ^ *p++) * FLOW_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+/* Hash the addresses of the IP packet at the cursor, and for TCP and UDP
+ * also the protocol and ports. Fragments only have the addresses hashed
+ * so that all of them end up in the same queue.
+ */
+static u32_t ip_flow_hash(struct net_pkt *pkt)
+{
+	union {
+		struct net_ipv4_hdr ipv4;
+		struct net_ipv6_hdr ipv6;
+	} hdr;
+	u32_t hash = FLOW_HASH_INIT;
+	u16_t ports[2];
+	size_t opts_len;
+	u8_t proto;
+
+	if (net_pkt_read(pkt, &hdr, sizeof(hdr.ipv4))) {
+		return 0;
+	}
+
+	switch (hdr.ipv4.vhl & 0xf0) {
+	case 0x40:
+		hash = flow_hash(hash, &hdr.ipv4.src,
+				 2 * sizeof(struct in_addr));
+
+		/* More fragments flag or fragment offset */
+		if ((hdr.ipv4.offset[0] & 0x3f) || hdr.ipv4.offset[1]) {
+			return hash;
+		}
+
+		proto = hdr.ipv4.proto;
+		opts_len = (hdr.ipv4.vhl & 0x0f) * 4U - sizeof(hdr.ipv4);
+		break;
+	case 0x60:
+		if (net_pkt_read(pkt, (u8_t *)&hdr + sizeof(hdr.ipv4),
+				 sizeof(hdr.ipv6) - sizeof(hdr.ipv4))) {
+			return 0;
+		}
+
+		hash = flow_hash(hash, &hdr.ipv6.src,
+				 2 * sizeof(struct in6_addr));
+
+		/* Packets with extension headers are hashed on addresses */
+		proto = hdr.ipv6.nexthdr;
+		opts_len = 0;
+		break;
+	default:
+		return 0;
+	}
+
+	if ((proto != IPPROTO_TCP && proto != IPPROTO_UDP) ||
+	    net_pkt_skip(pkt, opts_len) ||
+	    net_pkt_read(pkt, ports, sizeof(ports))) {
+		return hash;
+	}
+
+	hash = flow_hash(hash, &proto, sizeof(proto));
+
+	return flow_hash(hash, ports, sizeof(ports));
+}
+
+/* Move the cursor to the IP header of a received frame. Returns false if
+ * the frame does not hold an uncompressed IP packet.
+ */
+static bool rx_skip_l2_hdr(struct net_if *iface, struct net_pkt *pkt)
+{
+#if defined(CONFIG_NET_L2_ETHERNET)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(ETHERNET)) {
+		struct net_eth_hdr hdr;
+		u16_t type;
+
+		if (net_pkt_read(pkt, &hdr, sizeof(hdr))) {
+			return false;
+		}
+
+		type = ntohs(hdr.type);
+		if (type == NET_ETH_PTYPE_VLAN &&
+		    (net_pkt_skip(pkt, sizeof(u16_t)) ||
+		     net_pkt_read_be16(pkt, &type))) {
+			return false;
+		}
+
+		return type == NET_ETH_PTYPE_IP || type == NET_ETH_PTYPE_IPV6;
+	}
+#endif
+#if defined(CONFIG_NET_L2_DUMMY)
+	if (net_if_l2(iface) == &NET_L2_GET_NAME(DUMMY)) {
+		return true;
+	}
+#endif
+
+	/* Other L2s may compress the IP header */
+	return false;
+}
+
+u32_t net_rx_flow_hash(struct net_if *iface, struct net_pkt *pkt)
+{
+	u32_t hash = 0U;
+
+	net_pkt_cursor_init(pkt);
+
+	if (rx_skip_l2_hdr(iface, pkt)) {
+		hash = ip_flow_hash(pkt);
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	return hash;
+}
+#endif /* CONFIG_NET_RX_FLOW_STEERING */
+
 /* Convert traffic class to thread priority */
 static u8_t tx_tc2thread(u8_t tc)
 {
@@ -261,6 +430,24 @@ void net_tc_tx_init(void)
 	}
 }
 
+#if defined(CONFIG_NET_RX_FLOW_QUEUES_PIN)
+static void rx_queue_pin(struct k_thread *thread, int cpu)
+{
+	/* The CPU mask of a thread can only be changed while it cannot
+	 * run. The queue thread is idle this early, waiting for work.
+	 */
+	k_thread_suspend(thread);
+
+	if (k_thread_cpu_mask_clear(thread) < 0 ||
+	    k_thread_cpu_mask_enable(thread, cpu) < 0) {
+		NET_ERR("Cannot pin RX queue thread %p to CPU %d", thread,
+			cpu);
+	}
+
+	k_thread_resume(thread);
+}
+#endif
+
 void net_tc_rx_init(void)
 {
 	int i;
@@ -271,10 +458,10 @@ void net_tc_rx_init(void)
 	net_if_foreach(net_tc_rx_stats_priority_setup, NULL);
 #endif
 
-	for (i = 0; i < NET_TC_RX_COUNT; i++) {
+	for (i = 0; i < NET_RX_QUEUE_COUNT; i++) {
 		u8_t thread_priority;
 
-		thread_priority = rx_tc2thread(i);
+		thread_priority = rx_tc2thread(i / NET_RX_FLOW_QUEUES);
 		rx_classes[i].tc = thread_priority;
 
 #if defined(CONFIG_NET_SHELL)
@@ -297,5 +484,10 @@ void net_tc_rx_init(void)
 			       K_THREAD_STACK_SIZEOF(rx_stack[i]),
 			       K_PRIO_COOP(thread_priority));
 		k_thread_name_set(&rx_classes[i].work_q.thread, "rx_workq");
+
+#if defined(CONFIG_NET_RX_FLOW_QUEUES_PIN)
+		rx_queue_pin(&rx_classes[i].work_q.thread,
+			     (i % NET_RX_FLOW_QUEUES) % CONFIG_MP_NUM_CPUS);
+#endif
 	}
 }
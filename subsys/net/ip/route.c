@@ -16,6 +16,8 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 #include <limits.h>
 #include <zephyr/types.h>
 #include <sys/slist.h>
+#include <sys/dlist.h>
+#include <sys/byteorder.h>
 
 #include <net/net_pkt.h>
 #include <net/net_core.h>
@@ -36,7 +38,7 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 /* We keep track of the routes in a separate list so that we can remove
  * the oldest routes (at tail) if needed.
  */
-static sys_slist_t routes;
+static sys_dlist_t routes = SYS_DLIST_STATIC_INIT(&routes);
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -86,6 +88,21 @@ static struct net_nbr *get_nexthop_route(void)
 	return NULL;
 }
 
+static void put_nexthop_route(struct net_route_nexthop *nexthop_route)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_NET_MAX_NEXTHOPS; i++) {
+		struct net_nbr *nbr = get_nexthop_nbr(
+			(struct net_nbr *)net_route_nexthop_pool, i);
+
+		if (nbr->ref && nbr->data == (u8_t *)nexthop_route) {
+			net_nbr_unref(nbr);
+			return;
+		}
+	}
+}
+
 static void net_route_entry_remove(struct net_nbr *nbr)
 {
 	NET_DBG("Route %p removed", nbr);
@@ -252,12 +269,229 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 /* Route was accessed, so place it in front of the routes list */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_remove(&route->node);
+	sys_dlist_prepend(&routes, &route->node);
 }
 
-struct net_route_entry *net_route_lookup(struct net_if *iface,
-					 struct in6_addr *dst)
+#if defined(CONFIG_NET_ROUTE_TRIE)
+/*
+ * Path compressed binary trie of the route prefixes. A node either holds
+ * the routes to its prefix or, when it has two children, only tells where
+ * the prefixes below it differ. Routes with the same prefix on different
+ * interfaces share a node. N routes need at most 2 * N - 1 nodes.
+ */
+struct route_trie_node {
+	struct route_trie_node *parent;
+	struct route_trie_node *child[2];
+
+	/** Routes to this prefix */
+	sys_slist_t routes;
+
+	/** Only the first prefix_len bits are meaningful */
+	struct in6_addr prefix;
+	u8_t prefix_len;
+};
+
+static struct route_trie_node route_trie_nodes[2 * CONFIG_NET_MAX_ROUTES];
+static struct route_trie_node *route_trie_root;
+
+/* Unused nodes, linked through child[0] */
+static struct route_trie_node *route_trie_free;
+
+static inline int addr_bit(const struct in6_addr *addr, u8_t bit)
+{
+	return (addr->s6_addr[bit / 8U] >> (7 - (bit % 8U))) & 1;
+}
+
+/* Length of the common prefix of two addresses, at most max bits */
+static u8_t common_prefix_len(const struct in6_addr *a,
+			      const struct in6_addr *b, u8_t max)
+{
+	u8_t len = 0U;
+	int i;
+
+	for (i = 0; i < 16 && len < max; i++) {
+		u8_t diff = a->s6_addr[i] ^ b->s6_addr[i];
+
+		if (diff) {
+			len += __builtin_clz(diff) - 24;
+			break;
+		}
+
+		len += 8U;
+	}
+
+	return MIN(len, max);
+}
+
+static struct route_trie_node *route_trie_node_alloc(struct in6_addr *prefix,
+						     u8_t prefix_len)
+{
+	struct route_trie_node *node = route_trie_free;
+
+	NET_ASSERT(node);
+
+	route_trie_free = node->child[0];
+
+	(void)memset(node, 0, sizeof(*node));
+	net_ipaddr_copy(&node->prefix, prefix);
+	node->prefix_len = prefix_len;
+
+	return node;
+}
+
+static void route_trie_node_free(struct route_trie_node *node)
+{
+	node->child[0] = route_trie_free;
+	route_trie_free = node;
+}
+
+/* Where the parent points to the node */
+static struct route_trie_node **route_trie_link(struct route_trie_node *node)
+{
+	if (!node->parent) {
+		return &route_trie_root;
+	}
+
+	return &node->parent->child[addr_bit(&node->prefix,
+					     node->parent->prefix_len)];
+}
+
+static void route_trie_insert(struct net_route_entry *route)
+{
+	struct route_trie_node **link = &route_trie_root;
+	struct route_trie_node *parent = NULL;
+	struct route_trie_node *node, *new, *split;
+	u8_t len = route->prefix_len;
+	u8_t common = 0U;
+
+	while ((node = *link)) {
+		common = common_prefix_len(&route->addr, &node->prefix,
+					   MIN(len, node->prefix_len));
+		if (common < node->prefix_len) {
+			break;
+		}
+
+		if (node->prefix_len == len) {
+			sys_slist_prepend(&node->routes, &route->prefix_node);
+			return;
+		}
+
+		parent = node;
+		link = &node->child[addr_bit(&route->addr, node->prefix_len)];
+	}
+
+	/* There are enough nodes for any set of routes, see above */
+	new = route_trie_node_alloc(&route->addr, len);
+	sys_slist_prepend(&new->routes, &route->prefix_node);
+
+	if (!node) {
+		/* Nothing below, the new prefix becomes a leaf */
+		split = new;
+	} else if (common == len) {
+		/* The new prefix covers the node */
+		new->child[addr_bit(&node->prefix, len)] = node;
+		node->parent = new;
+		split = new;
+	} else {
+		/* The prefixes differ at bit common */
+		split = route_trie_node_alloc(&route->addr, common);
+		split->child[addr_bit(&route->addr, common)] = new;
+		split->child[addr_bit(&node->prefix, common)] = node;
+		new->parent = split;
+		node->parent = split;
+	}
+
+	split->parent = parent;
+	*link = split;
+}
+
+static void route_trie_remove(struct net_route_entry *route)
+{
+	struct route_trie_node *node = route_trie_root;
+
+	while (node && node->prefix_len < route->prefix_len) {
+		node = node->child[addr_bit(&route->addr, node->prefix_len)];
+	}
+
+	if (!node ||
+	    !sys_slist_find_and_remove(&node->routes, &route->prefix_node)) {
+		return;
+	}
+
+	/* Drop the nodes that no longer hold routes nor tell two subtrees
+	 * apart.
+	 */
+	while (node && sys_slist_is_empty(&node->routes) &&
+	       !(node->child[0] && node->child[1])) {
+		struct route_trie_node *parent = node->parent;
+		struct route_trie_node *child = node->child[0] ?
+			node->child[0] : node->child[1];
+
+		if (child) {
+			child->parent = parent;
+		}
+
+		*route_trie_link(node) = child;
+		route_trie_node_free(node);
+
+		node = parent;
+	}
+}
+
+static void route_trie_init(void)
+{
+	int i;
+
+	route_trie_root = NULL;
+	route_trie_free = NULL;
+
+	for (i = 0; i < ARRAY_SIZE(route_trie_nodes); i++) {
+		route_trie_node_free(&route_trie_nodes[i]);
+	}
+}
+
+static struct net_route_entry *route_find(struct net_if *iface,
+					  struct in6_addr *dst)
+{
+	struct route_trie_node *node = route_trie_root;
+	struct net_route_entry *route, *found = NULL;
+
+	while (node && net_ipv6_is_prefix((u8_t *)dst,
+					  (u8_t *)&node->prefix,
+					  node->prefix_len)) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&node->routes, route,
+					     prefix_node) {
+			if (!iface || route->iface == iface) {
+				found = route;
+				break;
+			}
+		}
+
+		if (node->prefix_len == 128) {
+			break;
+		}
+
+		node = node->child[addr_bit(dst, node->prefix_len)];
+	}
+
+	return found;
+}
+#else
+static inline void route_trie_insert(struct net_route_entry *route)
+{
+}
+
+static inline void route_trie_remove(struct net_route_entry *route)
+{
+}
+
+static inline void route_trie_init(void)
+{
+}
+
+static struct net_route_entry *route_find(struct net_if *iface,
+					  struct in6_addr *dst)
 {
 	struct net_route_entry *route, *found = NULL;
 	u8_t longest_match = 0U;
@@ -285,6 +519,97 @@ struct net_route_entry *net_route_lookup(struct net_if *iface,
 		}
 	}
 
+	return found;
+}
+#endif /* CONFIG_NET_ROUTE_TRIE */
+
+#if CONFIG_NET_ROUTE_CACHE_SIZE > 0
+/*
+ * Direct mapped cache of the routes to recently used destinations. It is
+ * emptied whenever a route is added or deleted.
+ */
+struct route_cache_entry {
+	struct in6_addr dst;
+	struct net_if *iface;
+	struct net_route_entry *route;
+};
+
+static struct route_cache_entry route_cache[CONFIG_NET_ROUTE_CACHE_SIZE];
+
+static struct route_cache_entry *route_cache_slot(struct net_if *iface,
+						  struct in6_addr *dst)
+{
+	u32_t hash = (u32_t)(uintptr_t)iface;
+	int i;
+
+	for (i = 0; i < 16; i += 4) {
+		hash ^= sys_get_be32(&dst->s6_addr[i]);
+	}
+
+	/* Fibonacci hashing spreads the interface ids over the slots */
+	hash *= 2654435769U;
+
+	return &route_cache[(hash >> 16) % CONFIG_NET_ROUTE_CACHE_SIZE];
+}
+
+static struct net_route_entry *route_cache_get(struct net_if *iface,
+					       struct in6_addr *dst)
+{
+	struct route_cache_entry *slot = route_cache_slot(iface, dst);
+
+	if (slot->route && slot->iface == iface &&
+	    net_ipv6_addr_cmp(&slot->dst, dst)) {
+		return slot->route;
+	}
+
+	return NULL;
+}
+
+static void route_cache_put(struct net_if *iface, struct in6_addr *dst,
+			    struct net_route_entry *route)
+{
+	struct route_cache_entry *slot = route_cache_slot(iface, dst);
+
+	net_ipaddr_copy(&slot->dst, dst);
+	slot->iface = iface;
+	slot->route = route;
+}
+
+static inline void route_cache_flush(void)
+{
+	(void)memset(route_cache, 0, sizeof(route_cache));
+}
+#else
+static inline struct net_route_entry *route_cache_get(struct net_if *iface,
+						      struct in6_addr *dst)
+{
+	return NULL;
+}
+
+static inline void route_cache_put(struct net_if *iface,
+				   struct in6_addr *dst,
+				   struct net_route_entry *route)
+{
+}
+
+static inline void route_cache_flush(void)
+{
+}
+#endif /* CONFIG_NET_ROUTE_CACHE_SIZE > 0 */
+
+struct net_route_entry *net_route_lookup(struct net_if *iface,
+					 struct in6_addr *dst)
+{
+	struct net_route_entry *found;
+
+	found = route_cache_get(iface, dst);
+	if (!found) {
+		found = route_find(iface, dst);
+		if (found) {
+			route_cache_put(iface, dst, found);
+		}
+	}
+
 	if (found) {
 		net_route_info("Found", found, dst);
 
@@ -316,6 +641,11 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 		return NULL;
 	}
 
+	if (prefix_len > 128) {
+		NET_DBG("Invalid prefix length %d", prefix_len);
+		return NULL;
+	}
+
 	nbr_nexthop = net_ipv6_nbr_lookup(iface, nexthop);
 	if (!nbr_nexthop) {
 		NET_DBG("No such neighbor %s found",
@@ -352,9 +682,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
 		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
+		sys_dnode_t *last = sys_dlist_peek_tail(&routes);
 
 		route = CONTAINER_OF(last,
 				     struct net_route_entry,
@@ -400,7 +728,9 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	route = net_route_data(nbr);
 	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+	sys_dlist_prepend(&routes, &route->node);
+	route_trie_insert(route);
+	route_cache_flush();
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -453,13 +783,18 @@ int net_route_del(struct net_route_entry *route)
 	net_mgmt_event_notify(NET_EVENT_IPV6_ROUTE_DEL, route->iface);
 #endif
 
-	sys_slist_find_and_remove(&routes, &route->node);
+	if (sys_dnode_is_linked(&route->node)) {
+		sys_dlist_remove(&route->node);
+	}
 
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
 		return -ENOENT;
 	}
 
+	route_trie_remove(route);
+	route_cache_flush();
+
 	net_route_info("Deleted", route, &route->addr);
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&route->nexthop, nexthop_route, node) {
@@ -468,6 +803,7 @@ int net_route_del(struct net_route_entry *route)
 		}
 
 		nbr_nexthop_put(nexthop_route->nbr);
+		put_nexthop_route(nexthop_route);
 	}
 
 	nbr_free(nbr);
@@ -826,6 +1162,8 @@ int net_route_packet(struct net_pkt *pkt, struct in6_addr *nexthop)
 
 void net_route_init(void)
 {
+	route_trie_init();
+
 	NET_DBG("Allocated %d routing entries (%zu bytes)",
 		CONFIG_NET_MAX_ROUTES, sizeof(net_route_entries_pool));
 
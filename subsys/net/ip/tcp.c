@@ -34,10 +34,18 @@ LOG_MODULE_REGISTER(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
 #include "tcp_internal.h"
 #include "net_stats.h"
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+#include "tcp_cc.h"
+#endif
+
 #define ALLOC_TIMEOUT K_MSEC(500)
 
 static int net_tcp_queue_pkt(struct net_context *context, struct net_pkt *pkt);
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+static void tcp_cc_timeout(struct net_tcp *tcp, struct net_pkt *pkt);
+#endif
+
 /*
  * Each TCP connection needs to be tracked by net_context, so
  * we need to allocate equal number of control structures here.
@@ -52,6 +60,9 @@ static struct tcp_backlog_entry {
 	struct k_delayed_work ack_timer;
 	struct sockaddr remote;
 	u16_t send_mss;
+#if defined(CONFIG_NET_TCP_SACK)
+	bool sack_permitted;
+#endif
 } tcp_backlog[CONFIG_NET_TCP_BACKLOG_SIZE];
 
 #if defined(CONFIG_NET_TCP_ACK_TIMEOUT)
@@ -62,6 +73,9 @@ static struct tcp_backlog_entry {
 
 #define FIN_TIMEOUT K_SECONDS(1)
 
+/* Number of duplicate ACKs after which the missing data is retransmitted */
+#define DUP_ACK_THRESHOLD 3
+
 /* Declares a wrapper function for a net_conn callback that refs the
  * context around the invocation (to protect it from premature
  * deletion).  Long term would be nice to see this feature be part of
@@ -163,8 +177,12 @@ static void net_tcp_trace(struct net_pkt *pkt,
 
 static inline u32_t retry_timeout(const struct net_tcp *tcp)
 {
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	return ((u32_t)1 << tcp->retry_timeout_shift) * tcp->rto;
+#else
 	return ((u32_t)1 << tcp->retry_timeout_shift) *
 				CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
+#endif
 }
 
 #define is_6lo_technology(pkt)						\
@@ -210,6 +228,36 @@ static void abort_connection(struct net_tcp *tcp)
 	net_context_unref(ctx);
 }
 
+/* Send again a packet of the sent list */
+static void tcp_retransmit(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	if (net_pkt_sent(pkt)) {
+		do_ref_if_needed(tcp, pkt);
+		net_pkt_set_sent(pkt, false);
+	}
+
+	net_pkt_set_queued(pkt, true);
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	/* No round-trip time sample from an ambiguous ACK (Karn) */
+	tcp->flags &= ~NET_TCP_RTT_PENDING;
+	tcp->cc_stats.rexmits++;
+#endif
+
+	if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
+		NET_DBG("retry %u: [%p] pkt %p send failed",
+			tcp->retry_timeout_shift, tcp, pkt);
+		net_pkt_unref(pkt);
+	} else {
+		NET_DBG("retry %u: [%p] sent pkt %p",
+			tcp->retry_timeout_shift, tcp, pkt);
+		if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
+		    !is_6lo_technology(pkt)) {
+			net_stats_update_tcp_seg_rexmit(net_pkt_iface(pkt));
+		}
+	}
+}
+
 static void tcp_retry_expired(struct k_work *work)
 {
 	struct net_tcp *tcp = CONTAINER_OF(work, struct net_tcp, retry_timer);
@@ -228,29 +276,23 @@ static void tcp_retry_expired(struct k_work *work)
 
 		k_delayed_work_submit(&tcp->retry_timer, retry_timeout(tcp));
 
+#if defined(CONFIG_NET_TCP_SACK)
+		/* What the peer reported may be stale by now, recover from
+		 * the first unacknowledged segment (RFC 6675 section 5.1).
+		 */
+		tcp->flags &= ~NET_TCP_IN_RECOVERY;
+		tcp->sacked_count = 0U;
+		tcp->dup_acks = 0U;
+#endif
+
 		pkt = CONTAINER_OF(sys_slist_peek_head(&tcp->sent_list),
 				   struct net_pkt, sent_list);
 
-		if (net_pkt_sent(pkt)) {
-			do_ref_if_needed(tcp, pkt);
-			net_pkt_set_sent(pkt, false);
-		}
-
-		net_pkt_set_queued(pkt, true);
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+		tcp_cc_timeout(tcp, pkt);
+#endif
 
-		if (net_tcp_send_pkt(pkt) < 0 && !is_6lo_technology(pkt)) {
-			NET_DBG("retry %u: [%p] pkt %p send failed",
-				tcp->retry_timeout_shift, tcp, pkt);
-			net_pkt_unref(pkt);
-		} else {
-			NET_DBG("retry %u: [%p] sent pkt %p",
-				tcp->retry_timeout_shift, tcp, pkt);
-			if (IS_ENABLED(CONFIG_NET_STATISTICS_TCP) &&
-			    !is_6lo_technology(pkt)) {
-				net_stats_update_tcp_seg_rexmit(
-							net_pkt_iface(pkt));
-			}
-		}
+		tcp_retransmit(tcp, pkt);
 	} else if (CONFIG_NET_TCP_TIME_WAIT_DELAY != 0) {
 		if (tcp->fin_sent && tcp->fin_rcvd) {
 			NET_DBG("[%p] Closing connection (context %p)",
@@ -286,6 +328,9 @@ struct net_tcp *net_tcp_alloc(struct net_context *context)
 	tcp_context[i].send_seq = tcp_init_isn();
 	tcp_context[i].recv_wnd = MIN(NET_TCP_MAX_WIN, NET_TCP_BUF_MAX_LEN);
 	tcp_context[i].send_mss = NET_TCP_DEFAULT_MSS;
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	tcp_context[i].rto = CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
+#endif
 
 	tcp_context[i].accept_cb = NULL;
 
@@ -315,6 +360,375 @@ static void timewait_timer_cancel(struct net_tcp *tcp)
 	k_delayed_work_cancel(&tcp->timewait_timer);
 }
 
+#if defined(CONFIG_NET_TCP_SACK)
+/* Sequence number, data length and optionally flags of a TCP packet, its
+ * cursor is left untouched.
+ */
+static int tcp_pkt_segment(struct net_pkt *pkt, u32_t *seq, u32_t *len,
+			   u8_t *flags)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+	size_t hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ipv6_ext_len(pkt);
+	bool overwrite = net_pkt_is_being_overwritten(pkt);
+	struct net_tcp_hdr *tcp_hdr = NULL;
+	struct net_pkt_cursor backup;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (!net_pkt_skip(pkt, hdr_len)) {
+		tcp_hdr = (struct net_tcp_hdr *)net_pkt_get_data(pkt,
+								 &tcp_access);
+	}
+
+	if (tcp_hdr) {
+		*seq = sys_get_be32(tcp_hdr->seq);
+		*len = net_pkt_get_len(pkt) - hdr_len -
+			NET_TCP_HDR_LEN(tcp_hdr);
+
+		if (flags) {
+			*flags = NET_TCP_FLAGS(tcp_hdr);
+		}
+	}
+
+	net_pkt_cursor_restore(pkt, &backup);
+	net_pkt_set_overwrite(pkt, overwrite);
+
+	if (!tcp_hdr) {
+		NET_ERR("pkt %p has no TCP header", pkt);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static u8_t tcp_pkt_bufs(struct net_pkt *pkt)
+{
+	struct net_buf *buf;
+	u8_t count = 0U;
+
+	for (buf = pkt->buffer; buf; buf = buf->frags) {
+		count++;
+	}
+
+	return count;
+}
+
+static void tcp_ooo_flush(struct net_tcp *tcp)
+{
+	struct net_pkt *pkt;
+
+	while ((pkt = SYS_SLIST_PEEK_HEAD_CONTAINER(&tcp->ooo_list, pkt,
+						    sent_list))) {
+		sys_slist_remove(&tcp->ooo_list, NULL, &pkt->sent_list);
+		net_pkt_unref(pkt);
+	}
+
+	tcp->ooo_bufs = 0U;
+}
+#endif /* CONFIG_NET_TCP_SACK */
+
+enum tcp_cc_event {
+	/* New data acknowledged outside of a recovery */
+	TCP_CC_ACK,
+	/* Duplicate ACKs started a recovery */
+	TCP_CC_RECOVERY,
+	/* A duplicate ACK during the recovery */
+	TCP_CC_DUP_ACK,
+	/* Some but not all of the data sent before the recovery ACKed */
+	TCP_CC_PARTIAL_ACK,
+	/* All of the data sent before the recovery ACKed */
+	TCP_CC_RECOVERED,
+};
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+#define TCP_CC_DEFAULT net_tcp_cc_cubic
+#else
+#define TCP_CC_DEFAULT net_tcp_cc_newreno
+#endif
+
+static void tcp_cc_established(struct net_tcp *tcp,
+			       struct net_tcp_hdr *tcp_hdr)
+{
+	u32_t mss;
+
+	tcp->cc = &TCP_CC_DEFAULT;
+	tcp->snd_una = tcp->send_seq;
+	tcp->snd_nxt = tcp->send_seq;
+	tcp->send_wnd = sys_get_be16(tcp_hdr->wnd);
+
+	/* Initial window of RFC 5681 */
+	mss = net_tcp_cc_mss(tcp);
+	tcp->cwnd = MIN(4 * mss, MAX(2 * mss, 4380));
+	tcp->ssthresh = UINT32_MAX;
+
+	tcp->cc->init(tcp);
+}
+
+/* Round-trip time estimation of RFC 6298, with the scaling of srtt and
+ * rttvar used by Jacobson.
+ */
+static void tcp_rtt_sample(struct net_tcp *tcp, u32_t rtt)
+{
+	s32_t err;
+
+	if (!(tcp->flags & NET_TCP_RTT_VALID)) {
+		tcp->srtt = rtt << 3;
+		tcp->rttvar = rtt << 1;
+		tcp->flags |= NET_TCP_RTT_VALID;
+	} else {
+		err = rtt - (tcp->srtt >> 3);
+		tcp->srtt += err;
+
+		if (err < 0) {
+			err = -err;
+		}
+
+		tcp->rttvar += err - (tcp->rttvar >> 2);
+	}
+
+	tcp->rto = MAX((tcp->srtt >> 3) + MAX(tcp->rttvar, 1U),
+		       CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT);
+
+	NET_DBG("[%p] rtt %u srtt %u rttvar %u rto %u", tcp, rtt,
+		tcp->srtt >> 3, tcp->rttvar >> 2, tcp->rto);
+}
+
+/* Account for an ACK, returns the number of bytes it acknowledged */
+static u32_t tcp_cc_ack(struct net_tcp *tcp, struct net_tcp_hdr *tcp_hdr)
+{
+	u32_t ack = sys_get_be32(tcp_hdr->ack);
+	u32_t acked;
+
+	if (!tcp->cc) {
+		return 0;
+	}
+
+	tcp->send_wnd = sys_get_be16(tcp_hdr->wnd);
+
+	if (!net_tcp_seq_greater(ack, tcp->snd_una)) {
+		return 0;
+	}
+
+	acked = ack - tcp->snd_una;
+	tcp->snd_una = ack;
+
+	/* What was sent before a retransmission timeout got through */
+	if (net_tcp_seq_greater(ack, tcp->snd_nxt)) {
+		tcp->snd_nxt = ack;
+	}
+
+	if ((tcp->flags & NET_TCP_RTT_PENDING) &&
+	    !net_tcp_seq_greater(tcp->rtt_seq, ack)) {
+		tcp->flags &= ~NET_TCP_RTT_PENDING;
+		tcp_rtt_sample(tcp, k_uptime_get_32() - tcp->rtt_start);
+	}
+
+	return acked;
+}
+
+/* The window only grows while it limits the sender (RFC 7661). In slow
+ * start, when it was at least half used.
+ */
+static bool tcp_cc_limited(struct net_tcp *tcp, u32_t acked)
+{
+	u32_t flight = net_tcp_cc_flight(tcp) + acked;
+
+	if (tcp->cwnd < tcp->ssthresh) {
+		return 2 * flight >= tcp->cwnd;
+	}
+
+	return flight + net_tcp_cc_mss(tcp) >= tcp->cwnd;
+}
+
+/* The loss recovery tells how the window changes, see
+ * tcp_sack_received(). During a recovery the window is inflated by the
+ * duplicate ACKs, as in RFC 5681 and RFC 6582.
+ */
+static void tcp_cc_update(struct net_tcp *tcp, enum tcp_cc_event event,
+			  u32_t acked)
+{
+	u32_t mss;
+
+	if (!tcp->cc) {
+		return;
+	}
+
+	mss = net_tcp_cc_mss(tcp);
+
+	switch (event) {
+	case TCP_CC_ACK:
+		if (acked && tcp_cc_limited(tcp, acked)) {
+			tcp->cc->ack(tcp, acked);
+		}
+
+		break;
+
+	case TCP_CC_RECOVERY:
+		tcp->ssthresh = tcp->cc->ssthresh(tcp);
+		tcp->cwnd = tcp->ssthresh + DUP_ACK_THRESHOLD * mss;
+		tcp->cc_stats.recoveries++;
+		break;
+
+	case TCP_CC_DUP_ACK:
+		tcp->cwnd += mss;
+		break;
+
+	case TCP_CC_PARTIAL_ACK:
+		tcp->cwnd -= MIN(acked, tcp->cwnd - mss);
+
+		if (acked >= mss) {
+			tcp->cwnd += mss;
+		}
+
+		break;
+
+	case TCP_CC_RECOVERED:
+		tcp->cwnd = MIN(tcp->ssthresh,
+				MAX(net_tcp_cc_flight(tcp), mss) + mss);
+		break;
+	}
+
+	NET_DBG("[%p] event %d cwnd %u ssthresh %u flight %u", tcp, event,
+		tcp->cwnd, tcp->ssthresh, net_tcp_cc_flight(tcp));
+}
+
+/* Start over from the first unacknowledged segment, which the caller
+ * retransmits, with a window of one segment. The following ones are
+ * sent again as the ACKs open the window.
+ */
+static void tcp_cc_timeout(struct net_tcp *tcp, struct net_pkt *pkt)
+{
+	u32_t seq, len;
+	u8_t flags;
+
+	if (!tcp->cc) {
+		return;
+	}
+
+	/* Nothing is lost if nothing was sent, the window of the peer
+	 * was closed and this probes it. Only the first timeout reduces
+	 * the slow start threshold, the window in use is gone by the next
+	 * ones.
+	 */
+	if (net_tcp_cc_flight(tcp)) {
+		if (tcp->retry_timeout_shift == 1U) {
+			tcp->ssthresh = tcp->cc->ssthresh(tcp);
+		}
+
+		tcp->cwnd = net_tcp_cc_mss(tcp);
+		tcp->cc_stats.timeouts++;
+	}
+
+	tcp->snd_nxt = tcp->snd_una;
+
+	if (!tcp_pkt_segment(pkt, &seq, &len, &flags)) {
+		if (flags & (NET_TCP_SYN | NET_TCP_FIN)) {
+			len++;
+		}
+
+		tcp->snd_nxt = seq + len;
+	}
+}
+
+/* Send the queued segments the congestion window and the window of the
+ * peer leave room for, returns false if the connection does not use
+ * congestion control yet.
+ */
+static bool tcp_cc_send(struct net_tcp *tcp)
+{
+	u32_t wnd = MIN(tcp->cwnd, tcp->send_wnd);
+	struct net_pkt *pkt;
+	u32_t seq, len;
+	u32_t flight;
+	u8_t flags;
+	int ret;
+
+	if (!tcp->cc) {
+		return false;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (tcp_pkt_segment(pkt, &seq, &len, &flags) < 0) {
+			break;
+		}
+
+		/* In flight already */
+		if (net_tcp_seq_greater(tcp->snd_nxt, seq)) {
+			continue;
+		}
+
+		/* Not yet sent since the timeout moved snd_nxt back */
+		if (net_pkt_queued(pkt)) {
+			break;
+		}
+
+		if (flags & (NET_TCP_SYN | NET_TCP_FIN)) {
+			len++;
+		}
+
+		/* A segment larger than the window goes alone */
+		flight = net_tcp_cc_flight(tcp);
+		if (flight + len > wnd && (flight || !tcp->send_wnd)) {
+			break;
+		}
+
+		if (net_pkt_sent(pkt)) {
+			tcp_retransmit(tcp, pkt);
+		} else {
+			NET_DBG("[%p] Sending pkt %p (%zd bytes)", tcp, pkt,
+				net_pkt_get_len(pkt));
+
+			/* Marked first, the Tx thread may be done with the
+			 * packet before net_tcp_send_pkt() returns.
+			 */
+			net_pkt_set_queued(pkt, true);
+
+			ret = net_tcp_send_pkt(pkt);
+			if (ret < 0 && !is_6lo_technology(pkt)) {
+				NET_DBG("[%p] pkt %p not sent (%d)", tcp, pkt,
+					ret);
+				net_pkt_set_queued(pkt, false);
+				net_pkt_unref(pkt);
+			}
+
+			if (!(tcp->flags & NET_TCP_RTT_PENDING)) {
+				tcp->flags |= NET_TCP_RTT_PENDING;
+				tcp->rtt_seq = seq + len;
+				tcp->rtt_start = k_uptime_get_32();
+			}
+		}
+
+		tcp->snd_nxt = seq + len;
+	}
+
+	return true;
+}
+#else
+static inline void tcp_cc_established(struct net_tcp *tcp,
+				      struct net_tcp_hdr *tcp_hdr)
+{
+}
+
+static inline u32_t tcp_cc_ack(struct net_tcp *tcp,
+			       struct net_tcp_hdr *tcp_hdr)
+{
+	return 0;
+}
+
+static inline void tcp_cc_update(struct net_tcp *tcp,
+				 enum tcp_cc_event event, u32_t acked)
+{
+}
+
+static inline bool tcp_cc_send(struct net_tcp *tcp)
+{
+	return false;
+}
+#endif /* CONFIG_NET_TCP_CONGESTION_CONTROL */
+
 int net_tcp_release(struct net_tcp *tcp)
 {
 	struct net_pkt *pkt;
@@ -331,6 +745,10 @@ int net_tcp_release(struct net_tcp *tcp)
 		net_pkt_unref(pkt);
 	}
 
+#if defined(CONFIG_NET_TCP_SACK)
+	tcp_ooo_flush(tcp);
+#endif
+
 	retry_timer_cancel(tcp);
 	k_sem_reset(&tcp->connect_wait);
 
@@ -657,6 +1075,36 @@ u16_t net_tcp_get_recv_mss(const struct net_tcp *tcp)
 	return 0;
 }
 
+/* SACK is offered in the SYN, and accepted in the SYN-ACK if it was
+ * offered by the peer (RFC 2018 section 2).
+ */
+static void tcp_set_sack_perm_opt(struct net_tcp *tcp, u8_t *options,
+				  u8_t *optionlen)
+{
+	if (!IS_ENABLED(CONFIG_NET_TCP_SACK) ||
+	    (net_tcp_get_state(tcp) == NET_TCP_SYN_RCVD &&
+	     !(tcp->flags & NET_TCP_SACK_PERMITTED))) {
+		return;
+	}
+
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_PERM_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_PERM_SIZE;
+}
+
+static void tcp_set_sack_permitted(struct net_tcp *tcp,
+				   const struct net_tcp_options *opts)
+{
+#if defined(CONFIG_NET_TCP_SACK)
+	if (opts->sack_permitted) {
+		tcp->flags |= NET_TCP_SACK_PERMITTED;
+	} else {
+		tcp->flags &= ~NET_TCP_SACK_PERMITTED;
+	}
+#endif
+}
+
 static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 				u8_t *optionlen)
 {
@@ -676,12 +1124,78 @@ static void net_tcp_set_syn_opt(struct net_tcp *tcp, u8_t *options,
 		      (u32_t *)(options + *optionlen));
 
 	*optionlen += NET_TCP_MSS_SIZE;
+
+	tcp_set_sack_perm_opt(tcp, options, optionlen);
+}
+
+#if defined(CONFIG_NET_TCP_SACK)
+/* Report the queued out-of-order segments, the block holding the latest
+ * one first (RFC 2018 section 4).
+ */
+static void tcp_set_sack_opt(struct net_tcp *tcp, u8_t *options,
+			     u8_t *optionlen)
+{
+	struct net_tcp_sack_block blocks[NET_TCP_SACK_MAX_BLOCKS];
+	struct net_tcp_sack_block *block;
+	struct net_pkt *pkt;
+	int count = 0;
+	int first = 0;
+	u32_t seq, len;
+	int i;
+
+	*optionlen = 0U;
+
+	if (!(tcp->flags & NET_TCP_SACK_PERMITTED)) {
+		return;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, pkt, sent_list) {
+		if (tcp_pkt_segment(pkt, &seq, &len, NULL) < 0) {
+			continue;
+		}
+
+		block = count > 0 ? &blocks[count - 1] : NULL;
+
+		if (block && !net_tcp_seq_greater(seq, block->right)) {
+			if (net_tcp_seq_greater(seq + len, block->right)) {
+				block->right = seq + len;
+			}
+		} else if (count < NET_TCP_SACK_MAX_BLOCKS) {
+			blocks[count].left = seq;
+			blocks[count].right = seq + len;
+			count++;
+		} else {
+			break;
+		}
+
+		if (seq == tcp->ooo_last_seq) {
+			first = count - 1;
+		}
+	}
+
+	if (!count) {
+		return;
+	}
+
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_NOP_OPT;
+	options[(*optionlen)++] = NET_TCP_SACK_OPT;
+	options[(*optionlen)++] = 2 + count * NET_TCP_SACK_BLOCK_SIZE;
+
+	for (i = 0; i < count; i++) {
+		block = &blocks[(first + i) % count];
+
+		sys_put_be32(block->left, options + *optionlen);
+		sys_put_be32(block->right, options + *optionlen + 4);
+		*optionlen += NET_TCP_SACK_BLOCK_SIZE;
+	}
 }
+#endif /* CONFIG_NET_TCP_SACK */
 
 int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 			struct net_pkt **pkt)
 {
-	u8_t options[NET_TCP_MAX_OPT_SIZE];
+	u8_t options[MAX(NET_TCP_MAX_OPT_SIZE, NET_TCP_SACK_MAX_OPT_SIZE)];
 	u8_t optionlen;
 
 	switch (net_tcp_get_state(tcp)) {
@@ -702,8 +1216,15 @@ int net_tcp_prepare_ack(struct net_tcp *tcp, const struct sockaddr *remote,
 		return net_tcp_prepare_segment(tcp, NET_TCP_FIN | NET_TCP_ACK,
 					       0, 0, NULL, remote, pkt);
 	default:
+#if defined(CONFIG_NET_TCP_SACK)
+		tcp_set_sack_opt(tcp, options, &optionlen);
+
+		return net_tcp_prepare_segment(tcp, NET_TCP_ACK, options,
+					       optionlen, NULL, remote, pkt);
+#else
 		return net_tcp_prepare_segment(tcp, NET_TCP_ACK, 0, 0, NULL,
 					       remote, pkt);
+#endif
 	}
 
 	return -EINVAL;
@@ -806,6 +1327,7 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 {
 	struct net_conn *conn = (struct net_conn *)context->conn_handler;
 	size_t data_len = net_pkt_get_len(pkt);
+	u16_t mss;
 	int ret;
 
 	NET_DBG("[%p] Queue %p len %zd", context->tcp, pkt, data_len);
@@ -819,6 +1341,15 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 		return -ESHUTDOWN;
 	}
 
+	/* A packet larger than one segment is split by the device. The
+	 * segments have the size the MTU would limit the packet to
+	 * without segmentation offload.
+	 */
+	mss = net_tcp_get_recv_mss(context->tcp);
+	if (data_len > mss && net_if_supports_tso(net_pkt_iface(pkt))) {
+		net_pkt_set_tso_mss(pkt, mss);
+	}
+
 	/* Set PSH on all packets, our window is so small that there's
 	 * no point in the remote side trying to finesse things and
 	 * coalesce packets.
@@ -854,12 +1385,27 @@ static int net_tcp_queue_pkt(struct net_context *context, struct net_pkt *pkt)
 	return 0;
 }
 
+/* Rewrite a 16-bit aligned part of the header of an already finalized
+ * segment, updating the checksum incrementally rather than summing the
+ * whole segment again.
+ */
+static void tcp_hdr_update(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
+			   void *field, const void *data, size_t len)
+{
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt)) &&
+	    !net_pkt_tso_mss(pkt)) {
+		tcp_hdr->chksum = net_calc_chksum_update(tcp_hdr->chksum,
+							 field, data, len);
+	}
+
+	memcpy(field, data, len);
+}
+
 int net_tcp_send_pkt(struct net_pkt *pkt)
 {
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
 	struct net_context *ctx = net_pkt_context(pkt);
 	struct net_tcp_hdr *tcp_hdr;
-	bool calc_chksum = false;
 
 	if (!ctx || !ctx->tcp) {
 		NET_ERR("%scontext is not set on pkt %p",
@@ -882,9 +1428,10 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 	}
 
 	if (sys_get_be32(tcp_hdr->ack) != ctx->tcp->send_ack) {
-		sys_put_be32(ctx->tcp->send_ack, tcp_hdr->ack);
-		tcp_hdr->chksum = 0U;
-		calc_chksum = true;
+		u8_t ack[4];
+
+		sys_put_be32(ctx->tcp->send_ack, ack);
+		tcp_hdr_update(pkt, tcp_hdr, tcp_hdr->ack, ack, sizeof(ack));
 	}
 
 	/* The data stream code always sets this flag, because
@@ -894,26 +1441,19 @@ int net_tcp_send_pkt(struct net_pkt *pkt)
 	 */
 	if (ctx->tcp->sent_ack != ctx->tcp->send_ack &&
 		(tcp_hdr->flags & NET_TCP_ACK) == 0U) {
-		tcp_hdr->flags |= NET_TCP_ACK;
-		tcp_hdr->chksum = 0U;
-		calc_chksum = true;
+		/* The offset and flags bytes form one checksummed word */
+		u8_t offset_flags[2] = {
+			tcp_hdr->offset, tcp_hdr->flags | NET_TCP_ACK
+		};
+
+		tcp_hdr_update(pkt, tcp_hdr, &tcp_hdr->offset, offset_flags,
+			       sizeof(offset_flags));
 	}
 
 	/* As we modified the header, we need to write it back.
 	 */
 	net_pkt_set_data(pkt, &tcp_access);
 
-	if (calc_chksum) {
-		net_pkt_cursor_init(pkt);
-		net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
-			     net_pkt_ipv6_ext_len(pkt));
-
-		/* No need to get tcp_hdr again */
-		tcp_hdr->chksum = net_calc_chksum_tcp(pkt);
-
-		net_pkt_set_data(pkt, &tcp_access);
-	}
-
 	if (tcp_hdr->flags & NET_TCP_FIN) {
 		ctx->tcp->fin_sent = 1U;
 	}
@@ -997,6 +1537,11 @@ int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
 {
 	struct net_pkt *pkt;
 
+	/* With congestion control the rest is sent as the ACKs arrive */
+	if (tcp_cc_send(context->tcp)) {
+		goto done;
+	}
+
 	/* For now, just send all queued data synchronously.  Need to
 	 * add window handling and retry/ACK logic.
 	 */
@@ -1025,6 +1570,7 @@ int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
 		}
 	}
 
+done:
 	/* Just make the callback synchronously even if it didn't
 	 * go over the wire.  In theory it would be nice to track
 	 * specific ACK locations in the stream and make the
@@ -1277,7 +1823,9 @@ int net_tcp_finalize(struct net_pkt *pkt)
 
 	tcp_hdr->chksum = 0U;
 
-	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt))) {
+	/* The device computes the checksum of each segment itself */
+	if (net_if_need_calc_tx_checksum(net_pkt_iface(pkt)) &&
+	    !net_pkt_tso_mss(pkt)) {
 		tcp_hdr->chksum = net_calc_chksum_tcp(pkt);
 	}
 
@@ -1288,6 +1836,9 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 		       struct net_tcp_options *opts)
 {
 	u8_t opt, optlen;
+#if defined(CONFIG_NET_TCP_SACK)
+	int i;
+#endif
 
 	while (opt_totlen) {
 		if (net_pkt_read_u8(pkt, &opt)) {
@@ -1339,6 +1890,35 @@ int net_tcp_parse_opts(struct net_pkt *pkt, int opt_totlen,
 			}
 
 			break;
+#if defined(CONFIG_NET_TCP_SACK)
+		case NET_TCP_SACK_PERM_OPT:
+			if (optlen != 0U) {
+				goto error;
+			}
+
+			opts->sack_permitted = true;
+			break;
+		case NET_TCP_SACK_OPT:
+			if (optlen % NET_TCP_SACK_BLOCK_SIZE) {
+				goto error;
+			}
+
+			for (i = 0; i < optlen; i += NET_TCP_SACK_BLOCK_SIZE) {
+				struct net_tcp_sack_block block;
+
+				if (net_pkt_read_be32(pkt, &block.left) ||
+				    net_pkt_read_be32(pkt, &block.right)) {
+					goto error;
+				}
+
+				if (opts->sack_count <
+				    NET_TCP_SACK_MAX_BLOCKS) {
+					opts->sack[opts->sack_count++] = block;
+				}
+			}
+
+			break;
+#endif
 		default:
 			if (net_pkt_skip(pkt, optlen)) {
 				goto error;
@@ -1577,6 +2157,10 @@ static int tcp_backlog_syn(struct net_pkt *pkt,
 	tcp_backlog[empty_slot].send_seq = context->tcp->send_seq;
 	tcp_backlog[empty_slot].send_ack = context->tcp->send_ack;
 	tcp_backlog[empty_slot].send_mss = send_mss;
+#if defined(CONFIG_NET_TCP_SACK)
+	tcp_backlog[empty_slot].sack_permitted =
+		!!(context->tcp->flags & NET_TCP_SACK_PERMITTED);
+#endif
 
 	k_delayed_work_init(&tcp_backlog[empty_slot].ack_timer,
 			    backlog_ack_timeout);
@@ -1607,6 +2191,11 @@ static int tcp_backlog_ack(struct net_pkt *pkt,
 	context->tcp->send_seq = tcp_backlog[r].send_seq + 1;
 	context->tcp->send_ack = tcp_backlog[r].send_ack;
 	context->tcp->send_mss = tcp_backlog[r].send_mss;
+#if defined(CONFIG_NET_TCP_SACK)
+	if (tcp_backlog[r].sack_permitted) {
+		context->tcp->flags |= NET_TCP_SACK_PERMITTED;
+	}
+#endif
 
 	k_delayed_work_cancel(&tcp_backlog[r].ack_timer);
 	(void)memset(&tcp_backlog[r], 0, sizeof(struct tcp_backlog_entry));
@@ -1798,6 +2387,8 @@ static inline int send_syn_segment(struct net_context *context,
 
 	if (flags == NET_TCP_SYN) {
 		net_tcp_set_syn_opt(context->tcp, options, &optionlen);
+	} else {
+		tcp_set_sack_perm_opt(context->tcp, options, &optionlen);
 	}
 
 	ret = net_tcp_prepare_segment(context->tcp, flags, options, optionlen,
@@ -1904,6 +2495,389 @@ static u16_t adjust_data_len(struct net_pkt *pkt, struct net_tcp_hdr *tcp_hdr,
 	return data_len;
 }
 
+#if defined(CONFIG_NET_TCP_SACK)
+static bool tcp_sack_covered(struct net_tcp *tcp, u32_t seq, u32_t len)
+{
+	int i;
+
+	for (i = 0; i < tcp->sacked_count; i++) {
+		if (!net_tcp_seq_greater(tcp->sacked[i].left, seq) &&
+		    !net_tcp_seq_greater(seq + len, tcp->sacked[i].right)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* Add a block to the scoreboard, merging it with those it overlaps */
+static void tcp_sack_add(struct net_tcp *tcp,
+			 struct net_tcp_sack_block block)
+{
+	struct net_tcp_sack_block *lowest = NULL;
+	int count = 0;
+	int i;
+
+	for (i = 0; i < tcp->sacked_count; i++) {
+		struct net_tcp_sack_block *cur = &tcp->sacked[i];
+
+		if (net_tcp_seq_greater(cur->left, block.right) ||
+		    net_tcp_seq_greater(block.left, cur->right)) {
+			tcp->sacked[count++] = *cur;
+			continue;
+		}
+
+		if (net_tcp_seq_greater(block.left, cur->left)) {
+			block.left = cur->left;
+		}
+
+		if (net_tcp_seq_greater(cur->right, block.right)) {
+			block.right = cur->right;
+		}
+	}
+
+	if (count == NET_TCP_SACK_MAX_BLOCKS) {
+		/* Forget about the lowest block, the holes around it are
+		 * the most likely to have been retransmitted already.
+		 */
+		for (i = 0; i < count; i++) {
+			if (!lowest ||
+			    net_tcp_seq_greater(lowest->left,
+						tcp->sacked[i].left)) {
+				lowest = &tcp->sacked[i];
+			}
+		}
+
+		*lowest = tcp->sacked[--count];
+	}
+
+	tcp->sacked[count++] = block;
+	tcp->sacked_count = count;
+}
+
+static void tcp_sack_update(struct net_tcp *tcp, u32_t ack,
+			    const struct net_tcp_options *opts)
+{
+	const struct net_tcp_sack_block *block;
+	int count = 0;
+	int i;
+
+	for (i = 0; i < tcp->sacked_count; i++) {
+		if (net_tcp_seq_greater(tcp->sacked[i].right, ack)) {
+			tcp->sacked[count++] = tcp->sacked[i];
+		}
+	}
+
+	tcp->sacked_count = count;
+
+	for (i = 0; i < opts->sack_count; i++) {
+		block = &opts->sack[i];
+
+		/* Ignore duplicate reports (RFC 2883) and invalid blocks */
+		if (!net_tcp_seq_greater(block->left, ack) ||
+		    !net_tcp_seq_greater(block->right, block->left) ||
+		    net_tcp_seq_greater(block->right, tcp->send_seq)) {
+			continue;
+		}
+
+		tcp_sack_add(tcp, *block);
+	}
+}
+
+/* Retransmit the segments below the highest SACKed one which the peer
+ * did not report, or the first unacknowledged segment if it reported
+ * none. Each segment is retransmitted once per recovery.
+ */
+static void tcp_sack_retransmit(struct net_tcp *tcp, u32_t ack)
+{
+	struct net_pkt *pkt;
+	u32_t high = ack + 1;
+	u32_t seq, len;
+	int i;
+
+	for (i = 0; i < tcp->sacked_count; i++) {
+		if (net_tcp_seq_greater(tcp->sacked[i].left, high)) {
+			high = tcp->sacked[i].left;
+		}
+	}
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	/* Beyond snd_nxt, segments are sent again as the window allows */
+	if (tcp->cc && net_tcp_seq_greater(high, tcp->snd_nxt)) {
+		high = tcp->snd_nxt;
+	}
+#endif
+
+	if (net_tcp_seq_greater(ack, tcp->rexmit_high)) {
+		tcp->rexmit_high = ack;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->sent_list, pkt, sent_list) {
+		if (tcp_pkt_segment(pkt, &seq, &len, NULL) < 0 ||
+		    !net_tcp_seq_greater(high, seq)) {
+			break;
+		}
+
+		/* Packets still queued for sending are not retransmitted */
+		if (!len || !net_pkt_sent(pkt) ||
+		    net_tcp_seq_greater(tcp->rexmit_high, seq) ||
+		    tcp_sack_covered(tcp, seq, len)) {
+			continue;
+		}
+
+		NET_DBG("[%p] retransmit seq %u len %u", tcp, seq, len);
+
+		tcp->rexmit_high = seq + len;
+		tcp_retransmit(tcp, pkt);
+	}
+}
+
+/* Loss recovery along the lines of RFC 6675: after three duplicate ACKs,
+ * the segments the peer reported missing are retransmitted, and then those
+ * found missing by the following ACKs, until the data sent before the
+ * recovery started is acknowledged. Without SACK from the peer this is the
+ * fast retransmit of RFC 5681, with the partial ACKs of RFC 6582.
+ */
+static void tcp_sack_received(struct net_tcp *tcp, struct net_pkt *pkt,
+			      struct net_tcp_hdr *tcp_hdr)
+{
+	struct net_tcp_options opts = {
+		.mss = NET_TCP_DEFAULT_MSS,
+	};
+	u16_t opt_totlen = NET_TCP_HDR_LEN(tcp_hdr) -
+		sizeof(struct net_tcp_hdr);
+	u32_t ack = sys_get_be32(tcp_hdr->ack);
+	u32_t acked = tcp_cc_ack(tcp, tcp_hdr);
+	struct net_pkt_cursor backup;
+	bool dup;
+
+	if (opt_totlen && (tcp->flags & NET_TCP_SACK_PERMITTED)) {
+		net_pkt_cursor_backup(pkt, &backup);
+
+		if (net_tcp_parse_opts(pkt, opt_totlen, &opts) < 0) {
+			opts.sack_count = 0U;
+		}
+
+		net_pkt_cursor_restore(pkt, &backup);
+	}
+
+	/* A duplicate ACK acknowledges nothing new and carries nothing
+	 * else than options.
+	 */
+	dup = ack == tcp->ack_rcvd && !sys_slist_is_empty(&tcp->sent_list) &&
+		net_pkt_remaining_data(pkt) == opt_totlen &&
+		!(NET_TCP_FLAGS(tcp_hdr) & (NET_TCP_SYN | NET_TCP_FIN));
+	tcp->ack_rcvd = ack;
+
+	tcp_sack_update(tcp, ack, &opts);
+
+	if (!(tcp->flags & NET_TCP_IN_RECOVERY)) {
+		if (!dup) {
+			tcp->dup_acks = 0U;
+			tcp_cc_update(tcp, TCP_CC_ACK, acked);
+			return;
+		}
+
+		if (++tcp->dup_acks < DUP_ACK_THRESHOLD) {
+			return;
+		}
+
+		tcp->flags |= NET_TCP_IN_RECOVERY;
+		tcp->recover = tcp->send_seq;
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+		/* Data queued beyond snd_nxt was never sent, the recovery
+		 * ends with the highest one sent (RFC 6582 section 3.2).
+		 */
+		if (tcp->cc) {
+			tcp->recover = tcp->snd_nxt;
+		}
+#endif
+		tcp->rexmit_high = ack;
+
+		NET_DBG("[%p] %u duplicate ACKs, recovering up to %u", tcp,
+			tcp->dup_acks, tcp->recover);
+
+		tcp_cc_update(tcp, TCP_CC_RECOVERY, acked);
+	} else if (!net_tcp_seq_greater(tcp->recover, ack)) {
+		tcp->flags &= ~NET_TCP_IN_RECOVERY;
+		tcp->dup_acks = 0U;
+		tcp_cc_update(tcp, TCP_CC_RECOVERED, acked);
+		return;
+	} else {
+		tcp_cc_update(tcp, dup ? TCP_CC_DUP_ACK : TCP_CC_PARTIAL_ACK,
+			      acked);
+	}
+
+	tcp_sack_retransmit(tcp, ack);
+}
+
+/* Queue a segment received after a missing one, in sequence number order.
+ * Its cursor is left at the start of its data.
+ */
+static bool tcp_ooo_queue(struct net_tcp *tcp, struct net_pkt *pkt,
+			  struct net_tcp_hdr *tcp_hdr)
+{
+	u32_t seq = sys_get_be32(tcp_hdr->seq);
+	struct net_pkt *prev = NULL;
+	struct net_pkt *item;
+	u32_t item_seq, item_len;
+	u16_t data_len;
+	u8_t bufs;
+
+	if (NET_TCP_FLAGS(tcp_hdr) & (NET_TCP_SYN | NET_TCP_FIN |
+				      NET_TCP_RST | NET_TCP_URG)) {
+		return false;
+	}
+
+	data_len = adjust_data_len(pkt, tcp_hdr, net_pkt_remaining_data(pkt));
+	if (!data_len ||
+	    net_tcp_seq_greater(seq + data_len,
+				tcp->send_ack + net_tcp_get_recv_wnd(tcp))) {
+		return false;
+	}
+
+	bufs = tcp_pkt_bufs(pkt);
+	if (tcp->ooo_bufs + bufs > CONFIG_NET_TCP_OOO_MAX_BUFS) {
+		NET_DBG("[%p] no room for out-of-order seq %u", tcp, seq);
+		return false;
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&tcp->ooo_list, item, sent_list) {
+		if (tcp_pkt_segment(item, &item_seq, &item_len,
+				    NULL) < 0 ||
+		    item_seq == seq) {
+			return false;
+		}
+
+		if (net_tcp_seq_greater(item_seq, seq)) {
+			break;
+		}
+
+		prev = item;
+	}
+
+	NET_DBG("[%p] queue out-of-order seq %u len %u", tcp, seq, data_len);
+
+	net_pkt_set_overwrite(pkt, true);
+
+	sys_slist_insert(&tcp->ooo_list, prev ? &prev->sent_list : NULL,
+			 &pkt->sent_list);
+	tcp->ooo_bufs += bufs;
+	tcp->ooo_last_seq = seq;
+
+	return true;
+}
+
+/* Point ip_hdr and proto_hdr at the headers of a queued segment, the TCP
+ * one read through tcp_access. The cursor is left where it was.
+ */
+static int tcp_ooo_hdrs(struct net_pkt *pkt,
+			struct net_pkt_data_access *tcp_access,
+			union net_ip_header *ip_hdr,
+			union net_proto_header *proto_hdr)
+{
+	size_t hdr_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ipv6_ext_len(pkt);
+	bool overwrite = net_pkt_is_being_overwritten(pkt);
+	struct net_pkt_cursor backup;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		ip_hdr->ipv4 = NET_IPV4_HDR(pkt);
+	} else {
+		ip_hdr->ipv6 = NET_IPV6_HDR(pkt);
+	}
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	proto_hdr->tcp = NULL;
+	if (!net_pkt_skip(pkt, hdr_len)) {
+		proto_hdr->tcp = (struct net_tcp_hdr *)net_pkt_get_data(
+			pkt, tcp_access);
+	}
+
+	net_pkt_cursor_restore(pkt, &backup);
+	net_pkt_set_overwrite(pkt, overwrite);
+
+	return proto_hdr->tcp ? 0 : -ENOBUFS;
+}
+
+/* Pass on the queued segments made contiguous by the received data, each
+ * with its own headers.
+ */
+static void tcp_ooo_deliver(struct net_conn *conn, struct net_tcp *tcp)
+{
+	struct net_pkt *pkt;
+	u32_t seq = 0U;
+	u32_t len = 0U;
+
+	while ((pkt = SYS_SLIST_PEEK_HEAD_CONTAINER(&tcp->ooo_list, pkt,
+						    sent_list))) {
+		NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct net_tcp_hdr);
+		union net_proto_header proto_hdr;
+		union net_ip_header ip_hdr;
+
+		if (tcp_pkt_segment(pkt, &seq, &len, NULL) < 0) {
+			len = 0U;
+		} else if (net_tcp_seq_greater(seq, tcp->send_ack)) {
+			break;
+		}
+
+		sys_slist_remove(&tcp->ooo_list, NULL, &pkt->sent_list);
+		tcp->ooo_bufs -= tcp_pkt_bufs(pkt);
+
+		/* Skip what was received again since it was queued */
+		if (len <= tcp->send_ack - seq ||
+		    net_pkt_skip(pkt, tcp->send_ack - seq) ||
+		    tcp_ooo_hdrs(pkt, &tcp_access, &ip_hdr, &proto_hdr) < 0) {
+			net_pkt_unref(pkt);
+			continue;
+		}
+
+		len -= tcp->send_ack - seq;
+
+		NET_DBG("[%p] deliver out-of-order seq %u len %u", tcp,
+			tcp->send_ack, len);
+
+		if (net_context_packet_received(conn, pkt, &ip_hdr,
+						&proto_hdr,
+						tcp->recv_user_data) ==
+		    NET_DROP) {
+			net_pkt_unref(pkt);
+		}
+
+		tcp->send_ack += len;
+	}
+}
+#endif /* CONFIG_NET_TCP_SACK */
+
+/* Process the acknowledgment, window and SACK blocks of a received segment.
+ * Returns false if the segment must be dropped.
+ */
+static bool tcp_ack_fields_received(struct net_context *context,
+				    struct net_pkt *pkt,
+				    struct net_tcp_hdr *tcp_hdr)
+{
+	if (!net_tcp_ack_received(context, sys_get_be32(tcp_hdr->ack))) {
+		return false;
+	}
+
+#if defined(CONFIG_NET_TCP_SACK)
+	tcp_sack_received(context->tcp, pkt, tcp_hdr);
+#endif
+	tcp_cc_send(context->tcp);
+
+	/* TCP state might be changed after maintaining the sent pkt
+	 * list, e.g., an ack of FIN is received.
+	 */
+	if (net_tcp_get_state(context->tcp) == NET_TCP_FIN_WAIT_1) {
+		/* Active close: step to FIN_WAIT_2 */
+		net_tcp_change_state(context->tcp, NET_TCP_FIN_WAIT_2);
+	}
+
+	return true;
+}
+
 /* This is called when we receive data after the connection has been
  * established. The core TCP logic is located here.
  *
@@ -1954,6 +2928,22 @@ resend_ack:
 
 	if (net_tcp_seq_cmp(sys_get_be32(tcp_hdr->seq),
 			    context->tcp->send_ack) > 0) {
+#if defined(CONFIG_NET_TCP_SACK)
+		/* Keep the segment until the missing data arrives, and
+		 * tell the peer what it is missing with a duplicate ACK.
+		 * What it acknowledges is valid already.
+		 */
+		if ((tcp_flags & (NET_TCP_ACK | NET_TCP_RST)) == NET_TCP_ACK &&
+		    !tcp_ack_fields_received(context, pkt, tcp_hdr)) {
+			ret = NET_DROP;
+			goto unlock;
+		}
+
+		if (tcp_ooo_queue(context->tcp, pkt, tcp_hdr)) {
+			send_ack(context, &conn->remote_addr, true);
+			goto unlock;
+		}
+#endif
 		/* Don't try to reorder packets.  If it doesn't
 		 * match the next segment exactly, drop and wait for
 		 * retransmit
@@ -1991,22 +2981,12 @@ resend_ack:
 
 	/* Handle TCP state transition */
 	if (tcp_flags & NET_TCP_ACK) {
-		if (!net_tcp_ack_received(context,
-					  sys_get_be32(tcp_hdr->ack))) {
+		if (!tcp_ack_fields_received(context, pkt, tcp_hdr)) {
 			ret = NET_DROP;
 			goto unlock;
 		}
 
-		/* TCP state might be changed after maintaining the sent pkt
-		 * list, e.g., an ack of FIN is received.
-		 */
-
-		if (net_tcp_get_state(context->tcp)
-			   == NET_TCP_FIN_WAIT_1) {
-			/* Active close: step to FIN_WAIT_2 */
-			net_tcp_change_state(context->tcp, NET_TCP_FIN_WAIT_2);
-		} else if (net_tcp_get_state(context->tcp)
-			   == NET_TCP_LAST_ACK) {
+		if (net_tcp_get_state(context->tcp) == NET_TCP_LAST_ACK) {
 			/* Passive close: step to CLOSED */
 			net_tcp_change_state(context->tcp, NET_TCP_CLOSED);
 			/* Release the pkt before clean up */
@@ -2038,7 +3018,7 @@ resend_ack:
 		context->tcp->fin_rcvd = 1U;
 	}
 
-	data_len = net_pkt_remaining_data(pkt);
+	data_len = adjust_data_len(pkt, tcp_hdr, net_pkt_remaining_data(pkt));
 	if (data_len > net_tcp_get_recv_wnd(context->tcp)) {
 		/* In case we have zero window, we should still accept
 		 * Zero Window Probes from peer, which per convention
@@ -2063,8 +3043,6 @@ resend_ack:
 	 * release the pkt. Otherwise, release the pkt immediately.
 	 */
 	if (data_len > 0) {
-		data_len = adjust_data_len(pkt, tcp_hdr, data_len);
-
 		ret = net_context_packet_received(conn, pkt, ip_hdr, proto_hdr,
 						  context->tcp->recv_user_data);
 	} else if (data_len == 0U) {
@@ -2077,6 +3055,12 @@ resend_ack:
 		context->tcp->send_ack += 1U;
 	}
 
+#if defined(CONFIG_NET_TCP_SACK)
+	if (data_len > 0 && !(tcp_flags & NET_TCP_FIN)) {
+		tcp_ooo_deliver(conn, context->tcp);
+	}
+#endif
+
 	send_ack(context, &conn->remote_addr, false);
 
 clean_up:
@@ -2160,9 +3144,21 @@ NET_CONN_CB(tcp_synack_received)
 		/* Remove the temporary connection handler and register
 		 * a proper now as we have an established connection.
 		 */
+		struct net_tcp_options tcp_opts = {
+			.mss = NET_TCP_DEFAULT_MSS,
+		};
 		struct sockaddr local_addr;
 		struct sockaddr remote_addr;
 
+		/* Only SACK is taken from the options, not used if they
+		 * can't be parsed.
+		 */
+		if (net_tcp_parse_opts(pkt, NET_TCP_HDR_LEN(tcp_hdr) -
+				       sizeof(struct net_tcp_hdr),
+				       &tcp_opts) == 0) {
+			tcp_set_sack_permitted(context->tcp, &tcp_opts);
+		}
+
 		tcp_copy_ip_addr_from_hdr(net_pkt_family(pkt), ip_hdr, tcp_hdr,
 					  &remote_addr, true);
 		tcp_copy_ip_addr_from_hdr(net_pkt_family(pkt), ip_hdr, tcp_hdr,
@@ -2186,6 +3182,7 @@ NET_CONN_CB(tcp_synack_received)
 
 		net_tcp_change_state(context->tcp, NET_TCP_ESTABLISHED);
 		net_context_set_state(context, NET_CONTEXT_CONNECTED);
+		tcp_cc_established(context->tcp, tcp_hdr);
 
 		send_ack(context, &remote_addr, false);
 
@@ -2306,6 +3303,9 @@ NET_CONN_CB(tcp_syn_rcvd)
 
 		net_tcp_change_state(tcp, NET_TCP_SYN_RCVD);
 
+		/* Answered in the SYN-ACK, then stored in the backlog */
+		tcp_set_sack_permitted(tcp, &tcp_opts);
+
 		/* Set TCP seq and ack which are then stored in the backlog */
 		context->tcp->send_seq = tcp_init_isn();
 		context->tcp->send_ack =
@@ -2429,6 +3429,7 @@ NET_CONN_CB(tcp_syn_rcvd)
 		new_context->tcp->state = NET_TCP_ESTABLISHED;
 
 		net_context_set_state(new_context, NET_CONTEXT_CONNECTED);
+		tcp_cc_established(new_context->tcp, tcp_hdr);
 
 		if (new_context->remote.sa_family == AF_INET) {
 			addrlen = sizeof(struct sockaddr_in);
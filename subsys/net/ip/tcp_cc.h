@@ -0,0 +1,102 @@
+/** @file
+ @brief TCP congestion control
+
+ This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __TCP_CC_H
+#define __TCP_CC_H
+
+#include <zephyr/types.h>
+
+#include "tcp_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Congestion control algorithm. The code in tcp.c keeps the data in
+ * flight below the congestion window and does the loss recovery, the
+ * algorithm decides how the window grows and how much it shrinks.
+ */
+struct net_tcp_cc {
+	/** Name shown by the net shell */
+	const char *name;
+
+	/**
+	 * @brief Set up the state of a connection. The window and
+	 * the slow start threshold have their initial values already.
+	 */
+	void (*init)(struct net_tcp *tcp);
+
+	/**
+	 * @brief Grow the window for newly acknowledged data. Not called
+	 * during a recovery.
+	 *
+	 * @param acked Number of bytes acknowledged.
+	 */
+	void (*ack)(struct net_tcp *tcp, u32_t acked);
+
+	/**
+	 * @brief Return the slow start threshold to use after a loss.
+	 * Called with the window in use when the loss was detected.
+	 */
+	u32_t (*ssthresh)(struct net_tcp *tcp);
+};
+
+#if defined(CONFIG_NET_TCP_CC_NEWRENO)
+extern const struct net_tcp_cc net_tcp_cc_newreno;
+#endif
+
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+extern const struct net_tcp_cc net_tcp_cc_cubic;
+#endif
+
+/* Size of the segments the window is counted in */
+static inline u32_t net_tcp_cc_mss(const struct net_tcp *tcp)
+{
+	return MIN(tcp->send_mss, net_tcp_get_recv_mss(tcp));
+}
+
+static inline u32_t net_tcp_cc_flight(const struct net_tcp *tcp)
+{
+	return tcp->snd_nxt - tcp->snd_una;
+}
+
+/**
+ * @brief Grow the window by the acknowledged data up to the slow start
+ * threshold, by at most one segment per ACK (RFC 3465).
+ *
+ * @return Acknowledged bytes left over for congestion avoidance.
+ */
+static inline u32_t net_tcp_cc_slow_start(struct net_tcp *tcp, u32_t acked)
+{
+	u32_t incr = MIN(acked, net_tcp_cc_mss(tcp));
+
+	if (tcp->cwnd >= tcp->ssthresh) {
+		return acked;
+	}
+
+	if (tcp->cwnd + incr <= tcp->ssthresh) {
+		tcp->cwnd += incr;
+		return 0;
+	}
+
+	acked -= tcp->ssthresh - tcp->cwnd;
+	tcp->cwnd = tcp->ssthresh;
+
+	return acked;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TCP_CC_H */
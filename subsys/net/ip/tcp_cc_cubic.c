@@ -0,0 +1,180 @@
+/** @file
+ * @brief TCP CUBIC congestion control
+ *
+ * This implements CUBIC as specified in RFC 8312. After a loss, the
+ * window grows as a cubic function of the time elapsed, quickly at
+ * first, flattening out around the window at which the loss happened and
+ * then probing for more bandwidth. It never grows slower than NewReno
+ * would.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <string.h>
+#include <sys/util.h>
+
+#include "tcp_cc.h"
+
+/* Multiplicative decrease factor and scaling constant C of RFC 8312, in
+ * tenths, and the additive increase factor 3 * (1 - beta) / (1 + beta)
+ * of the TCP friendly region, in thousandths.
+ */
+#define CUBIC_BETA 7
+#define CUBIC_C 4
+#define CUBIC_ALPHA 529
+
+/* Bound on the time in the cubic function, which keeps the arithmetic
+ * within 64 bits. The window is far beyond any use by then.
+ */
+#define CUBIC_MAX_TIME 100000U
+
+/* Integer cube root, from Hacker's Delight */
+static u32_t cubic_root(u64_t x)
+{
+	u64_t y = 0U;
+	u64_t b;
+	int s;
+
+	for (s = 63; s >= 0; s -= 3) {
+		y += y;
+		b = 3U * y * (y + 1U) + 1U;
+
+		if ((x >> s) >= b) {
+			x -= b << s;
+			y++;
+		}
+	}
+
+	return y;
+}
+
+/* C * t^3, t in milliseconds, in bytes */
+static u32_t cubic_offset(struct net_tcp *tcp, u32_t t)
+{
+	u64_t d = MIN(t, CUBIC_MAX_TIME);
+
+	/* In thousandths of segments first, 10 * 10^9 for the tenths of
+	 * C and the milliseconds cubed.
+	 */
+	return (CUBIC_C * d * d * d / 10000000U) * net_tcp_cc_mss(tcp) /
+		1000U;
+}
+
+static void cubic_init(struct net_tcp *tcp)
+{
+	(void)memset(&tcp->cc_data.cubic, 0, sizeof(tcp->cc_data.cubic));
+}
+
+/* Window the cubic function gives one round trip from now */
+static u32_t cubic_target(struct net_tcp *tcp, u32_t now)
+{
+	u32_t mss = net_tcp_cc_mss(tcp);
+	u32_t elapsed;
+	u32_t offset;
+
+	/* A congestion avoidance period starts */
+	if (!tcp->cc_data.cubic.origin) {
+		tcp->cc_data.cubic.epoch_start = now;
+		tcp->cc_data.cubic.w_est = tcp->cwnd;
+		tcp->cc_data.cubic.est_acked = 0U;
+		tcp->cc_data.cubic.bytes_acked = 0U;
+
+		if (tcp->cwnd < tcp->cc_data.cubic.w_max) {
+			/* K = cbrt((W_max - cwnd) / C), in milliseconds */
+			tcp->cc_data.cubic.k = cubic_root(
+				(u64_t)(tcp->cc_data.cubic.w_max - tcp->cwnd) *
+				10000000000ULL / CUBIC_C / mss);
+			tcp->cc_data.cubic.origin = tcp->cc_data.cubic.w_max;
+		} else {
+			tcp->cc_data.cubic.k = 0U;
+			tcp->cc_data.cubic.origin = tcp->cwnd;
+		}
+	}
+
+	elapsed = now - tcp->cc_data.cubic.epoch_start + (tcp->srtt >> 3);
+
+	if (elapsed >= tcp->cc_data.cubic.k) {
+		return tcp->cc_data.cubic.origin +
+			cubic_offset(tcp, elapsed - tcp->cc_data.cubic.k);
+	}
+
+	offset = cubic_offset(tcp, tcp->cc_data.cubic.k - elapsed);
+	if (offset >= tcp->cc_data.cubic.origin) {
+		return 0U;
+	}
+
+	return tcp->cc_data.cubic.origin - offset;
+}
+
+static void cubic_ack(struct net_tcp *tcp, u32_t acked)
+{
+	u32_t mss = net_tcp_cc_mss(tcp);
+	u32_t target;
+	u32_t needed;
+
+	acked = net_tcp_cc_slow_start(tcp, acked);
+	if (!acked) {
+		return;
+	}
+
+	target = cubic_target(tcp, k_uptime_get_32());
+
+	/* Standard TCP grows by alpha segments per window acknowledged,
+	 * do at least as well.
+	 */
+	tcp->cc_data.cubic.est_acked += acked;
+	needed = (u64_t)tcp->cwnd * 1000U / CUBIC_ALPHA;
+
+	if (tcp->cc_data.cubic.est_acked >= needed) {
+		tcp->cc_data.cubic.est_acked -= needed;
+		tcp->cc_data.cubic.w_est += mss;
+	}
+
+	target = MAX(target, tcp->cc_data.cubic.w_est);
+	target = MIN(target, tcp->cwnd + tcp->cwnd / 2U);
+
+	/* One segment per cwnd / (target - cwnd) segments acknowledged, or
+	 * per 100 windows when the target is reached.
+	 */
+	if (target > tcp->cwnd) {
+		needed = (u64_t)tcp->cwnd * mss / (target - tcp->cwnd);
+	} else {
+		needed = 100U * tcp->cwnd;
+	}
+
+	tcp->cc_data.cubic.bytes_acked += acked;
+
+	if (tcp->cc_data.cubic.bytes_acked >= needed) {
+		tcp->cc_data.cubic.bytes_acked -= needed;
+		tcp->cwnd += mss;
+	}
+}
+
+static u32_t cubic_ssthresh(struct net_tcp *tcp)
+{
+	/* Fast convergence: release some bandwidth to the newer flows
+	 * if the window did not get back to where it was last time.
+	 */
+	if (tcp->cwnd < tcp->cc_data.cubic.w_max) {
+		tcp->cc_data.cubic.w_max = tcp->cwnd * (10U + CUBIC_BETA) /
+			20U;
+	} else {
+		tcp->cc_data.cubic.w_max = tcp->cwnd;
+	}
+
+	tcp->cc_data.cubic.origin = 0U;
+
+	return MAX(tcp->cwnd * CUBIC_BETA / 10U, 2U * net_tcp_cc_mss(tcp));
+}
+
+const struct net_tcp_cc net_tcp_cc_cubic = {
+	.name = "cubic",
+	.init = cubic_init,
+	.ack = cubic_ack,
+	.ssthresh = cubic_ssthresh,
+};
@@ -0,0 +1,51 @@
+/** @file
+ * @brief TCP NewReno congestion control
+ *
+ * The window doubles every round trip in slow start and grows by one
+ * segment per round trip in congestion avoidance (RFC 5681), counting
+ * acknowledged bytes rather than ACKs (RFC 3465). A loss halves it.
+ */
+
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/util.h>
+
+#include "tcp_cc.h"
+
+static void newreno_init(struct net_tcp *tcp)
+{
+	tcp->cc_data.newreno.bytes_acked = 0U;
+}
+
+static void newreno_ack(struct net_tcp *tcp, u32_t acked)
+{
+	acked = net_tcp_cc_slow_start(tcp, acked);
+	if (!acked) {
+		return;
+	}
+
+	tcp->cc_data.newreno.bytes_acked += acked;
+
+	if (tcp->cc_data.newreno.bytes_acked >= tcp->cwnd) {
+		tcp->cc_data.newreno.bytes_acked -= tcp->cwnd;
+		tcp->cwnd += net_tcp_cc_mss(tcp);
+	}
+}
+
+static u32_t newreno_ssthresh(struct net_tcp *tcp)
+{
+	tcp->cc_data.newreno.bytes_acked = 0U;
+
+	return MAX(net_tcp_cc_flight(tcp) / 2U, 2U * net_tcp_cc_mss(tcp));
+}
+
+const struct net_tcp_cc net_tcp_cc_newreno = {
+	.name = "newreno",
+	.init = newreno_init,
+	.ack = newreno_ack,
+	.ssthresh = newreno_ssthresh,
+};
@@ -29,7 +29,11 @@ extern "C" {
 /** Is this TCP context/socket used or not */
 #define NET_TCP_IN_USE BIT(0)
 
-/* BIT(1), BIT(2) are unused and available */
+/** The peer accepts SACK options (RFC 2018) */
+#define NET_TCP_SACK_PERMITTED BIT(1)
+
+/** Missing segments are being retransmitted after duplicate ACKs */
+#define NET_TCP_IN_RECOVERY BIT(2)
 
 /** Is the socket shutdown for read/write */
 #define NET_TCP_IS_SHUTDOWN BIT(3)
@@ -40,6 +44,12 @@ extern "C" {
 /** MSS option has been set already */
 #define NET_TCP_RECV_MSS_SET BIT(5)
 
+/** A segment is being timed for a round-trip time sample */
+#define NET_TCP_RTT_PENDING BIT(6)
+
+/** The round-trip time has been measured at least once */
+#define NET_TCP_RTT_VALID BIT(7)
+
 /*
  * TCP connection states
  */
@@ -90,16 +100,38 @@ enum net_tcp_state {
 #define NET_TCP_NOP_OPT          1
 #define NET_TCP_MSS_OPT          2
 #define NET_TCP_WINDOW_SCALE_OPT 3
+#define NET_TCP_SACK_PERM_OPT    4
+#define NET_TCP_SACK_OPT         5
 
 /* TCP Option sizes */
 #define NET_TCP_END_SIZE          1
 #define NET_TCP_NOP_SIZE          1
 #define NET_TCP_MSS_SIZE          4
 #define NET_TCP_WINDOW_SCALE_SIZE 3
+#define NET_TCP_SACK_PERM_SIZE    2
+#define NET_TCP_SACK_BLOCK_SIZE   8
+
+/* Max number of SACK blocks in an option, and size of the option with
+ * the two NOPs aligning it.
+ */
+#define NET_TCP_SACK_MAX_BLOCKS   4
+#define NET_TCP_SACK_MAX_OPT_SIZE (4 + NET_TCP_SACK_MAX_BLOCKS * \
+				   NET_TCP_SACK_BLOCK_SIZE)
+
+/** Range of sequence numbers, right edge excluded */
+struct net_tcp_sack_block {
+	u32_t left;
+	u32_t right;
+};
 
 /** Parsed TCP option values for net_tcp_parse_opts()  */
 struct net_tcp_options {
 	u16_t mss;
+#if defined(CONFIG_NET_TCP_SACK)
+	bool sack_permitted;
+	u8_t sack_count;
+	struct net_tcp_sack_block sack[NET_TCP_SACK_MAX_BLOCKS];
+#endif
 };
 
 /* Max received bytes to buffer internally */
@@ -110,6 +142,45 @@ struct net_tcp_options {
 
 struct net_context;
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+struct net_tcp_cc;
+
+/** State of the congestion control algorithm of a connection */
+union net_tcp_cc_data {
+	struct {
+		/** Bytes acknowledged since the window last grew */
+		u32_t bytes_acked;
+	} newreno;
+
+	struct {
+		/** Window before the last reduction, in bytes */
+		u32_t w_max;
+		/** Time it takes to grow back to w_max, in milliseconds */
+		u32_t k;
+		/** Start of the current congestion avoidance period */
+		u32_t epoch_start;
+		/** Window the cubic function is centered on, in bytes */
+		u32_t origin;
+		/** Window standard TCP would have, in bytes */
+		u32_t w_est;
+		/** Bytes acknowledged since w_est last grew */
+		u32_t est_acked;
+		/** Bytes acknowledged since the window last grew */
+		u32_t bytes_acked;
+	} cubic;
+};
+
+/** Per connection congestion control statistics */
+struct net_tcp_cc_stats {
+	/** Segments sent again */
+	u32_t rexmits;
+	/** Recoveries started by duplicate ACKs */
+	u16_t recoveries;
+	/** Retransmission timeouts */
+	u16_t timeouts;
+};
+#endif
+
 struct net_tcp {
 	/** Network context back pointer. */
 	struct net_context *context;
@@ -141,6 +212,80 @@ struct net_tcp {
 	/** Last ACK value sent */
 	u32_t sent_ack;
 
+#if defined(CONFIG_NET_TCP_SACK)
+	/** Segments received after a missing one, sorted by sequence
+	 * number and linked through their sent_list node.
+	 */
+	sys_slist_t ooo_list;
+
+	/** Data the peer reported received, the scoreboard of RFC 6675 */
+	struct net_tcp_sack_block sacked[NET_TCP_SACK_MAX_BLOCKS];
+
+	/** Start of the last segment queued in ooo_list */
+	u32_t ooo_last_seq;
+
+	/** Last ACK value received */
+	u32_t ack_rcvd;
+
+	/** send_seq when the recovery started, which ends when it is ACKed */
+	u32_t recover;
+
+	/** Data below this has been retransmitted during the recovery */
+	u32_t rexmit_high;
+
+	/** Number of net_buf fragments held in ooo_list */
+	u8_t ooo_bufs;
+
+	/** Number of blocks in sacked */
+	u8_t sacked_count;
+
+	/** Number of consecutive duplicate ACKs received */
+	u8_t dup_acks;
+#endif
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	/** Congestion control algorithm of the connection */
+	const struct net_tcp_cc *cc;
+
+	/** State of the algorithm */
+	union net_tcp_cc_data cc_data;
+
+	/** Congestion window, in bytes */
+	u32_t cwnd;
+
+	/** Slow start threshold, in bytes */
+	u32_t ssthresh;
+
+	/** Oldest unacknowledged sequence number */
+	u32_t snd_una;
+
+	/** Data below this has been sent, the data in flight starts at
+	 * snd_una. After a retransmission timeout it goes back to
+	 * snd_una, and the segments are sent again.
+	 */
+	u32_t snd_nxt;
+
+	/** Smoothed round-trip time, in milliseconds times 8 */
+	u32_t srtt;
+
+	/** Round-trip time variation, in milliseconds times 4 */
+	u32_t rttvar;
+
+	/** Retransmission timeout before any backoff, in milliseconds */
+	u32_t rto;
+
+	/** Sequence number whose ACK ends the round-trip time sample */
+	u32_t rtt_seq;
+
+	/** When the timed segment was sent */
+	u32_t rtt_start;
+
+	struct net_tcp_cc_stats cc_stats;
+
+	/** Receive window of the peer */
+	u16_t send_wnd;
+#endif
+
 	/** Accept callback to be called when the connection has been
 	 * established.
 	 */
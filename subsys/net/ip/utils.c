@@ -485,65 +485,183 @@ Z_SYSCALL_HANDLER(net_addr_pton, family, src, dst)
 }
 #endif /* CONFIG_USERSPACE */
 
-static u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+/* The checksum is computed a machine word at a time: RFC 1071 shows the
+ * one's complement sum of 16-bit words can be accumulated in any wider
+ * word (folding the carries back in at the end) and in either byte
+ * order, as long as the result is byte swapped accordingly.  Words are
+ * summed in native byte order with an end-around carry, which compilers
+ * turn into an add-with-carry chain on 32-bit and 64-bit CPUs alike.
+ */
+#if defined(CONFIG_64BIT)
+typedef u64_t chksum_word_t;
+#else
+typedef u32_t chksum_word_t;
+#endif
+
+static inline chksum_word_t chksum_word_add(chksum_word_t acc,
+					    chksum_word_t word)
+{
+	acc += word;
+
+	return acc + (acc < word);
+}
+
+static inline u16_t chksum_fold(chksum_word_t acc)
 {
-	const u8_t *end;
-	u16_t tmp;
+	while (acc >> 16) {
+		acc = (acc & 0xffff) + (acc >> 16);
+	}
+
+	return acc;
+}
 
-	end = data + len - 1;
+static inline u16_t chksum_swap(u16_t sum)
+{
+	return (sum << 8) | (sum >> 8);
+}
+
+/* Add two checksums in host order, i.e. as calc_chksum() returns them */
+static inline u16_t chksum_add(u16_t sum, u16_t part)
+{
+	sum += part;
+
+	return sum + (sum < part);
+}
 
-	while (data < end) {
-		tmp = (data[0] << 8) + data[1];
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
+/* Sum @a len bytes at @a src, also copying them to @a dst unless it is
+ * NULL.  The result is in host order.
+ */
+static ALWAYS_INLINE u16_t chksum_copy(u8_t *dst, const u8_t *src,
+				       size_t len)
+{
+	chksum_word_t acc = 0U;
+	chksum_word_t word;
+
+	while (len >= 4 * sizeof(word)) {
+		int i;
+
+		for (i = 0; i < 4; i++) {
+			word = UNALIGNED_GET((const chksum_word_t *)src);
+			acc = chksum_word_add(acc, word);
+
+			if (dst) {
+				UNALIGNED_PUT(word, (chksum_word_t *)dst);
+				dst += sizeof(word);
+			}
+
+			src += sizeof(word);
 		}
 
-		data += 2;
+		len -= 4 * sizeof(word);
 	}
 
-	if (data == end) {
-		tmp = data[0] << 8;
-		sum += tmp;
-		if (sum < tmp) {
-			sum++;
+	while (len >= sizeof(word)) {
+		word = UNALIGNED_GET((const chksum_word_t *)src);
+		acc = chksum_word_add(acc, word);
+
+		if (dst) {
+			UNALIGNED_PUT(word, (chksum_word_t *)dst);
+			dst += sizeof(word);
 		}
+
+		src += sizeof(word);
+		len -= sizeof(word);
 	}
 
-	return sum;
+	while (len >= sizeof(u16_t)) {
+		u16_t half = UNALIGNED_GET((const u16_t *)src);
+
+		acc = chksum_word_add(acc, half);
+
+		if (dst) {
+			UNALIGNED_PUT(half, (u16_t *)dst);
+			dst += sizeof(u16_t);
+		}
+
+		src += sizeof(u16_t);
+		len -= sizeof(u16_t);
+	}
+
+	if (len) {
+		/* The odd byte is the first of a zero padded word */
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		acc = chksum_word_add(acc, (u16_t)(*src << 8));
+#else
+		acc = chksum_word_add(acc, *src);
+#endif
+		if (dst) {
+			*dst = *src;
+		}
+	}
+
+	return ntohs(chksum_fold(acc));
+}
+
+static u16_t calc_chksum(u16_t sum, const u8_t *data, size_t len)
+{
+	return chksum_add(sum, chksum_copy(NULL, data, len));
+}
+
+u16_t net_calc_chksum_add(u16_t sum, size_t offset, u16_t part)
+{
+	/* Data starting at an odd offset is summed with its bytes
+	 * swapped.
+	 */
+	if (offset & 1) {
+		part = chksum_swap(part);
+	}
+
+	return chksum_add(sum, part);
 }
 
-static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
+u16_t net_calc_chksum_copy(u16_t sum, size_t offset, void *dst,
+			   const void *src, size_t len)
+{
+	return net_calc_chksum_add(sum, offset, chksum_copy(dst, src, len));
+}
+
+u16_t net_calc_chksum_update(u16_t chksum, const void *old_data,
+			     const void *new_data, size_t len)
+{
+	const u8_t *old = old_data;
+	const u8_t *new = new_data;
+	chksum_word_t acc = (u16_t)~chksum;
+
+	/* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+	while (len >= sizeof(u16_t)) {
+		acc += (u16_t)~UNALIGNED_GET((const u16_t *)old);
+		acc += UNALIGNED_GET((const u16_t *)new);
+
+		old += sizeof(u16_t);
+		new += sizeof(u16_t);
+		len -= sizeof(u16_t);
+	}
+
+	return ~chksum_fold(acc);
+}
+
+/* Sum @a len bytes from the packet cursor on, across fragments */
+static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum,
+				    size_t len)
 {
 	struct net_pkt_cursor *cur = &pkt->cursor;
-	size_t len;
+	size_t offset = 0;
 
 	if (!cur->buf || !cur->pos) {
 		return sum;
 	}
 
-	len = cur->buf->len - (cur->pos - cur->buf->data);
+	while (cur->buf && len) {
+		size_t chunk = cur->buf->len - (cur->pos - cur->buf->data);
 
-	while (cur->buf) {
-		sum = calc_chksum(sum, cur->pos, len);
+		chunk = MIN(chunk, len);
+		sum = net_calc_chksum_copy(sum, offset, NULL, cur->pos, chunk);
+		offset += chunk;
+		len -= chunk;
 
 		cur->buf = cur->buf->frags;
-		if (!cur->buf || !cur->buf->len) {
-			break;
-		}
-
-		cur->pos = cur->buf->data;
-
-		if (len % 2) {
-			sum += *cur->pos;
-			if (sum < *cur->pos) {
-				sum++;
-			}
-
-			cur->pos++;
-			len = cur->buf->len - 1;
-		} else {
-			len = cur->buf->len;
+		if (cur->buf) {
+			cur->pos = cur->buf->data;
 		}
 	}
 
@@ -553,23 +671,25 @@ static inline u16_t pkt_calc_chksum(struct net_pkt *pkt, u16_t sum)
 u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto)
 {
 	size_t len = 0U;
+	size_t data_len;
 	u16_t sum = 0U;
 	struct net_pkt_cursor backup;
 	bool ow;
 
 	if (IS_ENABLED(CONFIG_NET_IPV4) &&
 	    net_pkt_family(pkt) == AF_INET) {
+		data_len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt);
 		if (proto != IPPROTO_ICMP) {
 			len = 2 * sizeof(struct in_addr);
-			sum = net_pkt_get_len(pkt) -
-				net_pkt_ip_hdr_len(pkt) + proto;
+			sum = data_len + proto;
 		}
 	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
 		   net_pkt_family(pkt) == AF_INET6) {
 		len = 2 * sizeof(struct in6_addr);
-		sum =  net_pkt_get_len(pkt) -
+		data_len = net_pkt_get_len(pkt) -
 			net_pkt_ip_hdr_len(pkt) -
-			net_pkt_ipv6_ext_len(pkt) + proto;
+			net_pkt_ipv6_ext_len(pkt);
+		sum = data_len + proto;
 	} else {
 		NET_DBG("Unknown protocol family %d", net_pkt_family(pkt));
 		return 0;
@@ -587,7 +707,22 @@ u16_t net_calc_chksum(struct net_pkt *pkt, u8_t proto)
 
 	net_pkt_skip(pkt, len + net_pkt_ipv6_ext_len(pkt));
 
-	sum = pkt_calc_chksum(pkt, sum);
+#if defined(CONFIG_NET_CHKSUM_COPY)
+	/* The payload at the end of the packet may have been summed
+	 * already while it was written, see net_pkt_write_chksum().
+	 */
+	if (pkt->chksum_len && pkt->chksum_len <= data_len) {
+		size_t hdr_len = data_len - pkt->chksum_len;
+
+		sum = pkt_calc_chksum(pkt, sum, hdr_len);
+		sum = chksum_add(sum, (hdr_len & 1) ?
+				 chksum_swap(pkt->chksum) : pkt->chksum);
+	} else {
+		sum = pkt_calc_chksum(pkt, sum, data_len);
+	}
+#else
+	sum = pkt_calc_chksum(pkt, sum, data_len);
+#endif
 
 	sum = (sum == 0U) ? 0xffff : htons(sum);
 
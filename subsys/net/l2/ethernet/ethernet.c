@@ -29,6 +29,7 @@ LOG_MODULE_REGISTER(net_ethernet, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
 #include "net_private.h"
 #include "ipv6.h"
 #include "ipv4_autoconf_internal.h"
+#include "tcp_internal.h"
 
 #define NET_BUF_TIMEOUT K_MSEC(100)
 
@@ -167,6 +168,308 @@ enum net_verdict ethernet_check_ipv4_bcast_addr(struct net_pkt *pkt,
 	return NET_OK;
 }
 
+#if defined(CONFIG_NET_ETHERNET_GRO)
+/* Segments are verified while they are merged if the TCP input would
+ * verify them, so that the checksum of the merged packet can be
+ * computed without reading the payload again.
+ */
+static bool gro_need_chksum(struct net_if *iface)
+{
+	return IS_ENABLED(CONFIG_NET_TCP_CHECKSUM) &&
+		net_if_need_calc_rx_checksum(iface);
+}
+
+/* Read the IP and TCP headers of a packet into @a hdr and leave the
+ * cursor at its payload.  Returns the payload length, or 0 if the
+ * packet is not a plain TCP data segment that can be merged.
+ */
+static size_t gro_parse(struct net_pkt *pkt, struct ethernet_gro *hdr)
+{
+	size_t len = net_pkt_get_len(pkt);
+	size_t hdr_len;
+	u8_t tcp_len;
+
+	net_pkt_cursor_init(pkt);
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		struct net_ipv4_hdr *ipv4 = &hdr->ip.ipv4;
+
+		/* No options, and not a fragment (DF may be set) */
+		if (net_pkt_read(pkt, ipv4, sizeof(*ipv4)) ||
+		    ipv4->vhl != 0x45 || ipv4->proto != IPPROTO_TCP ||
+		    (ipv4->offset[0] & 0xbf) || ipv4->offset[1] ||
+		    ntohs(ipv4->len) != len) {
+			return 0;
+		}
+
+		hdr_len = sizeof(*ipv4);
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		struct net_ipv6_hdr *ipv6 = &hdr->ip.ipv6;
+
+		/* No extension headers */
+		if (net_pkt_read(pkt, ipv6, sizeof(*ipv6)) ||
+		    (ipv6->vtc & 0xf0) != 0x60 ||
+		    ipv6->nexthdr != IPPROTO_TCP ||
+		    ntohs(ipv6->len) + sizeof(*ipv6) != len) {
+			return 0;
+		}
+
+		hdr_len = sizeof(*ipv6);
+	} else {
+		return 0;
+	}
+
+	net_pkt_set_ip_hdr_len(pkt, hdr_len);
+
+	if (net_pkt_read(pkt, &hdr->tcp, sizeof(hdr->tcp))) {
+		return 0;
+	}
+
+	/* Only ACK and PSH, anything else changes the connection state */
+	tcp_len = (hdr->tcp.offset >> 4) * 4U;
+	if (tcp_len < sizeof(hdr->tcp) || !(hdr->tcp.flags & NET_TCP_ACK) ||
+	    (hdr->tcp.flags & ~(NET_TCP_ACK | NET_TCP_PSH))) {
+		return 0;
+	}
+
+	if (net_pkt_read(pkt, hdr->tcp_opts, tcp_len - sizeof(hdr->tcp))) {
+		return 0;
+	}
+
+	hdr_len += tcp_len;
+	if (len <= hdr_len) {
+		return 0;
+	}
+
+	return len - hdr_len;
+}
+
+/* Verify the checksums of a parsed segment.  The TCP payload is summed
+ * into the packet's cached checksum on the way, so neither the TCP
+ * input nor the merged packet's checksum needs to read it again.
+ */
+static bool gro_chksum_ok(struct net_pkt *pkt, size_t len)
+{
+#if defined(CONFIG_NET_IPV4)
+	if (net_pkt_family(pkt) == AF_INET &&
+	    net_calc_chksum_ipv4(pkt) != 0U) {
+		return false;
+	}
+#endif
+
+	pkt->chksum = 0U;
+	pkt->chksum_len = 0U;
+
+	if (net_pkt_read_chksum(pkt, NULL, len)) {
+		return false;
+	}
+
+	return net_calc_chksum_tcp(pkt) == 0U;
+}
+
+/* Is the segment the continuation of the held packet's flow? */
+static bool gro_match(struct ethernet_gro *gro, struct net_pkt *pkt,
+		      struct ethernet_gro *seg, size_t len)
+{
+	struct net_pkt *held = gro->pkt;
+
+	if (net_pkt_iface(pkt) != net_pkt_iface(held) ||
+	    net_pkt_family(pkt) != net_pkt_family(held) ||
+	    net_pkt_get_len(held) + len > CONFIG_NET_ETHERNET_GRO_MAX_SIZE) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		struct net_ipv4_hdr *a = &gro->ip.ipv4;
+		struct net_ipv4_hdr *b = &seg->ip.ipv4;
+
+		if (a->tos != b->tos || a->ttl != b->ttl ||
+		    a->offset[0] != b->offset[0] ||
+		    !net_ipv4_addr_cmp(&a->src, &b->src) ||
+		    !net_ipv4_addr_cmp(&a->dst, &b->dst)) {
+			return false;
+		}
+	} else {
+		struct net_ipv6_hdr *a = &gro->ip.ipv6;
+		struct net_ipv6_hdr *b = &seg->ip.ipv6;
+
+		/* Traffic class and flow label */
+		if (memcmp(a, b, 4) || a->hop_limit != b->hop_limit ||
+		    !net_ipv6_addr_cmp(&a->src, &b->src) ||
+		    !net_ipv6_addr_cmp(&a->dst, &b->dst)) {
+			return false;
+		}
+	}
+
+	return gro->tcp.src_port == seg->tcp.src_port &&
+		gro->tcp.dst_port == seg->tcp.dst_port &&
+		gro->tcp.offset == seg->tcp.offset &&
+		sys_get_be32(seg->tcp.seq) == gro->seq &&
+		!memcmp(gro->tcp_opts, seg->tcp_opts,
+			(seg->tcp.offset >> 4) * 4U - sizeof(seg->tcp));
+}
+
+static void gro_hold(struct ethernet_gro *gro, struct net_pkt *pkt,
+		     struct ethernet_gro *seg, size_t len, int queue)
+{
+	gro->pkt = pkt;
+	gro->ip = seg->ip;
+	gro->tcp = seg->tcp;
+	memcpy(gro->tcp_opts, seg->tcp_opts, sizeof(gro->tcp_opts));
+	gro->seq = sys_get_be32(seg->tcp.seq) + len;
+	gro->count = 1U;
+
+	/* Queued behind the packets that are already waiting, so those
+	 * can still be merged.  Does nothing if it is still pending for
+	 * a packet flushed in the meantime.
+	 */
+	net_tc_submit_work_to_rx_queue(queue, &gro->flush);
+}
+
+static void gro_merge(struct ethernet_gro *gro, struct net_pkt *pkt,
+		      struct ethernet_gro *seg, size_t len)
+{
+	struct net_pkt *held = gro->pkt;
+	struct net_buf *buf = pkt->buffer;
+	size_t hdr_len = net_pkt_get_len(pkt) - len;
+
+	/* Chain the payload, without the headers, to the held packet */
+	while (hdr_len) {
+		size_t pull = MIN(hdr_len, buf->len);
+
+		net_buf_pull(buf, pull);
+		hdr_len -= pull;
+
+		if (!buf->len) {
+			buf = net_buf_frag_del(NULL, buf);
+		}
+	}
+
+	pkt->buffer = NULL;
+	net_pkt_append_buffer(held, buf);
+
+	if (gro_need_chksum(net_pkt_iface(held))) {
+		held->chksum = net_calc_chksum_add(held->chksum,
+						   held->chksum_len,
+						   pkt->chksum);
+		held->chksum_len += len;
+	}
+
+	net_pkt_unref(pkt);
+
+	/* The latest acknowledgment and window apply */
+	memcpy(gro->tcp.ack, seg->tcp.ack, sizeof(gro->tcp.ack));
+	memcpy(gro->tcp.wnd, seg->tcp.wnd, sizeof(gro->tcp.wnd));
+	gro->tcp.flags |= seg->tcp.flags;
+	gro->seq += len;
+	gro->count++;
+}
+
+/* Write the headers of a merged packet back with its new length */
+static void gro_update_headers(struct ethernet_gro *gro, struct net_pkt *pkt)
+{
+	size_t len = net_pkt_get_len(pkt);
+	u16_t chksum;
+
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		gro->ip.ipv4.len = htons(len);
+		gro->ip.ipv4.chksum = 0U;
+	} else {
+		gro->ip.ipv6.len = htons(len - sizeof(gro->ip.ipv6));
+	}
+
+	gro->tcp.chksum = 0U;
+
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_cursor_init(pkt);
+	net_pkt_write(pkt, &gro->ip, net_pkt_ip_hdr_len(pkt));
+	net_pkt_write(pkt, &gro->tcp, sizeof(gro->tcp));
+
+#if defined(CONFIG_NET_IPV4)
+	if (net_pkt_family(pkt) == AF_INET) {
+		NET_IPV4_HDR(pkt)->chksum = net_calc_chksum_ipv4(pkt);
+	}
+#endif
+
+	if (gro_need_chksum(net_pkt_iface(pkt))) {
+		chksum = net_calc_chksum_tcp(pkt);
+
+		net_pkt_cursor_init(pkt);
+		net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+			     offsetof(struct net_tcp_hdr, chksum));
+		net_pkt_write(pkt, &chksum, sizeof(chksum));
+	}
+}
+
+static void gro_flush(struct ethernet_gro *gro)
+{
+	struct net_pkt *pkt = gro->pkt;
+
+	if (!pkt) {
+		return;
+	}
+
+	gro->pkt = NULL;
+
+	if (gro->count > 1) {
+		gro_update_headers(gro, pkt);
+
+		NET_DBG("Merged %u segments into pkt %p len %zu",
+			gro->count, pkt, net_pkt_get_len(pkt));
+	}
+
+	net_process_l3_data(pkt);
+}
+
+static void gro_flush_work(struct k_work *work)
+{
+	gro_flush(CONTAINER_OF(work, struct ethernet_gro, flush));
+}
+
+/* Each Rx queue owns the GRO state of the same index, which only its
+ * thread touches; the flush work is queued to the same queue.
+ */
+static enum net_verdict ethernet_gro_recv(struct net_if *iface,
+					  struct net_pkt *pkt)
+{
+	struct ethernet_context *ctx = net_if_l2_data(iface);
+	int queue = net_rx_queue_current();
+	struct ethernet_gro *gro;
+	struct ethernet_gro seg;
+	size_t len;
+
+	/* Not received through an Rx queue */
+	if (queue < 0) {
+		return NET_CONTINUE;
+	}
+
+	gro = &ctx->gro[queue];
+
+	len = gro_parse(pkt, &seg);
+	if (len && gro_need_chksum(iface) && !gro_chksum_ok(pkt, len)) {
+		/* Left for the IP or TCP input to drop and count */
+		len = 0;
+	}
+
+	if (len && gro->pkt && gro_match(gro, pkt, &seg, len)) {
+		gro_merge(gro, pkt, &seg, len);
+		return NET_OK;
+	}
+
+	/* Anything else is passed on after the held packet */
+	gro_flush(gro);
+
+	if (!len) {
+		return NET_CONTINUE;
+	}
+
+	gro_hold(gro, pkt, &seg, len, queue);
+
+	return NET_OK;
+}
+#endif /* CONFIG_NET_ETHERNET_GRO */
+
 static enum net_verdict ethernet_recv(struct net_if *iface,
 				      struct net_pkt *pkt)
 {
@@ -298,7 +601,11 @@ static enum net_verdict ethernet_recv(struct net_if *iface,
 
 	ethernet_update_length(iface, pkt);
 
+#if defined(CONFIG_NET_ETHERNET_GRO)
+	return ethernet_gro_recv(iface, pkt);
+#else
 	return NET_CONTINUE;
+#endif
 drop:
 	eth_stats_update_errors_rx(iface);
 	return NET_DROP;
@@ -654,6 +961,127 @@ error:
 	return ret;
 }
 
+#if defined(CONFIG_NET_TCP_TSO)
+static inline u16_t tso_chksum(u16_t sum)
+{
+	sum = (sum == 0U) ? 0xffff : htons(sum);
+
+	return ~sum;
+}
+
+int net_eth_tso_segment(struct net_pkt *pkt, u8_t *frame, size_t size,
+			net_eth_tso_cb_t cb, void *user_data)
+{
+	struct net_eth_hdr *eth_hdr = (struct net_eth_hdr *)frame;
+	size_t ip_len = net_pkt_ip_hdr_len(pkt) + net_pkt_ipv6_ext_len(pkt);
+	u16_t mss = net_pkt_tso_mss(pkt);
+	size_t eth_len = sizeof(struct net_eth_hdr);
+	struct net_ipv4_hdr *ipv4_hdr;
+	struct net_ipv6_hdr *ipv6_hdr;
+	struct net_tcp_hdr *tcp_hdr;
+	size_t hdr_len, tcp_len, len;
+	u16_t id;
+	u32_t seq;
+	u8_t flags;
+	int ret;
+
+	if (size < sizeof(struct net_eth_vlan_hdr) + ip_len + NET_TCPH_LEN) {
+		return -EMSGSIZE;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_read(pkt, frame, eth_len)) {
+		return -ENOBUFS;
+	}
+
+	if (ntohs(eth_hdr->type) == NET_ETH_PTYPE_VLAN) {
+		if (net_pkt_read(pkt, frame + eth_len,
+				 NET_ETH_VLAN_HDR_SIZE)) {
+			return -ENOBUFS;
+		}
+
+		eth_len = sizeof(struct net_eth_vlan_hdr);
+	}
+
+	ipv4_hdr = (struct net_ipv4_hdr *)(frame + eth_len);
+	ipv6_hdr = (struct net_ipv6_hdr *)(frame + eth_len);
+	tcp_hdr = (struct net_tcp_hdr *)(frame + eth_len + ip_len);
+
+	if (net_pkt_read(pkt, frame + eth_len, ip_len + NET_TCPH_LEN)) {
+		return -ENOBUFS;
+	}
+
+	tcp_len = (tcp_hdr->offset >> 4) * 4U;
+	hdr_len = eth_len + ip_len + tcp_len;
+	if (!mss || hdr_len + mss > size) {
+		return -EMSGSIZE;
+	}
+
+	if (net_pkt_read(pkt, frame + eth_len + ip_len + NET_TCPH_LEN,
+			 tcp_len - NET_TCPH_LEN)) {
+		return -ENOBUFS;
+	}
+
+	len = net_pkt_remaining_data(pkt);
+	id = (ipv4_hdr->id[0] << 8) | ipv4_hdr->id[1];
+	seq = sys_get_be32(tcp_hdr->seq);
+	flags = tcp_hdr->flags;
+
+	while (len) {
+		size_t seg_len = MIN(len, mss);
+		u16_t sum = tcp_len + seg_len + IPPROTO_TCP;
+
+		if (net_pkt_read(pkt, frame + hdr_len, seg_len)) {
+			return -ENOBUFS;
+		}
+
+		len -= seg_len;
+
+		if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		    net_pkt_family(pkt) == AF_INET) {
+			ipv4_hdr->len = htons(ip_len + tcp_len + seg_len);
+			ipv4_hdr->id[0] = id >> 8;
+			ipv4_hdr->id[1] = id;
+			ipv4_hdr->chksum = 0U;
+			ipv4_hdr->chksum = tso_chksum(
+				net_calc_chksum_copy(0U, 0U, NULL, ipv4_hdr,
+						     ip_len));
+
+			sum = net_calc_chksum_copy(sum, 0U, NULL,
+						   &ipv4_hdr->src,
+						   2 * sizeof(struct in_addr));
+		} else {
+			ipv6_hdr->len = htons(ip_len - sizeof(*ipv6_hdr) +
+					      tcp_len + seg_len);
+
+			sum = net_calc_chksum_copy(sum, 0U, NULL,
+						   &ipv6_hdr->src,
+						   2 * sizeof(struct in6_addr));
+		}
+
+		/* FIN and PSH belong to the end of the data */
+		sys_put_be32(seq, tcp_hdr->seq);
+		tcp_hdr->flags = len ?
+			flags & ~(NET_TCP_FIN | NET_TCP_PSH) : flags;
+		tcp_hdr->chksum = 0U;
+		tcp_hdr->chksum = tso_chksum(
+			net_calc_chksum_copy(sum, 0U, NULL, tcp_hdr,
+					     tcp_len + seg_len));
+
+		ret = cb(pkt, frame, hdr_len + seg_len, user_data);
+		if (ret < 0) {
+			return ret;
+		}
+
+		seq += seg_len;
+		id++;
+	}
+
+	return 0;
+}
+#endif /* CONFIG_NET_TCP_TSO */
+
 static inline int ethernet_enable(struct net_if *iface, bool state)
 {
 	const struct ethernet_api *eth =
@@ -1072,6 +1500,16 @@ void ethernet_init(struct net_if *iface)
 		ctx->ethernet_l2_flags |= NET_L2_PROMISC_MODE;
 	}
 
+#if defined(CONFIG_NET_ETHERNET_GRO)
+	if (!ctx->is_init) {
+		int i;
+
+		for (i = 0; i < NET_RX_QUEUE_COUNT; i++) {
+			k_work_init(&ctx->gro[i].flush, gro_flush_work);
+		}
+	}
+#endif
+
 #if defined(CONFIG_NET_VLAN)
 	if (!(net_eth_get_hw_capabilities(iface) & ETHERNET_HW_VLAN)) {
 		return;
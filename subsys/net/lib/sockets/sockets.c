@@ -16,6 +16,7 @@ LOG_MODULE_REGISTER(net_sock, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <net/net_pkt.h>
 #include <net/socket.h>
 #include <syscall_handler.h>
+#include <kernel_internal.h>
 #include <sys/fdtable.h>
 #include <sys/math_extras.h>
 #include <net/socks.h>
@@ -104,6 +105,10 @@ int zsock_socket_internal(int family, int type, int proto)
 	/* recv_q and accept_q are in union */
 	k_fifo_init(&ctx->recv_q);
 
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	sys_slist_init(&ctx->epoll_items);
+#endif
+
 #ifdef CONFIG_USERSPACE
 	/* Set net context object as initialized and grant access to the
 	 * calling thread (and only the calling thread)
@@ -176,6 +181,7 @@ int zsock_close_ctx(struct net_context *ctx)
 	}
 
 	zsock_flush_queue(ctx);
+	zsock_epoll_release(&ctx->epoll_items);
 
 	SET_ERRNO(net_context_put(ctx));
 
@@ -238,8 +244,12 @@ static void zsock_accepted_cb(struct net_context *new_ctx,
 		(void)net_context_recv(new_ctx, zsock_received_cb, K_NO_WAIT,
 				       NULL);
 		k_fifo_init(&new_ctx->recv_q);
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+		sys_slist_init(&new_ctx->epoll_items);
+#endif
 
 		k_fifo_put(&parent->accept_q, new_ctx);
+		zsock_epoll_notify(&parent->epoll_items);
 	}
 }
 
@@ -269,6 +279,8 @@ static void zsock_received_cb(struct net_context *ctx,
 			net_pkt_set_eof(last_pkt, true);
 			NET_DBG("Set EOF flag on pkt %p", last_pkt);
 		}
+
+		zsock_epoll_notify(&ctx->epoll_items);
 		return;
 	}
 
@@ -280,6 +292,7 @@ static void zsock_received_cb(struct net_context *ctx,
 	}
 
 	k_fifo_put(&ctx->recv_q, pkt);
+	zsock_epoll_notify(&ctx->epoll_items);
 }
 
 int zsock_bind_ctx(struct net_context *ctx, const struct sockaddr *addr,
@@ -477,7 +490,23 @@ ssize_t zsock_sendto_ctx(struct net_context *ctx, const void *buf, size_t len,
 		return -1;
 	}
 
-	if (dest_addr) {
+	if (IS_ENABLED(CONFIG_NET_CONTEXT_ZEROCOPY) &&
+	    (flags & ZSOCK_MSG_ZEROCOPY)) {
+		/* Only sendmsg() can send without copying */
+		struct iovec iov = {
+			.iov_base = (void *)buf,
+			.iov_len = len,
+		};
+		struct msghdr msg = {
+			.msg_name = (struct sockaddr *)dest_addr,
+			.msg_namelen = dest_addr ? addrlen : 0,
+			.msg_iov = &iov,
+			.msg_iovlen = 1,
+		};
+
+		status = net_context_sendmsg(ctx, &msg, flags, NULL, timeout,
+					     ctx->user_data);
+	} else if (dest_addr) {
 		status = net_context_sendto(ctx, buf, len, dest_addr,
 					    addrlen, NULL, timeout,
 					    ctx->user_data);
@@ -551,6 +580,182 @@ Z_SYSCALL_HANDLER(zsock_sendmsg, sock, msg, flags)
 }
 #endif /* CONFIG_USERSPACE */
 
+int zsock_sendmmsg_ctx(struct net_context *ctx, struct mmsghdr *msgvec,
+		       unsigned int vlen, int flags)
+{
+	s32_t timeout = K_FOREVER;
+	unsigned int count;
+	int status = 0;
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	/* Register the callback before sending in order to receive the response
+	 * from the peer.
+	 */
+	status = net_context_recv(ctx, zsock_received_cb,
+				  K_NO_WAIT, ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	/* The context lock is recursive, so holding it over the batch only
+	 * saves each send from contending for it.
+	 */
+	k_mutex_lock(&ctx->lock, K_FOREVER);
+
+	for (count = 0; count < vlen; count++) {
+		status = net_context_sendmsg(ctx, &msgvec[count].msg_hdr,
+					     flags, NULL, timeout, NULL);
+		if (status < 0) {
+			break;
+		}
+
+		msgvec[count].msg_len = status;
+	}
+
+	k_mutex_unlock(&ctx->lock);
+
+	/* An error after the first message is left for the next call */
+	if (!count && status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	return count;
+}
+
+int z_impl_zsock_sendmmsg(int sock, struct mmsghdr *msgvec, unsigned int vlen,
+			  int flags)
+{
+	VTABLE_CALL(sendmmsg, sock, msgvec, vlen, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+/* Copy the message headers of a sendmmsg()/recvmmsg() call, and the
+ * iovec arrays they point to, into kernel memory, and check that the
+ * caller may access the buffers and names they describe (for writing
+ * when write is set). The call then works on the copies, which another
+ * user thread can't change after the check. Free both copies with
+ * k_free(). Returns -EFAULT on an access violation, -ENOMEM when the
+ * copies can't be allocated.
+ */
+static int mmsghdr_from_user(struct mmsghdr *umsgvec, unsigned int vlen,
+			     bool write, struct mmsghdr **msgvec_copy,
+			     struct iovec **iov_copy)
+{
+	struct mmsghdr *msgvec;
+	struct iovec *iov = NULL;
+	size_t iovcnt = 0, size;
+	unsigned int i;
+	size_t j;
+
+	if (Z_SYSCALL_MEMORY_ARRAY(umsgvec, vlen, sizeof(*umsgvec), write)) {
+		return -EFAULT;
+	}
+
+	msgvec = z_user_alloc_from_copy(umsgvec, vlen * sizeof(*umsgvec));
+	if (!msgvec) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		if (size_add_overflow(iovcnt, msgvec[i].msg_hdr.msg_iovlen,
+				      &iovcnt)) {
+			goto fault;
+		}
+	}
+
+	if (size_mul_overflow(iovcnt, sizeof(*iov), &size)) {
+		goto fault;
+	}
+
+	if (iovcnt) {
+		iov = z_thread_malloc(size);
+		if (!iov) {
+			k_free(msgvec);
+			return -ENOMEM;
+		}
+	}
+
+	for (i = 0, iovcnt = 0; i < vlen; i++) {
+		struct msghdr *msg = &msgvec[i].msg_hdr;
+
+		if (msg->msg_iovlen) {
+			if (z_user_from_copy(&iov[iovcnt], msg->msg_iov,
+					     msg->msg_iovlen * sizeof(*iov))) {
+				goto fault;
+			}
+			msg->msg_iov = &iov[iovcnt];
+			iovcnt += msg->msg_iovlen;
+		} else {
+			msg->msg_iov = NULL;
+		}
+
+		for (j = 0; j < msg->msg_iovlen; j++) {
+			if (Z_SYSCALL_MEMORY(msg->msg_iov[j].iov_base,
+					     msg->msg_iov[j].iov_len, write)) {
+				goto fault;
+			}
+		}
+
+		if (msg->msg_name &&
+		    Z_SYSCALL_MEMORY(msg->msg_name, msg->msg_namelen, write)) {
+			goto fault;
+		}
+
+		/* Not supported, don't pass on unchecked pointers */
+		msg->msg_control = NULL;
+		msg->msg_controllen = 0;
+	}
+
+	*msgvec_copy = msgvec;
+	*iov_copy = iov;
+
+	return 0;
+
+fault:
+	k_free(iov);
+	k_free(msgvec);
+
+	return -EFAULT;
+}
+
+Z_SYSCALL_HANDLER(zsock_sendmmsg, sock, msgvec_param, vlen, flags)
+{
+	struct mmsghdr *umsgvec = (struct mmsghdr *)msgvec_param;
+	struct mmsghdr *msgvec;
+	struct iovec *iov;
+	int ret, i;
+
+	ret = mmsghdr_from_user(umsgvec, vlen, false, &msgvec, &iov);
+	Z_OOPS(ret == -EFAULT);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	ret = z_impl_zsock_sendmmsg(sock, msgvec, vlen, flags);
+
+	for (i = 0; i < ret; i++) {
+		if (z_user_to_copy(&umsgvec[i].msg_len, &msgvec[i].msg_len,
+				   sizeof(msgvec[i].msg_len))) {
+			ret = -EFAULT;
+			break;
+		}
+	}
+
+	k_free(iov);
+	k_free(msgvec);
+
+	Z_OOPS(ret == -EFAULT);
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
 static int sock_get_pkt_src_addr(struct net_pkt *pkt,
 				 enum net_ip_protocol proto,
 				 struct sockaddr *addr,
@@ -652,6 +857,54 @@ error:
 	return ret;
 }
 
+/* Copy a received datagram into the iovecs, as much of it as fits, and
+ * its source address into src_addr. Returns the length copied or a
+ * negative errno.
+ */
+static ssize_t sock_recv_dgram_pkt(struct net_context *ctx,
+				   struct net_pkt *pkt,
+				   const struct iovec *iov,
+				   size_t iovlen,
+				   struct sockaddr *src_addr,
+				   socklen_t *addrlen)
+{
+	size_t recv_len = 0;
+	int i;
+
+	if (src_addr && addrlen) {
+		int rv;
+
+		rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
+					   src_addr, *addrlen);
+		if (rv < 0) {
+			return rv;
+		}
+
+		/* addrlen is a value-result argument, set to actual
+		 * size of source address
+		 */
+		if (src_addr->sa_family == AF_INET) {
+			*addrlen = sizeof(struct sockaddr_in);
+		} else if (src_addr->sa_family == AF_INET6) {
+			*addrlen = sizeof(struct sockaddr_in6);
+		} else {
+			return -ENOTSUP;
+		}
+	}
+
+	for (i = 0; i < iovlen; i++) {
+		size_t len = MIN(iov[i].iov_len, net_pkt_remaining_data(pkt));
+
+		if (net_pkt_read(pkt, iov[i].iov_base, len)) {
+			return -ENOBUFS;
+		}
+
+		recv_len += len;
+	}
+
+	return recv_len;
+}
+
 static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 				       void *buf,
 				       size_t max_len,
@@ -659,8 +912,12 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 				       struct sockaddr *src_addr,
 				       socklen_t *addrlen)
 {
+	struct iovec iov = {
+		.iov_base = buf,
+		.iov_len = max_len,
+	};
 	s32_t timeout = K_FOREVER;
-	size_t recv_len = 0;
+	ssize_t recv_len;
 	struct net_pkt_cursor backup;
 	struct net_pkt *pkt;
 
@@ -690,36 +947,9 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 
 	net_pkt_cursor_backup(pkt, &backup);
 
-	if (src_addr && addrlen) {
-		int rv;
-
-		rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
-					   src_addr, *addrlen);
-		if (rv < 0) {
-			errno = -rv;
-			return -1;
-		}
-
-		/* addrlen is a value-result argument, set to actual
-		 * size of source address
-		 */
-		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
-		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
-		} else {
-			errno = ENOTSUP;
-			return -1;
-		}
-	}
-
-	recv_len = net_pkt_remaining_data(pkt);
-	if (recv_len > max_len) {
-		recv_len = max_len;
-	}
-
-	if (net_pkt_read(pkt, buf, recv_len)) {
-		errno = ENOBUFS;
+	recv_len = sock_recv_dgram_pkt(ctx, pkt, &iov, 1, src_addr, addrlen);
+	if (recv_len < 0) {
+		errno = -recv_len;
 		return -1;
 	}
 
@@ -874,6 +1104,109 @@ Z_SYSCALL_HANDLER(zsock_recvfrom, sock, buf, max_len, flags, src_addr,
 }
 #endif /* CONFIG_USERSPACE */
 
+int zsock_recvmmsg_ctx(struct net_context *ctx, struct mmsghdr *msgvec,
+		       unsigned int vlen, int flags)
+{
+	s32_t timeout = K_FOREVER;
+	unsigned int count;
+
+	if (net_context_get_type(ctx) != SOCK_DGRAM ||
+	    (flags & ZSOCK_MSG_PEEK)) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	for (count = 0; count < vlen; count++) {
+		struct msghdr *msg = &msgvec[count].msg_hdr;
+		struct net_pkt *pkt;
+		ssize_t recv_len;
+
+		pkt = k_fifo_get(&ctx->recv_q, timeout);
+		if (!pkt) {
+			break;
+		}
+
+		recv_len = sock_recv_dgram_pkt(ctx, pkt, msg->msg_iov,
+					       msg->msg_iovlen, msg->msg_name,
+					       &msg->msg_namelen);
+		msg->msg_flags = net_pkt_remaining_data(pkt) ?
+				 ZSOCK_MSG_TRUNC : 0;
+		net_pkt_unref(pkt);
+
+		if (recv_len < 0) {
+			if (!count) {
+				errno = -recv_len;
+				return -1;
+			}
+
+			break;
+		}
+
+		msgvec[count].msg_len = recv_len;
+
+		/* Only take what is already queued after the first one */
+		timeout = K_NO_WAIT;
+	}
+
+	if (!count && vlen) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	return count;
+}
+
+int z_impl_zsock_recvmmsg(int sock, struct mmsghdr *msgvec, unsigned int vlen,
+			  int flags)
+{
+	VTABLE_CALL(recvmmsg, sock, msgvec, vlen, flags);
+}
+
+#ifdef CONFIG_USERSPACE
+Z_SYSCALL_HANDLER(zsock_recvmmsg, sock, msgvec_param, vlen, flags)
+{
+	struct mmsghdr *umsgvec = (struct mmsghdr *)msgvec_param;
+	struct mmsghdr *msgvec;
+	struct iovec *iov;
+	int ret, i;
+
+	ret = mmsghdr_from_user(umsgvec, vlen, true, &msgvec, &iov);
+	Z_OOPS(ret == -EFAULT);
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	ret = z_impl_zsock_recvmmsg(sock, msgvec, vlen, flags);
+
+	for (i = 0; i < ret; i++) {
+		struct msghdr *umsg = &umsgvec[i].msg_hdr;
+		struct msghdr *msg = &msgvec[i].msg_hdr;
+
+		if (z_user_to_copy(&umsgvec[i].msg_len, &msgvec[i].msg_len,
+				   sizeof(msgvec[i].msg_len)) ||
+		    z_user_to_copy(&umsg->msg_namelen, &msg->msg_namelen,
+				   sizeof(msg->msg_namelen)) ||
+		    z_user_to_copy(&umsg->msg_flags, &msg->msg_flags,
+				   sizeof(msg->msg_flags))) {
+			ret = -EFAULT;
+			break;
+		}
+	}
+
+	k_free(iov);
+	k_free(msgvec);
+
+	Z_OOPS(ret == -EFAULT);
+
+	return ret;
+}
+#endif /* CONFIG_USERSPACE */
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -947,6 +1280,23 @@ static int zsock_poll_update_ctx(struct net_context *ctx,
 	return 0;
 }
 
+static int zsock_poll_ready_ctx(struct net_context *ctx, int events)
+{
+	int revents = 0;
+
+	/* For now, assume that socket is always writable */
+	if (events & ZSOCK_POLLOUT) {
+		revents |= ZSOCK_POLLOUT;
+	}
+
+	if ((events & ZSOCK_POLLIN) &&
+	    (!k_fifo_is_empty(&ctx->recv_q) || sock_is_eof(ctx))) {
+		revents |= ZSOCK_POLLIN;
+	}
+
+	return revents;
+}
+
 static inline int time_left(u32_t start, u32_t timeout)
 {
 	u32_t elapsed = k_uptime_get_32() - start;
@@ -1156,6 +1506,44 @@ int zsock_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 
 				return 0;
 			}
+
+			break;
+
+		case SO_ZEROCOPY:
+		case SO_ZEROCOPY_DONE:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_ZEROCOPY)) {
+				size_t len;
+				u32_t value;
+				bool enabled;
+
+				if (*optlen < sizeof(int)) {
+					errno = EINVAL;
+					return -1;
+				}
+
+				if (optname == SO_ZEROCOPY) {
+					ret = net_context_get_option(
+						ctx, NET_OPT_ZEROCOPY,
+						&enabled, &len);
+					value = enabled;
+				} else {
+					ret = net_context_get_option(
+						ctx, NET_OPT_ZEROCOPY_DONE,
+						&value, &len);
+				}
+
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				*(int *)optval = value;
+				*optlen = sizeof(int);
+
+				return 0;
+			}
+
+			break;
 		}
 
 		break;
@@ -1260,6 +1648,31 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 
 			break;
 
+		case SO_ZEROCOPY:
+			if (IS_ENABLED(CONFIG_NET_CONTEXT_ZEROCOPY)) {
+				bool enable;
+
+				if (optlen != sizeof(int)) {
+					errno = EINVAL;
+					return -1;
+				}
+
+				enable = *(const int *)optval != 0;
+
+				ret = net_context_set_option(ctx,
+							     NET_OPT_ZEROCOPY,
+							     &enable,
+							     sizeof(enable));
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				return 0;
+			}
+
+			break;
+
 		case SO_SOCKS5:
 			if (IS_ENABLED(CONFIG_SOCKS)) {
 				ret = net_context_set_option(ctx,
@@ -1484,6 +1897,21 @@ static int sock_ioctl_vmeth(void *obj, unsigned int request, va_list args)
 		return zsock_getsockname_ctx(obj, addr, addrlen);
 	}
 
+	case ZFD_IOCTL_POLL_READY:
+		return zsock_poll_ready_ctx(obj, va_arg(args, int));
+
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+	case ZFD_IOCTL_EPOLL_ITEMS: {
+		struct net_context *ctx = obj;
+		sys_slist_t **items;
+
+		items = va_arg(args, sys_slist_t **);
+		*items = &ctx->epoll_items;
+
+		return 0;
+	}
+#endif
+
 	default:
 		errno = EOPNOTSUPP;
 		return -1;
@@ -1526,6 +1954,18 @@ static ssize_t sock_sendmsg_vmeth(void *obj, const struct msghdr *msg,
 	return zsock_sendmsg_ctx(obj, msg, flags);
 }
 
+static int sock_sendmmsg_vmeth(void *obj, struct mmsghdr *msgvec,
+			       unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg_ctx(obj, msgvec, vlen, flags);
+}
+
+static int sock_recvmmsg_vmeth(void *obj, struct mmsghdr *msgvec,
+			       unsigned int vlen, int flags)
+{
+	return zsock_recvmmsg_ctx(obj, msgvec, vlen, flags);
+}
+
 static ssize_t sock_recvfrom_vmeth(void *obj, void *buf, size_t max_len,
 				   int flags, struct sockaddr *src_addr,
 				   socklen_t *addrlen)
@@ -1559,7 +1999,9 @@ const struct socket_op_vtable sock_fd_op_vtable = {
 	.accept = sock_accept_vmeth,
 	.sendto = sock_sendto_vmeth,
 	.sendmsg = sock_sendmsg_vmeth,
+	.sendmmsg = sock_sendmmsg_vmeth,
 	.recvfrom = sock_recvfrom_vmeth,
+	.recvmmsg = sock_recvmmsg_vmeth,
 	.getsockopt = sock_getsockopt_vmeth,
 	.setsockopt = sock_setsockopt_vmeth,
 };
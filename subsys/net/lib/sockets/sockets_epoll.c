@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_sock_epoll, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <kernel.h>
+#include <sys/fdtable.h>
+#include <net/net_context.h>
+#include <net/socket.h>
+
+#include "sockets_internal.h"
+
+/* Events which are reported whether they were asked for or not */
+#define EPOLL_ALWAYS (ZSOCK_EPOLLERR | ZSOCK_EPOLLHUP)
+#define EPOLL_FLAGS (ZSOCK_EPOLLONESHOT | ZSOCK_EPOLLET)
+
+struct epoll_instance {
+	/* Items whose socket may be ready, in the order they became so */
+	sys_dlist_t ready;
+	struct k_sem wait;
+	bool in_use;
+};
+
+struct epoll_item {
+	/* In the list of the socket, see zsock_epoll_notify() */
+	sys_snode_t node;
+	/* In the ready list of the instance */
+	sys_dnode_t ready_node;
+	struct epoll_instance *ep;
+	sys_slist_t *items;
+	void *obj;
+	const struct fd_op_vtable *vtable;
+	u32_t events;
+	zsock_epoll_data_t data;
+};
+
+static struct epoll_instance epoll_instances[CONFIG_NET_SOCKETS_EPOLL_MAX];
+static struct epoll_item epoll_items[CONFIG_NET_SOCKETS_EPOLL_ITEMS];
+
+/* Protects the lists of the sockets and the ready lists, which are
+ * updated from the receive path.
+ */
+static struct k_spinlock epoll_lock;
+
+static const struct fd_op_vtable epoll_fd_op_vtable;
+
+/* Called with epoll_lock held */
+static void epoll_item_ready(struct epoll_item *item)
+{
+	if (!(item->events & ~EPOLL_FLAGS) ||
+	    sys_dnode_is_linked(&item->ready_node)) {
+		return;
+	}
+
+	sys_dlist_append(&item->ep->ready, &item->ready_node);
+	k_sem_give(&item->ep->wait);
+}
+
+/* Called with epoll_lock held */
+static void epoll_item_free(struct epoll_item *item)
+{
+	sys_slist_find_and_remove(item->items, &item->node);
+
+	if (sys_dnode_is_linked(&item->ready_node)) {
+		sys_dlist_remove(&item->ready_node);
+	}
+
+	item->ep = NULL;
+}
+
+void zsock_epoll_notify(sys_slist_t *items)
+{
+	struct epoll_item *item;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&epoll_lock);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(items, item, node) {
+		epoll_item_ready(item);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+}
+
+void zsock_epoll_release(sys_slist_t *items)
+{
+	struct epoll_item *item;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&epoll_lock);
+
+	while ((item = SYS_SLIST_PEEK_HEAD_CONTAINER(items, item, node))) {
+		epoll_item_free(item);
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+}
+
+static struct epoll_item *epoll_item_find(struct epoll_instance *ep,
+					  sys_slist_t *items)
+{
+	struct epoll_item *item;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(items, item, node) {
+		if (item->ep == ep) {
+			return item;
+		}
+	}
+
+	return NULL;
+}
+
+static struct epoll_item *epoll_item_alloc(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (epoll_items[i].ep == NULL) {
+			return &epoll_items[i];
+		}
+	}
+
+	return NULL;
+}
+
+int zsock_epoll_create(int size)
+{
+	struct epoll_instance *ep = NULL;
+	k_spinlock_key_t key;
+	int fd;
+	int i;
+
+	if (size <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fd = z_reserve_fd();
+	if (fd < 0) {
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_instances); i++) {
+		if (!epoll_instances[i].in_use) {
+			ep = &epoll_instances[i];
+			ep->in_use = true;
+			break;
+		}
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (ep == NULL) {
+		z_free_fd(fd);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	sys_dlist_init(&ep->ready);
+	k_sem_init(&ep->wait, 0, 1);
+
+	z_finalize_fd(fd, ep, &epoll_fd_op_vtable);
+
+	NET_DBG("epoll: ep=%p, fd=%d", ep, fd);
+
+	return fd;
+}
+
+int zsock_epoll_ctl(int epfd, int op, int fd, struct zsock_epoll_event *event)
+{
+	const struct fd_op_vtable *vtable;
+	struct epoll_instance *ep;
+	struct epoll_item *item;
+	k_spinlock_key_t key;
+	sys_slist_t *items;
+	void *obj;
+	int ret = 0;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	obj = z_get_fd_obj_and_vtable(fd, &vtable);
+	if (obj == NULL) {
+		return -1;
+	}
+
+	if (z_fdtable_call_ioctl(vtable, obj, ZFD_IOCTL_EPOLL_ITEMS,
+				 &items) < 0) {
+		errno = EPERM;
+		return -1;
+	}
+
+	if (op != ZSOCK_EPOLL_CTL_DEL && event == NULL) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	key = k_spin_lock(&epoll_lock);
+
+	item = epoll_item_find(ep, items);
+
+	switch (op) {
+	case ZSOCK_EPOLL_CTL_ADD:
+		if (item != NULL) {
+			ret = -EEXIST;
+			break;
+		}
+
+		item = epoll_item_alloc();
+		if (item == NULL) {
+			ret = -ENOMEM;
+			break;
+		}
+
+		item->ep = ep;
+		item->items = items;
+		item->obj = obj;
+		item->vtable = vtable;
+		sys_dnode_init(&item->ready_node);
+		sys_slist_append(items, &item->node);
+		/* fall through */
+	case ZSOCK_EPOLL_CTL_MOD:
+		if (item == NULL) {
+			ret = -ENOENT;
+			break;
+		}
+
+		item->events = event->events | EPOLL_ALWAYS;
+		item->data = event->data;
+
+		/* The socket might be ready already, epoll_wait() checks */
+		epoll_item_ready(item);
+		break;
+
+	case ZSOCK_EPOLL_CTL_DEL:
+		if (item == NULL) {
+			ret = -ENOENT;
+			break;
+		}
+
+		epoll_item_free(item);
+		break;
+
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	k_spin_unlock(&epoll_lock, key);
+
+	if (ret < 0) {
+		errno = -ret;
+		return -1;
+	}
+
+	return 0;
+}
+
+static inline int time_left(u32_t start, u32_t timeout)
+{
+	u32_t elapsed = k_uptime_get_32() - start;
+
+	return timeout - elapsed;
+}
+
+/* Report the ready sockets, called with epoll_lock held. Only the items
+ * on the ready list are looked at: an item which turns out not to be
+ * ready, or is edge-triggered, leaves the list until its socket notifies
+ * again. Level-triggered items which were reported go back to the end of
+ * the list, so that they are checked again on the next call.
+ */
+static int epoll_collect(struct epoll_instance *ep,
+			 struct zsock_epoll_event *events, int maxevents)
+{
+	struct epoll_item *item, *next;
+	sys_dlist_t requeue;
+	int revents;
+	int count = 0;
+
+	sys_dlist_init(&requeue);
+
+	SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&ep->ready, item, next, ready_node) {
+		if (count == maxevents) {
+			break;
+		}
+
+		sys_dlist_remove(&item->ready_node);
+
+		revents = z_fdtable_call_ioctl(item->vtable, item->obj,
+					       ZFD_IOCTL_POLL_READY,
+					       item->events & ~EPOLL_FLAGS);
+		if (revents <= 0) {
+			continue;
+		}
+
+		events[count].events = revents;
+		events[count].data = item->data;
+		count++;
+
+		if (item->events & ZSOCK_EPOLLONESHOT) {
+			item->events = 0U;
+		} else if (!(item->events & ZSOCK_EPOLLET)) {
+			sys_dlist_append(&requeue, &item->ready_node);
+		}
+	}
+
+	while ((next = SYS_DLIST_PEEK_HEAD_CONTAINER(&requeue, item,
+						     ready_node))) {
+		sys_dlist_remove(&next->ready_node);
+		sys_dlist_append(&ep->ready, &next->ready_node);
+	}
+
+	return count;
+}
+
+int zsock_epoll_wait(int epfd, struct zsock_epoll_event *events,
+		     int maxevents, int timeout)
+{
+	struct epoll_instance *ep;
+	u32_t entry_time = k_uptime_get_32();
+	int remaining_time;
+	k_spinlock_key_t key;
+	int count;
+
+	ep = z_get_fd_obj(epfd, &epoll_fd_op_vtable, EINVAL);
+	if (ep == NULL) {
+		return -1;
+	}
+
+	if (maxevents <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (timeout < 0) {
+		timeout = K_FOREVER;
+	}
+
+	remaining_time = timeout;
+
+	while (true) {
+		key = k_spin_lock(&epoll_lock);
+		count = epoll_collect(ep, events, maxevents);
+		k_spin_unlock(&epoll_lock, key);
+
+		if (count > 0 || timeout == K_NO_WAIT) {
+			break;
+		}
+
+		if (timeout != K_FOREVER) {
+			remaining_time = time_left(entry_time, timeout);
+			if (remaining_time <= 0) {
+				break;
+			}
+		}
+
+		/* A socket became ready after the ready list was looked at,
+		 * or has been reported already: check the list again.
+		 */
+		if (k_sem_take(&ep->wait, remaining_time) < 0) {
+			break;
+		}
+	}
+
+	return count;
+}
+
+static ssize_t epoll_read_vmeth(void *obj, void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static ssize_t epoll_write_vmeth(void *obj, const void *buffer, size_t count)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+static int epoll_close(struct epoll_instance *ep)
+{
+	k_spinlock_key_t key;
+	int i;
+
+	key = k_spin_lock(&epoll_lock);
+
+	for (i = 0; i < ARRAY_SIZE(epoll_items); i++) {
+		if (epoll_items[i].ep == ep) {
+			epoll_item_free(&epoll_items[i]);
+		}
+	}
+
+	ep->in_use = false;
+
+	k_spin_unlock(&epoll_lock, key);
+
+	return 0;
+}
+
+static int epoll_ioctl_vmeth(void *obj, unsigned int request, va_list args)
+{
+	switch (request) {
+	case ZFD_IOCTL_CLOSE:
+		return epoll_close(obj);
+
+	default:
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+}
+
+static const struct fd_op_vtable epoll_fd_op_vtable = {
+	.read = epoll_read_vmeth,
+	.write = epoll_write_vmeth,
+	.ioctl = epoll_ioctl_vmeth,
+};
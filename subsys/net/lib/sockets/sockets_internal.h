@@ -46,6 +46,21 @@ struct socket_op_vtable {
 	int (*setsockopt)(void *obj, int level, int optname,
 			  const void *optval, socklen_t optlen);
 	ssize_t (*sendmsg)(void *obj, const struct msghdr *msg, int flags);
+	int (*sendmmsg)(void *obj, struct mmsghdr *msgvec, unsigned int vlen,
+			int flags);
+	int (*recvmmsg)(void *obj, struct mmsghdr *msgvec, unsigned int vlen,
+			int flags);
 };
 
+#if defined(CONFIG_NET_SOCKETS_EPOLL)
+/* Put the epoll registrations of a socket on the ready lists of their
+ * instances, or drop them when the socket is closed.
+ */
+void zsock_epoll_notify(sys_slist_t *items);
+void zsock_epoll_release(sys_slist_t *items);
+#else
+#define zsock_epoll_notify(items)
+#define zsock_epoll_release(items)
+#endif
+
 #endif /* _SOCKETS_INTERNAL_H_ */
@@ -24,6 +24,106 @@ sys_slist_t settings_handlers;
 
 K_MUTEX_DEFINE(settings_lock);
 
+#if CONFIG_SETTINGS_STATIC_HANDLER_INDEX_SIZE > 0
+extern struct settings_handler_static _settings_handler_static_list_start[];
+extern struct settings_handler_static _settings_handler_static_list_end[];
+
+/* Static handlers sorted by name, to find a handler by binary search */
+static u16_t settings_handler_index[CONFIG_SETTINGS_STATIC_HANDLER_INDEX_SIZE];
+static bool settings_handler_indexed;
+static size_t settings_handler_index_cnt;
+
+static void settings_handler_index_init(void)
+{
+	struct settings_handler_static *start;
+	size_t cnt, i, j;
+
+	start = _settings_handler_static_list_start;
+	cnt = _settings_handler_static_list_end - start;
+	if (cnt > ARRAY_SIZE(settings_handler_index)) {
+		LOG_DBG("%d static handlers, not indexed", (int)cnt);
+		return;
+	}
+
+	/* Insertion sort, handlers are few */
+	for (i = 0; i < cnt; i++) {
+		for (j = i; j > 0; j--) {
+			if (strcmp(start[settings_handler_index[j - 1]].name,
+				   start[i].name) <= 0) {
+				break;
+			}
+			settings_handler_index[j] =
+				settings_handler_index[j - 1];
+		}
+		settings_handler_index[j] = i;
+	}
+
+	settings_handler_index_cnt = cnt;
+	settings_handler_indexed = true;
+}
+
+/* Find the static handler named by the first len characters of name */
+static struct settings_handler_static *
+settings_handler_index_find(const char *name, size_t len)
+{
+	struct settings_handler_static *ch;
+	size_t lo, hi, mid;
+	int cmp;
+
+	lo = 0;
+	hi = settings_handler_index_cnt;
+	while (lo < hi) {
+		mid = (lo + hi) / 2U;
+		ch = &_settings_handler_static_list_start[
+			settings_handler_index[mid]];
+		cmp = strncmp(ch->name, name, len);
+		if ((cmp == 0) && (ch->name[len] != '\0')) {
+			cmp = 1;
+		}
+		if (cmp == 0) {
+			return ch;
+		}
+		if (cmp < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return NULL;
+}
+
+/* The handler whose name is the longest match for name is the one for name
+ * up to its end or up to one of its separators, the longest first.
+ */
+static struct settings_handler_static *
+settings_handler_index_lookup(const char *name, const char **next)
+{
+	struct settings_handler_static *ch;
+	size_t len;
+
+	len = 0;
+	while ((name[len] != '\0') && (name[len] != SETTINGS_NAME_END)) {
+		len++;
+	}
+
+	while (len > 0) {
+		ch = settings_handler_index_find(name, len);
+		if (ch) {
+			if (name[len] == SETTINGS_NAME_SEPARATOR) {
+				*next = &name[len + 1];
+			}
+			return ch;
+		}
+
+		do {
+			len--;
+		} while ((len > 0) && (name[len] != SETTINGS_NAME_SEPARATOR));
+	}
+
+	return NULL;
+}
+#endif /* CONFIG_SETTINGS_STATIC_HANDLER_INDEX_SIZE > 0 */
 
 void settings_store_init(void);
 
@@ -32,6 +132,9 @@ void settings_init(void)
 #if defined(CONFIG_SETTINGS_DYNAMIC_HANDLERS)
 	sys_slist_init(&settings_handlers);
 #endif /* CONFIG_SETTINGS_DYNAMIC_HANDLERS */
+#if CONFIG_SETTINGS_STATIC_HANDLER_INDEX_SIZE > 0
+	settings_handler_index_init();
+#endif /* CONFIG_SETTINGS_STATIC_HANDLER_INDEX_SIZE > 0 */
 	settings_store_init();
 }
 
@@ -135,36 +238,49 @@ int settings_name_next(const char *name, const char **next)
 	return rc;
 }
 
-struct settings_handler_static *settings_parse_and_lookup(const char *name,
-							const char **next)
+static struct settings_handler_static *
+settings_static_lookup(const char *name, const char **next)
 {
 	struct settings_handler_static *bestmatch;
 	const char *tmpnext;
 
-	bestmatch = NULL;
-	if (next) {
-		*next = NULL;
+#if CONFIG_SETTINGS_STATIC_HANDLER_INDEX_SIZE > 0
+	if (settings_handler_indexed) {
+		return settings_handler_index_lookup(name, next);
 	}
+#endif /* CONFIG_SETTINGS_STATIC_HANDLER_INDEX_SIZE > 0 */
 
+	bestmatch = NULL;
 	Z_STRUCT_SECTION_FOREACH(settings_handler_static, ch) {
 		if (!settings_name_steq(name, ch->name, &tmpnext)) {
 			continue;
 		}
 		if (!bestmatch) {
 			bestmatch = ch;
-			if (next) {
-				*next = tmpnext;
-			}
+			*next = tmpnext;
 			continue;
 		}
 		if (settings_name_steq(ch->name, bestmatch->name, NULL)) {
 			bestmatch = ch;
-			if (next) {
-				*next = tmpnext;
-			}
+			*next = tmpnext;
 		}
 	}
 
+	return bestmatch;
+}
+
+struct settings_handler_static *settings_parse_and_lookup(const char *name,
+							const char **next)
+{
+	struct settings_handler_static *bestmatch;
+	const char *tmpnext;
+
+	tmpnext = NULL;
+	bestmatch = settings_static_lookup(name, &tmpnext);
+	if (next) {
+		*next = tmpnext;
+	}
+
 #if defined(CONFIG_SETTINGS_DYNAMIC_HANDLERS)
 	struct settings_handler *ch;
 
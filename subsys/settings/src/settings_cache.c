@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2019 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <kernel.h>
+
+#include "settings/settings.h"
+#include "settings_priv.h"
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
+
+extern struct k_mutex settings_lock;
+
+/* A setting written with settings_save_one(). A dirty entry holds a value
+ * not yet written to the back-end, a clean one the value last written to
+ * it, to drop writes of the same value.
+ */
+struct settings_cache_entry {
+	/* Order of the first change since the entry was clean, or of the
+	 * last use of a clean entry.
+	 */
+	u32_t seq;
+	u16_t val_len;
+	bool used;
+	bool dirty;
+	char name[SETTINGS_MAX_NAME_LEN + 1];
+	u8_t value[CONFIG_SETTINGS_CACHE_VALUE_SIZE];
+};
+
+/* Protected by settings_lock */
+static struct settings_cache_entry
+	settings_cache[CONFIG_SETTINGS_CACHE_ENTRIES];
+static u32_t settings_cache_seq;
+static int settings_cache_dirty;
+
+static struct k_delayed_work settings_cache_work;
+
+static struct settings_cache_entry *settings_cache_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(settings_cache); i++) {
+		if (settings_cache[i].used &&
+		    !strcmp(settings_cache[i].name, name)) {
+			return &settings_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* The dirty entry changed first, or the clean entry used least recently */
+static struct settings_cache_entry *settings_cache_oldest(bool dirty)
+{
+	struct settings_cache_entry *oldest = NULL;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(settings_cache); i++) {
+		if (!settings_cache[i].used ||
+		    (settings_cache[i].dirty != dirty)) {
+			continue;
+		}
+		if (!oldest ||
+		    ((s32_t)(settings_cache[i].seq - oldest->seq) < 0)) {
+			oldest = &settings_cache[i];
+		}
+	}
+
+	return oldest;
+}
+
+static struct settings_cache_entry *settings_cache_alloc(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(settings_cache); i++) {
+		if (!settings_cache[i].used) {
+			return &settings_cache[i];
+		}
+	}
+
+	return settings_cache_oldest(false);
+}
+
+int settings_cache_flush(struct settings_store *cs)
+{
+	struct settings_cache_entry *entry;
+	int rc;
+
+	while (settings_cache_dirty) {
+		entry = settings_cache_oldest(true);
+
+		rc = cs->cs_itf->csi_save(cs, entry->name,
+					  entry->val_len ?
+					  (const char *)entry->value : NULL,
+					  entry->val_len);
+		if ((rc == -ENOENT) && !entry->val_len) {
+			/* Nothing to delete */
+			rc = 0;
+		}
+		if (rc) {
+			return rc;
+		}
+
+		entry->dirty = false;
+		settings_cache_dirty--;
+	}
+
+	return 0;
+}
+
+static void settings_cache_work_handler(struct k_work *work)
+{
+	struct settings_store *cs;
+	int rc;
+
+	k_mutex_lock(&settings_lock, K_FOREVER);
+
+	cs = settings_save_dst;
+	rc = cs ? settings_cache_flush(cs) : 0;
+	if (rc) {
+		LOG_ERR("cache flush failed (err %d)", rc);
+		if (CONFIG_SETTINGS_CACHE_FLUSH_INTERVAL > 0) {
+			k_delayed_work_submit(
+				&settings_cache_work,
+				CONFIG_SETTINGS_CACHE_FLUSH_INTERVAL);
+		}
+	}
+
+	k_mutex_unlock(&settings_lock);
+}
+
+static void settings_cache_schedule(void)
+{
+	if (settings_cache_dirty >= CONFIG_SETTINGS_CACHE_FLUSH_THRESHOLD) {
+		k_delayed_work_submit(&settings_cache_work, K_NO_WAIT);
+	} else if ((settings_cache_dirty == 1) &&
+		   (CONFIG_SETTINGS_CACHE_FLUSH_INTERVAL > 0)) {
+		k_delayed_work_submit(&settings_cache_work,
+				      CONFIG_SETTINGS_CACHE_FLUSH_INTERVAL);
+	}
+}
+
+int settings_cache_save(struct settings_store *cs, const char *name,
+			const char *value, size_t val_len)
+{
+	struct settings_cache_entry *entry;
+	int rc;
+
+	entry = settings_cache_find(name);
+
+	if ((strlen(name) > SETTINGS_MAX_NAME_LEN) ||
+	    (val_len > sizeof(entry->value))) {
+		/* Write it after the cached values to keep the order */
+		rc = settings_cache_flush(cs);
+		if (rc) {
+			return rc;
+		}
+		if (entry) {
+			entry->used = false;
+		}
+		return cs->cs_itf->csi_save(cs, name, value, val_len);
+	}
+
+	if (!value) {
+		val_len = 0;
+	}
+
+	if (entry && (entry->val_len == val_len) &&
+	    (!val_len || !memcmp(entry->value, value, val_len))) {
+		/* Unchanged */
+		if (!entry->dirty) {
+			entry->seq = ++settings_cache_seq;
+		}
+		return 0;
+	}
+
+	if (!entry) {
+		entry = settings_cache_alloc();
+		if (!entry) {
+			/* All entries are dirty, make room */
+			rc = settings_cache_flush(cs);
+			if (rc) {
+				return rc;
+			}
+			entry = settings_cache_alloc();
+		}
+		strcpy(entry->name, name);
+		entry->used = true;
+		entry->dirty = false;
+	}
+
+	if (!entry->dirty) {
+		entry->dirty = true;
+		entry->seq = ++settings_cache_seq;
+		settings_cache_dirty++;
+	}
+
+	entry->val_len = val_len;
+	if (val_len) {
+		memcpy(entry->value, value, val_len);
+	}
+
+	settings_cache_schedule();
+
+	return 0;
+}
+
+int settings_flush(void)
+{
+	struct settings_store *cs;
+	int rc;
+
+	cs = settings_save_dst;
+	if (!cs) {
+		return -ENOENT;
+	}
+
+	k_mutex_lock(&settings_lock, K_FOREVER);
+	rc = settings_cache_flush(cs);
+	k_mutex_unlock(&settings_lock);
+
+	return rc;
+}
+
+void settings_cache_init(void)
+{
+	k_delayed_work_init(&settings_cache_work, settings_cache_work_handler);
+}
@@ -18,8 +18,29 @@ LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
 struct settings_nvs_read_fn_arg {
 	struct nvs_fs *fs;
 	u16_t id;
+	u32_t addr;
 };
 
+/* Address of the name and value entries of a setting, found in a single
+ * walk through NVS for a range of name ids when loading.
+ */
+struct settings_nvs_index {
+	u32_t name_addr;
+	u32_t val_addr;
+};
+
+struct settings_nvs_index_arg {
+	u16_t first_id;
+	u16_t cnt;
+	u16_t missing;
+};
+
+#define SETTINGS_NVS_NO_ADDR 0xFFFFFFFF
+
+/* Loading is done with the settings lock held */
+static struct settings_nvs_index
+	settings_nvs_index[CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE];
+
 static int settings_nvs_load(struct settings_store *cs, const char *subtree);
 static int settings_nvs_save(struct settings_store *cs, const char *name,
 			     const char *value, size_t val_len);
@@ -32,10 +53,18 @@ static struct settings_store_itf settings_nvs_itf = {
 static ssize_t settings_nvs_read_fn(void *back_end, void *data, size_t len)
 {
 	struct settings_nvs_read_fn_arg *rd_fn_arg;
+	ssize_t rc;
 
 	rd_fn_arg = (struct settings_nvs_read_fn_arg *)back_end;
 
-	return nvs_read(rd_fn_arg->fs, rd_fn_arg->id, data, len);
+	rc = nvs_read_addr(rd_fn_arg->fs, rd_fn_arg->id, rd_fn_arg->addr, data,
+			   len);
+	if (rc == -ENOENT) {
+		/* The entry was moved by a write from the handler */
+		rc = nvs_read(rd_fn_arg->fs, rd_fn_arg->id, data, len);
+	}
+
+	return rc;
 }
 
 int settings_nvs_src(struct settings_nvs *cf)
@@ -54,70 +83,146 @@ int settings_nvs_dst(struct settings_nvs *cf)
 	return 0;
 }
 
+static int settings_nvs_index_cb(u16_t id, u32_t addr, size_t len, void *arg)
+{
+	struct settings_nvs_index_arg *index_arg;
+	u32_t *index_addr;
+	u16_t i;
+
+	index_arg = (struct settings_nvs_index_arg *)arg;
+
+	i = id - index_arg->first_id;
+	if (i < index_arg->cnt) {
+		index_addr = &settings_nvs_index[i].name_addr;
+	} else {
+		i -= NVS_NAME_ID_OFFSET;
+		if (i >= index_arg->cnt) {
+			return 0;
+		}
+		index_addr = &settings_nvs_index[i].val_addr;
+	}
+
+	/* The first entry found for an id is its latest one */
+	if (*index_addr == SETTINGS_NVS_NO_ADDR) {
+		*index_addr = addr;
+		index_arg->missing--;
+		if (!index_arg->missing) {
+			/* All found, stop the walk */
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static ssize_t settings_nvs_read_addr(struct settings_nvs *cf, u16_t id,
+				      u32_t addr, void *data, size_t len)
+{
+	if (addr == SETTINGS_NVS_NO_ADDR) {
+		return -ENOENT;
+	}
+
+	return nvs_read_addr(&cf->cf_nvs, id, addr, data, len);
+}
+
 static int settings_nvs_load(struct settings_store *cs, const char *subtree)
 {
 	struct settings_nvs *cf = (struct settings_nvs *)cs;
 	struct settings_nvs_read_fn_arg read_fn_arg;
-	struct settings_handler *ch;
+	struct settings_nvs_index_arg index_arg;
+	struct settings_nvs_index *index;
+	struct settings_handler_static *ch;
 	char name[SETTINGS_MAX_NAME_LEN + SETTINGS_EXTRA_LEN + 1];
 	char buf;
 	const char *name_argv;
 	ssize_t rc1, rc2;
-	u16_t name_id = NVS_NAMECNT_ID;
-
-	name_id = cf->last_name_id + 1;
+	u32_t ate_wra;
+	u16_t name_id;
+	int rc;
 
-	while (1) {
+	name_id = cf->last_name_id;
 
-		name_id--;
-		if (name_id == NVS_NAMECNT_ID) {
-			break;
+	while (name_id != NVS_NAMECNT_ID) {
+		/* Find the entries of the settings name_id and below, as many
+		 * as fit in the index, in a single walk through NVS.
+		 */
+		index_arg.cnt = MIN(name_id - NVS_NAMECNT_ID,
+				    ARRAY_SIZE(settings_nvs_index));
+		index_arg.first_id = name_id - index_arg.cnt + 1;
+		index_arg.missing = 2 * index_arg.cnt;
+		(void)memset(settings_nvs_index, 0xff,
+			     sizeof(settings_nvs_index));
+
+		rc = nvs_walk(&cf->cf_nvs, settings_nvs_index_cb, &index_arg);
+		if (rc < 0) {
+			return rc;
 		}
 
-		/* In the NVS backend, each setting item is stored in two NVS
-		 * entries one for the setting's name and one with the
-		 * setting's value.
-		 */
-		rc1 = nvs_read(&cf->cf_nvs, name_id, &name, sizeof(name));
-		rc2 = nvs_read(&cf->cf_nvs, name_id + NVS_NAME_ID_OFFSET,
-			       &buf, sizeof(buf));
+		ate_wra = cf->cf_nvs.ate_wra;
 
-		if ((rc1 <= 0) && (rc2 <= 0)) {
-			continue;
-		}
+		for (; name_id >= index_arg.first_id; name_id--) {
+			/* A write can move entries, find them again */
+			if (cf->cf_nvs.ate_wra != ate_wra) {
+				break;
+			}
+
+			index = &settings_nvs_index[name_id -
+						    index_arg.first_id];
 
-		if ((rc1 <= 0) || (rc2 <= 0)) {
-			/* Settings item is not stored correctly in the NVS.
-			 * NVS entry for its name or value is either missing
-			 * or deleted. Clean dirty entries to make space for
-			 * future settings item.
+			/* In the NVS backend, each setting item is stored in
+			 * two NVS entries one for the setting's name and one
+			 * with the setting's value.
 			 */
-			if (name_id == cf->last_name_id) {
-				cf->last_name_id--;
-				nvs_write(&cf->cf_nvs, NVS_NAMECNT_ID,
-					  &cf->last_name_id, sizeof(u16_t));
+			rc1 = settings_nvs_read_addr(cf, name_id,
+						     index->name_addr, &name,
+						     sizeof(name));
+			rc2 = settings_nvs_read_addr(cf, name_id +
+						     NVS_NAME_ID_OFFSET,
+						     index->val_addr, &buf,
+						     sizeof(buf));
+
+			if ((rc1 <= 0) && (rc2 <= 0)) {
+				continue;
 			}
-			nvs_delete(&cf->cf_nvs, name_id);
-			nvs_delete(&cf->cf_nvs, name_id + NVS_NAME_ID_OFFSET);
-			continue;
-		}
 
-		/* Found a name, this might not include a trailing \0 */
-		name[rc1] = '\0';
+			if ((rc1 <= 0) || (rc2 <= 0)) {
+				/* Settings item is not stored correctly in
+				 * the NVS. NVS entry for its name or value is
+				 * either missing or deleted. Clean dirty
+				 * entries to make space for future settings
+				 * item.
+				 */
+				if (name_id == cf->last_name_id) {
+					cf->last_name_id--;
+					nvs_write(&cf->cf_nvs, NVS_NAMECNT_ID,
+						  &cf->last_name_id,
+						  sizeof(u16_t));
+				}
+				nvs_delete(&cf->cf_nvs, name_id);
+				nvs_delete(&cf->cf_nvs,
+					   name_id + NVS_NAME_ID_OFFSET);
+				continue;
+			}
 
-		if (subtree && !settings_name_steq(name, subtree, NULL)) {
-			continue;
-		}
+			/* Found a name, this might not include a trailing \0 */
+			name[MIN(rc1, sizeof(name) - 1)] = '\0';
 
-		ch = settings_parse_and_lookup(name, &name_argv);
-		if (!ch) {
-			continue;
-		}
+			if (subtree &&
+			    !settings_name_steq(name, subtree, NULL)) {
+				continue;
+			}
 
-		read_fn_arg.fs = &cf->cf_nvs;
-		read_fn_arg.id = name_id + NVS_NAME_ID_OFFSET;
-		ch->h_set(name_argv, rc2, settings_nvs_read_fn,
-			  (void *) &read_fn_arg);
+			ch = settings_parse_and_lookup(name, &name_argv);
+			if (!ch) {
+				continue;
+			}
+
+			read_fn_arg.fs = &cf->cf_nvs;
+			read_fn_arg.id = name_id + NVS_NAME_ID_OFFSET;
+			read_fn_arg.addr = index->val_addr;
+			ch->h_set(name_argv, rc2, settings_nvs_read_fn,
+				  (void *) &read_fn_arg);
+		}
 	}
 	return 0;
 }
@@ -119,6 +119,15 @@ void settings_line_io_init(int (*read_cb)(void *ctx, off_t off, char *buf,
 			  u8_t io_rwbs);
 
 
+#if defined(CONFIG_SETTINGS_CACHE)
+void settings_cache_init(void);
+
+/* Called with the settings lock held */
+int settings_cache_save(struct settings_store *cs, const char *name,
+			const char *value, size_t val_len);
+int settings_cache_flush(struct settings_store *cs);
+#endif /* CONFIG_SETTINGS_CACHE */
+
 extern sys_slist_t settings_load_srcs;
 extern sys_slist_t settings_handlers;
 extern struct settings_store *settings_save_dst;
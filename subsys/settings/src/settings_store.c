@@ -59,6 +59,12 @@ int settings_load_subtree(const char *subtree)
 	 *    commit all
 	 */
 	k_mutex_lock(&settings_lock, K_FOREVER);
+#if defined(CONFIG_SETTINGS_CACHE)
+	/* Let the back-ends load the latest values */
+	if (settings_save_dst) {
+		settings_cache_flush(settings_save_dst);
+	}
+#endif /* CONFIG_SETTINGS_CACHE */
 	SYS_SLIST_FOR_EACH_CONTAINER(&settings_load_srcs, cs, cs_next) {
 		cs->cs_itf->csi_load(cs, subtree);
 	}
@@ -82,7 +88,11 @@ int settings_save_one(const char *name, const void *value, size_t val_len)
 
 	k_mutex_lock(&settings_lock, K_FOREVER);
 
+#if defined(CONFIG_SETTINGS_CACHE)
+	rc = settings_cache_save(cs, name, (char *)value, val_len);
+#else
 	rc = cs->cs_itf->csi_save(cs, name, (char *)value, val_len);
+#endif /* CONFIG_SETTINGS_CACHE */
 
 	k_mutex_unlock(&settings_lock);
 
@@ -131,6 +141,13 @@ int settings_save(void)
 	}
 #endif /* CONFIG_SETTINGS_DYNAMIC_HANDLERS */
 
+#if defined(CONFIG_SETTINGS_CACHE)
+	rc2 = settings_flush();
+	if (!rc) {
+		rc = rc2;
+	}
+#endif /* CONFIG_SETTINGS_CACHE */
+
 	if (cs->cs_itf->csi_save_end) {
 		cs->cs_itf->csi_save_end(cs);
 	}
@@ -140,4 +157,7 @@ int settings_save(void)
 void settings_store_init(void)
 {
 	sys_slist_init(&settings_load_srcs);
+#if defined(CONFIG_SETTINGS_CACHE)
+	settings_cache_init();
+#endif /* CONFIG_SETTINGS_CACHE */
 }
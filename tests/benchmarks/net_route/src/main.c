@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <net/net_if.h>
+#include <net/net_ip.h>
+#include <net/dummy.h>
+
+#include "ipv6.h"
+#include "route.h"
+
+/* IPv6 route lookup benchmark. The routing table is filled with
+ * growing numbers of routes, every fourth one a /64 prefix and the
+ * others /128 host routes in a common /64, going through a handful of
+ * next hop neighbors. For each table size, net_route_lookup() is timed
+ * for destinations cycling over all the routes, and for a single
+ * destination looked up again and again. The cost of the linear scan
+ * grows with the number of routes, the one of the trie with the length
+ * of the prefixes.
+ */
+
+#define NEXTHOPS 4
+#define LOOKUPS 4096
+
+static const int sizes[] = { 8, 32, 64, 128, 256 };
+
+static struct in6_addr dst[CONFIG_NET_MAX_ROUTES];
+static struct net_route_entry *routes[CONFIG_NET_MAX_ROUTES];
+static struct in6_addr nexthops[NEXTHOPS];
+static struct net_if *iface;
+
+static u8_t mac[NEXTHOPS][6];
+
+static int bench_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void bench_iface_init(struct net_if *iface)
+{
+	static u8_t my_mac[] = { 0x00, 0x00, 0x5e, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, my_mac, sizeof(my_mac), NET_LINK_DUMMY);
+}
+
+static int bench_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api bench_if_api = {
+	.iface_api.init = bench_iface_init,
+	.send = bench_send,
+};
+
+NET_DEVICE_INIT(net_route_bench, "net_route_bench", bench_dev_init, NULL,
+		NULL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &bench_if_api,
+		DUMMY_L2, NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static void add_nexthops(void)
+{
+	struct net_linkaddr lladdr;
+	int i;
+
+	for (i = 0; i < NEXTHOPS; i++) {
+		net_ipv6_addr_create(&nexthops[i], 0xfe80, 0, 0, 0,
+				     0x0200, 0x5eff, 0xfe00, 0x5310 + i);
+
+		mac[i][0] = 0x00;
+		mac[i][2] = 0x5e;
+		mac[i][4] = 0x53;
+		mac[i][5] = 0x10 + i;
+
+		lladdr.addr = mac[i];
+		lladdr.len = sizeof(mac[i]);
+		lladdr.type = NET_LINK_DUMMY;
+
+		if (!net_ipv6_nbr_add(iface, &nexthops[i], &lladdr, false,
+				      NET_IPV6_NBR_STATE_REACHABLE)) {
+			printk("Cannot add neighbor %d\n", i);
+		}
+	}
+}
+
+static bool add_route(int i)
+{
+	struct in6_addr prefix;
+	u8_t len;
+
+	if (i % 4 == 0) {
+		net_ipv6_addr_create(&prefix, 0x2001, 0x0db8, i + 1, 0,
+				     0, 0, 0, 0);
+		net_ipv6_addr_create(&dst[i], 0x2001, 0x0db8, i + 1, 0,
+				     0, 0, 0, 0x42);
+		len = 64U;
+	} else {
+		net_ipv6_addr_create(&prefix, 0x2001, 0x0db8, 0, 0xffff,
+				     0, 0, 0, i + 1);
+		net_ipaddr_copy(&dst[i], &prefix);
+		len = 128U;
+	}
+
+	routes[i] = net_route_add(iface, &prefix, len,
+				  &nexthops[i % NEXTHOPS]);
+
+	return routes[i] != NULL;
+}
+
+static u32_t time_lookups(int count, bool same)
+{
+	u32_t start_cycles, cycles;
+	int errors = 0;
+	int i;
+
+	start_cycles = k_cycle_get_32();
+
+	for (i = 0; i < LOOKUPS; i++) {
+		int n = same ? count / 2 : i % count;
+
+		if (net_route_lookup(iface, &dst[n]) != routes[n]) {
+			errors++;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start_cycles;
+
+	if (errors) {
+		printk("%d lookups found the wrong route!\n", errors);
+	}
+
+	return cycles;
+}
+
+static void report(int count, const char *pattern, u32_t cycles)
+{
+	u32_t per_lookup = cycles / LOOKUPS;
+	u32_t per_sec = 0U;
+
+	if (cycles) {
+		per_sec = (u64_t)LOOKUPS * sys_clock_hw_cycles_per_sec() /
+			cycles;
+	}
+
+	printk("routes %3d%s %8u cycles/lookup %8u lookups/s\n", count,
+	       pattern, per_lookup, per_sec);
+}
+
+void main(void)
+{
+	int count = 0;
+	int i;
+
+	iface = net_if_get_default();
+
+	add_nexthops();
+
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		if (sizes[i] > CONFIG_NET_MAX_ROUTES) {
+			break;
+		}
+
+		while (count < sizes[i]) {
+			if (!add_route(count)) {
+				printk("Cannot add route %d\n", count);
+				return;
+			}
+
+			count++;
+		}
+
+		report(count, "     ", time_lookups(count, false));
+		report(count, " same", time_lookups(count, true));
+	}
+
+	printk("fin\n");
+}
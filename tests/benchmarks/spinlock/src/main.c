@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+#include <spinlock.h>
+#include <kernel_structs.h>
+
+/* This is a spinlock contention microbenchmark.  One thread per CPU
+ * (the main thread being one of them) hammers a single shared
+ * k_spinlock for a fixed window of time: take the lock, touch some
+ * shared data for "hold" iterations, release it, then do a fixed
+ * amount of private work before trying again.  At the end of each
+ * window it reports, per CPU, how many times the lock was acquired
+ * and the longest wait for it, then the aggregate throughput and a
+ * fairness figure (the least served CPU's count as a percentage of
+ * the most served one's).
+ *
+ * Build with CONFIG_SPINLOCK_TAS, CONFIG_SPINLOCK_TICKET or
+ * CONFIG_SPINLOCK_MCS to compare the implementations.  The numbers
+ * are only meaningful with one host core per emulated CPU.
+ */
+
+#if CONFIG_MP_NUM_CPUS < 2
+#error Spinlock benchmark requires at least two CPUs!
+#endif
+
+#define N_CPUS CONFIG_MP_NUM_CPUS
+#define STACK_SIZE 1024
+#define WINDOW_MS 500
+#define OUTSIDE_WORK 64
+
+#if defined(CONFIG_SPINLOCK_TICKET)
+#define ALGORITHM "ticket"
+#elif defined(CONFIG_SPINLOCK_MCS)
+#define ALGORITHM "mcs"
+#else
+#define ALGORITHM "tas"
+#endif
+
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, N_CPUS - 1, STACK_SIZE);
+static struct k_thread threads[N_CPUS - 1];
+
+struct contender {
+	u32_t count;
+	u32_t max_wait;
+	int cpu;
+};
+
+static struct k_spinlock lock;
+static volatile u32_t shared[8];
+
+static struct contender contenders[N_CPUS];
+static volatile int hold_iters;
+static atomic_t ready;
+static atomic_t done;
+static volatile int go;
+static u32_t window_cycles;
+
+static void contend(struct contender *c)
+{
+	u32_t start = k_cycle_get_32();
+	volatile u32_t private = 0U;
+
+	c->count = 0U;
+	c->max_wait = 0U;
+
+	while (k_cycle_get_32() - start < window_cycles) {
+		u32_t t0 = k_cycle_get_32();
+		k_spinlock_key_t key = k_spin_lock(&lock);
+		u32_t wait = k_cycle_get_32() - t0;
+
+		for (int i = 0; i < hold_iters; i++) {
+			shared[i % ARRAY_SIZE(shared)]++;
+		}
+		k_spin_unlock(&lock, key);
+
+		c->count++;
+		if (wait > c->max_wait) {
+			c->max_wait = wait;
+		}
+
+		for (int i = 0; i < OUTSIDE_WORK; i++) {
+			private++;
+		}
+	}
+
+	c->cpu = _current_cpu->id;
+}
+
+static void contender_fn(void *arg1, void *arg2, void *arg3)
+{
+	struct contender *c = arg1;
+
+	ARG_UNUSED(arg2);
+	ARG_UNUSED(arg3);
+
+	while (true) {
+		int round = go;
+
+		(void)atomic_inc(&ready);
+		while (go == round) {
+		}
+
+		contend(c);
+		(void)atomic_inc(&done);
+	}
+}
+
+static void run(int hold)
+{
+	u32_t total = 0U, min = UINT32_MAX, max = 0U, max_wait = 0U;
+
+	hold_iters = hold;
+
+	/* Wait for the other contenders to be parked on their CPUs */
+	while (atomic_get(&ready) < N_CPUS - 1) {
+	}
+	(void)atomic_clear(&ready);
+	(void)atomic_clear(&done);
+
+	go++;
+	contend(&contenders[N_CPUS - 1]);
+
+	while (atomic_get(&done) < N_CPUS - 1) {
+	}
+
+	for (int i = 0; i < N_CPUS; i++) {
+		struct contender *c = &contenders[i];
+
+		printk("  cpu %d: %8u acquisitions, max wait %8u cycles\n",
+		       c->cpu, c->count, c->max_wait);
+		total += c->count;
+		min = MIN(min, c->count);
+		max = MAX(max, c->count);
+		max_wait = MAX(max_wait, c->max_wait);
+	}
+
+	printk("%s: hold %3d total %8u (%u/ms) fairness %3u%% max wait %u\n",
+	       ALGORITHM, hold, total, total / WINDOW_MS,
+	       max ? (u32_t)((u64_t)min * 100U / max) : 0U, max_wait);
+}
+
+void main(void)
+{
+	static const int holds[] = { 1, 16, 256 };
+
+	window_cycles = (u32_t)((u64_t)sys_clock_hw_cycles_per_sec() *
+				WINDOW_MS / MSEC_PER_SEC);
+
+	/* Run cooperatively, above the contenders, so creating them
+	 * doesn't preempt us: they get picked up by the other CPUs
+	 */
+	k_thread_priority_set(k_current_get(), K_PRIO_COOP(1));
+
+	for (int i = 0; i < N_CPUS - 1; i++) {
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				contender_fn, &contenders[i], NULL, NULL,
+				K_PRIO_COOP(2), 0, K_NO_WAIT);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(holds); i++) {
+		run(holds[i]);
+	}
+
+#ifdef CONFIG_SPINLOCK_STATS
+	printk("lock acquired %u times, %u contended\n",
+	       lock.acquired, lock.contended);
+#endif
+	printk("fin\n");
+}
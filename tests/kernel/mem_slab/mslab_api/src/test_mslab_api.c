@@ -222,3 +222,52 @@ void test_mslab_used_get(void)
 	tmslab_used_get(&mslab);
 	tmslab_used_get(&kmslab);
 }
+
+/**
+ * @brief Verify the per-CPU block cache of a memory slab
+ *
+ * @details Allocate every block, check the slab is exhausted, then
+ * free them all.  The freed blocks must stay cached on this CPU yet
+ * still be reported as free, and allocating them again must be
+ * served entirely from the cache.
+ *
+ * @ingroup kernel_memory_slab_tests
+ */
+void test_mslab_magazine(void)
+{
+#ifdef CONFIG_MEM_SLAB_MAGAZINE
+	struct k_mem_slab_magazine_stats before, after;
+	void *block[BLK_NUM];
+
+	for (int i = 0; i < BLK_NUM; i++) {
+		zassert_equal(k_mem_slab_alloc(&mslab, &block[i], K_NO_WAIT),
+			      0, NULL);
+	}
+	zassert_equal(k_mem_slab_num_free_get(&mslab), 0, NULL);
+	zassert_equal(k_mem_slab_alloc(&mslab, &block[0], K_NO_WAIT),
+		      -ENOMEM, NULL);
+
+	for (int i = 0; i < BLK_NUM; i++) {
+		k_mem_slab_free(&mslab, &block[i]);
+	}
+	k_mem_slab_magazine_stats_get(&mslab, &before);
+	zassert_equal(before.cached, BLK_NUM, NULL);
+	zassert_true(before.refills > 0, NULL);
+	zassert_equal(k_mem_slab_num_free_get(&mslab), BLK_NUM, NULL);
+
+	for (int i = 0; i < BLK_NUM; i++) {
+		zassert_equal(k_mem_slab_alloc(&mslab, &block[i], K_NO_WAIT),
+			      0, NULL);
+	}
+	k_mem_slab_magazine_stats_get(&mslab, &after);
+	zassert_equal(after.hits - before.hits, BLK_NUM, NULL);
+	zassert_equal(after.misses, before.misses, NULL);
+	zassert_equal(after.cached, 0, NULL);
+
+	for (int i = 0; i < BLK_NUM; i++) {
+		k_mem_slab_free(&mslab, &block[i]);
+	}
+#else
+	ztest_test_skip();
+#endif
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "test_msgq.h"
+
+#define BATCH_LEN 8
+#define N_READERS 2
+
+K_MSGQ_DEFINE(bmsgq, sizeof(u32_t), BATCH_LEN, 4);
+static K_THREAD_STACK_ARRAY_DEFINE(rstack, N_READERS, STACK_SIZE);
+static struct k_thread rdata[N_READERS];
+static u32_t received[N_READERS];
+
+static void reader(void *p1, void *p2, void *p3)
+{
+	u32_t *rx = p1;
+
+	zassert_equal(k_msgq_get_n(&bmsgq, rx, 4, K_FOREVER), 1, NULL);
+}
+
+static void start_readers(void)
+{
+	for (int i = 0; i < N_READERS; i++) {
+		received[i] = 0U;
+		k_thread_create(&rdata[i], rstack[i], STACK_SIZE, reader,
+				&received[i], NULL, NULL,
+				K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+	}
+
+	/* Let them block on the empty queue */
+	k_sleep(TIMEOUT);
+}
+
+static void check_readers(u32_t first)
+{
+	for (int i = 0; i < N_READERS; i++) {
+		zassert_equal(received[i], first + i, NULL);
+		k_thread_abort(&rdata[i]);
+	}
+}
+
+/**
+ * @brief Test batched send and receive
+ *
+ * @details Fill the queue in two batches, the second of which only
+ * partly fits, then drain it in batches that wrap around the end of
+ * the ring buffer, checking messages stay in order.
+ *
+ * @see k_msgq_put_n(), k_msgq_get_n()
+ */
+void test_msgq_put_get_n(void)
+{
+	u32_t tx[BATCH_LEN * 2], rx[BATCH_LEN * 2];
+
+	for (int i = 0; i < ARRAY_SIZE(tx); i++) {
+		tx[i] = i;
+	}
+
+	k_msgq_purge(&bmsgq);
+	zassert_equal(k_msgq_get_n(&bmsgq, rx, 1, K_NO_WAIT), -ENOMSG, NULL);
+
+	zassert_equal(k_msgq_put_n(&bmsgq, tx, 5, K_NO_WAIT), 5, NULL);
+	/**TESTPOINT: only the messages that fit are sent*/
+	zassert_equal(k_msgq_put_n(&bmsgq, &tx[5], 5, K_NO_WAIT), 3, NULL);
+	zassert_equal(k_msgq_put_n(&bmsgq, &tx[8], 1, K_NO_WAIT), -ENOMSG,
+		      NULL);
+	zassert_equal(k_msgq_put_n(&bmsgq, &tx[8], 1, TIMEOUT), -EAGAIN,
+		      NULL);
+
+	zassert_equal(k_msgq_get_n(&bmsgq, rx, 6, K_NO_WAIT), 6, NULL);
+	zassert_equal(k_msgq_put_n(&bmsgq, &tx[8], 4, K_NO_WAIT), 4, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 6, NULL);
+
+	/**TESTPOINT: receiving wraps around the ring buffer*/
+	zassert_equal(k_msgq_get_n(&bmsgq, &rx[6], ARRAY_SIZE(rx) - 6,
+				   K_NO_WAIT), 6, NULL);
+	for (int i = 0; i < 12; i++) {
+		zassert_equal(rx[i], i, "message %d out of order", i);
+	}
+
+	zassert_equal(k_msgq_num_free_get(&bmsgq), BATCH_LEN, NULL);
+}
+
+/**
+ * @brief Test batched send to waiting receivers
+ *
+ * @details Messages go to blocked receivers first, in order, and the
+ * rest are queued.
+ *
+ * @see k_msgq_put_n(), k_msgq_get_n()
+ */
+void test_msgq_put_n_readers(void)
+{
+	u32_t tx[3] = { 10, 11, 12 }, rx;
+
+	k_msgq_purge(&bmsgq);
+	start_readers();
+
+	zassert_equal(k_msgq_put_n(&bmsgq, tx, ARRAY_SIZE(tx), K_NO_WAIT),
+		      ARRAY_SIZE(tx), NULL);
+	check_readers(10);
+
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 1, NULL);
+	zassert_equal(k_msgq_get(&bmsgq, &rx, K_NO_WAIT), 0, NULL);
+	zassert_equal(rx, 12, NULL);
+}
+
+/**
+ * @brief Test zero-copy slot reservation
+ *
+ * @details Reserved slots are hidden from receivers and block other
+ * senders until committed, a partial commit releases the rest of the
+ * reservation, and a reservation stops at the end of the ring buffer.
+ *
+ * @see k_msgq_reserve(), k_msgq_commit()
+ */
+void test_msgq_reserve_commit(void)
+{
+	u32_t *slots, msg = 0U, rx[BATCH_LEN];
+	int to_end;
+
+	k_msgq_purge(&bmsgq);
+
+	zassert_equal(k_msgq_reserve(&bmsgq, (void **)&slots, 3), 3, NULL);
+	zassert_equal(k_msgq_reserve(&bmsgq, (void **)&slots, 1), -EBUSY,
+		      NULL);
+	zassert_equal(k_msgq_put(&bmsgq, &msg, K_NO_WAIT), -EBUSY, NULL);
+	zassert_equal(k_msgq_put_n(&bmsgq, &msg, 1, K_NO_WAIT), -EBUSY,
+		      NULL);
+	zassert_equal(k_msgq_num_free_get(&bmsgq), BATCH_LEN - 3, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 0, NULL);
+
+	slots[0] = 20;
+	slots[1] = 21;
+	zassert_equal(k_msgq_commit(&bmsgq, 3 + 1), -EINVAL, NULL);
+	zassert_equal(k_msgq_commit(&bmsgq, 2), 0, NULL);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 2, NULL);
+	zassert_equal(k_msgq_num_free_get(&bmsgq), BATCH_LEN - 2, NULL);
+
+	/**TESTPOINT: a reservation stops at the end of the ring*/
+	to_end = (u32_t *)bmsgq.buffer_end - (u32_t *)bmsgq.write_ptr;
+	zassert_equal(k_msgq_reserve(&bmsgq, (void **)&slots, BATCH_LEN),
+		      MIN(to_end, BATCH_LEN - 2), NULL);
+	zassert_equal(k_msgq_commit(&bmsgq, 0), 0, NULL);
+
+	zassert_equal(k_msgq_get_n(&bmsgq, rx, BATCH_LEN, K_NO_WAIT), 2,
+		      NULL);
+	zassert_equal(rx[0], 20, NULL);
+	zassert_equal(rx[1], 21, NULL);
+
+	/**TESTPOINT: committing wakes waiting receivers*/
+	start_readers();
+	for (int i = 0; i < N_READERS; i++) {
+		zassert_equal(k_msgq_reserve(&bmsgq, (void **)&slots, 1), 1,
+			      NULL);
+		slots[0] = 30 + i;
+		zassert_equal(k_msgq_commit(&bmsgq, 1), 0, NULL);
+	}
+	check_readers(30);
+	zassert_equal(k_msgq_num_used_get(&bmsgq), 0, NULL);
+}
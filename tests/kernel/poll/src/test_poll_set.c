@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <kernel.h>
+
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define NUM_SEMS 16
+
+#ifdef CONFIG_POLL_SET
+static struct k_poll_set set;
+static struct k_sem sems[NUM_SEMS];
+static struct k_fifo set_fifo;
+static struct k_poll_signal set_signal;
+static struct k_poll_event events[NUM_SEMS + 2];
+
+static struct k_thread set_thread;
+static K_THREAD_STACK_DEFINE(set_stack, STACK_SIZE);
+
+static void set_setup(void)
+{
+	k_poll_set_init(&set);
+	k_fifo_init(&set_fifo);
+	k_poll_signal_init(&set_signal);
+
+	for (int i = 0; i < NUM_SEMS; i++) {
+		k_sem_init(&sems[i], 0, 1);
+		k_poll_event_init(&events[i], K_POLL_TYPE_SEM_AVAILABLE,
+				  K_POLL_MODE_NOTIFY_ONLY, &sems[i]);
+	}
+	k_poll_event_init(&events[NUM_SEMS], K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+			  K_POLL_MODE_NOTIFY_ONLY, &set_fifo);
+	k_poll_event_init(&events[NUM_SEMS + 1], K_POLL_TYPE_SIGNAL,
+			  K_POLL_MODE_NOTIFY_ONLY, &set_signal);
+
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		zassert_equal(k_poll_set_add(&set, &events[i]), 0, NULL);
+	}
+}
+
+static void set_teardown(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		zassert_equal(k_poll_set_remove(&set, &events[i]), 0, NULL);
+	}
+}
+#endif
+
+/**
+ * @brief Test persistent poll set readiness
+ *
+ * @details Events stay registered across waits, readiness is level
+ * triggered, only ready events are returned, the number returned is
+ * bounded by the caller's array and ready events are returned in
+ * round-robin order.
+ *
+ * @ingroup kernel_poll_tests
+ *
+ * @see k_poll_set_init(), k_poll_set_add(), k_poll_set_remove(),
+ * k_poll_set_wait()
+ */
+void test_poll_set_ready(void)
+{
+#ifdef CONFIG_POLL_SET
+	struct k_poll_event *ready[4];
+	struct k_poll_event ignore;
+	static struct fifo_item {
+		void *reserved;
+	} item;
+
+	set_setup();
+
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), -EAGAIN, NULL);
+
+	/**TESTPOINT: an available object is reported on every wait*/
+	k_sem_give(&sems[5]);
+	for (int i = 0; i < 2; i++) {
+		zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+					      K_NO_WAIT), 1, NULL);
+		zassert_equal_ptr(ready[0], &events[5], NULL);
+		zassert_equal(ready[0]->state, K_POLL_STATE_SEM_AVAILABLE,
+			      NULL);
+	}
+
+	/**TESTPOINT: it drops off once the object is taken*/
+	zassert_equal(k_sem_take(&sems[5], K_NO_WAIT), 0, NULL);
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), -EAGAIN, NULL);
+	zassert_equal(events[5].state, K_POLL_STATE_NOT_READY, NULL);
+
+	k_fifo_put(&set_fifo, &item);
+	k_poll_signal_raise(&set_signal, 0);
+	k_sem_give(&sems[0]);
+	k_sem_give(&sems[NUM_SEMS - 1]);
+	k_sem_give(&sems[7]);
+
+	/**TESTPOINT: at most num_events are returned, round-robin*/
+	zassert_equal(k_poll_set_wait(&set, ready, 2, K_NO_WAIT), 2, NULL);
+	zassert_equal_ptr(ready[0], &events[NUM_SEMS], NULL);
+	zassert_equal(ready[0]->state, K_POLL_STATE_FIFO_DATA_AVAILABLE,
+		      NULL);
+	zassert_equal_ptr(ready[1], &events[NUM_SEMS + 1], NULL);
+	zassert_equal(ready[1]->state, K_POLL_STATE_SIGNALED, NULL);
+
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), 4, NULL);
+	zassert_equal_ptr(ready[0], &events[0], NULL);
+	zassert_equal_ptr(ready[1], &events[NUM_SEMS - 1], NULL);
+	zassert_equal_ptr(ready[2], &events[7], NULL);
+	zassert_equal_ptr(ready[3], &events[NUM_SEMS], NULL);
+
+	zassert_equal_ptr(k_fifo_get(&set_fifo, K_NO_WAIT), &item, NULL);
+	k_poll_signal_reset(&set_signal);
+	for (int i = 0; i < NUM_SEMS; i++) {
+		(void)k_sem_take(&sems[i], K_NO_WAIT);
+	}
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), -EAGAIN, NULL);
+
+	/**TESTPOINT: registration errors*/
+	zassert_equal(k_poll_set_add(&set, &events[3]), -EBUSY, NULL);
+	k_poll_event_init(&ignore, K_POLL_TYPE_IGNORE,
+			  K_POLL_MODE_NOTIFY_ONLY, &sems[0]);
+	zassert_equal(k_poll_set_add(&set, &ignore), -EINVAL, NULL);
+	zassert_equal(k_poll_set_remove(&set, &ignore), -EINVAL, NULL);
+
+	/**TESTPOINT: a removed event is no longer reported*/
+	zassert_equal(k_poll_set_remove(&set, &events[3]), 0, NULL);
+	k_sem_give(&sems[3]);
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), -EAGAIN, NULL);
+	zassert_equal(k_poll_set_add(&set, &events[3]), 0, NULL);
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), 1, NULL);
+	zassert_equal(k_sem_take(&sems[3], K_NO_WAIT), 0, NULL);
+
+	set_teardown();
+#else
+	ztest_test_skip();
+#endif
+}
+
+#ifdef CONFIG_POLL_SET
+static struct k_poll_event poller_event;
+static int poller_rc;
+static K_SEM_DEFINE(helper_done, 0, 1);
+
+static void set_helper(void *p1, void *p2, void *p3)
+{
+	int action = POINTER_TO_INT(p1);
+
+	k_sleep(50);
+
+	switch (action) {
+	case 0:
+		k_sem_give(&sems[9]);
+		break;
+	case 1:
+		k_queue_cancel_wait(&set_fifo._queue);
+		break;
+	case 2:
+		/* Wait with k_poll() on an object in the set */
+		k_poll_event_init(&poller_event, K_POLL_TYPE_SEM_AVAILABLE,
+				  K_POLL_MODE_NOTIFY_ONLY, &sems[2]);
+		poller_rc = k_poll(&poller_event, 1, K_FOREVER);
+		break;
+	}
+
+	k_sem_give(&helper_done);
+}
+
+/* The helper runs at a lower priority than the test thread, so it is
+ * preempted as soon as it gives helper_done and has to be aborted
+ * before its thread object can be reused.
+ */
+static void start_helper(int action)
+{
+	k_thread_create(&set_thread, set_stack, STACK_SIZE, set_helper,
+			INT_TO_POINTER(action), NULL, NULL,
+			k_thread_priority_get(k_current_get()) + 1, 0,
+			K_NO_WAIT);
+}
+
+static void stop_helper(void)
+{
+	k_sem_take(&helper_done, K_FOREVER);
+	k_thread_abort(&set_thread);
+}
+#endif
+
+/**
+ * @brief Test waiting on a persistent poll set
+ *
+ * @details A waiter is woken when an object becomes available, times
+ * out otherwise, gets -EINTR when a queue in the set is cancelled (the
+ * next wait gets the cancelled event if there was no waiter), and an
+ * object can be in a poll set and be waited on with k_poll() at the
+ * same time.
+ *
+ * @ingroup kernel_poll_tests
+ *
+ * @see k_poll_set_wait(), k_queue_cancel_wait()
+ */
+void test_poll_set_wait(void)
+{
+#ifdef CONFIG_POLL_SET
+	struct k_poll_event *ready[4];
+
+	set_setup();
+
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready), 20),
+		      -EAGAIN, NULL);
+
+	start_helper(0);
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_FOREVER), 1, NULL);
+	zassert_equal_ptr(ready[0], &events[9], NULL);
+	zassert_equal(k_sem_take(&sems[9], K_NO_WAIT), 0, NULL);
+	stop_helper();
+
+	/**TESTPOINT: cancelling a queue interrupts the wait*/
+	start_helper(1);
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_SECONDS(1)), -EINTR, NULL);
+	stop_helper();
+
+	/**TESTPOINT: a cancellation without a waiter is returned once*/
+	k_queue_cancel_wait(&set_fifo._queue);
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), 1, NULL);
+	zassert_equal_ptr(ready[0], &events[NUM_SEMS], NULL);
+	zassert_equal(ready[0]->state, K_POLL_STATE_CANCELLED, NULL);
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), -EAGAIN, NULL);
+
+	/**TESTPOINT: k_poll() callers are still notified*/
+	start_helper(2);
+	k_sleep(100);
+	k_sem_give(&sems[2]);
+	stop_helper();
+	zassert_equal(poller_rc, 0, NULL);
+	zassert_equal(poller_event.state, K_POLL_STATE_SEM_AVAILABLE, NULL);
+	zassert_equal(k_poll_set_wait(&set, ready, ARRAY_SIZE(ready),
+				      K_NO_WAIT), 1, NULL);
+	zassert_equal_ptr(ready[0], &events[2], NULL);
+	zassert_equal(k_sem_take(&sems[2], K_NO_WAIT), 0, NULL);
+
+	set_teardown();
+#else
+	ztest_test_skip();
+#endif
+}
@@ -430,6 +430,85 @@ void test_wakeup_threads(void)
 	cleanup_resources();
 }
 
+K_SEM_DEFINE(pend_sema, 0, 1);
+
+#define ABORT_ROUNDS 20
+
+static volatile int pend_loops[THREADS_NUM];
+
+static void thread_pend_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+	int thread_num = (int)p1;
+
+	while (true) {
+		(void)k_sem_take(&pend_sema, 1);
+		pend_loops[thread_num]++;
+	}
+}
+
+static void wait_for_pend_loops(int tnum)
+{
+	s64_t end = k_uptime_get() + TIMEOUT;
+
+	/* A thread whose unpend was lost stays pending with nothing
+	 * to wake it up
+	 */
+	for (int i = 0; i < tnum; i++) {
+		int loops = pend_loops[i];
+
+		while (pend_loops[i] - loops < 2) {
+			zassert_true(k_uptime_get() < end,
+				     "thread %d stuck", i);
+			k_sem_give(&pend_sema);
+		}
+	}
+}
+
+/**
+ * @brief Test aborting threads pending on other CPUs
+ *
+ * @ingroup kernel_smp_tests
+ *
+ * @details Spawn threads on the remaining cores that keep pending on
+ * a semaphore, with a timeout, while the main thread gives it. Abort
+ * them while they pend, wake up or run, and check that each one ends
+ * up dead, out of the ready queue and out of the semaphore wait
+ * queue.
+ */
+void test_abort_pend_threads(void)
+{
+	for (int round = 0; round < ABORT_ROUNDS; round++) {
+		spawn_threads(K_PRIO_PREEMPT(1), THREADS_NUM - 1,
+			      EQUAL_PRIORITY, &thread_pend_entry,
+			      !THREAD_DELAY);
+
+		wait_for_pend_loops(THREADS_NUM - 1);
+
+		abort_threads(THREADS_NUM - 1);
+
+		for (int i = 0; i < THREADS_NUM - 1; i++) {
+			u8_t state = tinfo[i].tid->base.thread_state;
+
+			zassert_true(state & _THREAD_DEAD,
+				     "thread %d not dead", i);
+			zassert_false(state &
+				      (_THREAD_QUEUED | _THREAD_PENDING),
+				      "dead thread %d still queued", i);
+		}
+
+		/* Nobody is left to take it */
+		k_sem_reset(&pend_sema);
+		k_sem_give(&pend_sema);
+		zassert_equal(k_sem_count_get(&pend_sema), 1,
+			      "semaphore given to a dead thread");
+		k_sem_reset(&pend_sema);
+
+		cleanup_resources();
+	}
+}
+
 void test_main(void)
 {
 	/* Sleep a bit to guarantee that both CPUs enter an idle
@@ -445,7 +524,8 @@ void test_main(void)
 			 ztest_unit_test(test_preempt_resched_threads),
 			 ztest_unit_test(test_yield_threads),
 			 ztest_unit_test(test_sleep_threads),
-			 ztest_unit_test(test_wakeup_threads)
+			 ztest_unit_test(test_wakeup_threads),
+			 ztest_unit_test(test_abort_pend_threads)
 			 );
 	ztest_run_test_suite(smp);
 }
@@ -510,6 +510,91 @@ void test_delayed_work_cancel_isr(void)
 	}
 }
 
+#define POOL_THREADS 3
+
+static K_THREAD_STACK_ARRAY_DEFINE(pool_stacks, POOL_THREADS, STACK_SIZE);
+static struct k_thread pool_threads[POOL_THREADS];
+static struct k_work_q pool_workq;
+static struct k_work pool_work[POOL_THREADS];
+static struct k_delayed_work pool_delayed_work;
+static K_SEM_DEFINE(pool_release, 0, POOL_THREADS);
+static atomic_t pool_running;
+
+static void pool_work_handler(struct k_work *w)
+{
+	atomic_inc(&pool_running);
+	k_sem_take(&pool_release, K_FOREVER);
+	atomic_dec(&pool_running);
+	k_sem_give(&sync_sema);
+}
+
+/**
+ * @brief Test a work queue served by several threads
+ *
+ * @details Work items whose handlers block don't hold up the other
+ * items: each worker thread runs one of them concurrently.  Delayed
+ * work is processed as with a single thread work queue.
+ *
+ * @ingroup kernel_workqueue_tests
+ *
+ * @see k_work_q_pool_start(), k_work_q_stats_get()
+ */
+void test_workq_pool(void)
+{
+#ifdef CONFIG_WORKQUEUE_STATS
+	struct k_work_q_stats stats;
+
+	/* Left over from an earlier use of the queue object */
+	(void)memset(&pool_workq.stats, 0xff, sizeof(pool_workq.stats));
+#endif
+
+	k_work_q_pool_start(&pool_workq, pool_threads, pool_stacks[0],
+			    STACK_SIZE, POOL_THREADS,
+			    CONFIG_MAIN_THREAD_PRIORITY, false);
+	k_sem_reset(&sync_sema);
+
+#ifdef CONFIG_WORKQUEUE_STATS
+	/**TESTPOINT: statistics start from zero*/
+	k_work_q_stats_get(&pool_workq, &stats);
+	zassert_equal(stats.processed, 0, NULL);
+	zassert_equal(stats.wait_total, 0, NULL);
+	zassert_equal(stats.run_total, 0, NULL);
+#endif
+
+	for (int i = 0; i < POOL_THREADS; i++) {
+		k_work_init(&pool_work[i], pool_work_handler);
+		k_work_submit_to_queue(&pool_workq, &pool_work[i]);
+	}
+
+	/**TESTPOINT: every worker picks up a blocking item*/
+	k_sleep(TIMEOUT);
+	zassert_equal(atomic_get(&pool_running), POOL_THREADS, NULL);
+
+	for (int i = 0; i < POOL_THREADS; i++) {
+		k_sem_give(&pool_release);
+	}
+	for (int i = 0; i < POOL_THREADS; i++) {
+		zassert_equal(k_sem_take(&sync_sema, TIMEOUT), 0, NULL);
+	}
+	zassert_equal(atomic_get(&pool_running), 0, NULL);
+
+	/**TESTPOINT: delayed work on a pool work queue*/
+	k_delayed_work_init(&pool_delayed_work, new_work_handler);
+	zassert_equal(k_delayed_work_submit_to_queue(&pool_workq,
+						     &pool_delayed_work,
+						     TIMEOUT), 0, NULL);
+	zassert_equal(k_sem_take(&sync_sema, TIMEOUT * 2), 0, NULL);
+
+#ifdef CONFIG_WORKQUEUE_STATS
+	/* Statistics are updated once the handler has returned */
+	k_sleep(TIMEOUT);
+	k_work_q_stats_get(&pool_workq, &stats);
+	zassert_equal(stats.processed, POOL_THREADS + 1, NULL);
+	zassert_true(stats.run_max > 0, NULL);
+	zassert_true(stats.run_total >= stats.run_max, NULL);
+	zassert_true(stats.wait_total >= stats.wait_max, NULL);
+#endif
+}
 
 void test_main(void)
 {
@@ -542,6 +627,7 @@ void test_main(void)
 			 ztest_unit_test(test_delayed_work_cancel_from_queue_thread),
 			 ztest_unit_test(test_delayed_work_cancel_from_queue_isr),
 			 ztest_unit_test(test_delayed_work_cancel_thread),
-			 ztest_unit_test(test_delayed_work_cancel_isr));
+			 ztest_unit_test(test_delayed_work_cancel_isr),
+			 ztest_unit_test(test_workq_pool));
 	ztest_run_test_suite(workqueue_api);
 }
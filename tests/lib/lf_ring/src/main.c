@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+#include <sys/lf_ring.h>
+
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+#define N_PRODUCERS 3
+#define N_ITEMS 1000
+#define STREAM_BYTES 10000
+
+SPSC_RING_DECLARE(spsc, 5);
+MPSC_RING_DECLARE(mpsc, 8, 3);
+
+static K_THREAD_STACK_ARRAY_DEFINE(stacks, N_PRODUCERS, STACK_SIZE);
+static struct k_thread threads[N_PRODUCERS];
+
+struct item {
+	u32_t producer;
+	u32_t seq;
+};
+
+static K_SEM_DEFINE(done, 0, N_PRODUCERS);
+
+static struct mpsc_ring *isr_ring;
+static u32_t isr_seq;
+static int isr_ret;
+
+/**
+ * @brief Test single-producer, single-consumer copy and claim calls
+ *
+ * @details Data comes out in order across the end of the buffer and
+ * across the wrap of the free running indices, claims are limited to
+ * the free space and the contiguous part of the buffer, and finishing
+ * more than was claimed fails.
+ */
+void test_spsc_ring_claim(void)
+{
+	u8_t in[48], out[48], *data;
+	u32_t cap = spsc_ring_capacity_get(&spsc);
+
+	zassert_equal(cap, 32, NULL);
+	for (int i = 0; i < sizeof(in); i++) {
+		in[i] = i;
+	}
+
+	/* Start just below the index wrap */
+	atomic_set(&spsc.prod.head, -20);
+	atomic_set(&spsc.cons.tail, -20);
+	spsc.prod.tail_cache = spsc.cons.head_cache = -20;
+
+	for (int round = 0; round < 4; round++) {
+		zassert_equal(spsc_ring_put(&spsc, in, 24), 24, NULL);
+		zassert_equal(spsc_ring_used_get(&spsc), 24, NULL);
+		zassert_equal(spsc_ring_put(&spsc, in + 24, 24), cap - 24,
+			      NULL);
+		zassert_equal(spsc_ring_get(&spsc, out, sizeof(out)), cap,
+			      NULL);
+		zassert_mem_equal(in, out, cap, NULL);
+		zassert_equal(spsc_ring_used_get(&spsc), 0, NULL);
+		zassert_equal(spsc_ring_get(&spsc, out, 1), 0, NULL);
+	}
+
+	/* The buffer offset is now 12: a claim stops at the end */
+	zassert_equal(spsc_ring_put_claim(&spsc, &data, cap), 20, NULL);
+	zassert_equal(spsc_ring_put_claim(&spsc, &data, cap), 12, NULL);
+	zassert_equal(data, spsc.buf, NULL);
+	zassert_equal(spsc_ring_put_claim(&spsc, &data, cap), 0, NULL);
+	zassert_equal(spsc_ring_put_finish(&spsc, cap + 1), -EINVAL, NULL);
+	zassert_equal(spsc_ring_put_finish(&spsc, 8), 0, NULL);
+
+	/**TESTPOINT: only finished bytes are visible to the consumer*/
+	zassert_equal(spsc_ring_get_claim(&spsc, &data, cap), 8, NULL);
+	zassert_equal(spsc_ring_get_finish(&spsc, 9), -EINVAL, NULL);
+	zassert_equal(spsc_ring_get_finish(&spsc, 3), 0, NULL);
+	zassert_equal(spsc_ring_used_get(&spsc), 5, NULL);
+	zassert_equal(spsc_ring_get(&spsc, out, cap), 5, NULL);
+}
+
+static void spsc_producer(void *p1, void *p2, void *p3)
+{
+	u8_t next = 0U;
+	u32_t sent = 0U;
+
+	while (sent < STREAM_BYTES) {
+		u8_t *data;
+		u32_t n = spsc_ring_put_claim(&spsc, &data,
+					      MIN(7, STREAM_BYTES - sent));
+
+		for (int i = 0; i < n; i++) {
+			data[i] = next++;
+		}
+		spsc_ring_put_finish(&spsc, n);
+		sent += n;
+		if (n == 0U) {
+			k_yield();
+		}
+	}
+
+	k_sem_give(&done);
+}
+
+/**
+ * @brief Test a single-producer, single-consumer byte stream
+ *
+ * @details A producer thread streams a counting byte sequence in odd
+ * sized chunks while the test thread consumes it.
+ */
+void test_spsc_ring_stream(void)
+{
+	u8_t buf[5], next = 0U;
+	u32_t received = 0U;
+
+	/* Same priority as the test thread, so k_yield() switches */
+	k_thread_create(&threads[0], stacks[0], STACK_SIZE, spsc_producer,
+			NULL, NULL, NULL,
+			k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+
+	while (received < STREAM_BYTES) {
+		u32_t n = spsc_ring_get(&spsc, buf, sizeof(buf));
+
+		for (int i = 0; i < n; i++) {
+			zassert_equal(buf[i], next, "byte %u", received + i);
+			next++;
+		}
+		received += n;
+		if (n == 0U) {
+			k_yield();
+		}
+	}
+
+	k_sem_take(&done, K_FOREVER);
+}
+
+static void mpsc_isr_put(void *arg)
+{
+	struct item it = { .producer = N_PRODUCERS, .seq = isr_seq };
+
+	isr_ret = mpsc_ring_put(isr_ring, &it);
+	if (isr_ret == 0) {
+		isr_seq++;
+	}
+}
+
+/**
+ * @brief Test multi-producer, single-consumer basic operation
+ *
+ * @details Items come out in order, a full ring rejects puts, an
+ * empty ring rejects gets, and ISRs can put items.
+ */
+void test_mpsc_ring_basic(void)
+{
+	struct item it;
+	u32_t n = mpsc.mask + 1;
+
+	zassert_equal(mpsc_ring_get(&mpsc, &it), -EAGAIN, NULL);
+
+	for (int lap = 0; lap < 3; lap++) {
+		for (int i = 0; i < n; i++) {
+			it.producer = 0U;
+			it.seq = i;
+			zassert_equal(mpsc_ring_put(&mpsc, &it), 0, NULL);
+		}
+		zassert_equal(mpsc_ring_put(&mpsc, &it), -ENOMEM, NULL);
+
+		for (int i = 0; i < n; i++) {
+			zassert_equal(mpsc_ring_get(&mpsc, &it), 0, NULL);
+			zassert_equal(it.seq, i, NULL);
+		}
+		zassert_equal(mpsc_ring_get(&mpsc, &it), -EAGAIN, NULL);
+	}
+
+	isr_ring = &mpsc;
+	isr_seq = 0U;
+	irq_offload(mpsc_isr_put, NULL);
+	zassert_equal(isr_ret, 0, NULL);
+	zassert_equal(mpsc_ring_get(&mpsc, &it), 0, NULL);
+	zassert_equal(it.producer, N_PRODUCERS, NULL);
+	zassert_equal(it.seq, 0, NULL);
+}
+
+static void mpsc_producer(void *p1, void *p2, void *p3)
+{
+	struct mpsc_ring *ring = p1;
+	struct item it = { .producer = POINTER_TO_UINT(p2) };
+
+	for (it.seq = 0U; it.seq < N_ITEMS; ) {
+		if (mpsc_ring_put(ring, &it) == 0) {
+			it.seq++;
+		} else {
+			k_yield();
+		}
+	}
+
+	k_sem_give(&done);
+}
+
+/**
+ * @brief Test concurrent producers on a multi-producer ring
+ *
+ * @details Several threads and an ISR put items into a dynamically
+ * initialized ring; every item arrives exactly once and each
+ * producer's items arrive in order.
+ */
+void test_mpsc_ring_producers(void)
+{
+	static u32_t buf[16 * sizeof(struct item) / 4];
+	static atomic_t seq[16];
+	static struct mpsc_ring ring;
+	u32_t expect[N_PRODUCERS + 1] = { 0 };
+	u32_t total = 0U;
+	struct item it;
+
+	mpsc_ring_init(&ring, sizeof(struct item), 16, buf, seq);
+
+	for (int i = 0; i < N_PRODUCERS; i++) {
+		k_thread_create(&threads[i], stacks[i], STACK_SIZE,
+				mpsc_producer, &ring, UINT_TO_POINTER(i),
+				NULL, k_thread_priority_get(k_current_get()),
+				0, K_NO_WAIT);
+	}
+
+	isr_ring = &ring;
+	isr_seq = 0U;
+	while (total < N_PRODUCERS * N_ITEMS + N_ITEMS) {
+		if (isr_seq < N_ITEMS) {
+			irq_offload(mpsc_isr_put, NULL);
+		}
+
+		if (mpsc_ring_get(&ring, &it) != 0) {
+			k_yield();
+			continue;
+		}
+
+		zassert_true(it.producer <= N_PRODUCERS, NULL);
+		zassert_equal(it.seq, expect[it.producer],
+			      "producer %u", it.producer);
+		expect[it.producer]++;
+		total++;
+	}
+
+	for (int i = 0; i < N_PRODUCERS; i++) {
+		k_sem_take(&done, K_FOREVER);
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lf_ring,
+			 ztest_unit_test(test_spsc_ring_claim),
+			 ztest_unit_test(test_spsc_ring_stream),
+			 ztest_unit_test(test_mpsc_ring_basic),
+			 ztest_unit_test(test_mpsc_ring_producers));
+	ztest_run_test_suite(lf_ring);
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <sys/tlsf.h>
+
+#define HEAP_SIZE 8192
+#define MAX_ALLOCS 128
+
+static char __aligned(sizeof(void *)) heap_mem[HEAP_SIZE];
+static struct sys_tlsf heap;
+
+static struct {
+	u8_t *ptr;
+	size_t size;
+} allocs[MAX_ALLOCS];
+
+static u32_t rand_state = 12345;
+
+static u32_t rand32(void)
+{
+	/* Fixed LCG so failures are reproducible */
+	rand_state = rand_state * 1103515245U + 12345U;
+	return rand_state >> 8;
+}
+
+static u8_t fill_byte(int i)
+{
+	return (u8_t)(0xa5 ^ i);
+}
+
+static void fill(int i)
+{
+	(void)memset(allocs[i].ptr, fill_byte(i), allocs[i].size);
+}
+
+static bool check(int i)
+{
+	for (size_t j = 0; j < allocs[i].size; j++) {
+		if (allocs[i].ptr[j] != fill_byte(i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Allocate and free blocks of assorted sizes
+ *
+ * @details Fill every block with its own pattern, check alignment,
+ * check nothing got overwritten and the heap is consistent, then free
+ * everything and check the heap is back to a single free block.
+ */
+void test_tlsf_alloc_free(void)
+{
+	struct sys_tlsf_stats stats;
+	static const size_t sizes[] = { 0, 1, 7, 8, 33, 100, 255, 256,
+					1000, 17, 3 };
+
+	sys_tlsf_init(&heap, heap_mem, sizeof(heap_mem));
+	zassert_true(sys_tlsf_validate(&heap), NULL);
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		allocs[i].size = sizes[i];
+		allocs[i].ptr = sys_tlsf_alloc(&heap, sizes[i]);
+		zassert_not_null(allocs[i].ptr, "alloc of %zu failed",
+				 sizes[i]);
+		zassert_equal((uintptr_t)allocs[i].ptr % sizeof(void *), 0,
+			      "misaligned block");
+		fill(i);
+	}
+
+	zassert_true(sys_tlsf_validate(&heap), NULL);
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		zassert_true(check(i), "block %d corrupted", i);
+		sys_tlsf_free(&heap, allocs[i].ptr);
+		zassert_true(sys_tlsf_validate(&heap), NULL);
+	}
+
+	sys_tlsf_free(&heap, NULL);
+
+	sys_tlsf_stats_get(&heap, &stats);
+	zassert_equal(stats.used_bytes, 0, NULL);
+	zassert_equal(stats.free_blocks, 1, NULL);
+	zassert_equal(stats.free_bytes, stats.total_bytes, NULL);
+	zassert_true(stats.total_bytes > HEAP_SIZE * 3 / 4, NULL);
+}
+
+/**
+ * @brief Check the heap is exhausted cleanly and merges on free
+ *
+ * @details Fill the heap with small blocks until allocation fails,
+ * free every other one and check a larger block can't be found, then
+ * free the rest and check it can.
+ */
+void test_tlsf_exhaust_merge(void)
+{
+	struct sys_tlsf_stats stats;
+	int n;
+
+	sys_tlsf_init(&heap, heap_mem, sizeof(heap_mem));
+
+	for (n = 0; n < MAX_ALLOCS; n++) {
+		allocs[n].ptr = sys_tlsf_alloc(&heap, 48);
+		if (allocs[n].ptr == NULL) {
+			break;
+		}
+	}
+	zassert_true(n > 8 && n < MAX_ALLOCS, "unexpected block count %d", n);
+
+	for (int i = 0; i < n; i += 2) {
+		sys_tlsf_free(&heap, allocs[i].ptr);
+	}
+	zassert_true(sys_tlsf_validate(&heap), NULL);
+	zassert_is_null(sys_tlsf_alloc(&heap, 256), NULL);
+
+	sys_tlsf_stats_get(&heap, &stats);
+	zassert_true(stats.largest_free_bytes < 256, NULL);
+	zassert_true(stats.free_blocks >= n / 2, NULL);
+
+	for (int i = 1; i < n; i += 2) {
+		sys_tlsf_free(&heap, allocs[i].ptr);
+	}
+	zassert_true(sys_tlsf_validate(&heap), NULL);
+
+	sys_tlsf_stats_get(&heap, &stats);
+	zassert_equal(stats.free_blocks, 1, NULL);
+	zassert_true(stats.peak_used_bytes >= n * 48, NULL);
+	zassert_not_null(sys_tlsf_alloc(&heap, HEAP_SIZE / 2), NULL);
+}
+
+/**
+ * @brief Check per-block overhead
+ *
+ * @details Every allocation should cost its size rounded up to a word
+ * (or the minimum block size) plus a single word of header.
+ */
+void test_tlsf_overhead(void)
+{
+	struct sys_tlsf_stats stats;
+
+	sys_tlsf_init(&heap, heap_mem, sizeof(heap_mem));
+
+	for (int i = 0; i < 16; i++) {
+		zassert_not_null(sys_tlsf_alloc(&heap, 40), NULL);
+	}
+
+	sys_tlsf_stats_get(&heap, &stats);
+	zassert_equal(stats.used_bytes, 16 * (40 + sizeof(size_t)), NULL);
+}
+
+/**
+ * @brief Random allocation and free stress test
+ */
+void test_tlsf_random(void)
+{
+	sys_tlsf_init(&heap, heap_mem, sizeof(heap_mem));
+	(void)memset(allocs, 0, sizeof(allocs));
+
+	for (int iter = 0; iter < 20000; iter++) {
+		int i = rand32() % MAX_ALLOCS;
+
+		if (allocs[i].ptr != NULL) {
+			zassert_true(check(i), "block %d corrupted", i);
+			sys_tlsf_free(&heap, allocs[i].ptr);
+			allocs[i].ptr = NULL;
+		} else {
+			allocs[i].size = rand32() % 300;
+			allocs[i].ptr = sys_tlsf_alloc(&heap, allocs[i].size);
+			if (allocs[i].ptr != NULL) {
+				fill(i);
+			}
+		}
+
+		if ((iter % 256) == 0) {
+			zassert_true(sys_tlsf_validate(&heap),
+				     "heap corrupt at iteration %d", iter);
+		}
+	}
+
+	for (int i = 0; i < MAX_ALLOCS; i++) {
+		if (allocs[i].ptr != NULL) {
+			zassert_true(check(i), "block %d corrupted", i);
+			sys_tlsf_free(&heap, allocs[i].ptr);
+		}
+	}
+	zassert_true(sys_tlsf_validate(&heap), NULL);
+}
+
+/**
+ * @brief Check k_malloc() uses the TLSF heap
+ */
+void test_tlsf_k_malloc(void)
+{
+	struct sys_tlsf_stats before, after;
+	void *p;
+
+	k_malloc_stats_get(&before);
+	p = k_malloc(100);
+	zassert_not_null(p, NULL);
+
+	k_malloc_stats_get(&after);
+	zassert_equal(after.used_bytes - before.used_bytes,
+		      ROUND_UP(100, sizeof(void *)) + sizeof(size_t), NULL);
+
+	k_free(p);
+	k_malloc_stats_get(&after);
+	zassert_equal(after.used_bytes, before.used_bytes, NULL);
+	zassert_true(after.peak_used_bytes >= 100, NULL);
+
+	/* Odd sizes shouldn't be rounded up to a power of two */
+	p = k_calloc(3, 300);
+	zassert_not_null(p, NULL);
+	k_free(p);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(tlsf,
+			 ztest_unit_test(test_tlsf_alloc_free),
+			 ztest_unit_test(test_tlsf_exhaust_merge),
+			 ztest_unit_test(test_tlsf_overhead),
+			 ztest_unit_test(test_tlsf_random),
+			 ztest_unit_test(test_tlsf_k_malloc));
+	ztest_run_test_suite(tlsf);
+}
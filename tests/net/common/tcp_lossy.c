@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+#include <net/net_pkt.h>
+#include <net/net_if.h>
+#include <net/dummy.h>
+#include <sys/fdtable.h>
+
+#include "../socket/socket_helpers.h"
+#include "tcp_lossy.h"
+
+#define ANY_PORT 0
+
+#define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
+#define RECV_TIMEOUT K_SECONDS(10)
+
+u8_t tx_data[SEGMENTS * SEG_LEN];
+static u8_t rx_data[SEGMENTS * SEG_LEN];
+
+static int drops[MAX_DROPS];
+static int drop_count;
+static int hold = -1;
+static u32_t seen[2 * SEGMENTS];
+static int seen_count;
+int rexmits;
+int sack_acks;
+static struct net_pkt *held;
+
+void lossy_reset(const int *drop, int count, int hold_seg)
+{
+	if (count) {
+		memcpy(drops, drop, count * sizeof(drop[0]));
+	}
+
+	drop_count = count;
+	hold = hold_seg;
+	seen_count = 0;
+	rexmits = 0;
+	sack_acks = 0;
+}
+
+static bool has_sack_opt(struct net_pkt *pkt, struct net_tcp_hdr *hdr)
+{
+	int opt_len = NET_TCP_HDR_LEN(hdr) - sizeof(*hdr);
+	u8_t opts[40];
+	int i;
+
+	if (net_pkt_read(pkt, opts, opt_len)) {
+		return false;
+	}
+
+	for (i = 0; i < opt_len && opts[i] != NET_TCP_END_OPT; ) {
+		if (opts[i] == NET_TCP_SACK_OPT) {
+			return true;
+		} else if (opts[i] == NET_TCP_NOP_OPT) {
+			i++;
+		} else if (i + 1 < opt_len && opts[i + 1] >= 2) {
+			i += opts[i + 1];
+		} else {
+			break;
+		}
+	}
+
+	return false;
+}
+
+/* Returns the number of the data segment, or -1 if the packet is
+ * something else or a retransmission.
+ */
+static int lossy_classify(struct net_pkt *pkt)
+{
+	struct net_tcp_hdr hdr;
+	u32_t seq;
+	int len;
+	int i;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, NET_IPV4H_LEN) ||
+	    net_pkt_read(pkt, &hdr, sizeof(hdr))) {
+		return -1;
+	}
+
+	len = net_pkt_get_len(pkt) - NET_IPV4H_LEN - NET_TCP_HDR_LEN(&hdr);
+	if (len <= 0) {
+		if (has_sack_opt(pkt, &hdr)) {
+			sack_acks++;
+		}
+
+		return -1;
+	}
+
+	seq = sys_get_be32(hdr.seq);
+
+	for (i = 0; i < seen_count; i++) {
+		if (seen[i] == seq) {
+			rexmits++;
+			return -1;
+		}
+	}
+
+	if (seen_count < ARRAY_SIZE(seen)) {
+		seen[seen_count++] = seq;
+	}
+
+	return seen_count - 1;
+}
+
+static int lossy_dev_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 0;
+}
+
+static void lossy_iface_init(struct net_if *iface)
+{
+	net_if_set_link_addr(iface, "\x00\x00\x5e\x00\x53\xfe", 6,
+			     NET_LINK_DUMMY);
+}
+
+static int lossy_send(struct device *dev, struct net_pkt *pkt)
+{
+	struct net_pkt *cloned;
+	int seg;
+	int i;
+
+	ARG_UNUSED(dev);
+
+	cloned = net_pkt_clone(pkt, K_MSEC(100));
+	if (!cloned) {
+		return -ENOMEM;
+	}
+
+	seg = lossy_classify(cloned);
+	net_pkt_cursor_init(cloned);
+
+	for (i = 0; seg >= 0 && i < drop_count; i++) {
+		if (drops[i] == seg) {
+			net_pkt_unref(cloned);
+			return 0;
+		}
+	}
+
+	if (seg >= 0 && seg == hold) {
+		held = cloned;
+		return 0;
+	}
+
+	if (net_recv_data(net_pkt_iface(cloned), cloned) < 0) {
+		net_pkt_unref(cloned);
+	}
+
+	if (held && seg == hold + 1) {
+		if (net_recv_data(net_pkt_iface(held), held) < 0) {
+			net_pkt_unref(held);
+		}
+
+		held = NULL;
+	}
+
+	k_yield();
+
+	return 0;
+}
+
+static struct dummy_api lossy_api = {
+	.iface_api.init = lossy_iface_init,
+	.send = lossy_send,
+};
+
+NET_DEVICE_INIT(lossy, "lossy", lossy_dev_init, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &lossy_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 536);
+
+struct net_tcp *sock_tcp(int sock)
+{
+	struct net_context *ctx = z_get_fd_obj(sock, NULL, 0);
+
+	zassert_not_null(ctx, "no context");
+
+	return ctx->tcp;
+}
+
+void connect_socks(u16_t port, int *c_sock, int *s_sock, int *new_sock)
+{
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, port,
+			    s_sock, &s_saddr);
+
+	zassert_equal(bind(*s_sock, (struct sockaddr *)&s_saddr,
+			   sizeof(s_saddr)),
+		      0, "bind failed");
+	zassert_equal(listen(*s_sock, 1), 0, "listen failed");
+	zassert_equal(connect(*c_sock, (struct sockaddr *)&s_saddr,
+			      sizeof(s_saddr)),
+		      0, "connect failed");
+
+	*new_sock = accept(*s_sock, &addr, &addrlen);
+	zassert_true(*new_sock >= 0, "accept failed");
+}
+
+void close_socks(int c_sock, int s_sock, int new_sock)
+{
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+u32_t transfer(int c_sock, int new_sock)
+{
+	struct pollfd pfd = { .fd = new_sock, .events = POLLIN };
+	u32_t start = k_uptime_get_32();
+	size_t received = 0;
+	ssize_t ret;
+	int i;
+
+	for (i = 0; i < sizeof(tx_data); i++) {
+		tx_data[i] = i % 251;
+	}
+
+	(void)memset(rx_data, 0, sizeof(rx_data));
+
+	for (i = 0; i < SEGMENTS; i++) {
+		zassert_equal(send(c_sock, tx_data + i * SEG_LEN, SEG_LEN, 0),
+			      SEG_LEN, "send failed");
+	}
+
+	while (received < sizeof(rx_data)) {
+		zassert_equal(poll(&pfd, 1, RECV_TIMEOUT), 1,
+			      "timeout, %zd bytes received", received);
+
+		ret = recv(new_sock, rx_data + received,
+			   sizeof(rx_data) - received, 0);
+		zassert_true(ret > 0, "recv failed");
+
+		received += ret;
+	}
+
+	zassert_mem_equal(rx_data, tx_data, sizeof(tx_data), "wrong data");
+
+	return k_uptime_get_32() - start;
+}
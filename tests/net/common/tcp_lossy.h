@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Network interface for TCP tests. Its driver loops the packets back
+ * like the loopback driver does, but loses or delays some of the data
+ * segments the first time they are sent.
+ */
+
+#ifndef __TCP_LOSSY_H
+#define __TCP_LOSSY_H
+
+#include <zephyr/types.h>
+
+#include "tcp_internal.h"
+
+#define SEG_LEN 48
+#define SEGMENTS 24
+
+#define MAX_DROPS 4
+
+extern u8_t tx_data[SEGMENTS * SEG_LEN];
+
+/* Retransmitted data segments, and ACKs with a SACK option, seen by the
+ * driver since the last lossy_reset()
+ */
+extern int rexmits;
+extern int sack_acks;
+
+/* Data segments are numbered in the order they are first sent. The
+ * segments in drop are lost, segment hold_seg, if not -1, is delivered
+ * after the next one.
+ */
+void lossy_reset(const int *drop, int count, int hold_seg);
+
+struct net_tcp *sock_tcp(int sock);
+void connect_socks(u16_t port, int *c_sock, int *s_sock, int *new_sock);
+void close_socks(int c_sock, int s_sock, int new_sock);
+
+/* Send all the segments and receive them, returns the time it took */
+u32_t transfer(int c_sock, int new_sock);
+
+#endif /* __TCP_LOSSY_H */
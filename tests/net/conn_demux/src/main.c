@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measures the cost of matching a received UDP packet to its connection
+ * handler in net_conn_input() as the number of registered connections
+ * grows.  The connections all share one local port, like the accepted
+ * connections of a server, which is the worst case for any lookup that
+ * only looks at the destination port.
+ *
+ * The cycle counts are only meaningful on targets with a free running
+ * cycle counter; native_posix reports 0.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_UDP_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <zephyr/types.h>
+#include <string.h>
+#include <errno.h>
+#include <device.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/ethernet.h>
+#include <net/dummy.h>
+
+#include <ztest.h>
+
+#include "net_private.h"
+#include "connection.h"
+#include "udp_internal.h"
+
+#define LOCAL_PORT 4242
+#define REMOTE_PORT_BASE 10000
+#define UNKNOWN_REMOTE_PORT 9999
+#define MAX_CONNS (CONFIG_NET_MAX_CONN - 1)
+#define PKT_COUNT 1000
+
+static const int conn_counts[] = { 1, 8, 32, 64, 128 };
+
+static struct in_addr my_addr = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr = { { { 192, 0, 2, 9 } } };
+
+static struct net_conn_handle *handles[MAX_CONNS];
+static struct net_conn_handle *listener;
+static void *last_user_data;
+static int hits;
+
+struct net_conn_demux_context {
+	u8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static int net_conn_demux_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void net_conn_demux_iface_init(struct net_if *iface)
+{
+	struct net_conn_demux_context *ctx =
+		net_if_get_device(iface)->driver_data;
+
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	ctx->mac_addr[0] = 0x00;
+	ctx->mac_addr[1] = 0x00;
+	ctx->mac_addr[2] = 0x5E;
+	ctx->mac_addr[3] = 0x00;
+	ctx->mac_addr[4] = 0x53;
+	ctx->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, ctx->mac_addr, 6, NET_LINK_ETHERNET);
+}
+
+static int tester_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct net_conn_demux_context net_conn_demux_context_data;
+
+static struct dummy_api net_conn_demux_if_api = {
+	.iface_api.init = net_conn_demux_iface_init,
+	.send = tester_send,
+};
+
+NET_DEVICE_INIT(net_conn_demux_test, "net_conn_demux_test",
+		net_conn_demux_dev_init, &net_conn_demux_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_conn_demux_if_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static enum net_verdict recv_cb(struct net_conn *conn,
+				struct net_pkt *pkt,
+				union net_ip_header *ip_hdr,
+				union net_proto_header *proto_hdr,
+				void *user_data)
+{
+	last_user_data = user_data;
+	hits++;
+
+	return NET_OK;
+}
+
+static void register_conns(int count)
+{
+	struct sockaddr_in remote = {
+		.sin_family = AF_INET,
+		.sin_addr = peer_addr,
+	};
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_addr = my_addr,
+		.sin_port = htons(LOCAL_PORT),
+	};
+	struct sockaddr_in any = {
+		.sin_family = AF_INET,
+		.sin_port = htons(LOCAL_PORT),
+	};
+	int ret;
+	int i;
+
+	ret = net_udp_register(AF_INET, NULL, (struct sockaddr *)&any,
+			       0, LOCAL_PORT, recv_cb, &listener, &listener);
+	zassert_equal(ret, 0, "cannot register listener (%d)", ret);
+
+	for (i = 0; i < count; i++) {
+		remote.sin_port = htons(REMOTE_PORT_BASE + i);
+		ret = net_udp_register(AF_INET, (struct sockaddr *)&remote,
+				       (struct sockaddr *)&local,
+				       REMOTE_PORT_BASE + i, LOCAL_PORT,
+				       recv_cb, &handles[i], &handles[i]);
+		zassert_equal(ret, 0, "cannot register conn %d (%d)", i, ret);
+	}
+}
+
+static void unregister_conns(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		zassert_equal(net_udp_unregister(handles[i]), 0, NULL);
+	}
+
+	zassert_equal(net_udp_unregister(listener), 0, NULL);
+}
+
+/* Returns the average number of cycles per packet */
+static u32_t demux(struct net_pkt *pkt, u16_t src_port, void *expected)
+{
+	struct net_ipv4_hdr ipv4_hdr;
+	struct net_udp_hdr udp_hdr;
+	union net_ip_header ip_hdr = { .ipv4 = &ipv4_hdr };
+	union net_proto_header proto_hdr = { .udp = &udp_hdr };
+	enum net_verdict verdict = NET_OK;
+	u32_t start;
+	u32_t cycles;
+	int i;
+
+	(void)memset(&ipv4_hdr, 0, sizeof(ipv4_hdr));
+	ipv4_hdr.vhl = 0x45;
+	ipv4_hdr.proto = IPPROTO_UDP;
+	net_ipaddr_copy(&ipv4_hdr.src, &peer_addr);
+	net_ipaddr_copy(&ipv4_hdr.dst, &my_addr);
+
+	(void)memset(&udp_hdr, 0, sizeof(udp_hdr));
+	udp_hdr.src_port = htons(src_port);
+	udp_hdr.dst_port = htons(LOCAL_PORT);
+
+	hits = 0;
+	last_user_data = NULL;
+
+	start = k_cycle_get_32();
+
+	for (i = 0; i < PKT_COUNT && verdict == NET_OK; i++) {
+		verdict = net_conn_input(pkt, &ip_hdr, IPPROTO_UDP,
+					 &proto_hdr);
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	zassert_equal(verdict, NET_OK, "packet dropped");
+	zassert_equal(hits, PKT_COUNT, "wrong number of packets");
+	zassert_equal_ptr(last_user_data, expected, "wrong handler");
+
+	return cycles / PKT_COUNT;
+}
+
+void test_conn_demux(void)
+{
+	struct net_pkt *pkt;
+	u32_t exact;
+	u32_t wildcard;
+	int i;
+
+	pkt = net_pkt_alloc(K_NO_WAIT);
+	zassert_not_null(pkt, "out of packets");
+
+	net_pkt_set_iface(pkt, net_if_get_default());
+	net_pkt_set_family(pkt, AF_INET);
+
+	for (i = 0; i < ARRAY_SIZE(conn_counts); i++) {
+		int count = MIN(conn_counts[i], MAX_CONNS);
+
+		register_conns(count);
+
+		/* The connection registered last */
+		exact = demux(pkt, REMOTE_PORT_BASE + count - 1,
+			      &handles[count - 1]);
+
+		/* No connected handler matches, only the listener */
+		wildcard = demux(pkt, UNKNOWN_REMOTE_PORT, &listener);
+
+		TC_PRINT("conn_demux: %3d connections %6u cycles/pkt "
+			 "connected %6u cycles/pkt listener\n",
+			 count, exact, wildcard);
+
+		unregister_conns(count);
+	}
+
+	net_pkt_unref(pkt);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_conn_demux,
+			 ztest_unit_test(test_conn_demux));
+
+	ztest_run_test_suite(net_conn_demux);
+}
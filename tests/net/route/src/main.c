@@ -468,6 +468,86 @@ static void route_del_many(void)
 	}
 }
 
+/* Nested prefixes, added from the most specific one as adding a route
+ * replaces the route its address already matches.
+ */
+static struct {
+	const char *prefix;
+	u8_t len;
+	struct net_route_entry *route;
+} lpm_routes[] = {
+	{ "2001:db8:0:1::5", 128 },
+	{ "2001:db8:0:1::", 64 },
+	{ "2001:db8:8000::", 33 },
+	{ "2001:db8::", 32 },
+};
+
+static void lpm_check(const char *dst, int expected)
+{
+	struct net_route_entry *route;
+	struct in6_addr addr;
+
+	zassert_equal(net_addr_pton(AF_INET6, dst, &addr), 0, "%s", dst);
+
+	route = net_route_lookup(my_iface, &addr);
+
+	if (expected < 0) {
+		zassert_is_null(route, "Route found for %s", dst);
+	} else {
+		zassert_equal_ptr(route, lpm_routes[expected].route,
+				  "Wrong route for %s", dst);
+	}
+}
+
+static void route_lpm_add(void)
+{
+	struct in6_addr addr;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(lpm_routes); i++) {
+		net_addr_pton(AF_INET6, lpm_routes[i].prefix, &addr);
+
+		lpm_routes[i].route = net_route_add(my_iface, &addr,
+						    lpm_routes[i].len,
+						    &peer_addr);
+		zassert_not_null(lpm_routes[i].route, "Route add failed");
+	}
+}
+
+static void route_lpm_lookup(void)
+{
+	/* Twice, the second round may be answered by the cache */
+	for (int i = 0; i < 2; i++) {
+		lpm_check("2001:db8:0:1::5", 0);
+		lpm_check("2001:db8:0:1::6", 1);
+		lpm_check("2001:db8:0:2::1", 3);
+		lpm_check("2001:db8:7fff::1", 3);
+		lpm_check("2001:db8:8000::1", 2);
+		lpm_check("2001:db8:ffff::1", 2);
+		lpm_check("2001:db9::1", -1);
+	}
+}
+
+static void route_lpm_del(void)
+{
+	zassert_false(net_route_del(lpm_routes[1].route), "Route del failed");
+
+	lpm_check("2001:db8:0:1::5", 0);
+	lpm_check("2001:db8:0:1::6", 3);
+
+	zassert_false(net_route_del(lpm_routes[3].route), "Route del failed");
+
+	lpm_check("2001:db8:0:1::5", 0);
+	lpm_check("2001:db8:0:1::6", -1);
+	lpm_check("2001:db8:8000::1", 2);
+
+	zassert_false(net_route_del(lpm_routes[0].route), "Route del failed");
+	zassert_false(net_route_del(lpm_routes[2].route), "Route del failed");
+
+	lpm_check("2001:db8:0:1::5", -1);
+	lpm_check("2001:db8:8000::1", -1);
+}
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -487,6 +567,9 @@ void test_main(void)
 			ztest_unit_test(route_del_nexthop_again),
 			ztest_unit_test(populate_nbr_cache),
 			ztest_unit_test(route_add_many),
-			ztest_unit_test(route_del_many));
+			ztest_unit_test(route_del_many),
+			ztest_unit_test(route_lpm_add),
+			ztest_unit_test(route_lpm_lookup),
+			ztest_unit_test(route_lpm_del));
 	ztest_run_test_suite(test_route);
 }
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Rx flow steering: received packets are spread over the Rx queues of
+ * their traffic class by flow, and the packets of each flow are still
+ * delivered in order by a single thread.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_UDP_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <zephyr/types.h>
+#include <string.h>
+#include <errno.h>
+#include <device.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/ethernet.h>
+#include <net/dummy.h>
+
+#include <ztest.h>
+
+#include "net_private.h"
+#include "connection.h"
+#include "udp_internal.h"
+#include "ipv4.h"
+
+#define LOCAL_PORT 4242
+#define REMOTE_PORT_BASE 10000
+#define FLOWS 2
+#define PKTS_PER_FLOW 20
+
+#define WAIT_TIME K_MSEC(100)
+
+static struct in_addr my_addr4 = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr4 = { { { 192, 0, 2, 9 } } };
+static struct in6_addr my_addr6 = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr6 = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					  0, 0, 0, 0, 0, 0, 0, 0x9 } } };
+
+struct flow {
+	struct net_conn_handle *handle;
+	u16_t remote_port;
+	k_tid_t thread;
+	u32_t next_seq;
+	bool failed;
+};
+
+static struct flow flows[FLOWS];
+
+struct net_rx_flow_context {
+	u8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static int net_rx_flow_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void net_rx_flow_iface_init(struct net_if *iface)
+{
+	struct net_rx_flow_context *ctx =
+		net_if_get_device(iface)->driver_data;
+
+	/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+	ctx->mac_addr[0] = 0x00;
+	ctx->mac_addr[1] = 0x00;
+	ctx->mac_addr[2] = 0x5E;
+	ctx->mac_addr[3] = 0x00;
+	ctx->mac_addr[4] = 0x53;
+	ctx->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, ctx->mac_addr, 6, NET_LINK_ETHERNET);
+}
+
+static int tester_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct net_rx_flow_context net_rx_flow_context_data;
+
+static struct dummy_api net_rx_flow_if_api = {
+	.iface_api.init = net_rx_flow_iface_init,
+	.send = tester_send,
+};
+
+NET_DEVICE_INIT(net_rx_flow_test, "net_rx_flow_test",
+		net_rx_flow_dev_init, &net_rx_flow_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_rx_flow_if_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+/* A UDP packet from remote_port carrying seq, as a driver would pass
+ * it to net_recv_data().
+ */
+static struct net_pkt *udp_pkt(sa_family_t family, u16_t remote_port,
+			       u32_t seq, bool fragment)
+{
+	struct net_if *iface = net_if_get_default();
+	struct net_udp_hdr udp_hdr;
+	struct net_pkt *pkt;
+	size_t ip_len;
+
+	ip_len = family == AF_INET ? NET_IPV4H_LEN : NET_IPV6H_LEN;
+
+	pkt = net_pkt_rx_alloc_with_buffer(iface, ip_len + NET_UDPH_LEN +
+					   sizeof(seq), AF_UNSPEC, 0,
+					   K_NO_WAIT);
+	zassert_not_null(pkt, "out of packets");
+
+	if (family == AF_INET) {
+		struct net_ipv4_hdr ipv4_hdr;
+
+		(void)memset(&ipv4_hdr, 0, sizeof(ipv4_hdr));
+		ipv4_hdr.vhl = 0x45;
+		ipv4_hdr.len = htons(ip_len + NET_UDPH_LEN + sizeof(seq));
+		ipv4_hdr.offset[0] = fragment ? 0x20 : 0x40;
+		ipv4_hdr.ttl = 64U;
+		ipv4_hdr.proto = IPPROTO_UDP;
+		net_ipaddr_copy(&ipv4_hdr.src, &peer_addr4);
+		net_ipaddr_copy(&ipv4_hdr.dst, &my_addr4);
+
+		zassert_equal(net_pkt_write(pkt, &ipv4_hdr, ip_len), 0, NULL);
+	} else {
+		struct net_ipv6_hdr ipv6_hdr;
+
+		(void)memset(&ipv6_hdr, 0, sizeof(ipv6_hdr));
+		ipv6_hdr.vtc = 0x60;
+		ipv6_hdr.len = htons(NET_UDPH_LEN + sizeof(seq));
+		ipv6_hdr.nexthdr = fragment ? NET_IPV6_NEXTHDR_FRAG :
+			IPPROTO_UDP;
+		ipv6_hdr.hop_limit = 64U;
+		net_ipaddr_copy(&ipv6_hdr.src, &peer_addr6);
+		net_ipaddr_copy(&ipv6_hdr.dst, &my_addr6);
+
+		zassert_equal(net_pkt_write(pkt, &ipv6_hdr, ip_len), 0, NULL);
+	}
+
+	udp_hdr.src_port = htons(remote_port);
+	udp_hdr.dst_port = htons(LOCAL_PORT);
+	udp_hdr.len = htons(NET_UDPH_LEN + sizeof(seq));
+	udp_hdr.chksum = 0U;
+
+	zassert_equal(net_pkt_write(pkt, &udp_hdr, NET_UDPH_LEN), 0, NULL);
+	zassert_equal(net_pkt_write_be32(pkt, seq), 0, NULL);
+
+	if (family == AF_INET) {
+		net_pkt_set_ip_hdr_len(pkt, ip_len);
+		NET_IPV4_HDR(pkt)->chksum = net_calc_chksum_ipv4(pkt);
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	return pkt;
+}
+
+static u32_t pkt_flow_hash(sa_family_t family, u16_t remote_port,
+			   bool fragment)
+{
+	struct net_pkt *pkt = udp_pkt(family, remote_port, 0, fragment);
+	u32_t hash;
+
+	hash = net_rx_flow_hash(net_if_get_default(), pkt);
+	net_pkt_unref(pkt);
+
+	return hash;
+}
+
+static int port_queue(u16_t remote_port)
+{
+	struct net_pkt *pkt = udp_pkt(AF_INET, remote_port, 0, false);
+	int queue;
+
+	net_pkt_set_flow_hash(pkt, net_rx_flow_hash(net_if_get_default(),
+						    pkt));
+	queue = net_rx_pkt2queue(pkt);
+	net_pkt_unref(pkt);
+
+	return queue;
+}
+
+static enum net_verdict recv_cb(struct net_conn *conn,
+				struct net_pkt *pkt,
+				union net_ip_header *ip_hdr,
+				union net_proto_header *proto_hdr,
+				void *user_data)
+{
+	struct flow *flow = user_data;
+	u32_t seq;
+
+	if (!flow->thread) {
+		flow->thread = k_current_get();
+	} else if (flow->thread != k_current_get()) {
+		flow->failed = true;
+	}
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	if (net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) + NET_UDPH_LEN) ||
+	    net_pkt_read_be32(pkt, &seq) || seq != flow->next_seq) {
+		flow->failed = true;
+	}
+
+	flow->next_seq++;
+
+	net_pkt_unref(pkt);
+
+	return NET_OK;
+}
+
+static void test_setup(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct net_if_addr *ifaddr;
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr4, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	ifaddr = net_if_ipv6_addr_add(iface, &my_addr6, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv6 address");
+	ifaddr->addr_state = NET_ADDR_PREFERRED;
+}
+
+static void test_flow_hash(void)
+{
+	sa_family_t families[] = { AF_INET, AF_INET6 };
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(families); i++) {
+		u32_t hash = pkt_flow_hash(families[i], REMOTE_PORT_BASE,
+					   false);
+
+		zassert_not_equal(hash, 0U, "no hash");
+		zassert_equal(hash, pkt_flow_hash(families[i],
+						  REMOTE_PORT_BASE, false),
+			      "hash not stable");
+		zassert_not_equal(hash, pkt_flow_hash(families[i],
+						      REMOTE_PORT_BASE + 1,
+						      false),
+				  "ports not hashed");
+
+		/* Fragments of different flows cannot be told apart */
+		zassert_equal(pkt_flow_hash(families[i], REMOTE_PORT_BASE,
+					    true),
+			      pkt_flow_hash(families[i], REMOTE_PORT_BASE + 1,
+					    true),
+			      "fragment ports hashed");
+	}
+}
+
+static void test_driver_hash(void)
+{
+	struct net_pkt *pkt = udp_pkt(AF_INET, REMOTE_PORT_BASE, 0, false);
+	int i;
+
+	for (i = 0; i < NET_RX_FLOW_QUEUES; i++) {
+		net_pkt_set_flow_hash(pkt, i);
+		zassert_equal(net_rx_pkt2queue(pkt), i, "wrong queue");
+	}
+
+	net_pkt_unref(pkt);
+}
+
+static void test_flow_order(void)
+{
+	struct sockaddr_in local = {
+		.sin_family = AF_INET,
+		.sin_port = htons(LOCAL_PORT),
+	};
+	u16_t port = REMOTE_PORT_BASE;
+	int ret;
+	int i;
+	int j;
+
+	/* Two flows that hash to different queues */
+	flows[0].remote_port = port;
+	do {
+		port++;
+	} while (port_queue(port) == port_queue(flows[0].remote_port));
+	flows[1].remote_port = port;
+
+	for (i = 0; i < FLOWS; i++) {
+		ret = net_udp_register(AF_INET, NULL,
+				       (struct sockaddr *)&local,
+				       flows[i].remote_port, LOCAL_PORT,
+				       recv_cb, &flows[i], &flows[i].handle);
+		zassert_equal(ret, 0, "cannot register flow %d (%d)", i, ret);
+	}
+
+	/* Interleaved, and all queued before any of them is processed */
+	for (j = 0; j < PKTS_PER_FLOW; j++) {
+		for (i = 0; i < FLOWS; i++) {
+			struct net_pkt *pkt = udp_pkt(AF_INET,
+						      flows[i].remote_port,
+						      j, false);
+
+			zassert_equal(net_recv_data(net_if_get_default(), pkt),
+				      0, "recv failed");
+		}
+	}
+
+	k_sleep(WAIT_TIME);
+
+	for (i = 0; i < FLOWS; i++) {
+		zassert_equal(flows[i].next_seq, PKTS_PER_FLOW,
+			      "flow %d lost packets", i);
+		zassert_false(flows[i].failed, "flow %d out of order", i);
+		zassert_equal(net_udp_unregister(flows[i].handle), 0, NULL);
+	}
+
+	zassert_not_equal(flows[0].thread, flows[1].thread,
+			  "flows handled by the same thread");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_rx_flow,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_flow_hash),
+			 ztest_unit_test(test_driver_hash),
+			 ztest_unit_test(test_flow_order));
+
+	ztest_run_test_suite(net_rx_flow);
+}
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+
+#include "../../socket_helpers.h"
+
+#define ANY_PORT 0
+#define SERVER_PORT 4242
+#define SERVER2_PORT 4243
+
+#define TEST_STR "test"
+
+#define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
+#define WAIT_TIME 100
+
+static struct zsock_epoll_event events[4];
+static char buf[16];
+
+static void prepare_udp(int *c_sock, int *s_sock, struct sockaddr_in *s_saddr,
+			u16_t port)
+{
+	struct sockaddr_in c_saddr;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    c_sock, &c_saddr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, port,
+			    s_sock, s_saddr);
+
+	zassert_equal(bind(*c_sock, (struct sockaddr *)&c_saddr,
+			   sizeof(c_saddr)),
+		      0, "bind failed");
+	zassert_equal(bind(*s_sock, (struct sockaddr *)s_saddr,
+			   sizeof(*s_saddr)),
+		      0, "bind failed");
+}
+
+static void send_str(int sock, struct sockaddr_in *addr)
+{
+	zassert_equal(sendto(sock, TEST_STR, sizeof(TEST_STR) - 1, 0,
+			     (struct sockaddr *)addr, sizeof(*addr)),
+		      sizeof(TEST_STR) - 1, "sendto failed");
+}
+
+static void recv_str(int sock)
+{
+	zassert_equal(recv(sock, buf, sizeof(buf), 0), sizeof(TEST_STR) - 1,
+		      "recv failed");
+}
+
+static void add(int epfd, int sock, u32_t ev)
+{
+	struct zsock_epoll_event event = {
+		.events = ev,
+		.data.fd = sock,
+	};
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, sock, &event), 0,
+		      "epoll_ctl failed (%d)", errno);
+}
+
+static void test_epoll_udp(void)
+{
+	struct sockaddr_in s_saddr[2];
+	int c_sock[2];
+	int s_sock[2];
+	int epfd;
+	int i;
+
+	prepare_udp(&c_sock[0], &s_sock[0], &s_saddr[0], SERVER_PORT);
+	prepare_udp(&c_sock[1], &s_sock[1], &s_saddr[1], SERVER2_PORT);
+
+	epfd = epoll_create(1);
+	zassert_true(epfd >= 0, "epoll_create failed");
+
+	for (i = 0; i < 2; i++) {
+		add(epfd, s_sock[i], EPOLLIN);
+	}
+
+	/* Nothing received yet */
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 0,
+		      "sockets ready");
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events),
+				 WAIT_TIME), 0, "sockets ready");
+
+	/* Wakes up the waiting thread */
+	send_str(c_sock[1], &s_saddr[1]);
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), -1), 1,
+		      "socket not ready");
+	zassert_equal(events[0].events, EPOLLIN, "wrong events");
+	zassert_equal(events[0].data.fd, s_sock[1], "wrong socket");
+
+	/* Level-triggered: ready until read */
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 1,
+		      "socket not ready");
+	zassert_equal(events[0].data.fd, s_sock[1], "wrong socket");
+
+	recv_str(s_sock[1]);
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 0,
+		      "socket still ready");
+
+	/* Both sockets, reported in the order they became ready */
+	send_str(c_sock[0], &s_saddr[0]);
+	send_str(c_sock[1], &s_saddr[1]);
+	k_sleep(WAIT_TIME);
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 2,
+		      "sockets not ready");
+	zassert_equal(events[0].data.fd, s_sock[0], "wrong socket");
+	zassert_equal(events[1].data.fd, s_sock[1], "wrong socket");
+
+	/* No more than maxevents, the others are kept */
+	zassert_equal(epoll_wait(epfd, events, 1, 0), 1, "wrong count");
+	zassert_equal(events[0].data.fd, s_sock[0], "wrong socket");
+	zassert_equal(epoll_wait(epfd, events, 1, 0), 1, "wrong count");
+	zassert_equal(events[0].data.fd, s_sock[1], "wrong socket");
+
+	recv_str(s_sock[0]);
+	recv_str(s_sock[1]);
+
+	zassert_equal(close(epfd), 0, "close failed");
+
+	for (i = 0; i < 2; i++) {
+		zassert_equal(close(c_sock[i]), 0, "close failed");
+		zassert_equal(close(s_sock[i]), 0, "close failed");
+	}
+}
+
+static void test_epoll_et_oneshot(void)
+{
+	struct sockaddr_in s_saddr[2];
+	struct zsock_epoll_event event;
+	int c_sock[2];
+	int s_sock[2];
+	int epfd;
+	int i;
+
+	prepare_udp(&c_sock[0], &s_sock[0], &s_saddr[0], SERVER_PORT);
+	prepare_udp(&c_sock[1], &s_sock[1], &s_saddr[1], SERVER2_PORT);
+
+	epfd = epoll_create(1);
+	zassert_true(epfd >= 0, "epoll_create failed");
+
+	add(epfd, s_sock[0], EPOLLIN | EPOLLET);
+	add(epfd, s_sock[1], EPOLLIN | EPOLLONESHOT);
+
+	send_str(c_sock[0], &s_saddr[0]);
+	send_str(c_sock[1], &s_saddr[1]);
+	k_sleep(WAIT_TIME);
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 2,
+		      "sockets not ready");
+
+	/* Neither is reported again while the data is unread */
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 0,
+		      "socket reported again");
+
+	/* Edge-triggered: more data is a new edge */
+	send_str(c_sock[0], &s_saddr[0]);
+	send_str(c_sock[1], &s_saddr[1]);
+	k_sleep(WAIT_TIME);
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 1,
+		      "wrong count");
+	zassert_equal(events[0].data.fd, s_sock[0], "wrong socket");
+
+	/* One-shot: disarmed until modified */
+	event.events = EPOLLIN | EPOLLONESHOT;
+	event.data.fd = s_sock[1];
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock[1], &event), 0,
+		      "epoll_ctl failed");
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 1,
+		      "wrong count");
+	zassert_equal(events[0].data.fd, s_sock[1], "wrong socket");
+
+	zassert_equal(close(epfd), 0, "close failed");
+
+	for (i = 0; i < 2; i++) {
+		zassert_equal(close(c_sock[i]), 0, "close failed");
+		zassert_equal(close(s_sock[i]), 0, "close failed");
+	}
+}
+
+static void test_epoll_ctl(void)
+{
+	struct zsock_epoll_event event = { .events = EPOLLIN };
+	struct sockaddr_in s_saddr;
+	int c_sock;
+	int s_sock;
+	int epfd;
+	int epfd2;
+
+	prepare_udp(&c_sock, &s_sock, &s_saddr, SERVER_PORT);
+
+	zassert_equal(epoll_create(0), -1, "epoll_create succeeded");
+	zassert_equal(errno, EINVAL, "wrong errno");
+
+	epfd = epoll_create(1);
+	zassert_true(epfd >= 0, "epoll_create failed");
+	epfd2 = epoll_create(1);
+	zassert_true(epfd2 >= 0, "epoll_create failed");
+	zassert_equal(epoll_create(1), -1, "too many instances");
+	zassert_equal(errno, ENOMEM, "wrong errno");
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_MOD, s_sock, &event), -1,
+		      "modified unregistered socket");
+	zassert_equal(errno, ENOENT, "wrong errno");
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_DEL, s_sock, NULL), -1,
+		      "removed unregistered socket");
+	zassert_equal(errno, ENOENT, "wrong errno");
+
+	add(epfd, s_sock, EPOLLIN);
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, s_sock, &event), -1,
+		      "registered twice");
+	zassert_equal(errno, EEXIST, "wrong errno");
+
+	/* Several instances may watch the same socket */
+	add(epfd2, s_sock, EPOLLIN);
+
+	zassert_equal(epoll_ctl(epfd, EPOLL_CTL_ADD, epfd2, &event), -1,
+		      "registered an epoll instance");
+	zassert_equal(errno, EPERM, "wrong errno");
+	zassert_equal(epoll_ctl(s_sock, EPOLL_CTL_ADD, c_sock, &event), -1,
+		      "used a socket as epoll instance");
+	zassert_equal(errno, EINVAL, "wrong errno");
+
+	send_str(c_sock, &s_saddr);
+	k_sleep(WAIT_TIME);
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 1,
+		      "socket not ready");
+	zassert_equal(epoll_wait(epfd2, events, ARRAY_SIZE(events), 0), 1,
+		      "socket not ready");
+
+	zassert_equal(epoll_ctl(epfd2, EPOLL_CTL_DEL, s_sock, NULL), 0,
+		      "epoll_ctl failed");
+	zassert_equal(epoll_wait(epfd2, events, ARRAY_SIZE(events), 0), 0,
+		      "removed socket reported");
+
+	/* Closing the socket unregisters it */
+	zassert_equal(close(s_sock), 0, "close failed");
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 0,
+		      "closed socket reported");
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(epfd2), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+}
+
+static void test_epoll_tcp(void)
+{
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	int epfd;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	zassert_equal(bind(s_sock, (struct sockaddr *)&s_saddr,
+			   sizeof(s_saddr)),
+		      0, "bind failed");
+	zassert_equal(listen(s_sock, 1), 0, "listen failed");
+
+	epfd = epoll_create(1);
+	zassert_true(epfd >= 0, "epoll_create failed");
+
+	/* A pending connection makes the listening socket readable */
+	add(epfd, s_sock, EPOLLIN);
+
+	zassert_equal(connect(c_sock, (struct sockaddr *)&s_saddr,
+			      sizeof(s_saddr)),
+		      0, "connect failed");
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), WAIT_TIME),
+		      1, "no connection");
+	zassert_equal(events[0].data.fd, s_sock, "wrong socket");
+
+	new_sock = accept(s_sock, &addr, &addrlen);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	add(epfd, new_sock, EPOLLIN | EPOLLOUT);
+
+	/* Always writable */
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 1,
+		      "socket not ready");
+	zassert_equal(events[0].events, EPOLLOUT, "wrong events");
+
+	zassert_equal(send(c_sock, TEST_STR, sizeof(TEST_STR) - 1, 0),
+		      sizeof(TEST_STR) - 1, "send failed");
+	k_sleep(WAIT_TIME);
+
+	zassert_equal(epoll_wait(epfd, events, ARRAY_SIZE(events), 0), 1,
+		      "socket not ready");
+	zassert_equal(events[0].data.fd, new_sock, "wrong socket");
+	zassert_equal(events[0].events, EPOLLIN | EPOLLOUT, "wrong events");
+
+	recv_str(new_sock);
+
+	zassert_equal(close(epfd), 0, "close failed");
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_epoll,
+			 ztest_unit_test(test_epoll_udp),
+			 ztest_unit_test(test_epoll_et_oneshot),
+			 ztest_unit_test(test_epoll_ctl),
+			 ztest_unit_test(test_epoll_tcp));
+
+	ztest_run_test_suite(socket_epoll);
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * sendmmsg()/recvmmsg(), and a comparison of the UDP throughput over the
+ * loopback interface with one call per datagram and with batched calls.
+ *
+ * The cycle counts are only meaningful on targets with a free running
+ * cycle counter; native_posix reports 0.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+
+#include "../../socket_helpers.h"
+
+#define CLIENT_PORT 9898
+#define SERVER_PORT 4242
+
+#define BATCH 8
+#define ROUNDS 50
+#define PAYLOAD_LEN 64
+
+static ZTEST_BMEM char tx_data[BATCH][PAYLOAD_LEN];
+static ZTEST_BMEM char rx_data[BATCH][PAYLOAD_LEN];
+static ZTEST_BMEM struct iovec tx_iov[BATCH];
+static ZTEST_BMEM struct iovec rx_iov[BATCH][2];
+static ZTEST_BMEM struct mmsghdr tx_msgs[BATCH];
+static ZTEST_BMEM struct mmsghdr rx_msgs[BATCH];
+static ZTEST_BMEM struct sockaddr_in rx_addrs[BATCH];
+
+static void prepare_socks(int *c_sock, struct sockaddr_in *c_saddr,
+			  int *s_sock, struct sockaddr_in *s_saddr)
+{
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    c_sock, c_saddr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    s_sock, s_saddr);
+
+	zassert_equal(bind(*c_sock, (struct sockaddr *)c_saddr,
+			   sizeof(*c_saddr)),
+		      0, "bind failed");
+	zassert_equal(bind(*s_sock, (struct sockaddr *)s_saddr,
+			   sizeof(*s_saddr)),
+		      0, "bind failed");
+}
+
+static void close_socks(int c_sock, int s_sock)
+{
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+/* Datagram i is i + 1 bytes of 'a' + i, sent to s_saddr */
+static void prepare_tx(struct sockaddr_in *s_saddr, size_t len)
+{
+	int i;
+
+	for (i = 0; i < BATCH; i++) {
+		(void)memset(tx_data[i], 'a' + i, PAYLOAD_LEN);
+
+		tx_iov[i].iov_base = tx_data[i];
+		tx_iov[i].iov_len = len ? len : i + 1;
+
+		(void)memset(&tx_msgs[i], 0, sizeof(tx_msgs[i]));
+		tx_msgs[i].msg_hdr.msg_name = s_saddr;
+		tx_msgs[i].msg_hdr.msg_namelen = sizeof(*s_saddr);
+		tx_msgs[i].msg_hdr.msg_iov = &tx_iov[i];
+		tx_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+}
+
+/* Each datagram is split over two buffers of half its size */
+static void prepare_rx(void)
+{
+	int i;
+
+	(void)memset(rx_data, 0, sizeof(rx_data));
+
+	for (i = 0; i < BATCH; i++) {
+		rx_iov[i][0].iov_base = rx_data[i];
+		rx_iov[i][0].iov_len = PAYLOAD_LEN / 2;
+		rx_iov[i][1].iov_base = rx_data[i] + PAYLOAD_LEN / 2;
+		rx_iov[i][1].iov_len = PAYLOAD_LEN / 2;
+
+		(void)memset(&rx_msgs[i], 0, sizeof(rx_msgs[i]));
+		rx_msgs[i].msg_hdr.msg_name = &rx_addrs[i];
+		rx_msgs[i].msg_hdr.msg_namelen = sizeof(rx_addrs[i]);
+		rx_msgs[i].msg_hdr.msg_iov = rx_iov[i];
+		rx_msgs[i].msg_hdr.msg_iovlen = ARRAY_SIZE(rx_iov[i]);
+	}
+}
+
+/* Receive count datagrams into rx_msgs, with as few calls as it takes */
+static void recv_batch(int sock, int count)
+{
+	int received = 0;
+	int ret;
+
+	while (received < count) {
+		ret = recvmmsg(sock, &rx_msgs[received], count - received, 0);
+		zassert_true(ret > 0, "recvmmsg failed (%d)", errno);
+
+		received += ret;
+	}
+}
+
+static void test_sendmmsg_recvmmsg(void)
+{
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	int c_sock;
+	int s_sock;
+	int i;
+
+	prepare_socks(&c_sock, &c_saddr, &s_sock, &s_saddr);
+	prepare_tx(&s_saddr, 0);
+	prepare_rx();
+
+	zassert_equal(sendmmsg(c_sock, tx_msgs, BATCH, 0), BATCH,
+		      "sendmmsg failed");
+
+	for (i = 0; i < BATCH; i++) {
+		zassert_equal(tx_msgs[i].msg_len, i + 1, "wrong sent length");
+	}
+
+	recv_batch(s_sock, BATCH);
+
+	for (i = 0; i < BATCH; i++) {
+		zassert_equal(rx_msgs[i].msg_len, i + 1,
+			      "wrong length of datagram %d", i);
+		zassert_mem_equal(rx_data[i], tx_data[i], i + 1,
+				  "wrong data in datagram %d", i);
+		zassert_equal(rx_msgs[i].msg_hdr.msg_flags, 0,
+			      "datagram %d truncated", i);
+		zassert_equal(rx_msgs[i].msg_hdr.msg_namelen,
+			      sizeof(struct sockaddr_in), "wrong addrlen");
+		zassert_equal(rx_addrs[i].sin_port, htons(CLIENT_PORT),
+			      "wrong source port");
+	}
+
+	close_socks(c_sock, s_sock);
+}
+
+static void test_recvmmsg_scatter(void)
+{
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	int c_sock;
+	int s_sock;
+
+	prepare_socks(&c_sock, &c_saddr, &s_sock, &s_saddr);
+	prepare_tx(&s_saddr, PAYLOAD_LEN);
+	prepare_rx();
+
+	/* A datagram larger than the buffers is truncated */
+	tx_iov[0].iov_len = PAYLOAD_LEN;
+	rx_iov[0][1].iov_len = PAYLOAD_LEN / 4;
+
+	zassert_equal(sendmmsg(c_sock, tx_msgs, 1, 0), 1, "sendmmsg failed");
+
+	recv_batch(s_sock, 1);
+
+	zassert_equal(rx_msgs[0].msg_len, PAYLOAD_LEN / 2 + PAYLOAD_LEN / 4,
+		      "wrong length");
+	zassert_mem_equal(rx_data[0], tx_data[0], rx_msgs[0].msg_len,
+			  "wrong data");
+	zassert_equal(rx_data[0][rx_msgs[0].msg_len], 0, "buffer overrun");
+	zassert_equal(rx_msgs[0].msg_hdr.msg_flags, MSG_TRUNC,
+		      "truncation not reported");
+
+	close_socks(c_sock, s_sock);
+}
+
+static void test_recvmmsg_nonblock(void)
+{
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	int c_sock;
+	int s_sock;
+
+	prepare_socks(&c_sock, &c_saddr, &s_sock, &s_saddr);
+	prepare_rx();
+
+	zassert_equal(recvmmsg(s_sock, rx_msgs, BATCH, MSG_DONTWAIT), -1,
+		      "recvmmsg did not fail");
+	zassert_equal(errno, EAGAIN, "wrong errno");
+
+	close_socks(c_sock, s_sock);
+}
+
+static u32_t run_single(int c_sock, int s_sock, struct sockaddr_in *s_saddr)
+{
+	u32_t start = k_cycle_get_32();
+	int round;
+	int i;
+
+	for (round = 0; round < ROUNDS; round++) {
+		for (i = 0; i < BATCH; i++) {
+			zassert_equal(sendto(c_sock, tx_data[i], PAYLOAD_LEN, 0,
+					     (struct sockaddr *)s_saddr,
+					     sizeof(*s_saddr)),
+				      PAYLOAD_LEN, "sendto failed");
+		}
+
+		for (i = 0; i < BATCH; i++) {
+			zassert_equal(recvfrom(s_sock, rx_data[i], PAYLOAD_LEN,
+					       0, NULL, NULL),
+				      PAYLOAD_LEN, "recvfrom failed");
+		}
+	}
+
+	return k_cycle_get_32() - start;
+}
+
+static u32_t run_batched(int c_sock, int s_sock)
+{
+	u32_t start = k_cycle_get_32();
+	int round;
+
+	for (round = 0; round < ROUNDS; round++) {
+		zassert_equal(sendmmsg(c_sock, tx_msgs, BATCH, 0), BATCH,
+			      "sendmmsg failed");
+
+		recv_batch(s_sock, BATCH);
+	}
+
+	return k_cycle_get_32() - start;
+}
+
+static void test_udp_throughput(void)
+{
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	u32_t single;
+	u32_t batched;
+	int c_sock;
+	int s_sock;
+
+	prepare_socks(&c_sock, &c_saddr, &s_sock, &s_saddr);
+	prepare_tx(&s_saddr, PAYLOAD_LEN);
+	prepare_rx();
+
+	single = run_single(c_sock, s_sock, &s_saddr);
+	batched = run_batched(c_sock, s_sock);
+
+	TC_PRINT("udp: %d datagrams of %d bytes, %d per call\n",
+		 ROUNDS * BATCH, PAYLOAD_LEN, BATCH);
+	TC_PRINT("udp: sendto/recvfrom   %6u cycles/datagram\n",
+		 single / (ROUNDS * BATCH));
+	TC_PRINT("udp: sendmmsg/recvmmsg %6u cycles/datagram\n",
+		 batched / (ROUNDS * BATCH));
+
+	close_socks(c_sock, s_sock);
+}
+
+void test_main(void)
+{
+	/* The system calls copy the message headers from this pool */
+	k_thread_system_pool_assign(k_current_get());
+
+	ztest_test_suite(socket_mmsg,
+			 ztest_unit_test(test_sendmmsg_recvmmsg),
+			 ztest_user_unit_test(test_sendmmsg_recvmmsg),
+			 ztest_unit_test(test_recvmmsg_scatter),
+			 ztest_user_unit_test(test_recvmmsg_scatter),
+			 ztest_unit_test(test_recvmmsg_nonblock),
+			 ztest_unit_test(test_udp_throughput));
+
+	ztest_run_test_suite(socket_mmsg);
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * MSG_ZEROCOPY sends: the data is referenced from the application buffer
+ * until the send is reported complete through SO_ZEROCOPY_DONE. The test
+ * thread is cooperative, so nothing it sends reaches the loopback driver,
+ * which copies the packet, before it waits. Changing the data in the
+ * meantime shows whether it was copied; UDP checksums are not checked as
+ * they no longer match.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+
+#include "../../socket_helpers.h"
+
+#define ANY_PORT 0
+#define SERVER_PORT 4242
+
+#define DATA_LEN 16
+#define SENDS (CONFIG_NET_CONTEXT_ZEROCOPY_BUF_COUNT + 1)
+
+#define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
+#define WAIT_TIME K_MSEC(100)
+
+static char data[SENDS][DATA_LEN];
+static char rx_buf[2 * DATA_LEN];
+
+static void fill_data(void)
+{
+	int i;
+
+	for (i = 0; i < SENDS; i++) {
+		(void)memset(data[i], 'a' + i, DATA_LEN);
+	}
+}
+
+static void enable_zerocopy(int sock)
+{
+	int one = 1;
+
+	zassert_equal(setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, &one,
+				 sizeof(one)),
+		      0, "setsockopt failed");
+}
+
+static int zerocopy_done(int sock)
+{
+	socklen_t optlen = sizeof(int);
+	int done;
+
+	zassert_equal(getsockopt(sock, SOL_SOCKET, SO_ZEROCOPY_DONE, &done,
+				 &optlen),
+		      0, "getsockopt failed");
+	zassert_equal(optlen, sizeof(int), "wrong optlen");
+
+	return done;
+}
+
+static void prepare_udp(int *c_sock, int *s_sock, struct sockaddr_in *s_saddr)
+{
+	struct sockaddr_in c_saddr;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    c_sock, &c_saddr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    s_sock, s_saddr);
+
+	zassert_equal(bind(*c_sock, (struct sockaddr *)&c_saddr,
+			   sizeof(c_saddr)),
+		      0, "bind failed");
+	zassert_equal(bind(*s_sock, (struct sockaddr *)s_saddr,
+			   sizeof(*s_saddr)),
+		      0, "bind failed");
+}
+
+static void test_udp_zerocopy(void)
+{
+	struct iovec iov[] = {
+		{ .iov_base = data[0], .iov_len = DATA_LEN },
+		{ .iov_base = data[1], .iov_len = DATA_LEN },
+	};
+	struct sockaddr_in s_saddr;
+	struct msghdr msg;
+	int c_sock;
+	int s_sock;
+
+	prepare_udp(&c_sock, &s_sock, &s_saddr);
+	enable_zerocopy(c_sock);
+	fill_data();
+
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &s_saddr;
+	msg.msg_namelen = sizeof(s_saddr);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = ARRAY_SIZE(iov);
+
+	zassert_equal(sendmsg(c_sock, &msg, MSG_ZEROCOPY), 2 * DATA_LEN,
+		      "sendmsg failed");
+	zassert_equal(zerocopy_done(c_sock), 0, "completed while queued");
+
+	/* Not copied: the receiver sees what is in the buffer now */
+	data[0][0] = 'X';
+	data[1][DATA_LEN - 1] = 'Y';
+
+	zassert_equal(recv(s_sock, rx_buf, sizeof(rx_buf), 0), 2 * DATA_LEN,
+		      "recv failed");
+	zassert_equal(rx_buf[0], 'X', "data copied");
+	zassert_equal(rx_buf[2 * DATA_LEN - 1], 'Y', "data copied");
+	zassert_equal(zerocopy_done(c_sock), 1, "not completed");
+
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+static void test_udp_zerocopy_disabled(void)
+{
+	struct sockaddr_in s_saddr;
+	int c_sock;
+	int s_sock;
+
+	prepare_udp(&c_sock, &s_sock, &s_saddr);
+	fill_data();
+
+	/* Without SO_ZEROCOPY the flag is ignored */
+	zassert_equal(sendto(c_sock, data[0], DATA_LEN, MSG_ZEROCOPY,
+			     (struct sockaddr *)&s_saddr, sizeof(s_saddr)),
+		      DATA_LEN, "sendto failed");
+
+	data[0][0] = 'X';
+
+	zassert_equal(recv(s_sock, rx_buf, sizeof(rx_buf), 0), DATA_LEN,
+		      "recv failed");
+	zassert_equal(rx_buf[0], 'a', "data not copied");
+	zassert_equal(zerocopy_done(c_sock), 0, "send numbered");
+
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+static void test_udp_zerocopy_fallback(void)
+{
+	struct iovec iov[SENDS];
+	struct sockaddr_in s_saddr;
+	struct msghdr msg;
+	int c_sock;
+	int s_sock;
+	int i;
+
+	prepare_udp(&c_sock, &s_sock, &s_saddr);
+	enable_zerocopy(c_sock);
+	fill_data();
+
+	for (i = 0; i < SENDS; i++) {
+		iov[i].iov_base = data[i];
+		iov[i].iov_len = DATA_LEN;
+	}
+
+	(void)memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &s_saddr;
+	msg.msg_namelen = sizeof(s_saddr);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = SENDS;
+
+	/* One buffer short: copied, and so complete at once */
+	zassert_equal(sendmsg(c_sock, &msg, MSG_ZEROCOPY), SENDS * DATA_LEN,
+		      "sendmsg failed");
+	zassert_equal(zerocopy_done(c_sock), 1, "not completed");
+
+	/* The buffers taken by the copied send are free again */
+	msg.msg_iovlen = SENDS - 1;
+	zassert_equal(sendmsg(c_sock, &msg, MSG_ZEROCOPY),
+		      (SENDS - 1) * DATA_LEN, "sendmsg failed");
+	zassert_equal(zerocopy_done(c_sock), 1, "completed while queued");
+
+	data[0][0] = 'X';
+
+	zassert_equal(recv(s_sock, rx_buf, sizeof(rx_buf), 0), sizeof(rx_buf),
+		      "recv failed");
+	zassert_equal(rx_buf[0], 'a', "data not copied");
+	zassert_equal(recv(s_sock, rx_buf, sizeof(rx_buf), 0), sizeof(rx_buf),
+		      "recv failed");
+	zassert_equal(rx_buf[0], 'X', "data copied");
+	zassert_equal(zerocopy_done(c_sock), 2, "not completed");
+
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+}
+
+static void test_tcp_zerocopy(void)
+{
+	struct sockaddr_in c_saddr;
+	struct sockaddr_in s_saddr;
+	struct sockaddr addr;
+	socklen_t addrlen = sizeof(addr);
+	int c_sock;
+	int s_sock;
+	int new_sock;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, ANY_PORT,
+			    &c_sock, &c_saddr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &s_sock, &s_saddr);
+
+	zassert_equal(bind(s_sock, (struct sockaddr *)&s_saddr,
+			   sizeof(s_saddr)),
+		      0, "bind failed");
+	zassert_equal(listen(s_sock, 1), 0, "listen failed");
+	zassert_equal(connect(c_sock, (struct sockaddr *)&s_saddr,
+			      sizeof(s_saddr)),
+		      0, "connect failed");
+
+	new_sock = accept(s_sock, &addr, &addrlen);
+	zassert_true(new_sock >= 0, "accept failed");
+
+	enable_zerocopy(c_sock);
+	fill_data();
+
+	zassert_equal(send(c_sock, data[0], DATA_LEN, MSG_ZEROCOPY), DATA_LEN,
+		      "send failed");
+	zassert_equal(send(c_sock, data[1], DATA_LEN, MSG_ZEROCOPY), DATA_LEN,
+		      "send failed");
+
+	zassert_equal(recv(new_sock, rx_buf, DATA_LEN, 0), DATA_LEN,
+		      "recv failed");
+	zassert_mem_equal(rx_buf, data[0], DATA_LEN, "wrong data");
+	zassert_equal(recv(new_sock, rx_buf, DATA_LEN, 0), DATA_LEN,
+		      "recv failed");
+	zassert_mem_equal(rx_buf, data[1], DATA_LEN, "wrong data");
+
+	/* Both acknowledged and read */
+	k_sleep(WAIT_TIME);
+	zassert_equal(zerocopy_done(c_sock), 2, "not completed");
+
+	zassert_equal(close(c_sock), 0, "close failed");
+	zassert_equal(close(new_sock), 0, "close failed");
+	zassert_equal(close(s_sock), 0, "close failed");
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_zerocopy,
+			 ztest_unit_test(test_udp_zerocopy),
+			 ztest_unit_test(test_udp_zerocopy_disabled),
+			 ztest_unit_test(test_udp_zerocopy_fallback),
+			 ztest_unit_test(test_tcp_zerocopy));
+
+	ztest_run_test_suite(socket_zerocopy);
+}
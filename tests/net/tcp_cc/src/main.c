@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Congestion control. The interface driver loops the packets back like
+ * the loopback driver does, but loses some of the data segments the first
+ * time they are sent. The algorithm is NewReno or CUBIC depending on the
+ * configuration, the window handling around it is the same for both.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+
+#include "tcp_lossy.h"
+#include "tcp_cc.h"
+
+#define SERVER_PORT 4242
+
+static u32_t initial_window(struct net_tcp *tcp)
+{
+	u32_t mss = net_tcp_cc_mss(tcp);
+
+	return MIN(4 * mss, MAX(2 * mss, 4380));
+}
+
+static void print_state(const char *name, struct net_tcp *tcp,
+			u32_t elapsed)
+{
+	TC_PRINT("%s: %s cwnd %u ssthresh %u rto %u, %u ms\n", name,
+		 tcp->cc->name, tcp->cwnd, tcp->ssthresh, tcp->rto, elapsed);
+	TC_PRINT("%s: %u retransmissions, %u recoveries, %u timeouts\n",
+		 name, tcp->cc_stats.rexmits, tcp->cc_stats.recoveries,
+		 tcp->cc_stats.timeouts);
+}
+
+static void test_initial_window(void)
+{
+	const struct net_tcp_cc *expected;
+	struct net_tcp *tcp;
+	int c_sock;
+	int s_sock;
+	int new_sock;
+
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+	expected = &net_tcp_cc_cubic;
+#else
+	expected = &net_tcp_cc_newreno;
+#endif
+
+	connect_socks(SERVER_PORT, &c_sock, &s_sock, &new_sock);
+
+	tcp = sock_tcp(c_sock);
+	zassert_equal(tcp->cc, expected, "wrong algorithm");
+	zassert_equal(sock_tcp(new_sock)->cc, expected, "wrong algorithm");
+
+	zassert_equal(tcp->cwnd, initial_window(tcp), "wrong initial window");
+	zassert_equal(tcp->ssthresh, UINT32_MAX, "slow start threshold set");
+	zassert_equal(tcp->rto, CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT,
+		      "wrong initial retransmission timeout");
+	zassert_equal(net_tcp_cc_flight(tcp), 0, "data in flight");
+	zassert_equal(tcp->send_wnd, sock_tcp(new_sock)->recv_wnd,
+		      "wrong peer window");
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+static void test_slow_start(void)
+{
+	struct net_tcp *tcp;
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	u32_t elapsed;
+
+	connect_socks(SERVER_PORT + 1, &c_sock, &s_sock, &new_sock);
+	tcp = sock_tcp(c_sock);
+
+	lossy_reset(NULL, 0, -1);
+	elapsed = transfer(c_sock, new_sock);
+
+	print_state("slow start", tcp, elapsed);
+
+	zassert_true(tcp->cwnd > initial_window(tcp), "window did not grow");
+	zassert_equal(tcp->ssthresh, UINT32_MAX, "slow start threshold set");
+	zassert_equal(tcp->cc_stats.rexmits, 0, "segments retransmitted");
+	zassert_true(tcp->flags & NET_TCP_RTT_VALID, "no RTT measured");
+	zassert_true(tcp->rto >= CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT,
+		     "retransmission timeout too short");
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+static void test_fast_recovery(void)
+{
+	static const int drop[] = { 4 };
+	struct net_tcp *tcp;
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	u32_t elapsed;
+
+	connect_socks(SERVER_PORT + 2, &c_sock, &s_sock, &new_sock);
+	tcp = sock_tcp(c_sock);
+
+	lossy_reset(drop, ARRAY_SIZE(drop), -1);
+	elapsed = transfer(c_sock, new_sock);
+
+	print_state("fast recovery", tcp, elapsed);
+
+	zassert_equal(rexmits, 1, "wrong number of retransmissions");
+	zassert_equal(tcp->cc_stats.rexmits, 1,
+		      "wrong number of retransmissions");
+	zassert_equal(tcp->cc_stats.recoveries, 1, "no recovery");
+	zassert_equal(tcp->cc_stats.timeouts, 0, "retransmitted on timeout");
+	zassert_true(tcp->ssthresh < initial_window(tcp),
+		     "slow start threshold not reduced");
+	zassert_false(tcp->flags & NET_TCP_IN_RECOVERY, "still recovering");
+
+	lossy_reset(NULL, 0, -1);
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+static void test_timeout(void)
+{
+	/* No duplicate ACKs follow the last segment */
+	static const int drop[] = { SEGMENTS - 1 };
+	struct net_tcp *tcp;
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	u32_t elapsed;
+
+	connect_socks(SERVER_PORT + 3, &c_sock, &s_sock, &new_sock);
+	tcp = sock_tcp(c_sock);
+
+	lossy_reset(drop, ARRAY_SIZE(drop), -1);
+	elapsed = transfer(c_sock, new_sock);
+
+	print_state("timeout", tcp, elapsed);
+
+	zassert_equal(rexmits, 1, "wrong number of retransmissions");
+	zassert_equal(tcp->cc_stats.recoveries, 0, "recovery started");
+	zassert_equal(tcp->cc_stats.timeouts, 1, "no timeout");
+	zassert_equal(tcp->cwnd, net_tcp_cc_mss(tcp),
+		      "window not reduced to one segment");
+	zassert_true(elapsed >= CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT,
+		     "retransmitted too early");
+
+	lossy_reset(NULL, 0, -1);
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+/* Acknowledge a window of data one segment at a time */
+static void ack_window(struct net_tcp *tcp)
+{
+	u32_t mss = net_tcp_cc_mss(tcp);
+	u32_t cwnd = tcp->cwnd;
+	u32_t acked;
+
+	for (acked = 0; acked < cwnd; acked += mss) {
+		tcp->cc->ack(tcp, mss);
+	}
+}
+
+/* After a loss with 100 segments in flight */
+static void check_newreno(struct net_tcp *tcp, u32_t mss)
+{
+	zassert_equal(tcp->ssthresh, 50 * mss, "window not halved");
+
+	/* One more segment per round trip */
+	ack_window(tcp);
+	zassert_equal(tcp->cwnd, 51 * mss, "wrong increase");
+	ack_window(tcp);
+	zassert_equal(tcp->cwnd, 52 * mss, "wrong increase");
+}
+
+static void check_cubic(struct net_tcp *tcp, u32_t mss)
+{
+	int i;
+
+	zassert_equal(tcp->ssthresh, 70 * mss, "window not reduced by 30%");
+	zassert_equal(tcp->cc_data.cubic.w_max, 100 * mss, "wrong W_max");
+
+	/* The window gets back to W_max in K = cbrt(30 / 0.4) s */
+	ack_window(tcp);
+	zassert_within(tcp->cc_data.cubic.k, 4217, 1, "wrong K");
+	zassert_true(tcp->cwnd < 75 * mss, "window grew too fast");
+
+	tcp->cc_data.cubic.epoch_start -= tcp->cc_data.cubic.k;
+	for (i = 0; i < 4; i++) {
+		ack_window(tcp);
+	}
+
+	zassert_within(tcp->cwnd, 100 * mss, 2 * mss,
+		       "window not back to W_max");
+
+	/* Then probes for more, slowly first */
+	tcp->cc_data.cubic.epoch_start -= 1000;
+	ack_window(tcp);
+	zassert_within(tcp->cwnd, 100 * mss, 2 * mss, "window grew too fast");
+
+	tcp->cc_data.cubic.epoch_start -= 4000;
+	ack_window(tcp);
+	zassert_true(tcp->cwnd > 110 * mss, "window did not grow");
+
+	/* Fast convergence, the window did not get back to W_max */
+	tcp->cwnd = 90 * mss;
+	tcp->snd_nxt = tcp->snd_una + tcp->cwnd;
+	tcp->cc->ssthresh(tcp);
+	zassert_within(tcp->cc_data.cubic.w_max, 90 * mss * 17 / 20, 1,
+		       "no fast convergence");
+}
+
+/* The algorithm alone, on a connection which only lends its MSS */
+static void test_algorithm(void)
+{
+	struct net_tcp tcp = { 0 };
+	u32_t mss;
+	int c_sock;
+	int s_sock;
+	int new_sock;
+
+	connect_socks(SERVER_PORT + 4, &c_sock, &s_sock, &new_sock);
+
+	tcp.context = sock_tcp(c_sock)->context;
+	tcp.send_mss = sock_tcp(c_sock)->send_mss;
+	tcp.cc = sock_tcp(c_sock)->cc;
+	mss = net_tcp_cc_mss(&tcp);
+
+	tcp.cwnd = 10 * mss;
+	tcp.ssthresh = UINT32_MAX;
+	tcp.cc->init(&tcp);
+
+	/* Slow start doubles the window each round trip */
+	ack_window(&tcp);
+	zassert_equal(tcp.cwnd, 20 * mss, "no slow start");
+
+	tcp.cwnd = 100 * mss;
+	tcp.snd_nxt = tcp.snd_una + tcp.cwnd;
+	tcp.ssthresh = tcp.cc->ssthresh(&tcp);
+	tcp.cwnd = tcp.ssthresh;
+
+	if (IS_ENABLED(CONFIG_NET_TCP_CC_CUBIC)) {
+		check_cubic(&tcp, mss);
+	} else {
+		check_newreno(&tcp, mss);
+	}
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(tcp_cc,
+			 ztest_unit_test(test_initial_window),
+			 ztest_unit_test(test_slow_start),
+			 ztest_unit_test(test_fast_recovery),
+			 ztest_unit_test(test_timeout),
+			 ztest_unit_test(test_algorithm));
+
+	ztest_run_test_suite(tcp_cc);
+}
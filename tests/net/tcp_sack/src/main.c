@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Out-of-order queue and selective acknowledgments. The interface driver
+ * loops the packets back like the loopback driver does, but loses or
+ * delays some of the data segments the first time they are sent, which
+ * makes the receiver see them out of order.
+ *
+ * With CONFIG_NET_TCP_SACK the segments after a lost one are kept and the
+ * lost ones retransmitted once each after three duplicate ACKs. Without
+ * it, they are dropped and retransmitted one per retransmission timeout,
+ * which the throughput printed by test_lossy_transfer shows.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+
+#include "tcp_lossy.h"
+
+#define SERVER_PORT 4242
+
+static void test_sack_negotiated(void)
+{
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	bool expected = IS_ENABLED(CONFIG_NET_TCP_SACK);
+
+	connect_socks(SERVER_PORT, &c_sock, &s_sock, &new_sock);
+
+	zassert_equal(!!(sock_tcp(c_sock)->flags & NET_TCP_SACK_PERMITTED),
+		      expected, "wrong SACK state of the client");
+	zassert_equal(!!(sock_tcp(new_sock)->flags & NET_TCP_SACK_PERMITTED),
+		      expected, "wrong SACK state of the server");
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+static void test_reordered_segment(void)
+{
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	u32_t elapsed;
+
+	connect_socks(SERVER_PORT + 1, &c_sock, &s_sock, &new_sock);
+
+	lossy_reset(NULL, 0, 2);
+	elapsed = transfer(c_sock, new_sock);
+
+	TC_PRINT("reordered: %u ms, %d retransmissions\n", elapsed, rexmits);
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK)) {
+		/* The segment after the late one was kept */
+		zassert_equal(rexmits, 0, "segments retransmitted");
+		zassert_true(sack_acks > 0, "no SACK option sent");
+	}
+
+	lossy_reset(NULL, 0, -1);
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+static void test_lossy_transfer(void)
+{
+	static const int drop[] = { 4, 13 };
+	int c_sock;
+	int s_sock;
+	int new_sock;
+	u32_t elapsed;
+
+	connect_socks(SERVER_PORT + 2, &c_sock, &s_sock, &new_sock);
+
+	lossy_reset(drop, ARRAY_SIZE(drop), -1);
+	elapsed = transfer(c_sock, new_sock);
+
+	TC_PRINT("lossy: %d segments of %d bytes, %d lost, "
+		 "%d retransmissions\n", SEGMENTS, SEG_LEN,
+		 (int)ARRAY_SIZE(drop), rexmits);
+	TC_PRINT("lossy: %zu bytes in %u ms\n", sizeof(tx_data), elapsed);
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK)) {
+		/* Only the lost segments were sent again, without waiting
+		 * for the retransmission timeout.
+		 */
+		zassert_equal(rexmits, ARRAY_SIZE(drop),
+			      "wrong number of retransmissions");
+		zassert_true(sack_acks > 0, "no SACK option sent");
+		zassert_true(elapsed <
+			     CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT,
+			     "retransmitted on timeout");
+	}
+
+	lossy_reset(NULL, 0, -1);
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+/* A segment received after a missing one still acknowledges data */
+static void test_out_of_order_ack(void)
+{
+	static const int drop[] = { 0 };
+	u8_t buf[SEG_LEN];
+	int c_sock;
+	int s_sock;
+	int new_sock;
+
+	connect_socks(SERVER_PORT + 3, &c_sock, &s_sock, &new_sock);
+
+	lossy_reset(drop, ARRAY_SIZE(drop), -1);
+
+	/* The server's data is lost, so its ACK of the client's data
+	 * comes after a missing segment.
+	 */
+	zassert_equal(send(new_sock, tx_data, SEG_LEN, 0), SEG_LEN,
+		      "send failed");
+	zassert_equal(send(c_sock, tx_data, SEG_LEN, 0), SEG_LEN,
+		      "send failed");
+	zassert_equal(recv(new_sock, buf, sizeof(buf), 0), SEG_LEN,
+		      "recv failed");
+
+	k_sleep(CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT / 4);
+
+	if (IS_ENABLED(CONFIG_NET_TCP_SACK)) {
+		zassert_true(sys_slist_is_empty(&sock_tcp(c_sock)->sent_list),
+			     "acknowledgment ignored");
+	}
+
+	zassert_equal(recv(c_sock, buf, sizeof(buf), 0), SEG_LEN,
+		      "lost segment not retransmitted");
+
+	lossy_reset(NULL, 0, -1);
+
+	close_socks(c_sock, s_sock, new_sock);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(tcp_sack,
+			 ztest_unit_test(test_sack_negotiated),
+			 ztest_unit_test(test_reordered_segment),
+			 ztest_unit_test(test_lossy_transfer),
+			 ztest_unit_test(test_out_of_order_ack));
+
+	ztest_run_test_suite(tcp_sack);
+}
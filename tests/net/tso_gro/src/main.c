@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * TCP segmentation offload and generic receive offload.  The frames
+ * net_eth_tso_segment() cuts out of a large TCP packet are checked
+ * field by field and then fed back into the stack, where GRO should
+ * hand them to the TCP connection handler as one packet whenever they
+ * are contiguous and valid.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_L2_ETHERNET_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <zephyr/types.h>
+#include <string.h>
+#include <errno.h>
+#include <device.h>
+#include <net/net_core.h>
+#include <net/net_pkt.h>
+#include <net/net_ip.h>
+#include <net/ethernet.h>
+
+#include <ztest.h>
+
+#include "net_private.h"
+#include "connection.h"
+#include "tcp_internal.h"
+
+#define MY_PORT 4242
+#define PEER_PORT 5555
+#define SEQ 0x01020304
+#define MSS 500
+#define SEGMENTS 3
+#define MAX_FRAMES 4
+
+#define WAIT_TIME K_MSEC(100)
+
+static struct in_addr my_addr4 = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr4 = { { { 192, 0, 2, 2 } } };
+static struct in6_addr my_addr6 = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr peer_addr6 = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					  0, 0, 0, 0, 0, 0, 0, 0x2 } } };
+
+/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+static u8_t peer_mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x02 };
+
+static u8_t frame_buf[NET_ETH_MAX_FRAME_SIZE];
+static u8_t frames[MAX_FRAMES][NET_ETH_MAX_FRAME_SIZE];
+static size_t frame_len[MAX_FRAMES];
+static int frame_count;
+
+static struct net_conn_handle *handle4;
+static struct net_conn_handle *handle6;
+static int recv_count;
+static size_t recv_len;
+static bool recv_data_ok;
+
+struct eth_context {
+	u8_t mac_addr[sizeof(struct net_eth_addr)];
+};
+
+static struct eth_context eth_context_data;
+
+static void eth_iface_init(struct net_if *iface)
+{
+	struct eth_context *context = net_if_get_device(iface)->driver_data;
+
+	context->mac_addr[0] = 0x00;
+	context->mac_addr[1] = 0x00;
+	context->mac_addr[2] = 0x5E;
+	context->mac_addr[3] = 0x00;
+	context->mac_addr[4] = 0x53;
+	context->mac_addr[5] = 0x01;
+
+	net_if_set_link_addr(iface, context->mac_addr,
+			     sizeof(context->mac_addr),
+			     NET_LINK_ETHERNET);
+
+	ethernet_init(iface);
+}
+
+static enum ethernet_hw_caps eth_get_capabilities(struct device *dev)
+{
+	return ETHERNET_HW_TSO;
+}
+
+static int eth_tx(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static int eth_init(struct device *dev)
+{
+	return 0;
+}
+
+static struct ethernet_api api_funcs = {
+	.iface_api.init = eth_iface_init,
+
+	.get_capabilities = eth_get_capabilities,
+	.send = eth_tx,
+};
+
+ETH_NET_DEVICE_INIT(eth_tso_gro_test, "eth_tso_gro_test",
+		    eth_init, &eth_context_data, NULL,
+		    CONFIG_ETH_INIT_PRIORITY, &api_funcs, NET_ETH_MTU);
+
+static inline u8_t pattern(size_t offset)
+{
+	return (u8_t)(offset % 251U);
+}
+
+static size_t ip_hdr_len(sa_family_t family)
+{
+	return family == AF_INET ? NET_IPV4H_LEN : NET_IPV6H_LEN;
+}
+
+/* Builds the packet the L2 would hand to a TSO capable driver: the
+ * peer sending len bytes of payload to us, so the resulting frames can
+ * also be fed back to the receive path.
+ */
+static struct net_pkt *build_pkt(sa_family_t family, size_t len, u16_t mss)
+{
+	struct net_if *iface = net_if_get_default();
+	size_t ip_len = ip_hdr_len(family);
+	struct net_eth_hdr eth_hdr;
+	struct net_tcp_hdr tcp_hdr;
+	struct net_pkt *pkt;
+	size_t i;
+
+	pkt = net_pkt_alloc_with_buffer(iface, sizeof(eth_hdr) + ip_len +
+					NET_TCPH_LEN + len, AF_UNSPEC, 0,
+					K_NO_WAIT);
+	zassert_not_null(pkt, "out of packets");
+
+	memcpy(eth_hdr.dst.addr, net_if_get_link_addr(iface)->addr,
+	       sizeof(eth_hdr.dst));
+	memcpy(eth_hdr.src.addr, peer_mac, sizeof(eth_hdr.src));
+	eth_hdr.type = htons(family == AF_INET ?
+			     NET_ETH_PTYPE_IP : NET_ETH_PTYPE_IPV6);
+	zassert_equal(net_pkt_write(pkt, &eth_hdr, sizeof(eth_hdr)), 0, NULL);
+
+	if (family == AF_INET) {
+		struct net_ipv4_hdr ipv4_hdr;
+
+		(void)memset(&ipv4_hdr, 0, sizeof(ipv4_hdr));
+		ipv4_hdr.vhl = 0x45;
+		ipv4_hdr.len = htons(ip_len + NET_TCPH_LEN + len);
+		ipv4_hdr.id[0] = 0x12;
+		ipv4_hdr.id[1] = 0x34;
+		ipv4_hdr.offset[0] = 0x40;
+		ipv4_hdr.ttl = 64U;
+		ipv4_hdr.proto = IPPROTO_TCP;
+		net_ipaddr_copy(&ipv4_hdr.src, &peer_addr4);
+		net_ipaddr_copy(&ipv4_hdr.dst, &my_addr4);
+
+		zassert_equal(net_pkt_write(pkt, &ipv4_hdr, ip_len), 0, NULL);
+	} else {
+		struct net_ipv6_hdr ipv6_hdr;
+
+		(void)memset(&ipv6_hdr, 0, sizeof(ipv6_hdr));
+		ipv6_hdr.vtc = 0x60;
+		ipv6_hdr.len = htons(NET_TCPH_LEN + len);
+		ipv6_hdr.nexthdr = IPPROTO_TCP;
+		ipv6_hdr.hop_limit = 64U;
+		net_ipaddr_copy(&ipv6_hdr.src, &peer_addr6);
+		net_ipaddr_copy(&ipv6_hdr.dst, &my_addr6);
+
+		zassert_equal(net_pkt_write(pkt, &ipv6_hdr, ip_len), 0, NULL);
+	}
+
+	(void)memset(&tcp_hdr, 0, sizeof(tcp_hdr));
+	tcp_hdr.src_port = htons(PEER_PORT);
+	tcp_hdr.dst_port = htons(MY_PORT);
+	sys_put_be32(SEQ, tcp_hdr.seq);
+	sys_put_be32(1U, tcp_hdr.ack);
+	tcp_hdr.offset = (NET_TCPH_LEN / 4U) << 4;
+	tcp_hdr.flags = NET_TCP_ACK | NET_TCP_PSH;
+	sys_put_be16(1280U, tcp_hdr.wnd);
+	zassert_equal(net_pkt_write(pkt, &tcp_hdr, NET_TCPH_LEN), 0, NULL);
+
+	for (i = 0; i < len; i++) {
+		zassert_equal(net_pkt_write_u8(pkt, pattern(i)), 0, NULL);
+	}
+
+	net_pkt_set_family(pkt, family);
+	net_pkt_set_ip_hdr_len(pkt, ip_len);
+	net_pkt_set_tso_mss(pkt, mss);
+
+	return pkt;
+}
+
+static int store_frame(struct net_pkt *pkt, u8_t *frame, size_t len,
+		       void *user_data)
+{
+	zassert_true(frame_count < MAX_FRAMES, "too many frames");
+	zassert_true(len <= sizeof(frames[0]), "frame too long");
+
+	memcpy(frames[frame_count], frame, len);
+	frame_len[frame_count++] = len;
+
+	return 0;
+}
+
+static void segment(sa_family_t family, size_t len, u16_t mss)
+{
+	struct net_pkt *pkt = build_pkt(family, len, mss);
+	int ret;
+
+	frame_count = 0;
+
+	ret = net_eth_tso_segment(pkt, frame_buf, sizeof(frame_buf),
+				  store_frame, NULL);
+	zassert_equal(ret, 0, "segmentation failed (%d)", ret);
+
+	net_pkt_unref(pkt);
+}
+
+static void check_frame(int i, sa_family_t family, u16_t mss, size_t seg_len,
+			bool last)
+{
+	size_t ip_len = ip_hdr_len(family);
+	u8_t *ip = frames[i] + sizeof(struct net_eth_hdr);
+	struct net_tcp_hdr *tcp_hdr = (struct net_tcp_hdr *)(ip + ip_len);
+	u8_t *data = (u8_t *)tcp_hdr + NET_TCPH_LEN;
+	u16_t sum = NET_TCPH_LEN + seg_len + IPPROTO_TCP;
+	size_t j;
+
+	zassert_equal(frame_len[i], sizeof(struct net_eth_hdr) + ip_len +
+		      NET_TCPH_LEN + seg_len, "frame %d length", i);
+
+	if (family == AF_INET) {
+		struct net_ipv4_hdr *ipv4_hdr = (struct net_ipv4_hdr *)ip;
+
+		zassert_equal(ntohs(ipv4_hdr->len),
+			      ip_len + NET_TCPH_LEN + seg_len,
+			      "frame %d IPv4 length", i);
+		zassert_equal((ipv4_hdr->id[0] << 8 | ipv4_hdr->id[1]),
+			      0x1234 + i, "frame %d IPv4 id", i);
+		zassert_equal(net_calc_chksum_copy(0U, 0U, NULL, ipv4_hdr,
+						   ip_len), 0xffff,
+			      "frame %d IPv4 checksum", i);
+
+		sum = net_calc_chksum_copy(sum, 0U, NULL, &ipv4_hdr->src,
+					   2 * sizeof(struct in_addr));
+	} else {
+		struct net_ipv6_hdr *ipv6_hdr = (struct net_ipv6_hdr *)ip;
+
+		zassert_equal(ntohs(ipv6_hdr->len), NET_TCPH_LEN + seg_len,
+			      "frame %d IPv6 length", i);
+
+		sum = net_calc_chksum_copy(sum, 0U, NULL, &ipv6_hdr->src,
+					   2 * sizeof(struct in6_addr));
+	}
+
+	zassert_equal(net_calc_chksum_copy(sum, 0U, NULL, tcp_hdr,
+					   NET_TCPH_LEN + seg_len), 0xffff,
+		      "frame %d TCP checksum", i);
+	zassert_equal(sys_get_be32(tcp_hdr->seq), SEQ + i * mss,
+		      "frame %d sequence number", i);
+	zassert_equal(tcp_hdr->flags,
+		      last ? NET_TCP_ACK | NET_TCP_PSH : NET_TCP_ACK,
+		      "frame %d flags", i);
+
+	for (j = 0; j < seg_len; j++) {
+		zassert_equal(data[j], pattern(i * mss + j),
+			      "frame %d payload at %zu", i, j);
+	}
+}
+
+static void check_segments(sa_family_t family, size_t len, u16_t mss)
+{
+	int count = (len + mss - 1) / mss;
+	int i;
+
+	segment(family, len, mss);
+
+	zassert_equal(frame_count, count, "wrong number of frames");
+
+	for (i = 0; i < count; i++) {
+		check_frame(i, family, mss,
+			    i < count - 1 ? mss : len - i * mss,
+			    i == count - 1);
+	}
+}
+
+static enum net_verdict tcp_recv(struct net_conn *conn,
+				 struct net_pkt *pkt,
+				 union net_ip_header *ip_hdr,
+				 union net_proto_header *proto_hdr,
+				 void *user_data)
+{
+	size_t hdr_len = net_pkt_ip_hdr_len(pkt) +
+		(proto_hdr->tcp->offset >> 4) * 4U;
+	size_t offset = sys_get_be32(proto_hdr->tcp->seq) - SEQ;
+	size_t len = net_pkt_get_len(pkt) - hdr_len;
+	size_t i;
+	u8_t byte;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_skip(pkt, hdr_len);
+
+	for (i = 0; i < len; i++) {
+		if (net_pkt_read_u8(pkt, &byte) ||
+		    byte != pattern(offset + i)) {
+			recv_data_ok = false;
+		}
+	}
+
+	recv_count++;
+	recv_len += len;
+
+	net_pkt_unref(pkt);
+
+	return NET_OK;
+}
+
+static void recv_frames(const int *order, int count, int corrupt)
+{
+	struct net_if *iface = net_if_get_default();
+	struct net_pkt *pkt;
+	int i;
+
+	recv_count = 0;
+	recv_len = 0;
+	recv_data_ok = true;
+
+	for (i = 0; i < count; i++) {
+		int idx = order[i];
+
+		if (idx == corrupt) {
+			frames[idx][frame_len[idx] - 1] ^= 0x5a;
+		}
+
+		pkt = net_pkt_rx_alloc_with_buffer(iface, frame_len[idx],
+						   AF_UNSPEC, 0, K_NO_WAIT);
+		zassert_not_null(pkt, "out of packets");
+
+		zassert_equal(net_pkt_write(pkt, frames[idx], frame_len[idx]),
+			      0, NULL);
+		zassert_equal(net_recv_data(iface, pkt), 0, "recv failed");
+	}
+
+	k_sleep(WAIT_TIME);
+}
+
+static void test_setup(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct sockaddr_in peer4 = {
+		.sin_family = AF_INET,
+		.sin_addr = peer_addr4,
+		.sin_port = htons(PEER_PORT),
+	};
+	struct sockaddr_in local4 = {
+		.sin_family = AF_INET,
+		.sin_addr = my_addr4,
+		.sin_port = htons(MY_PORT),
+	};
+	struct sockaddr_in6 peer6 = {
+		.sin6_family = AF_INET6,
+		.sin6_addr = peer_addr6,
+		.sin6_port = htons(PEER_PORT),
+	};
+	struct sockaddr_in6 local6 = {
+		.sin6_family = AF_INET6,
+		.sin6_addr = my_addr6,
+		.sin6_port = htons(MY_PORT),
+	};
+	struct net_if_addr *ifaddr;
+	int ret;
+
+	zassert_true(net_if_supports_tso(iface), "TSO not supported");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr4, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv4 address");
+
+	ifaddr = net_if_ipv6_addr_add(iface, &my_addr6, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv6 address");
+	ifaddr->addr_state = NET_ADDR_PREFERRED;
+
+	ret = net_tcp_register(AF_INET, (struct sockaddr *)&peer4,
+			       (struct sockaddr *)&local4, PEER_PORT, MY_PORT,
+			       tcp_recv, NULL, &handle4);
+	zassert_equal(ret, 0, "Cannot register IPv4 handler (%d)", ret);
+
+	ret = net_tcp_register(AF_INET6, (struct sockaddr *)&peer6,
+			       (struct sockaddr *)&local6, PEER_PORT, MY_PORT,
+			       tcp_recv, NULL, &handle6);
+	zassert_equal(ret, 0, "Cannot register IPv6 handler (%d)", ret);
+}
+
+static void test_tso_alloc(void)
+{
+	struct net_if *iface = net_if_get_default();
+	struct net_pkt *pkt;
+
+	/* TCP packets may exceed the MTU so they can be segmented later */
+	pkt = net_pkt_alloc_with_buffer(iface, SEGMENTS * NET_ETH_MTU,
+					AF_INET, IPPROTO_TCP, K_NO_WAIT);
+	zassert_not_null(pkt, "out of packets");
+	zassert_true(net_pkt_available_payload_buffer(pkt, IPPROTO_TCP) >
+		     NET_ETH_MTU,
+		     "TCP buffer limited to MTU");
+	net_pkt_unref(pkt);
+
+	/* Other protocols still are */
+	pkt = net_pkt_alloc_with_buffer(iface, SEGMENTS * NET_ETH_MTU,
+					AF_INET, IPPROTO_ICMP, K_NO_WAIT);
+	zassert_not_null(pkt, "out of packets");
+	zassert_true(net_pkt_available_buffer(pkt) <= NET_ETH_MTU,
+		     "ICMP buffer not limited to MTU");
+	net_pkt_unref(pkt);
+}
+
+static void test_tso_segment_ipv4(void)
+{
+	/* Short last segment */
+	check_segments(AF_INET, 2 * MSS + 123, MSS);
+}
+
+static void test_tso_segment_ipv6(void)
+{
+	/* Odd sized segments */
+	check_segments(AF_INET6, 1000, 333);
+}
+
+static void test_gro_ipv4(void)
+{
+	static const int order[] = { 0, 1, 2 };
+
+	segment(AF_INET, SEGMENTS * MSS, MSS);
+	recv_frames(order, ARRAY_SIZE(order), -1);
+
+	zassert_equal(recv_count, 1, "segments not merged (%d)", recv_count);
+	zassert_equal(recv_len, SEGMENTS * MSS, "wrong length");
+	zassert_true(recv_data_ok, "wrong data");
+}
+
+static void test_gro_ipv6(void)
+{
+	static const int order[] = { 0, 1, 2 };
+
+	segment(AF_INET6, SEGMENTS * MSS, MSS);
+	recv_frames(order, ARRAY_SIZE(order), -1);
+
+	zassert_equal(recv_count, 1, "segments not merged (%d)", recv_count);
+	zassert_equal(recv_len, SEGMENTS * MSS, "wrong length");
+	zassert_true(recv_data_ok, "wrong data");
+}
+
+static void test_gro_out_of_order(void)
+{
+	static const int order[] = { 0, 2, 1 };
+
+	segment(AF_INET, SEGMENTS * MSS, MSS);
+	recv_frames(order, ARRAY_SIZE(order), -1);
+
+	zassert_equal(recv_count, SEGMENTS, "wrong number of packets (%d)",
+		      recv_count);
+	zassert_equal(recv_len, SEGMENTS * MSS, "wrong length");
+	zassert_true(recv_data_ok, "wrong data");
+}
+
+static void test_gro_bad_chksum(void)
+{
+	static const int order[] = { 0, 1, 2 };
+
+	/* The corrupted segment is dropped by TCP, the others must not
+	 * be merged across the gap.
+	 */
+	segment(AF_INET, SEGMENTS * MSS, MSS);
+	recv_frames(order, ARRAY_SIZE(order), 1);
+
+	zassert_equal(recv_count, SEGMENTS - 1, "wrong number of packets (%d)",
+		      recv_count);
+	zassert_equal(recv_len, (SEGMENTS - 1) * MSS, "wrong length");
+	zassert_true(recv_data_ok, "wrong data");
+}
+
+static void test_cleanup(void)
+{
+	zassert_equal(net_tcp_unregister(handle4), 0, NULL);
+	zassert_equal(net_tcp_unregister(handle6), 0, NULL);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(net_tso_gro,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_tso_alloc),
+			 ztest_unit_test(test_tso_segment_ipv4),
+			 ztest_unit_test(test_tso_segment_ipv6),
+			 ztest_unit_test(test_gro_ipv4),
+			 ztest_unit_test(test_gro_ipv6),
+			 ztest_unit_test(test_gro_out_of_order),
+			 ztest_unit_test(test_gro_bad_chksum),
+			 ztest_unit_test(test_cleanup));
+
+	ztest_run_test_suite(net_tso_gro);
+}
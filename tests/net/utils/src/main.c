@@ -29,6 +29,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_UTILS_LOG_LEVEL);
 
 #define NET_LOG_ENABLED 1
 #include "net_private.h"
+#include "udp_internal.h"
 
 struct net_addr_test_data {
 	sa_family_t family;
@@ -832,12 +833,153 @@ void test_addr_parse(void)
 #endif
 }
 
+/* Reference checksum: 16 bits at a time, in host order */
+static u16_t ref_chksum(u16_t sum, const u8_t *data, size_t len,
+			size_t offset)
+{
+	u32_t acc = sum;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		acc += ((offset + i) & 1) ? data[i] : data[i] << 8;
+	}
+
+	while (acc >> 16) {
+		acc = (acc & 0xffff) + (acc >> 16);
+	}
+
+	return acc;
+}
+
+static u8_t chksum_src[160];
+static u8_t chksum_dst[160];
+
+static void chksum_data_init(void)
+{
+	u32_t seed = 0x12345678;
+	int i;
+
+	for (i = 0; i < sizeof(chksum_src); i++) {
+		seed = seed * 1103515245U + 12345U;
+		chksum_src[i] = seed >> 16;
+	}
+}
+
+void test_chksum(void)
+{
+	size_t len, off;
+	u16_t sum, sum2;
+
+	chksum_data_init();
+
+	/**TESTPOINT: all lengths and alignments, with and without copy*/
+	for (off = 0; off < 8; off++) {
+		for (len = 0; len + off <= sizeof(chksum_src) - 8; len++) {
+			u16_t ref = ref_chksum(0, &chksum_src[off], len, 0);
+
+			sum = net_calc_chksum_copy(0, 0, NULL,
+						   &chksum_src[off], len);
+			zassert_equal(sum, ref, "off %zu len %zu", off, len);
+
+			(void)memset(chksum_dst, 0, sizeof(chksum_dst));
+			sum = net_calc_chksum_copy(0, 0, &chksum_dst[7 - off],
+						   &chksum_src[off], len);
+			zassert_equal(sum, ref, "off %zu len %zu", off, len);
+			zassert_mem_equal(&chksum_dst[7 - off],
+					  &chksum_src[off], len,
+					  "copy off %zu len %zu", off, len);
+		}
+	}
+
+	/**TESTPOINT: data summed in pieces, at odd and even offsets*/
+	for (len = 0; len <= 33; len++) {
+		sum = net_calc_chksum_copy(0x1234, 0, NULL, chksum_src, len);
+		sum = net_calc_chksum_copy(sum, len, NULL, &chksum_src[len],
+					   100 - len);
+		zassert_equal(sum, ref_chksum(0x1234, chksum_src, 100, 0),
+			      "split at %zu", len);
+	}
+
+	/**TESTPOINT: RFC 1624 incremental update*/
+	for (off = 0; off < 32; off += 2) {
+		u8_t new[6] = { 0x00, 0xff, 0x80, 0x01, 0xfe, 0x7f };
+
+		(void)memcpy(chksum_dst, chksum_src, 64);
+		sum = htons(~ref_chksum(0, chksum_dst, 64, 0));
+
+		sum = net_calc_chksum_update(sum, &chksum_dst[off], new,
+					     sizeof(new));
+		(void)memcpy(&chksum_dst[off], new, sizeof(new));
+
+		sum2 = htons(~ref_chksum(0, chksum_dst, 64, 0));
+		zassert_equal(sum, sum2, "update at %zu: 0x%04x != 0x%04x",
+			      off, sum, sum2);
+	}
+}
+
+#if defined(CONFIG_NET_CHKSUM_COPY) && defined(CONFIG_NET_IPV6)
+void test_chksum_pkt_write(void)
+{
+	struct net_ipv6_hdr ipv6_hdr = {
+		.vtc = 0x60,
+		.nexthdr = IPPROTO_UDP,
+		.hop_limit = 64,
+		.src = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+			     0, 0, 0, 0, 0, 0, 0, 0x1 } } },
+		.dst = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+			     0, 0, 0, 0, 0, 0, 0, 0x2 } } },
+	};
+	struct net_pkt *pkt;
+	u16_t fused, full;
+
+	chksum_data_init();
+
+	pkt = net_pkt_alloc_with_buffer(NULL, 2 * sizeof(chksum_src) + 1,
+					AF_INET6, IPPROTO_UDP, K_NO_WAIT);
+	zassert_not_null(pkt, "Out of mem");
+
+	/* No interface, so build the IPv6 header by hand */
+	zassert_equal(net_pkt_write(pkt, &ipv6_hdr, sizeof(ipv6_hdr)), 0,
+		      NULL);
+	net_pkt_set_ip_hdr_len(pkt, sizeof(ipv6_hdr));
+	zassert_equal(net_udp_create(pkt, htons(1234), htons(4242)), 0,
+		      NULL);
+
+	/* Payload spanning fragments, written in odd sized pieces */
+	zassert_equal(net_pkt_write_chksum(pkt, chksum_src, 77), 0, NULL);
+	zassert_equal(net_pkt_write_chksum(pkt, &chksum_src[77],
+					   sizeof(chksum_src) - 77), 0, NULL);
+	zassert_equal(net_pkt_write_chksum(pkt, chksum_src,
+					   sizeof(chksum_src) + 1 - 77),
+		      0, NULL);
+	zassert_equal(pkt->chksum_len, 2 * sizeof(chksum_src) + 1 - 77,
+		      NULL);
+
+	net_pkt_cursor_init(pkt);
+	fused = net_calc_chksum_udp(pkt);
+
+	pkt->chksum_len = 0U;
+	full = net_calc_chksum_udp(pkt);
+
+	zassert_equal(fused, full, "0x%04x != 0x%04x", fused, full);
+
+	net_pkt_unref(pkt);
+}
+#else
+void test_chksum_pkt_write(void)
+{
+	ztest_test_skip();
+}
+#endif
+
 void test_main(void)
 {
 	ztest_test_suite(test_utils_fn,
 			 ztest_unit_test(test_net_addr),
 			 ztest_user_unit_test(test_net_addr),
-			 ztest_unit_test(test_addr_parse));
+			 ztest_unit_test(test_addr_parse),
+			 ztest_unit_test(test_chksum),
+			 ztest_unit_test(test_chksum_pkt_write));
 
 	ztest_run_test_suite(test_utils_fn);
 }
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2019 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "fcb_test.h"
+
+#define TEST_ELEMS 250
+
+static struct fcb_entry test_locs[TEST_ELEMS];
+
+static void fcb_test_check_loc(struct fcb_entry *loc, int i)
+{
+	zassert_true(loc->fe_sector == test_locs[i].fe_sector &&
+		     loc->fe_elem_off == test_locs[i].fe_elem_off &&
+		     loc->fe_data_off == test_locs[i].fe_data_off &&
+		     loc->fe_data_len == test_locs[i].fe_data_len,
+		     "wrong location of entry %d", i);
+}
+
+static void fcb_test_check_all(struct fcb *fcb, int first, int cnt)
+{
+	struct fcb_entry loc;
+	int i;
+
+	loc.fe_sector = NULL;
+	loc.fe_elem_off = 0U;
+	for (i = first; i < cnt; i++) {
+		zassert_true(fcb_getnext(fcb, &loc) == 0,
+			     "fcb_getnext call failure");
+		fcb_test_check_loc(&loc, i);
+	}
+	zassert_true(fcb_getnext(fcb, &loc) == FCB_ERR_NOVAR,
+		     "fcb_getnext returned more entries");
+
+	/* From any entry */
+	for (i = first; i < cnt - 1; i += 7) {
+		loc = test_locs[i];
+		zassert_true(fcb_getnext(fcb, &loc) == 0,
+			     "fcb_getnext call failure");
+		fcb_test_check_loc(&loc, i + 1);
+	}
+
+	for (i = 1; i <= 255; i += 31) {
+		zassert_true(fcb_offset_last_n(fcb, i, &loc) == 0,
+			     "fcb_offset_last_n call failure");
+		fcb_test_check_loc(&loc, MAX(cnt - i, first));
+	}
+}
+
+static void fcb_test_append_elems(struct fcb *fcb, int first, int cnt)
+{
+	int rc;
+	int i;
+
+	for (i = first; i < cnt; i++) {
+		rc = fcb_append(fcb, (i % 150) + 20, &test_locs[i]);
+		zassert_true(rc == 0, "fcb_append call failure");
+
+		rc = fcb_append_finish(fcb, &test_locs[i]);
+		zassert_true(rc == 0, "fcb_append_finish call failure");
+	}
+}
+
+void fcb_test_getnext(void)
+{
+	struct fcb *fcb;
+	struct fcb_entry loc;
+	int first;
+	int rc;
+
+	fcb = &test_fcb;
+	fcb->f_scratch_cnt = 1U;
+
+	fcb_test_append_elems(fcb, 0, TEST_ELEMS - 10);
+	zassert_true(test_locs[TEST_ELEMS - 11].fe_sector !=
+		     &test_fcb_sector[0],
+		     "entries should fill more than one sector");
+	fcb_test_check_all(fcb, 0, TEST_ELEMS - 10);
+
+	/* First entry of a sector */
+	loc.fe_sector = test_locs[TEST_ELEMS - 11].fe_sector;
+	loc.fe_elem_off = 0U;
+	zassert_true(fcb_getnext(fcb, &loc) == 0, "fcb_getnext call failure");
+	for (first = 0; test_locs[first].fe_sector != loc.fe_sector; first++) {
+	}
+	fcb_test_check_loc(&loc, first);
+
+	rc = fcb_rotate(fcb);
+	zassert_true(rc == 0, "fcb_rotate call failure");
+#if defined(CONFIG_FCB_DIRECTORY)
+	zassert_equal(fcb->f_dir_valid,
+		      TEST_ELEMS - 10 - first <= CONFIG_FCB_DIRECTORY_SIZE,
+		      "directory not rebuilt after rotate");
+#endif
+	fcb_test_check_all(fcb, first, TEST_ELEMS - 10);
+
+	fcb_test_append_elems(fcb, TEST_ELEMS - 10, TEST_ELEMS);
+	fcb_test_check_all(fcb, first, TEST_ELEMS);
+
+	rc = fcb_init(TEST_FCB_FLASH_AREA_ID, fcb);
+	zassert_true(rc == 0, "fcb_init call failure");
+	fcb_test_check_all(fcb, first, TEST_ELEMS);
+}
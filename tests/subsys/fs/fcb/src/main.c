@@ -142,6 +142,7 @@ void fcb_test_reset(void);
 void fcb_test_rotate(void);
 void fcb_test_multi_scratch(void);
 void fcb_test_last_of_n(void);
+void fcb_test_getnext(void);
 
 void test_main(void)
 {
@@ -171,6 +172,9 @@ void test_main(void)
 			 ztest_unit_test_setup_teardown(fcb_test_last_of_n,
 							fcb_pretest_4_sectors,
 							teardown_nothing),
+			 ztest_unit_test_setup_teardown(fcb_test_getnext,
+							fcb_pretest_4_sectors,
+							teardown_nothing),
 			 /* Finally, run one that leaves behind a
 			  * flash.bin file without any random content */
 			 ztest_unit_test_setup_teardown(fcb_test_reset,
@@ -244,6 +244,12 @@ void test_nvs_gc(void)
 
 	}
 
+#if defined(CONFIG_NVS_GC_STATS)
+	zassert_equal(fs.gc_count, 1, "unexpected gc count: %u", fs.gc_count);
+	zassert_true(fs.gc_copied >= max_id * sizeof(buf),
+		     "gc did not copy all entries: %u", fs.gc_copied);
+#endif
+
 	err = nvs_init(&fs, DT_FLASH_DEV_NAME);
 	zassert_true(err == 0,  "nvs_init call failure: %d", err);
 
@@ -585,6 +591,139 @@ void test_delete(void)
 		     " any footprint in the storage");
 }
 
+static int flash_sim_read_calls_find(struct stats_hdr *hdr, void *arg,
+				     const char *name, uint16_t off)
+{
+	if (!strcmp(name, "flash_read_calls")) {
+		u32_t **flash_read_stat = (u32_t **) arg;
+		*flash_read_stat = (u32_t *)((u8_t *)hdr + off);
+	}
+
+	return 0;
+}
+
+/*
+ * Test that with the lookup cache a read does not walk the allocation
+ * table, also after a reinitialization.
+ */
+void test_nvs_lookup_cache(void)
+{
+#if defined(CONFIG_NVS_LOOKUP_CACHE)
+	int err;
+	ssize_t len;
+	u16_t id, data;
+	u32_t *flash_read_stat;
+	u32_t reads;
+	int i, j;
+
+	fs.sector_count = 3;
+
+	err = nvs_init(&fs, DT_FLASH_DEV_NAME);
+	zassert_true(err == 0,  "nvs_init call failure: %d", err);
+
+	for (i = 0; i < 3; i++) {
+		for (id = 0; id < 32; id++) {
+			data = id + i;
+			len = nvs_write(&fs, id, &data, sizeof(data));
+			zassert_true(len == sizeof(data),
+				     "nvs_write failed: %d", len);
+		}
+	}
+
+	stats_walk(sim_stats, flash_sim_read_calls_find, &flash_read_stat);
+
+	for (j = 0; j < 2; j++) {
+		for (id = 0; id < 32; id++) {
+			reads = *flash_read_stat;
+			len = nvs_read(&fs, id, &data, sizeof(data));
+			zassert_true(len == sizeof(data),
+				     "nvs_read failed: %d", len);
+			zassert_equal(data, id + 2, "incorrect data read");
+			zassert_true(*flash_read_stat - reads <= 3,
+				     "too many flash reads: %u",
+				     *flash_read_stat - reads);
+		}
+
+		/* An id that was never written is not searched for */
+		reads = *flash_read_stat;
+		len = nvs_read(&fs, 100, &data, sizeof(data));
+		zassert_true(len == -ENOENT,
+			     "nvs_read shouldn't found the entry: %d", len);
+		zassert_equal(*flash_read_stat, reads,
+			      "flash read for an unknown id");
+
+		err = nvs_init(&fs, DT_FLASH_DEV_NAME);
+		zassert_true(err == 0,  "nvs_init call failure: %d", err);
+	}
+#else
+	ztest_test_skip();
+#endif
+}
+
+struct walk_result {
+	u32_t addr[4];
+	u16_t len[4];
+	int cnt;
+};
+
+static int walk_cb(u16_t id, u32_t addr, size_t len, void *arg)
+{
+	struct walk_result *res = arg;
+
+	res->cnt++;
+	/* Keep the latest entry of each id, which is found first */
+	if ((id < ARRAY_SIZE(res->addr)) && (res->addr[id] == 0xFFFFFFFF)) {
+		res->addr[id] = addr;
+		res->len[id] = len;
+	}
+
+	return 0;
+}
+
+void test_nvs_walk(void)
+{
+	int err;
+	ssize_t len;
+	u16_t id, data;
+	struct walk_result res;
+
+	err = nvs_init(&fs, DT_FLASH_DEV_NAME);
+	zassert_true(err == 0,  "nvs_init call failure: %d", err);
+
+	for (data = 0; data < 2; data++) {
+		for (id = 1; id < 4; id++) {
+			len = nvs_write(&fs, id, &data, sizeof(data));
+			zassert_true(len == sizeof(data),
+				     "nvs_write failed: %d", len);
+		}
+	}
+	err = nvs_delete(&fs, 3);
+	zassert_true(err == 0,  "nvs_delete call failure: %d", err);
+
+	(void)memset(&res, 0xff, sizeof(res));
+	res.cnt = 0;
+	err = nvs_walk(&fs, walk_cb, &res);
+	zassert_true(err == 0,  "nvs_walk call failure: %d", err);
+	zassert_equal(res.cnt, 7, "wrong number of entries walked: %d",
+		      res.cnt);
+	zassert_equal(res.addr[0], 0xFFFFFFFF, "unwritten id found");
+	zassert_equal(res.len[1], sizeof(data), "wrong length");
+	zassert_equal(res.len[3], 0, "deleted id has a length");
+
+	for (id = 1; id < 3; id++) {
+		data = 0U;
+		len = nvs_read_addr(&fs, id, res.addr[id], &data, sizeof(data));
+		zassert_true(len == sizeof(data),
+			     "nvs_read_addr failed: %d", len);
+		zassert_equal(data, 1, "latest entry not found first");
+	}
+
+	len = nvs_read_addr(&fs, 3, res.addr[3], &data, sizeof(data));
+	zassert_true(len == -ENOENT, "deleted entry read: %d", len);
+	len = nvs_read_addr(&fs, 2, res.addr[1], &data, sizeof(data));
+	zassert_true(len == -ENOENT, "entry of another id read: %d", len);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(test_nvs,
@@ -604,6 +743,10 @@ void test_main(void)
 			 ztest_unit_test_setup_teardown(test_nvs_full_sector,
 				 setup, teardown),
 			 ztest_unit_test_setup_teardown(test_delete, setup,
+				 teardown),
+			 ztest_unit_test_setup_teardown(test_nvs_lookup_cache,
+				 setup, teardown),
+			 ztest_unit_test_setup_teardown(test_nvs_walk, setup,
 				 teardown)
 			);
 
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2019 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <zephyr.h>
+#include <string.h>
+#include <errno.h>
+#include <settings/settings.h>
+
+#define MOCK_WRITES_MAX 16
+#define MOCK_VAL_MAX 16
+
+struct mock_write {
+	char name[SETTINGS_MAX_NAME_LEN + 1];
+	u8_t value[MOCK_VAL_MAX];
+	size_t val_len;
+	bool null;
+};
+
+static struct mock_write mock_writes[MOCK_WRITES_MAX];
+static int mock_write_cnt;
+static int mock_write_cnt_at_load;
+static int mock_rc;
+
+static int mock_load(struct settings_store *cs, const char *subtree)
+{
+	mock_write_cnt_at_load = mock_write_cnt;
+	return 0;
+}
+
+static int mock_save(struct settings_store *cs, const char *name,
+		     const char *value, size_t val_len)
+{
+	struct mock_write *wr;
+
+	if (mock_rc) {
+		return mock_rc;
+	}
+
+	if (!value && !strcmp(name, "d/missing")) {
+		return -ENOENT;
+	}
+
+	zassert_true(mock_write_cnt < MOCK_WRITES_MAX, "too many writes");
+	zassert_true(val_len <= MOCK_VAL_MAX, "value too long");
+
+	wr = &mock_writes[mock_write_cnt++];
+	strcpy(wr->name, name);
+	wr->null = (value == NULL);
+	wr->val_len = val_len;
+	if (value) {
+		memcpy(wr->value, value, val_len);
+	}
+
+	return 0;
+}
+
+static const struct settings_store_itf mock_itf = {
+	.csi_load = mock_load,
+	.csi_save = mock_save,
+};
+
+static struct settings_store mock_store = {
+	.cs_itf = &mock_itf,
+};
+
+int settings_backend_init(void)
+{
+	settings_dst_register(&mock_store);
+	settings_src_register(&mock_store);
+	return 0;
+}
+
+static void check_write(int idx, const char *name, u8_t value)
+{
+	zassert_true(idx < mock_write_cnt, "write %d missing", idx);
+	zassert_true(!strcmp(mock_writes[idx].name, name),
+		     "write %d is %s instead of %s", idx,
+		     mock_writes[idx].name, name);
+	zassert_equal(mock_writes[idx].val_len, sizeof(value),
+		      "wrong length written");
+	zassert_equal(mock_writes[idx].value[0], value,
+		      "wrong value written for %s", name);
+}
+
+static void save(const char *name, u8_t value)
+{
+	int rc;
+
+	rc = settings_save_one(name, &value, sizeof(value));
+	zassert_true(rc == 0, "settings_save_one failed: %d", rc);
+}
+
+static void setup(void)
+{
+	int rc;
+
+	rc = settings_flush();
+	zassert_true(rc == 0, "settings_flush failed: %d", rc);
+	mock_write_cnt = 0;
+}
+
+static void test_cache_init(void)
+{
+	int rc;
+
+	rc = settings_subsys_init();
+	zassert_true(rc == 0, "settings_subsys_init failed: %d", rc);
+}
+
+/* Repeated writes of a setting reach the back-end once, unchanged values
+ * not at all.
+ */
+static void test_cache_coalesce(void)
+{
+	int rc;
+
+	save("c/a", 1);
+	save("c/a", 2);
+	save("c/a", 3);
+	zassert_equal(mock_write_cnt, 0, "write not cached");
+
+	rc = settings_flush();
+	zassert_true(rc == 0, "settings_flush failed: %d", rc);
+	zassert_equal(mock_write_cnt, 1, "writes not merged");
+	check_write(0, "c/a", 3);
+
+	save("c/a", 3);
+	rc = settings_flush();
+	zassert_true(rc == 0, "settings_flush failed: %d", rc);
+	zassert_equal(mock_write_cnt, 1, "unchanged value written");
+}
+
+/* Settings are written in the order they were first changed, with their
+ * latest value, so a setting never reaches the back-end before the
+ * settings changed ahead of it.
+ */
+static void test_cache_order(void)
+{
+	int rc;
+
+	save("o/x", 1);
+	save("o/y", 1);
+	save("o/x", 2);
+	rc = settings_delete("o/z");
+	zassert_true(rc == 0, "settings_delete failed: %d", rc);
+	zassert_equal(mock_write_cnt, 0, "write not cached");
+
+	rc = settings_flush();
+	zassert_true(rc == 0, "settings_flush failed: %d", rc);
+	zassert_equal(mock_write_cnt, 3, "wrong number of writes");
+	check_write(0, "o/x", 2);
+	check_write(1, "o/y", 1);
+	zassert_true(!strcmp(mock_writes[2].name, "o/z"), "delete missing");
+	zassert_true(mock_writes[2].null && (mock_writes[2].val_len == 0),
+		     "delete written as a value");
+}
+
+/* Deleting a setting the back-end does not have is not an error */
+static void test_cache_delete_missing(void)
+{
+	int rc;
+
+	rc = settings_delete("d/missing");
+	zassert_true(rc == 0, "settings_delete failed: %d", rc);
+	save("d/a", 1);
+
+	rc = settings_flush();
+	zassert_true(rc == 0, "settings_flush failed: %d", rc);
+	zassert_equal(mock_write_cnt, 1, "wrong number of writes");
+	check_write(0, "d/a", 1);
+}
+
+/* A value too long for the cache is written at once, after the values
+ * changed before it.
+ */
+static void test_cache_write_through(void)
+{
+	u8_t big[MOCK_VAL_MAX] = { 0 };
+	int rc;
+
+	save("w/a", 1);
+	rc = settings_save_one("w/b", big, sizeof(big));
+	zassert_true(rc == 0, "settings_save_one failed: %d", rc);
+	zassert_equal(mock_write_cnt, 2, "long value not written");
+	check_write(0, "w/a", 1);
+	zassert_true(!strcmp(mock_writes[1].name, "w/b"), "wrong order");
+}
+
+static void test_cache_threshold(void)
+{
+	save("t/1", 1);
+	save("t/2", 2);
+	save("t/3", 3);
+	k_sleep(10);
+	zassert_equal(mock_write_cnt, 0, "flushed below the threshold");
+
+	save("t/4", 4);
+	k_sleep(10);
+	zassert_equal(mock_write_cnt, 4, "not flushed at the threshold");
+	check_write(0, "t/1", 1);
+	check_write(3, "t/4", 4);
+}
+
+static void test_cache_interval(void)
+{
+	save("i/a", 1);
+	k_sleep(CONFIG_SETTINGS_CACHE_FLUSH_INTERVAL / 2);
+	zassert_equal(mock_write_cnt, 0, "flushed before the interval");
+
+	k_sleep(CONFIG_SETTINGS_CACHE_FLUSH_INTERVAL);
+	zassert_equal(mock_write_cnt, 1, "not flushed after the interval");
+	check_write(0, "i/a", 1);
+}
+
+/* Values the back-end failed to write are kept, in order */
+static void test_cache_backend_error(void)
+{
+	int rc;
+
+	mock_rc = -EIO;
+
+	save("e/1", 1);
+	save("e/2", 2);
+	rc = settings_flush();
+	zassert_equal(rc, -EIO, "flush error not returned: %d", rc);
+
+	save("e/3", 3);
+	save("e/4", 4);
+	k_sleep(10);
+
+	/* All entries hold changed values, no room for another one */
+	rc = settings_save_one("e/5", "5", 1);
+	zassert_equal(rc, -EIO, "flush error not returned: %d", rc);
+
+	mock_rc = 0;
+	rc = settings_flush();
+	zassert_true(rc == 0, "settings_flush failed: %d", rc);
+	zassert_equal(mock_write_cnt, 4, "wrong number of writes");
+	check_write(0, "e/1", 1);
+	check_write(1, "e/2", 2);
+	check_write(2, "e/3", 3);
+	check_write(3, "e/4", 4);
+}
+
+static void test_cache_load(void)
+{
+	int rc;
+
+	save("l/a", 1);
+	rc = settings_load();
+	zassert_true(rc == 0, "settings_load failed: %d", rc);
+	zassert_equal(mock_write_cnt_at_load, 1, "not flushed before load");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_settings_cache,
+			 ztest_unit_test(test_cache_init),
+			 ztest_unit_test_setup_teardown(test_cache_coalesce,
+				 setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_cache_order,
+				 setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(
+				 test_cache_delete_missing, setup,
+				 unit_test_noop),
+			 ztest_unit_test_setup_teardown(
+				 test_cache_write_through, setup,
+				 unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_cache_threshold,
+				 setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_cache_interval,
+				 setup, unit_test_noop),
+			 ztest_unit_test_setup_teardown(
+				 test_cache_backend_error, setup,
+				 unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_cache_load,
+				 setup, unit_test_noop)
+			);
+
+	ztest_run_test_suite(test_settings_cache);
+}
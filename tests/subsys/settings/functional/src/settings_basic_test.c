@@ -16,16 +16,15 @@
 #include <logging/log.h>
 LOG_MODULE_REGISTER(settings_basic_test);
 
-#ifdef CONFIG_SETTINGS_FCB
 #include <storage/flash_map.h>
-#endif
 
 /* The standard test expects a cleared flash area.  Make sure it has
  * one.
  */
 static void test_clear_settings(void)
 {
-	if (IS_ENABLED(CONFIG_SETTINGS_FCB)) {
+	if (IS_ENABLED(CONFIG_SETTINGS_FCB) ||
+	    IS_ENABLED(CONFIG_SETTINGS_NVS)) {
 		const struct flash_area *fap;
 		int rc = flash_area_open(DT_FLASH_AREA_STORAGE_ID, &fap);
 
@@ -322,11 +321,51 @@ static void test_register_and_loading(void)
 	zassert_true(rc, "deregistering val1_settings failed");
 }
 
+SETTINGS_STATIC_HANDLER_DEFINE(st, "st", NULL, NULL, NULL, NULL);
+SETTINGS_STATIC_HANDLER_DEFINE(st_a, "st/a", NULL, NULL, NULL, NULL);
+SETTINGS_STATIC_HANDLER_DEFINE(st_a_b, "st/a/b", NULL, NULL, NULL, NULL);
+SETTINGS_STATIC_HANDLER_DEFINE(st_b, "st/b", NULL, NULL, NULL, NULL);
+
+/*
+ * Test that the static handler with the longest matching name is found for
+ * a setting
+ */
+static void test_static_lookup(void)
+{
+	struct settings_handler_static *ch;
+	const char *next;
+
+	ch = settings_parse_and_lookup("st/a/b/c", &next);
+	zassert_equal_ptr(ch, &settings_handler_st_a_b, "wrong handler");
+	zassert_true(next && !strcmp(next, "c"), "wrong next");
+
+	ch = settings_parse_and_lookup("st/a/c", &next);
+	zassert_equal_ptr(ch, &settings_handler_st_a, "wrong handler");
+	zassert_true(next && !strcmp(next, "c"), "wrong next");
+
+	ch = settings_parse_and_lookup("st/ab", &next);
+	zassert_equal_ptr(ch, &settings_handler_st, "wrong handler");
+	zassert_true(next && !strcmp(next, "ab"), "wrong next");
+
+	ch = settings_parse_and_lookup("st/b=", &next);
+	zassert_equal_ptr(ch, &settings_handler_st_b, "wrong handler");
+	zassert_is_null(next, "wrong next");
+
+	ch = settings_parse_and_lookup("st", &next);
+	zassert_equal_ptr(ch, &settings_handler_st, "wrong handler");
+	zassert_is_null(next, "wrong next");
+
+	ch = settings_parse_and_lookup("stb/a", &next);
+	zassert_is_null(ch, "handler found for unknown setting");
+	zassert_is_null(next, "wrong next");
+}
+
 void test_main(void)
 {
 	ztest_test_suite(settings_test_suite,
 			 ztest_unit_test(test_clear_settings),
 			 ztest_unit_test(test_support_rtn),
+			 ztest_unit_test(test_static_lookup),
 			 ztest_unit_test(test_register_and_loading)
 			);
 